@@ -22,8 +22,19 @@
 #include <assert.h>
 #include <table/BaseTable.hpp>
 #include "mvcc/mvcc.hpp"
+#include "mvcc/inplace_mvcc.hpp"
 #include "Transactions/Epochs.hpp"
+#include "Transactions/GarbageCollector.hpp"
+#include "Transactions/RedoLog.hpp"
+#include "Transactions/Checkpoint.hpp"
+#include "Transactions/TierRun.hpp"
+#include "ART/WriteBuffer.hpp"
+#include "ART/HashIndex.hpp"
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <algorithm>
 #ifdef __i386__
 #include <emmintrin.h>
 #else
@@ -34,19 +45,136 @@
 
 using namespace boost;
 
+/// 1 to keep a byte of the key's hash in the unused top byte of each tagged leaf pointer, see ArtCPP::setLeafFingerprints()
+#ifndef ART_LEAF_FINGERPRINTS
+#if UINTPTR_MAX > 0xFFFFFFFFu
+#define ART_LEAF_FINGERPRINTS 1
+#else
+#define ART_LEAF_FINGERPRINTS 0
+#endif
+#endif
+
+#if ART_LEAF_FINGERPRINTS
+#define LEAF_FINGERPRINT_SHIFT 56
+
+/**
+ * Checks once that heap pointers leave their top byte zero, so it can carry a
+ * fingerprint. It is not on 5-level paging (LA57) with high mappings, or with
+ * tagged pointers (ARM TBI/MTE, HWASan); leaf pointers then carry no fingerprint.
+ * @return true if the top byte of the probed allocations is zero
+ */
+static inline bool artLeafTopByteFree()
+{
+    static const bool free = [] {
+        const size_t sizes[] = {16, 4096, 1 << 20};
+        for (size_t size : sizes) {
+            void* p = malloc(size);
+            bool zero = ((uintptr_t)p >> LEAF_FINGERPRINT_SHIFT) == 0;
+            ::free(p);
+            if (!zero)
+                return false;
+        }
+        return true;
+    }();
+    return free;
+}
+
+/// Tag bits of a leaf pointer, the fingerprint byte only where artLeafTopByteFree()
+static inline uintptr_t artLeafTagMask()
+{
+    static const uintptr_t mask = artLeafTopByteFree() ? (((uintptr_t)0xFF << LEAF_FINGERPRINT_SHIFT) | 1) : 1;
+    return mask;
+}
+
+#define LEAF_TAG_MASK artLeafTagMask()
+#else
+#define LEAF_TAG_MASK ((uintptr_t)1)
+#endif
+
 /**
  * Macros to manipulate pointer tags
  */
 #define IS_LEAF(x) (((uintptr_t)x & 1))
 #define SET_LEAF(x) ((void*)((uintptr_t)x | 1))
-#define LEAF_RAW(x) ((art_leaf*)((void*)((uintptr_t)x & ~1)))
+#define LEAF_RAW(x) ((art_leaf*)((void*)((uintptr_t)x & ~LEAF_TAG_MASK)))
 
 #define NODE4   1
 #define NODE16  2
 #define NODE48  3
 #define NODE256 4
 #define MAX_PREFIX_LEN 10
-#define MAX_VERSION_DEPTH 100
+#define MAX_VERSION_DEPTH MVCC11_MAX_VERSION_DEPTH
+
+/// Number of point probes a worker keeps in flight in the batched lookups
+#ifndef ART_INTERLEAVE_GROUP
+#define ART_INTERLEAVE_GROUP 16
+#endif
+#define ART_PREFETCH(p) __builtin_prefetch((const void*)(p))
+
+/// Restarts a point lookup takes on nodes a writer holds locked before it reads through the lock
+#ifndef ART_LOCKED_READ_RESTARTS
+#define ART_LOCKED_READ_RESTARTS 64
+#endif
+
+/// Inner nodes of the last insertion path a thread remembers, see ArtCPP::setFingerCaching()
+#ifndef ART_FINGER_DEPTH
+#define ART_FINGER_DEPTH 24
+#endif
+
+/// Key bytes a new table's root indexes directly (1: 256 slots, 2: 65536), 0 for a plain root, see ArtCPP::partitionRoot()
+#ifndef ART_ROOT_PARTITION_BYTES
+#define ART_ROOT_PARTITION_BYTES 0
+#endif
+
+/// Lost write locks on a node, each within ART_COMBINING_WINDOW_US of the last, before writers combine their inserts into it
+#ifndef ART_COMBINING_THRESHOLD
+#define ART_COMBINING_THRESHOLD 4
+#endif
+
+/// A hot node that loses no write lock for this long cools down, its publication list goes to the next hot node
+#ifndef ART_COMBINING_WINDOW_US
+#define ART_COMBINING_WINDOW_US 1000
+#endif
+
+/// Hot nodes of a table with a publication list at the same time, see ArtCPP::setCombining()
+#ifndef ART_COMBINING_NODES
+#define ART_COMBINING_NODES 64
+#endif
+
+/// Inserts a publication list holds at once
+#ifndef ART_COMBINING_RECORDS
+#define ART_COMBINING_RECORDS 32
+#endif
+
+/// Yields a writer waits for the lock holder to take its published insert before it restarts
+#ifndef ART_COMBINING_WAIT
+#define ART_COMBINING_WAIT 64
+#endif
+
+/// Restarts and lost write locks on a node, each within ART_COMBINING_WINDOW_US of the last, before it is latched, see ArtCPP::setAdaptiveLatching()
+#ifndef ART_LATCH_THRESHOLD
+#define ART_LATCH_THRESHOLD 16
+#endif
+
+/// A latched node that sees no conflict for this long goes back to optimistic locking only
+#ifndef ART_LATCH_CALM_US
+#define ART_LATCH_CALM_US 10000
+#endif
+
+/// 1 for new tables whose leaves keep only the key bytes past their path, see ArtCPP::setLeafSuffixes()
+#ifndef ART_LEAF_SUFFIXES
+#define ART_LEAF_SUFFIXES 0
+#endif
+
+/// Keys a thread's read cache holds, a power of two, see ArtCPP::setReadCaching()
+#ifndef ART_READ_CACHE_ENTRIES
+#define ART_READ_CACHE_ENTRIES 1024
+#endif
+
+/// Counters that removed leaves bump by key hash, a read cache entry is stale once its counter moved
+#ifndef ART_READ_CACHE_STRIPES
+#define ART_READ_CACHE_STRIPES 64
+#endif
 
 typedef char DefaultKeyType[20];
 typedef boost::shared_mutex Mutex;
@@ -68,9 +196,14 @@ typedef struct
 {
     uint8_t type;
     uint8_t num_children;
+    ///node of a partitioned root: never locked, resized or replaced, its slots are claimed by CAS
+    uint8_t pinned;
     uint32_t partial_len;
     unsigned char partial[MAX_PREFIX_LEN];
 
+    ///newest checkpoint epoch a write below this node happened in, fits the header padding
+    std::atomic<uint32_t> dirtyEpoch;
+
     //2b type 60b version 1b lock 1b obsolete
     std::atomic<uint64_t> version{0b100};
 
@@ -160,7 +293,8 @@ void readUnlockOrRestart(art_node* node, uint64_t version,bool &needRestart)
 
 bool upgradeToWriteLockOrRestart(art_node* node, uint64_t& v,bool &needRestart)
 {
-    if (!node->version.compare_exchange_strong(v,v + 0b10)) ///CAS(version, setLockedBit(version)))
+    ///a version read while the node was locked or obsolete cannot be upgraded, the CAS would release the holder's lock
+    if ((v & 0b11) != 0 || !node->version.compare_exchange_strong(v,v + 0b10)) ///CAS(version, setLockedBit(version)))
     {
         v = v + 0b10;
         needRestart = true;
@@ -175,6 +309,12 @@ bool upgradeToWriteLockOrRestart(art_node* node, uint64_t& v,bool &needRestart)
 
 }
 
+/// Swaps the child in slot of a pinned node if it still is expected
+bool casChild(art_node** slot, art_node* expected, art_node* desired)
+{
+    return reinterpret_cast<std::atomic<art_node*>*>(slot)->compare_exchange_strong(expected, desired);
+}
+
 bool upgradeToWriteLockOrRestart(art_node* node, uint64_t version,art_node* lockedNode,bool &needRestart)
 {
     if (!node->version.compare_exchange_strong(version, version + 0b10))
@@ -246,9 +386,115 @@ typedef std::function<bool( void *)> Pred;
 typedef std::function<bool( void *)> UpdelFunc;
 
 
+/**
+ * Checkpoint epoch, advanced by every checkpoint of a table tracking dirty
+ * subtrees. Shared by all tables: a node only has to know whether it changed
+ * after a given checkpoint began.
+ */
+std::atomic<uint32_t> artCheckpointEpoch(1);
+
+/**
+ * Bumped whenever an inner node is freed: grown, shrunk, merged into its
+ * child or destroyed with its tree. Fingers hold raw node pointers and
+ * follow them only while this has not moved since they were taken.
+ */
+std::atomic<uint64_t> artNodeFrees(0);
+
+/**
+ * Fixed array of cache line aligned elements on the heap. A member array
+ * of them would make its owner over-aligned, and plain new of such an
+ * owner ignores that alignment before C++17.
+ */
+template <typename T>
+class AlignedArray
+{
+public:
+    explicit AlignedArray(size_t count) : mCount(count), mData(nullptr)
+    {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, std::max(alignof(T), sizeof(void*)), sizeof(T) * count) != 0)
+            throw std::bad_alloc();
+        mData = static_cast<T*>(memory);
+        for (size_t i = 0; i < count; i++)
+            new (mData + i) T();
+    }
+
+    ~AlignedArray()
+    {
+        for (size_t i = 0; i < mCount; i++)
+            mData[i].~T();
+        free(mData);
+    }
+
+    AlignedArray(const AlignedArray&) = delete;
+    AlignedArray& operator=(const AlignedArray&) = delete;
+
+    T& operator[](size_t i) { return mData[i]; }
+    const T& operator[](size_t i) const { return mData[i]; }
+    T* begin() { return mData; }
+    T* end() { return mData + mCount; }
+    const T* begin() const { return mData; }
+    const T* end() const { return mData + mCount; }
+
+private:
+    size_t mCount;
+    T* mData;
+};
+
+/// Point operations of one thread that started at its finger rather than at the root
+struct FingerStats
+{
+    uint64_t insertHits = 0;
+    uint64_t insertMisses = 0;
+    uint64_t lookupHits = 0;
+    uint64_t lookupMisses = 0;
+};
+
+/// Point lookups of one thread answered from its read cache, see ArtCPP::setReadCaching()
+struct ReadCacheStats
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    ///entries found for the key whose leaf was removed from the tree meanwhile, or may have been
+    uint64_t stale = 0;
+    ///misses that left a more frequently read key in its entry
+    uint64_t kept = 0;
+};
+
+/// Write-lock conflicts of inserts into one table, see ArtCPP::contentionStats()
+struct ContentionStats
+{
+    ///write locks an insert lost, or found taken when it reached a node
+    uint64_t conflicts = 0;
+    ///inserts started over at the root (or at their finger) after a conflict
+    uint64_t restarts = 0;
+    ///inserts handed to the holder of a hot node's lock, and how many it added
+    uint64_t published = 0;
+    uint64_t combined = 0;
+    ///nodes with a publication list now
+    uint64_t hotNodes = 0;
+    ///inserts on a publication list now, waiting for the holder of its node
+    uint64_t pending = 0;
+    ///point lookups that started over at a node that was locked or changed under them
+    uint64_t readRestarts = 0;
+    ///waits on the latch of a node, by lookups and by inserts that found it locked
+    uint64_t latchWaits = 0;
+    ///nodes latched now
+    uint64_t latchedNodes = 0;
+};
+
+/**
+ * Version a new node starts at, 2^19 lock episodes apart. A node calloc
+ * places where a freed one was must not show a version that a writer, or a
+ * published insert, still holds for the freed one, the CAS would succeed.
+ */
+std::atomic<uint64_t> artNodeVersions(0);
+
 /**
  * Allocates a node of the given type,
  * initializes to zero and sets the type.
+ * A new node starts dirty in the current checkpoint epoch, it may take over
+ * children written since the last checkpoint.
  **/
 static art_node* alloc_node(uint8_t type) {
     art_node* n;
@@ -269,6 +515,8 @@ static art_node* alloc_node(uint8_t type) {
             abort();
     }
     n->type = type;
+    n->dirtyEpoch.store(artCheckpointEpoch.load());
+    n->version.store(artNodeVersions.fetch_add(1ull << 20) + (1ull << 20));
     return n;
 }
 
@@ -336,6 +584,7 @@ static void destroy_node(art_node *n) {
     }
 
     // Free ourself on the way up
+    artNodeFrees.fetch_add(1);
     free(n);
 }
 
@@ -504,6 +753,7 @@ static void add_child48(art_node48 *n, art_node **ref, unsigned char c, void *ch
         }
         copy_header((art_node*)new_node, (art_node*)n);
         *ref = (art_node*)new_node;
+        artNodeFrees.fetch_add(1);
         free(n);
         add_child256(new_node, ref, c, child);
     }
@@ -572,6 +822,7 @@ static void add_child16(art_node16 *n, art_node **ref, unsigned char c, void *ch
         }
         copy_header((art_node*)new_node, (art_node*)n);
         *ref = (art_node*)new_node;
+        artNodeFrees.fetch_add(1);
         free(n);
         add_child48(new_node, ref, c, child);
     }
@@ -604,6 +855,7 @@ static void add_child4(art_node4 *n, art_node **ref, unsigned char c, void *chil
                sizeof(unsigned char)*n->n.num_children);
         copy_header((art_node*)new_node, (art_node*)n);
         *ref = (art_node*)new_node;
+        artNodeFrees.fetch_add(1);
         free(n);
         add_child16(new_node, ref, c, child);
     }
@@ -648,6 +900,8 @@ static bool isNodeFull(art_node *n) {
 
 static void remove_child256(art_node256 *n, art_node **ref, unsigned char c) {
     n->children[c] = NULL;
+    if (n->n.pinned)
+        return;
     n->n.num_children--;
 
     // Resize to a node48 on underflow, not immediately to prevent
@@ -665,6 +919,7 @@ static void remove_child256(art_node256 *n, art_node **ref, unsigned char c) {
                 pos++;
             }
         }
+        artNodeFrees.fetch_add(1);
         free(n);
     }
 }
@@ -689,6 +944,7 @@ static void remove_child48(art_node48 *n, art_node **ref, unsigned char c) {
                 child++;
             }
         }
+        artNodeFrees.fetch_add(1);
         free(n);
     }
 }
@@ -705,16 +961,27 @@ static void remove_child16(art_node16 *n, art_node **ref, art_node **l) {
         copy_header((art_node*)new_node, (art_node*)n);
         memcpy(new_node->keys, n->keys, 4);
         memcpy(new_node->children, n->children, 4*sizeof(void*));
+        artNodeFrees.fetch_add(1);
         free(n);
     }
 }
 
-static void remove_child4(art_node4 *n, art_node **ref, art_node **l) {
+/**
+ * keepPath is set for leaves that keep only their key suffix: every byte of
+ * their path has to stay in the nodes, so a last leaf is not pulled up and
+ * prefixes are not merged past MAX_PREFIX_LEN; a node4 may be left with one
+ * child or none, the caller removes an empty one.
+ */
+static void remove_child4(art_node4 *n, art_node **ref, art_node **l, bool keepPath = false) {
     int pos = l - n->children;
     memmove(n->keys+pos, n->keys+pos+1, n->n.num_children - 1 - pos);
     memmove(n->children+pos, n->children+pos+1, (n->n.num_children - 1 - pos)*sizeof(void*));
     n->n.num_children--;
 
+    if (keepPath && n->n.num_children == 1 &&
+        (IS_LEAF(n->children[0]) || n->n.partial_len + 1 + n->children[0]->partial_len > MAX_PREFIX_LEN))
+        return;
+
     // Remove nodes with only a single child
     if (n->n.num_children == 1) {
         art_node *child = n->children[0];
@@ -736,14 +1003,15 @@ static void remove_child4(art_node4 *n, art_node **ref, art_node **l) {
             child->partial_len += n->n.partial_len + 1;
         }
         *ref = child;
+        artNodeFrees.fetch_add(1);
         free(n);
     }
 }
 
-static void remove_child(art_node *n, art_node **ref, unsigned char c, art_node **l) {
+static void remove_child(art_node *n, art_node **ref, unsigned char c, art_node **l, bool keepPath = false) {
     switch (n->type) {
         case NODE4:
-            return remove_child4((art_node4*)n, ref, l);
+            return remove_child4((art_node4*)n, ref, l, keepPath);
         case NODE16:
             return remove_child16((art_node16*)n, ref, l);
         case NODE48:
@@ -809,29 +1077,196 @@ class ArtCPP : public pfabric::BaseTable
     using valueType = RecordType;
     using snapshot_type = mvcc11::snapshot<RecordType>;
     typedef smart_ptr::shared_ptr<snapshot_type const> const_snapshot_ptr;
+    /// in-place mvcc for trivially copyable records, snapshot chains otherwise
+    typedef typename mvcc11::select_mvcc<RecordType>::type mvcc_type;
 
     /**
 * Represents a leaf. These are
 * of arbitrary size, as they include the key with multiversioned object to get lock free Read access.
 */
     typedef struct mv_art_leaf {
-        mvcc11::mvcc<RecordType>* _mvcc;
+        mvcc_type* _mvcc;
         uint32_t key_len;
+        ///leading key bytes the path down to the leaf holds and key does not, 0 unless the table keeps suffixes
+        uint16_t key_depth;
+        ///keyFingerprint() of the whole key
+        uint8_t fingerprint;
+        ///the key_len - key_depth bytes past key_depth, the leaf is allocated for those only
         KeyType key;
     };
 
 
     typedef struct keyStruct
     {
-        KeyType k;
+        ///the whole key, keys may be longer than KeyType
+        std::string k;
     };
-    std::vector<keyStruct> deletionList;
-
-
-    public:  std::map<size_t,std::vector<mv_art_leaf>> ActiveTxnWriteSet;
-             std::map<size_t,std::vector<const_snapshot_ptr>> ActiveTxnReadSet;
-
 
+    ///Keys deleted since the last GC() pass; read/write sets live in TxnContext
+    private: struct DeletionQueue
+    {
+        boost::mutex lock;
+        std::vector<keyStruct> keys;
+    };
+    private: DeletionQueue deletionQueues[GC_QUEUE_PARTITIONS];
+    private: GarbageCollector gc;
+    ///GC() cycles of the driver thread and of callers run one at a time
+    private: boost::mutex gcCycleLock;
+    ///next root subtree the version sweep starts at
+    private: size_t pruneCursor = 0;
+    ///committed writes are logged here when set, see setRedoLog()
+    private: RedoLog* redoLog = nullptr;
+    ///writes raise the dirty epoch of their path, set by the first incrementalCheckpoint()
+    private: std::atomic<bool> dirtyTracking{false};
+    ///first epoch of the writes the next delta checkpoint has to cover
+    private: uint32_t checkpointEpoch = 0;
+    ///snapshot of the newest checkpoint, in checkpointDir
+    private: std::atomic<uint64_t> checkpointedTs{0};
+    private: std::string checkpointDir;
+    ///key ranges (keys sharing their first byte) move between the tree and runs on disk, see setMemoryBudget()
+    private: enum TierState { TierResident, TierEvicting, TierEvicted, TierLoading };
+    private: struct TierRange
+    {
+        std::atomic<int> state{TierResident};
+        ///access period of the newest point operation on the range
+        std::atomic<uint64_t> lastAccess{0};
+        ///point reads the run served since the range was evicted
+        std::atomic<uint32_t> runReads{0};
+        std::unique_ptr<TierRun> run;
+    };
+    private: struct alignas(64) TierPinCount
+    {
+        std::atomic<uint64_t> count{0};
+    };
+    ///point operations and scans pin the ranges while tiering is on
+    private: std::atomic<bool> tiering{false};
+    private: std::atomic<size_t> memoryBudget{0};
+    private: std::string tierDir;
+    private: TierRange tierRanges[256];
+    private: AlignedArray<TierPinCount> tierPins{16};
+    private: std::atomic<uint64_t> accessPeriod{1};
+    private: TierBlockCache blockCache;
+    ///one budget pass at a time
+    private: boost::mutex tierLock;
+    private: uint64_t tierRunSeq = 0;
+    private: std::atomic<uint64_t> residentEstimate{0};
+    private: std::atomic<uint64_t> tierEvictions{0};
+    private: std::atomic<uint64_t> tierReloads{0};
+    private: std::atomic<uint64_t> tierRunReads{0};
+    ///autocommit inserts go to the write buffer while set, see enableWriteBuffer()
+    private: std::atomic<bool> bufferWrites{false};
+    private: WriteBuffer<const_snapshot_ptr> writeBuffer;
+    private: std::unique_ptr<boost::thread> merger;
+    private: std::mutex mergerLock;
+    private: std::condition_variable mergerWake;
+    private: bool mergerStop = false;
+    ///inserts and point lookups of a thread start below the root, at its last insertion path, see setFingerCaching()
+    private: std::atomic<bool> fingerCaching{false};
+    ///tells the fingers of tables apart, the next table may get the same address
+    private: const uint64_t fingerOwner = nextFingerOwner();
+    private: struct FingerFrame
+    {
+        art_node* node;
+        ///slot of the parent (or the root pointer) that holds node
+        art_node** ref;
+        uint64_t version;
+        ///key bytes above node, its prefix starts at key[depth]
+        int depth;
+    };
+    private: struct Finger
+    {
+        uint64_t owner = 0;
+        ///artNodeFrees when the path was taken
+        uint64_t frees = 0;
+        bool recording = false;
+        int frames = 0;
+        FingerFrame path[ART_FINGER_DEPTH];
+        std::string key;
+        FingerStats stats;
+    };
+    ///key bytes the root indexes directly, 0 for a plain root, see partitionRoot()
+    private: int rootPartitionBytes = 0;
+    private: struct alignas(64) RootSlotKeys
+    {
+        std::atomic<uint64_t> count{0};
+    };
+    ///inserts below a partitioned root are counted here by first key byte rather than in t->size
+    private: AlignedArray<RootSlotKeys> rootSlotKeys{256};
+    ///losers of a hot node's write lock hand their inserts to its holder while set, see setCombining()
+    private: std::atomic<bool> combining{false};
+    ///an insert published on a hot node, one per thread; the low two bits of state are a CombineState
+    private: struct CombiningRecord
+    {
+        ///sequence of the insert in the upper bits, a record is reused once its insert is settled
+        std::atomic<uint64_t> state{0};
+        art_node* node = nullptr;
+        ///version of node the publisher descended with
+        uint64_t version = 0;
+        unsigned char byte = 0;
+        mv_art_leaf* leaf = nullptr;
+    };
+    private: enum CombineState : uint64_t { CombinePending = 0, CombineTaken = 1, CombineAdded = 2, CombineRefused = 3 };
+    ///conflict counts, publication list and latch of the hot node mapped here, see noteConflict()
+    private: struct alignas(64) CombiningSlot
+    {
+        std::atomic<art_node*> node{nullptr};
+        std::atomic<uint32_t> conflicts{0};
+        ///combiningClock() at the last conflict on node
+        std::atomic<uint64_t> lastConflict{0};
+        std::atomic<CombiningRecord*> records[ART_COMBINING_RECORDS]{};
+        ///writers of a latched node hold latch exclusively while they hold its lock, see latchOf()
+        std::atomic<bool> latched{false};
+        Mutex latch;
+    };
+    private: AlignedArray<CombiningSlot> combiningSlots{ART_COMBINING_NODES};
+    private: std::atomic<uint64_t> lockConflicts{0};
+    private: std::atomic<uint64_t> insertRestarts{0};
+    private: std::atomic<uint64_t> publishedInserts{0};
+    private: std::atomic<uint64_t> combinedInserts{0};
+    ///nodes with many conflicts get a reader-writer latch while set, see setAdaptiveLatching()
+    private: std::atomic<bool> latching{false};
+    private: std::atomic<uint64_t> readRestarts{0};
+    private: std::atomic<uint64_t> latchWaits{0};
+    ///*old of an insert that lost a write lock before it changed anything, it starts over
+    private: static const int InsertRestart = -1;
+    ///point lookups compare the fingerprint of a tagged leaf pointer before the leaf while set, see setLeafFingerprints()
+    private: std::atomic<bool> leafFingerprints{false};
+    ///leaves leave out the key bytes their path holds, see setLeafSuffixes()
+    private: bool leafSuffixes = false;
+    private: std::atomic<uint64_t> fingerprintRejected{0};
+    ///point lookups check a per-thread cache of leaves before the tree while set, see setReadCaching()
+    private: std::atomic<bool> readCaching{false};
+    private: struct ReadCacheEntry
+    {
+        uint64_t hash = 0;
+        mv_art_leaf* leaf = nullptr;
+        ///leafUnlinks of the key's stripe before the lookup that found leaf
+        uint64_t stamp = 0;
+        ///hits since the entry was filled, up to 3; a miss on the entry takes one instead of replacing it
+        uint32_t hits = 0;
+    };
+    private: struct ReadCache
+    {
+        uint64_t owner = 0;
+        ReadCacheEntry entries[ART_READ_CACHE_ENTRIES];
+        ReadCacheStats stats;
+    };
+    ///bumped by key hash before a leaf is unlinked from the tree, see readCacheInvalidate()
+    private: std::atomic<uint64_t> leafUnlinks[ART_READ_CACHE_STRIPES]{};
+    ///point operations count themselves in by the parity of leafEpoch while they hold leaves, see LeafPin
+    private: std::atomic<uint64_t> leafEpoch{0};
+    ///16 pins of parity 0, then 16 of parity 1
+    private: AlignedArray<TierPinCount> leafPins{32};
+    ///leaves unlinked by GC(), freed once no point operation can still hold them
+    private: boost::mutex retiredLock;
+    private: std::vector<mv_art_leaf*> retiredLeaves;
+    ///one freeRetiredLeaves() at a time, each waits for the parity the previous one left to readers
+    private: boost::mutex leafReclaimLock;
+    ///point lookups find leaves here instead of in the tree while set, see enableHashIndex()
+    private: std::unique_ptr<HashIndex<mv_art_leaf>> hashIndex;
+
+
+    public:
     typedef std::function<RecordType ( RecordType&)> Updater;
     typedef std::function<bool ( const_snapshot_ptr)> Predicate;
 
@@ -899,8 +1334,9 @@ class ArtCPP : public pfabric::BaseTable
         // Fail if the key length is too short
         if (n->key_len < (uint32_t)prefix_len) return 1;
 
-        // Compare the keys
-        return memcmp(n->key, prefix, prefix_len);
+        // Compare the keys past the bytes the path matched
+        if (prefix_len <= n->key_depth) return 0;
+        return memcmp(n->key, prefix + n->key_depth, prefix_len - n->key_depth);
     }
 
 
@@ -909,14 +1345,46 @@ class ArtCPP : public pfabric::BaseTable
         return ((uintptr_t)p & 1) != 0;
     }
 
+    /// Tags a leaf for its parent's slot, with the fingerprint of its key in the top byte
     __inline mv_art_leaf* SET_MV_LEAF(mv_art_leaf* p)
     {
+#if ART_LEAF_FINGERPRINTS
+        if (LEAF_TAG_MASK != 1)
+            return (mv_art_leaf*) ((uintptr_t)p | ((uintptr_t) p->fingerprint << LEAF_FINGERPRINT_SHIFT) | 1);
+        return (mv_art_leaf*) ((uintptr_t)p | 1);
+#else
         return (mv_art_leaf*) ((uintptr_t)p | 1);
+#endif
     }
 
     __inline mv_art_leaf* MV_LEAF_RAW(void* p)
     {
-        return (mv_art_leaf*)((uintptr_t)p & ~1);
+        return (mv_art_leaf*)((uintptr_t)p & ~LEAF_TAG_MASK);
+    }
+
+    /// Top byte of the index hash of a key, the fingerprint its tagged leaf pointers carry
+    static uint8_t keyFingerprint(const unsigned char* key, int key_len)
+    {
+        return (uint8_t) (HashIndex<mv_art_leaf>::hash(key, key_len) >> 56);
+    }
+
+    /**
+     * Checks the fingerprint of a tagged leaf pointer without reading the leaf.
+     * @return true if the leaf cannot hold the key, it need not be compared
+     */
+    __inline bool fingerprintMismatch(art_node* p, const unsigned char* key, int key_len)
+    {
+#if ART_LEAF_FINGERPRINTS
+        if (!leafFingerprints.load(std::memory_order_relaxed))
+            return false;
+        if ((uint8_t) ((uintptr_t)p >> LEAF_FINGERPRINT_SHIFT) == keyFingerprint(key, key_len))
+            return false;
+        fingerprintRejected.fetch_add(1, std::memory_order_relaxed);
+        return true;
+#else
+        (void)p; (void)key; (void)key_len;
+        return false;
+#endif
     }
 
     /// Find the minimum leaf under a node
@@ -938,9 +1406,11 @@ class ArtCPP : public pfabric::BaseTable
                 idx = ((const art_node48*)n)->keys[idx] - 1;
                 return minimum(((const art_node48*)n)->children[idx]);
             case NODE256:
-                idx=0;
-                while (!((const art_node256*)n)->children[idx]) idx++;
-                return minimum(((const art_node256*)n)->children[idx]);
+                ///a partitioned root may hold empty nodes
+                for (idx=0; idx < 256; idx++)
+                    if (mv_art_leaf* l = minimum(((const art_node256*)n)->children[idx]))
+                        return l;
+                return NULL;
             default:
                 abort();
         }
@@ -965,9 +1435,10 @@ class ArtCPP : public pfabric::BaseTable
                 idx = ((const art_node48*)n)->keys[idx] - 1;
                 return maximum(((const art_node48*)n)->children[idx]);
             case NODE256:
-                idx=255;
-                while (!((const art_node256*)n)->children[idx]) idx--;
-                return maximum(((const art_node256*)n)->children[idx]);
+                for (idx=255; idx >= 0; idx--)
+                    if (mv_art_leaf* l = maximum(((const art_node256*)n)->children[idx]))
+                        return l;
+                return NULL;
             default:
                 abort();
         }
@@ -1006,7 +1477,7 @@ class ArtCPP : public pfabric::BaseTable
             mv_art_leaf *l = minimum(n);
             max_cmp = min(l->key_len, key_len)- depth;
             for (; idx < max_cmp; idx++) {
-                if (l->key[idx+depth] != key[depth+idx])
+                if (mv_leaf_byte(l, idx+depth) != key[depth+idx])
                     return idx;
             }
         }
@@ -1022,37 +1493,259 @@ class ArtCPP : public pfabric::BaseTable
         // Fail if the key lengths are different
         if (n->key_len != (uint32_t)key_len) return 1;
 
-        // Compare the keys starting at the depth
-        return memcmp(n->key, key, key_len);
+        // Compare the keys past the bytes the path matched
+        return memcmp(n->key, key + n->key_depth, key_len - n->key_depth);
+    }
+
+    /// Appends the prefix of inner node n to path, the key bytes of the path down to n, with setLeafSuffixes()
+    private: size_t mv_path_enter(std::string& path, const art_node *n)
+    {
+        if (leafSuffixes)
+            path.append((const char*) n->partial, min(MAX_PREFIX_LEN, n->partial_len));
+        return path.size();
+    }
+
+    /// Ends path, below bytes long at n, with the byte of the child of n a walk goes to next
+    private: void mv_path_child(std::string& path, size_t below, unsigned char c)
+    {
+        if (!leafSuffixes)
+            return;
+        path.resize(below);
+        path.push_back((char) c);
+    }
+
+    /**
+     * Whole key of l, a leaf a walk came to with path holding the key bytes
+     * down to it; one that keeps a suffix only gets it rebuilt in key.
+     */
+    private: static const unsigned char* mv_leaf_key(const mv_art_leaf *l, const std::string& path, std::string& key)
+    {
+        if (l->key_depth == 0)
+            return (const unsigned char*) l->key;
+        key.assign(path, 0, l->key_depth);
+        key.append(l->key, l->key_len - l->key_depth);
+        return (const unsigned char*) key.data();
+    }
+
+    /// Byte i of the key of l, one at or past the bytes the path holds; 0 past the key, as a C string has
+    static unsigned char mv_leaf_byte(const mv_art_leaf *l, int i) {
+        return i < (int) l->key_len ? (unsigned char) l->key[i - l->key_depth] : 0;
     }
 
     static int mv_longest_common_prefix(mv_art_leaf *l1, mv_art_leaf *l2, int depth) {
         int max_cmp = min(l1->key_len, l2->key_len) - depth;
         int idx;
         for (idx=0; idx < max_cmp; idx++) {
-            if (l1->key[depth+idx] != l2->key[depth+idx])
+            if (mv_leaf_byte(l1, depth+idx) != mv_leaf_byte(l2, depth+idx))
+                return idx;
+        }
+        return idx;
+    }
+
+    static int mv_longest_common_prefix(mv_art_leaf *l, const unsigned char *key, int key_len, int depth) {
+        int max_cmp = min((int) l->key_len, key_len) - depth;
+        int idx;
+        for (idx=0; idx < max_cmp; idx++) {
+            if (mv_leaf_byte(l, depth+idx) != key[depth+idx])
                 return idx;
         }
         return idx;
     }
 
-    private: mv_art_leaf* make_mvv_leaf(const unsigned char *key, int key_len,RecordType& value,const size_t txn_id)
+    /**
+     * New node4 with the prefix_len bytes of key at depth as its prefix.
+     * Leaves that keep only their suffix need every byte of their path in
+     * the nodes, so with setLeafSuffixes() a prefix longer than
+     * MAX_PREFIX_LEN becomes a chain of node4s with one child each.
+     * @arg bottom Receives the last node of the chain, for the children
+     * @return the first node of the chain
+     */
+    private: art_node4* mv_prefix_nodes(const unsigned char *key, int depth, int prefix_len, art_node4 **bottom)
+    {
+        art_node4 *top = (art_node4*)alloc_node(NODE4);
+        art_node4 *n = top;
+        while (leafSuffixes && prefix_len > MAX_PREFIX_LEN)
+        {
+            n->n.partial_len = MAX_PREFIX_LEN;
+            memcpy(n->n.partial, key+depth, MAX_PREFIX_LEN);
+            art_node4 *next = (art_node4*)alloc_node(NODE4);
+            add_child4(n, nullptr, key[depth+MAX_PREFIX_LEN], next);
+            depth += MAX_PREFIX_LEN+1;
+            prefix_len -= MAX_PREFIX_LEN+1;
+            n = next;
+        }
+        n->n.partial_len = prefix_len;
+        memcpy(n->n.partial, key+depth, min(MAX_PREFIX_LEN, prefix_len));
+        *bottom = n;
+        return top;
+    }
+
+    /// Frees the nodes of a chain from mv_prefix_nodes() that was never linked, not the leaves below it
+    private: static void mv_free_prefix_nodes(art_node4 *n)
+    {
+        while (n != nullptr)
+        {
+            art_node *child = n->n.num_children == 1 ? n->children[0] : nullptr;
+            free(n);
+            n = child != nullptr && !IS_LEAF(child) ? (art_node4*)child : nullptr;
+        }
+    }
+
+    private: mv_art_leaf* make_mvv_leaf(const unsigned char *key, int key_len,RecordType& value,const size_t txn_id,
+                                        int depth)
+    {
+        mv_art_leaf *l = alloc_mvv_leaf(key, key_len, value, txn_id, depth);
+        announce_mvv_leaf(l, key, key_len, txn_id);
+        return l;
+    }
+
+    /**
+     * Leaf that is not tracked or announced yet, for a slot that may be lost to another writer.
+     * @arg depth Key bytes the path down to the leaf's slot holds, left out of the leaf with setLeafSuffixes()
+     */
+    private: mv_art_leaf* alloc_mvv_leaf(const unsigned char *key, int key_len, RecordType& value, const size_t txn_id,
+                                         int depth)
     {
-        mv_art_leaf *l = (mv_art_leaf*)malloc(sizeof(mv_art_leaf)+key_len);
+        int pathBytes = leafSuffixes ? min(min(depth, key_len), 0xFFFF) : 0;
+        mv_art_leaf *l = (mv_art_leaf*)malloc(offsetof(mv_art_leaf, key) + key_len - pathBytes);
+#if ART_LEAF_FINGERPRINTS
+        assert(LEAF_TAG_MASK == 1 || ((uintptr_t)l >> LEAF_FINGERPRINT_SHIFT) == 0);
+#endif
         l->key_len = key_len;
-        memcpy(l->key, key, key_len);
-        l->_mvcc = new mvcc11::mvcc<RecordType>(txn_id,value);
-        notifyObservers(l->_mvcc->current(), pfabric::TableParams::Insert, pfabric::TableParams::Immediate);
+        l->key_depth = pathBytes;
+        l->fingerprint = keyFingerprint(key, key_len);
+        memcpy(l->key, key + pathBytes, key_len - pathBytes);
+        l->_mvcc = new mvcc_type(txn_id,value);
         return l;
     }
 
+    /// Bytes of l itself, without its versions
+    static size_t mv_leaf_size(const mv_art_leaf* l)
+    {
+        return offsetof(mv_art_leaf, key) + l->key_len - l->key_depth;
+    }
+
+    private: void announce_mvv_leaf(mv_art_leaf* l, const unsigned char *key, int key_len, const size_t txn_id)
+    {
+        if (hashIndex != nullptr)
+            hashIndex->insert(l);
+        trackWrite(l, key, key_len, l->_mvcc->current(), txn_id);
+        notifyObservers(l->_mvcc->current(), pfabric::TableParams::Insert, pfabric::TableParams::Immediate);
+    }
+
+    /**
+     * Hands a write to the TxnContext running on this thread, if txn_id is its id.
+     * A failed write (NULL) or one that replaced a version committed after the
+     * context began makes the context rollback only (first updater wins).
+     * With a redo log the write is logged too; writes outside a context are
+     * already committed at txn_id and are sealed right away.
+     */
+    private: void trackWrite(const mv_art_leaf* leaf, const unsigned char* key, int key_len,
+                             const_snapshot_ptr const& version, size_t txn_id, RedoOp op = RedoOp::Put)
+    {
+        mvcc_type* object = leaf->_mvcc;
+        if (version != nullptr)
+            markDirty(key, key_len);
+        TxnContext* txn = TxnContext::current();
+        if (txn == nullptr || txn->id() != txn_id)
+        {
+            ///runs loaded back and merged buffer batches are in the log or a checkpoint already
+            if (redoLog != nullptr && version != nullptr && !replaying())
+            {
+                logWrite(key, key_len, version, op);
+                redoLog->seal(txn_id, false);
+            }
+            return;
+        }
+        if (version == nullptr)
+        {
+            txn->setRollbackOnly();
+            return;
+        }
+        txn->addWrite(object, const_cast<snapshot_type*>(version.get()), mvcc_type::write_ops());
+        if (redoLog != nullptr)
+        {
+            if (txn->logTo(redoLog))
+                logWrite(key, key_len, version, op);
+            else
+                txn->setRollbackOnly();
+        }
+
+        size_t replaced = version->version == txn_id ? object->previous_version(version) : version->version;
+        if (!mvcc11::is_txn_id(replaced) && replaced != MVCC11_ABORTED_VERSION && replaced > txn->beginTs())
+            txn->setRollbackOnly();
+    }
+
+    /**
+     * Raises the dirty epoch of every node on the path to key, so the next
+     * delta checkpoint descends there. A raise to a newer epoch by another
+     * writer is kept. Nothing to do until the table takes incremental checkpoints.
+     */
+    private: void markDirty(const unsigned char* key, int key_len)
+    {
+        if (!dirtyTracking.load())
+            return;
+        uint32_t epoch = artCheckpointEpoch.load();
+        int depth = 0;
+        art_node* n = t->root;
+        while (n && !IS_MV_LEAF(n))
+        {
+            uint32_t seen = n->dirtyEpoch.load();
+            while (seen < epoch && !n->dirtyEpoch.compare_exchange_weak(seen, epoch));
+            depth += n->partial_len;
+            if (depth > key_len)
+                return;
+            art_node** child = find_child(n, depth < key_len ? key[depth] : 0);
+            n = child ? *child : nullptr;
+            depth++;
+        }
+    }
+
+    private: void logWrite(const unsigned char* key, int key_len, const_snapshot_ptr const& version, RedoOp op)
+    {
+        if (op == RedoOp::Delete)
+            redoLog->appendDelete((const char*)key, key_len);
+        else
+            redoLog->appendPut((const char*)key, key_len, version->value);
+    }
+
+    /// Records a read in the read set of the TxnContext running on this thread
+    private: void trackRead(const mv_art_leaf* leaf, const_snapshot_ptr const& version, size_t txn_id)
+    {
+        TxnContext* txn = TxnContext::current();
+        if (txn != nullptr && txn->id() == txn_id && version != nullptr)
+            txn->addRead(leaf, version.get());
+    }
+
+    /// Remembers a deleted key for the next GC() pass, in the queue of the calling thread
+    private: void queueDeletion(const unsigned char* key, int key_len)
+    {
+        static thread_local size_t partition = std::hash<std::thread::id>()(std::this_thread::get_id()) % GC_QUEUE_PARTITIONS;
+        keyStruct candidate;
+        ///the key may not be NUL terminated
+        candidate.k.assign((const char*) key, key_len);
+        boost::mutex::scoped_lock guard(deletionQueues[partition].lock);
+        deletionQueues[partition].keys.push_back(candidate);
+    }
+
+    private: void requeueDeletions(const std::vector<keyStruct>& keys, size_t from)
+    {
+        if (from >= keys.size())
+            return;
+        boost::mutex::scoped_lock guard(deletionQueues[0].lock);
+        deletionQueues[0].keys.insert(deletionQueues[0].keys.end(), keys.begin() + from, keys.end());
+    }
+
 
 
     /**
      * Destructor for table.
      */
-    ~ArtCPP()
+    public: ~ArtCPP()
     {
+        stopBackgroundGC();
+        disableWriteBuffer();
+        freeRetiredLeaves();
     }
 
 
@@ -1061,6 +1754,10 @@ class ArtCPP : public pfabric::BaseTable
     * @return 0 on success.
     */
     public: int DestroyAdaptiveRadixTreeTable() {
+        for (auto& stripe : leafUnlinks)
+            stripe.fetch_add(1);
+        if (hashIndex != nullptr)
+            hashIndex->clear();
         destroy_node(t->root);
         return 0;
     }
@@ -1073,7 +1770,12 @@ class ArtCPP : public pfabric::BaseTable
     #else
     inline uint64_t art_size()
     {
-            return t->size;
+            flushWriteBuffer();
+            uint64_t keys = t->size;
+            if (rootPartitionBytes > 0)
+                for (const RootSlotKeys& slot : rootSlotKeys)
+                    keys += slot.count.load(std::memory_order_relaxed);
+            return keys;
         }
     #endif
 
@@ -1086,6 +1788,9 @@ class ArtCPP : public pfabric::BaseTable
      */
     public: auto deleteByKey(char *key,size_t txn_id)
     {
+        drainBuffered(key);
+        TierGuard tier(*this, key, true);
+        LeafPin pin(*this);
         int old_val = 0;
         int key_len =  std::strlen(key);
         //auto old = mv_recursive_delete(t->root, &t->root,(const unsigned char *) key, std::strlen(key),0, &old_val,txn_id);
@@ -1105,15 +1810,15 @@ class ArtCPP : public pfabric::BaseTable
             return NULL;
         }
 
-        uint64_t version;
-        version = n->readLockOrRestart(needRestart);
+        uint64_t version = 0;
+        ///a leaf has no version, its tagged pointer is not an address to read from
+        if (IS_MV_LEAF(n))
+            needRestart = false;
+        else
+            version = n->readLockOrRestart(needRestart);
 
         if (needRestart)
-        {
-            int old_val = 0;
-            auto older = mv_recursive_delete(t->root, &t->root, key, key_len, 0, &old_val, txn_id, 0,
-                                             t->root, false);
-        }
+            return mv_recursive_delete(t->root, &t->root, key, key_len, 0, old, txn_id, 0, t->root, false);
 
         ///-- If we are at a leaf,
         ///----We need to replace it with a node
@@ -1128,7 +1833,8 @@ class ArtCPP : public pfabric::BaseTable
                 *old = 1;
                 ///MVCC delete head version.
                 auto mutable_snapshot_ptr=  l->_mvcc->deleteMV(txn_id);
-                ActiveTxnWriteSet[txn_id].push_back(*l);
+                trackWrite(l, key, key_len, mutable_snapshot_ptr, txn_id, RedoOp::Delete);
+                queueDeletion(key, key_len);
                 notifyObservers(l->_mvcc->current(), pfabric::TableParams::Update, pfabric::TableParams::Immediate);
                 return mutable_snapshot_ptr;
             }
@@ -1156,17 +1862,14 @@ class ArtCPP : public pfabric::BaseTable
         art_node** nextNode = find_child(n, key[depth]);
         //checkOrRestart(version,*nextNode,needRestart);
         if (needRestart)
-        {
-            int old_val = 0;
-            auto older = mv_recursive_delete(t->root, &t->root, key, key_len, 0, &old_val, txn_id, 0,t->root, false);
-        }
+            return mv_recursive_delete(t->root, &t->root, key, key_len, 0, old, txn_id, 0, t->root, false);
 
         art_node **child = nextNode;
         if (child)
         {
             return mv_recursive_delete(*child, child, key, key_len, depth+1, old,txn_id,version,n,needRestart);
         }
-
+        return NULL;
     }
 
     /**
@@ -1181,11 +1884,34 @@ class ArtCPP : public pfabric::BaseTable
      */
     public: const_snapshot_ptr insertOrUpdateByKey(char *key,  RecordType&  value,size_t txn_id)
     {
+        if (bufferWrites.load() && !replaying() && autocommit(txn_id))
+            return bufferWrite(key, value, txn_id);
+        drainBuffered(key);
+        TierGuard tier(*this, key, true);
+        LeafPin pin(*this);
         int old_val = 0;
         int key_len =  std::strlen(key);
         //art_node *root =static_cast<art_node*>(t->root);
-        auto old = mv_recursive_insert(t->root, &t->root,(const unsigned char *) key, key_len, value, 0, &old_val,txn_id,0,t->root,false);
-        if (!old_val) t->size++;
+        const_snapshot_ptr old;
+        do
+        {
+            if (old_val == InsertRestart)
+            {
+                insertRestarts.fetch_add(1, std::memory_order_relaxed);
+                boost::this_thread::yield();
+            }
+            old_val = 0;
+            old = fingerCaching.load()
+                  ? fingerInsert((const unsigned char *) key, key_len, value, &old_val, txn_id)
+                  : mv_recursive_insert(t->root, &t->root,(const unsigned char *) key, key_len, value, 0, &old_val,txn_id,0,t->root,false);
+        } while (old_val == InsertRestart);
+        if (!old_val && rootPartitionBytes > 0)
+            rootSlotKeys[(unsigned char) key[0]].count.fetch_add(1, std::memory_order_relaxed);
+        else if (!old_val)
+            t->size++;
+        ///a new leaf is linked only now, its final path is marked again
+        if (!old_val)
+            markDirty((const unsigned char*) key, key_len);
         return old;
     }
 
@@ -1198,19 +1924,25 @@ class ArtCPP : public pfabric::BaseTable
         // If we are at a NULL node, inject a leaf
         if (!n)
         {
-            auto snapshot = SET_MV_LEAF(make_mvv_leaf(key, key_len, value,txn_id));
+            auto snapshot = SET_MV_LEAF(make_mvv_leaf(key, key_len, value,txn_id, depth));
             *ref = (art_node*) snapshot;
             return NULL;
         }
 
-        uint64_t version;
-        version = n->readLockOrRestart(needRestart);
+        uint64_t version = 0;
+        int nodeDepth = depth;
+        ///a leaf has no version, its tagged pointer is not an address to read from
+        if (!IS_MV_LEAF(n))
+            version = n->readLockOrRestart(needRestart);
 
-        if (needRestart)
+        ///a node another writer holds is retried from the top, losers descend a hot node to combine into it
+        CombiningSlot* hot = nullptr;
+        if (!IS_MV_LEAF(n) && (version & 0b11) != 0)
         {
-            int old_val = 0;
-            auto older = mv_recursive_insert(t->root, &t->root, key, key_len, value, 0, &old_val, txn_id, 0,
-                                             t->root, false);
+            hot = (version & 1) ? nullptr : noteConflict(n);
+            ///the holder of a latched node is waited for rather than raced
+            if (awaitLatch(n) || hot == nullptr)
+                return restartInsert(old);
         }
 
         ///-- If we are at a leaf,
@@ -1226,29 +1958,46 @@ class ArtCPP : public pfabric::BaseTable
                 *old = 1;
                 ///MVCC update current version
                 auto snapshot= l->_mvcc->overwriteMV(txn_id,value);
-                ActiveTxnWriteSet[txn_id].push_back(*l);
+                trackWrite(l, key, key_len, snapshot, txn_id);
                 notifyObservers(l->_mvcc->current(), pfabric::TableParams::Update, pfabric::TableParams::Immediate);
                 return l->_mvcc->current();
             }
 
             ///write lock here would lock it, becaue we are not updating it,
 
-            upgradeToWriteLockOrRestart(n,version,needRestart);
+            ///the slot belongs to the parent, a leaf has no version of its own
+            bool pinnedParent = parent != n && parent->pinned;
+            NodeLatch latch(*this, parent != n && !pinnedParent ? parent : nullptr);
+            if (parent != n && !pinnedParent && upgradeToWriteLockOrRestart(parent, parentVersion, needRestart))
+                return lostLock(parent, old);
             // New value, we must split the leaf into a node4
-            art_node4 *new_node = (art_node4*)alloc_node(NODE4);
+            int longest_prefix = mv_longest_common_prefix(l, key, key_len, depth);
+            art_node4 *bottom;
+            art_node4 *new_node = mv_prefix_nodes(key, depth, longest_prefix, &bottom);
             // Create a new leaf
             /// MVCC make new mvcc object pointing to current-version;
-            mv_art_leaf *l2 = make_mvv_leaf(key, key_len, value,txn_id);
+            mv_art_leaf *l2 = alloc_mvv_leaf(key, key_len, value,txn_id, depth+longest_prefix+1);
 
-
-            int longest_prefix = mv_longest_common_prefix(l, l2, depth);
-            new_node->n.partial_len = longest_prefix;
-            memcpy(new_node->n.partial, key+depth, min(MAX_PREFIX_LEN, longest_prefix));
-            // Add the leafs to the new node4
-            *ref = (art_node*)new_node;
-            add_child4(new_node, ref, l->key[depth+longest_prefix], SET_MV_LEAF(l));
-            add_child4(new_node, ref, l2->key[depth+longest_prefix], SET_MV_LEAF(l2));
-            n->writeUnlock();
+            // Add the leafs to the new node4, readers see it once it holds both
+            add_child4(bottom, ref, mv_leaf_byte(l, depth+longest_prefix), SET_MV_LEAF(l));
+            add_child4(bottom, ref, key[depth+longest_prefix], SET_MV_LEAF(l2));
+            if (pinnedParent)
+            {
+                ///another writer took the slot first, insert below what it holds now
+                if (!casChild(ref, n, (art_node*)new_node))
+                {
+                    mv_free_prefix_nodes(new_node);
+                    delete l2->_mvcc;
+                    free(l2);
+                    return mv_recursive_insert(*ref, ref, key, key_len, value, depth, old, txn_id, parentVersion, parent,
+                                               false);
+                }
+            }
+            else
+                *ref = (art_node*)new_node;
+            announce_mvv_leaf(l2, key, key_len, txn_id);
+            if (parent != n && !pinnedParent)
+                parent->writeUnlock();
             return NULL;
         }
 
@@ -1267,11 +2016,19 @@ class ArtCPP : public pfabric::BaseTable
 
             ///Write lock here again to create new node
             //insert-split-prefix
-            upgradeToWriteLockOrRestart(n,version,parent,needRestart);
-            upgradeToWriteLockOrRestart(parent,parentVersion,needRestart);
+            ///the root is its own parent, it is locked once; n's lock alone guards a slot of a pinned node
+            bool lockParent = parent != n && !parent->pinned;
+            NodeLatch latch(*this, n);
+            if (lockParent && upgradeToWriteLockOrRestart(parent, parentVersion, needRestart))
+                return lostLock(parent, old);
+            if (upgradeToWriteLockOrRestart(n, version, needRestart))
+            {
+                if (lockParent)
+                    parent->writeUnlock();
+                return lostLock(n, old);
+            }
 
             art_node4 *new_node = (art_node4*)alloc_node(NODE4);
-            *ref = (art_node*)new_node;
             new_node->n.partial_len = prefix_diff;
             memcpy(new_node->n.partial, n->partial, min(MAX_PREFIX_LEN, prefix_diff));
 
@@ -1286,59 +2043,104 @@ class ArtCPP : public pfabric::BaseTable
             {
                 n->partial_len -= (prefix_diff+1);
                 mv_art_leaf *l = minimum(n);
-                add_child4(new_node, ref, l->key[depth+prefix_diff], n);
-                memcpy(n->partial, l->key+depth+prefix_diff+1, min(MAX_PREFIX_LEN, n->partial_len));
+                add_child4(new_node, ref, mv_leaf_byte(l, depth+prefix_diff), n);
+                memcpy(n->partial, l->key+depth+prefix_diff+1-l->key_depth, min(MAX_PREFIX_LEN, n->partial_len));
             }
 
             // Insert the new leaf
             ///mvcc make new leaf
-            mv_art_leaf *l = make_mvv_leaf(key, key_len, value,txn_id);
+            mv_art_leaf *l = make_mvv_leaf(key, key_len, value,txn_id, depth+prefix_diff+1);
             add_child4(new_node, ref, key[depth+prefix_diff], SET_MV_LEAF(l));
+            ///linked once complete, n is locked until then
+            *ref = (art_node*)new_node;
 
             n->writeUnlock();
-            parent->writeUnlock();
+            if (lockParent)
+                parent->writeUnlock();
             return NULL;
         }
 
         RECURSE_SEARCH:;
+        fingerStep(n, ref, nodeDepth);
 
         // Find a child to recurse to
         art_node** nextNode = find_child(n, key[depth]);
-        //checkOrRestart(version,*nextNode,needRestart);
-        if (needRestart)
-        {
-            int old_val = 0;
-            auto older = mv_recursive_insert(t->root, &t->root, key, key_len, value, 0, &old_val, txn_id, 0,t->root, false);
-        }
 
         art_node **child = nextNode;
         if (child)
         {
+            ///a child read through a lock may be moved or freed by its holder
+            if (hot != nullptr)
+                return restartInsert(old);
             return mv_recursive_insert(*child, child, key, key_len, value, depth+1, old,txn_id,version,n,needRestart);
         }
 
         // No child, node goes within us
         ///mvcc make new leaf
 
-        if(isNodeFull(n))
+        if (n->pinned)
         {
-            upgradeToWriteLockOrRestart(parent, parentVersion,needRestart);
-            upgradeToWriteLockOrRestart(n, version, parent,needRestart);
+            ///an empty slot of a partitioned root is claimed by CAS
+            mv_art_leaf *l = alloc_mvv_leaf(key, key_len, value, txn_id, depth+1);
+            art_node** slot = &((art_node256*)n)->children[key[depth]];
+            if (!casChild(slot, nullptr, (art_node*)SET_MV_LEAF(l)))
+            {
+                delete l->_mvcc;
+                free(l);
+                return mv_recursive_insert(n, ref, key, key_len, value, nodeDepth, old, txn_id, parentVersion, parent,
+                                           false);
+            }
+            announce_mvv_leaf(l, key, key_len, txn_id);
+            return NULL;
+        }
 
-            mv_art_leaf *l = make_mvv_leaf(key, key_len, value, txn_id);
+        ///isNodeFull() is true while n has room for another child
+        if(!isNodeFull(n))
+        {
+            bool lockParent = parent != n && !parent->pinned;
+            NodeLatch latch(*this, n);
+            if (lockParent && upgradeToWriteLockOrRestart(parent, parentVersion, needRestart))
+                return lostLock(parent, old);
+            if (upgradeToWriteLockOrRestart(n, version, needRestart))
+            {
+                if (lockParent)
+                    parent->writeUnlock();
+                return lostLock(n, old);
+            }
+
+            mv_art_leaf *l = make_mvv_leaf(key, key_len, value, txn_id, depth+1);
+            ///grows n into a larger node in its parent's slot and frees n
             add_child(n, ref, key[depth], SET_MV_LEAF(l));
 
-            n->writeUnlockObsolete();
-            parent->writeUnlock();
+            if (lockParent)
+                parent->writeUnlock();
             return NULL;
         }
         else
         {
-            upgradeToWriteLockOrRestart(n, version,needRestart);
-            parent->readUnlockOrRestart(parentVersion,needRestart);
-            mv_art_leaf *l = make_mvv_leaf(key, key_len, value, txn_id);
+            ///n's lock alone guards the add: a node grown or moved since version was read has a newer one
+            mv_art_leaf *l = alloc_mvv_leaf(key, key_len, value, txn_id, depth+1);
+            uint64_t descended = version;
+            NodeLatch latch(*this, n);
+            if (upgradeToWriteLockOrRestart(n, version, needRestart))
+            {
+                latch.release();
+                if (hot == nullptr)
+                    hot = noteConflict(n);
+                if (hot != nullptr && publishInsert(*hot, n, descended, key[depth], l))
+                {
+                    announce_mvv_leaf(l, key, key_len, txn_id);
+                    return NULL;
+                }
+                delete l->_mvcc;
+                free(l);
+                return restartInsert(old);
+            }
             add_child(n, ref, key[depth], SET_MV_LEAF(l));
+            combine(n, ref, version);
             n->writeUnlock();
+            latch.release();
+            announce_mvv_leaf(l, key, key_len, txn_id);
             return NULL;
         }
     }
@@ -1361,6 +2163,7 @@ class ArtCPP : public pfabric::BaseTable
                     if(snapshot != nullptr)
                     {
                         auto updated= snapshot->_mvcc->update(txn_id,updater);
+                        trackWrite(snapshot, key, key_len, updated, txn_id);
                         notifyObservers(updated, pfabric::TableParams::Update, pfabric::TableParams::Immediate);
                         return updated;
                     }
@@ -1390,6 +2193,9 @@ class ArtCPP : public pfabric::BaseTable
     /// Recursive Updater
     public: const_snapshot_ptr insertOrUpdateByKey(char *key, Updater updater,size_t txn_id)
     {
+        drainBuffered(key);
+        TierGuard tier(*this, key, true);
+        LeafPin pin(*this);
         int old_val = 0;
         int key_len =  std::strlen(key);
         return UpdateIterative((const unsigned char *)key,key_len,txn_id,updater);
@@ -1422,7 +2228,7 @@ class ArtCPP : public pfabric::BaseTable
                 *old = 1;
                 ///MVCC update current version
                 auto snapshot = l->_mvcc->update(txn_id,updater);
-                ActiveTxnWriteSet[txn_id].push_back(*l);
+                trackWrite(l, key, key_len, snapshot, txn_id);
                 return snapshot;
 
             }
@@ -1523,6 +2329,19 @@ class ArtCPP : public pfabric::BaseTable
         int prefix_len=0;
 
         node = this->t->root;
+        ///an empty tree, or one holding a single key as after evicting all other ranges
+        if (node == nullptr)
+            return NULL;
+        if (IS_MV_LEAF(node))
+        {
+            mv_art_leaf* snapshot = MV_LEAF_RAW(node);
+            if (mv_leaf_matches(snapshot, key, key_len, 0))
+                return NULL;
+            auto updated = snapshot->_mvcc->update(txn_id,updater);
+            trackWrite(snapshot, key, key_len, updated, txn_id);
+            notifyObservers(updated, pfabric::TableParams::Update, pfabric::TableParams::Immediate);
+            return updated;
+        }
         v = node->readLockOrRestart(needRestart);
         if (needRestart) goto restart;
 
@@ -1564,7 +2383,7 @@ class ArtCPP : public pfabric::BaseTable
                     if(snapshot != nullptr)
                     {
                         auto updated= snapshot->_mvcc->update(txn_id,updater);
-                        ActiveTxnWriteSet[txn_id].push_back(*snapshot);
+                        trackWrite(snapshot, key, key_len, updated, txn_id);
                         notifyObservers(updated, pfabric::TableParams::Update, pfabric::TableParams::Immediate);
                         return updated;
                     }
@@ -1600,6 +2419,8 @@ class ArtCPP : public pfabric::BaseTable
                                int key_len, art_callback cb,
                                void *data,size_t txn_id)
     {
+        flushWriteBuffer();
+        TierPin pin(*this);
         art_node **child;
         art_node *n = t->root;
         int prefix_len, depth = 0;
@@ -1612,8 +2433,10 @@ class ArtCPP : public pfabric::BaseTable
                 if (!mv_leaf_prefix_matches((mv_art_leaf*)n, key, key_len)) {
                     mv_art_leaf *l = (mv_art_leaf*)(n);
                     auto current = l->_mvcc->current();
-                    ActiveTxnReadSet[txn_id].push_back(current);
-                    return cb(data, (const unsigned char*)l->key, l->key_len, current);
+                    trackRead(l, current, txn_id);
+                    ///the path down to l matched the prefix, up to depth
+                    std::string path((const char*) key, depth), leafKey;
+                    return cb(data, mv_leaf_key(l, path, leafKey), l->key_len, current);
                 }
                 return 0;
             }
@@ -1621,8 +2444,9 @@ class ArtCPP : public pfabric::BaseTable
             // If the depth matches the prefix, we need to handle this node
             if (depth == key_len) {
                 mv_art_leaf *l = minimum(n);
+                std::string path((const char*) key, depth);
                 if (!mv_leaf_prefix_matches(l, key, key_len))
-                    return mv_recursive_iter(n, cb, data,txn_id);
+                    return mv_recursive_iter(n, cb, data,txn_id, path);
                 return 0;
             }
 
@@ -1641,7 +2465,12 @@ class ArtCPP : public pfabric::BaseTable
 
                     // If we've matched the prefix, iterate on this node
                 } else if (depth + prefix_len == key_len) {
-                    return mv_recursive_iter(n, cb, data,txn_id);
+                    std::string path((const char*) key, depth);
+                    return mv_recursive_iter(n, cb, data,txn_id, path);
+
+                    // A mismatch within the node's prefix, no key below it has the prefix
+                } else if ((uint32_t)prefix_len < n->partial_len) {
+                    return 0;
                 }
 
                 // if there is a full match, go deeper
@@ -1667,11 +2496,82 @@ class ArtCPP : public pfabric::BaseTable
      */
     public: const_snapshot_ptr findValueByKey( char* key,size_t txn_id)
     {
-        auto current = art_search_OCC((unsigned char *)key,std::strlen(key));
-        ActiveTxnReadSet[txn_id].push_back(current);
+        ///bodies of read-only Transactions read their snapshot
+        TxnContext* txn = TxnContext::current();
+        if (txn != nullptr && txn->isReadOnly())
+            return findValueByKey(key, *txn);
+        if (const_snapshot_ptr buffered = writeBuffer.find(key, std::strlen(key), [](const snapshot_type&) { return true; }))
+            return buffered;
+
+        TierGuard tier(*this, key, false);
+        LeafPin pin(*this);
+        mv_art_leaf* leaf = cachedSearch((unsigned char *)key,std::strlen(key));
+        if (leaf == nullptr)
+            return tier.run() != nullptr ? readRun(*tier.run(), key) : nullptr;
+        auto current = leaf->_mvcc->current();
+        trackRead(leaf, current, txn_id);
         return current;
     }
 
+    /**
+     * Operations of an explicit transaction. They run on the calling thread,
+     * writes stay invisible to others until txn.commit() and a write-write
+     * conflict makes txn rollback only instead of blocking.
+     * @arg txn active transaction context
+     * @return as the size_t txn_id variants, reads return the version in txn's snapshot
+     */
+    public: const_snapshot_ptr findValueByKey(char* key, TxnContext& txn)
+    {
+        size_t readTs = txn.beginTs(), id = txn.id();
+        if (const_snapshot_ptr buffered = writeBuffer.find(key, std::strlen(key), [readTs, id](const snapshot_type& v) {
+                return mvcc11::is_visible(v, readTs, id);
+            }))
+            return buffered;
+        TierGuard tier(*this, key, false);
+        LeafPin pin(*this);
+        mv_art_leaf* leaf = cachedSearch((unsigned char *)key, std::strlen(key));
+        ///a run holds versions below the low watermark only, every snapshot sees them
+        if (leaf == nullptr)
+            return tier.run() != nullptr ? readRun(*tier.run(), key) : nullptr;
+        auto visible = leaf->_mvcc->visible(txn.beginTs(), txn.id());
+        if (visible != nullptr)
+            txn.addRead(leaf, visible.get());
+        return visible;
+    }
+
+    public: const_snapshot_ptr insertOrUpdateByKey(char *key, RecordType& value, TxnContext& txn)
+    {
+        if (!writable(txn))
+            return nullptr;
+        TxnScope scope(txn);
+        return insertOrUpdateByKey(key, value, txn.id());
+    }
+
+    public: const_snapshot_ptr insertOrUpdateByKey(char *key, Updater updater, TxnContext& txn)
+    {
+        if (!writable(txn))
+            return nullptr;
+        TxnScope scope(txn);
+        return insertOrUpdateByKey(key, updater, txn.id());
+    }
+
+    public: const_snapshot_ptr deleteByKey(char *key, TxnContext& txn)
+    {
+        if (!writable(txn))
+            return nullptr;
+        TxnScope scope(txn);
+        return deleteByKey(key, txn.id());
+    }
+
+    /// A write in a read-only context dooms it instead of installing a version
+    private: bool writable(TxnContext& txn)
+    {
+        if (!txn.isReadOnly())
+            return true;
+        txn.setRollbackOnly();
+        return false;
+    }
+
     private: const_snapshot_ptr art_search(std::shared_ptr<art_tree> t, const unsigned char *key, int key_len)
     {
         art_node **child;
@@ -1709,8 +2609,281 @@ class ArtCPP : public pfabric::BaseTable
         return NULL;
     }
 
+    /**
+     * Searches a batch of keys, interleaving the probes so that a
+     * worker overlaps the cache misses of up to ART_INTERLEAVE_GROUP
+     * lookups instead of stalling on each one.
+     * @arg keys The keys to look up
+     * @arg count The number of keys
+     * @arg results Receives the current snapshot per key or NULL
+     * @arg txn_id transaction id
+     * @return number of keys found
+     */
+    public: size_t findValuesByKeys(char** keys, size_t count, const_snapshot_ptr* results, size_t txn_id)
+    {
+        TierPin pin(*this);
+        LeafPin leaves(*this);
+        size_t found = 0;
+        interleaved_search(keys, count, [&](size_t index, mv_art_leaf* leaf)
+        {
+            results[index] = leaf ? leaf->_mvcc->current() : nullptr;
+            if (leaf)
+            {
+                trackRead(leaf, results[index], txn_id);
+                found++;
+            }
+            else if (TierRun* run = pinnedRun(keys[index]))
+            {
+                results[index] = readRun(*run, keys[index]);
+                found += results[index] != nullptr;
+            }
+        });
+        ///buffered writes are newer than the tree
+        for (size_t i = 0; writeBuffer.size() > 0 && i < count; i++)
+            if (const_snapshot_ptr buffered = writeBuffer.find(keys[i], std::strlen(keys[i]), [](const snapshot_type&) { return true; }))
+            {
+                found += results[i] == nullptr;
+                results[i] = buffered;
+            }
+        return found;
+    }
+
+    /**
+     * Updates a batch of existing keys, locating their leaves
+     * with interleaved probes as in findValuesByKeys().
+     * @return number of keys updated
+     */
+    public: size_t updateValuesByKeys(char** keys, size_t count, Updater updater,
+                                      const_snapshot_ptr* results, size_t txn_id)
+    {
+        flushWriteBuffer();
+        ///writes need their ranges in memory
+        if (tiering.load() && tierDepth() == 0)
+            for (size_t i = 0; i < count; i++)
+            {
+                TierGuard reload(*this, keys[i], true);
+            }
+        TierPin pin(*this);
+        size_t updatedKeys = 0;
+        std::vector<size_t> evicted;
+        {
+            LeafPin leaves(*this);
+            interleaved_search(keys, count, [&](size_t index, mv_art_leaf* leaf)
+            {
+                results[index] = nullptr;
+                if (leaf)
+                {
+                    auto updated = leaf->_mvcc->update(txn_id,updater);
+                    trackWrite(leaf, (const unsigned char*) keys[index], std::strlen(keys[index]), updated, txn_id);
+                    notifyObservers(updated, pfabric::TableParams::Update, pfabric::TableParams::Immediate);
+                    results[index] = updated;
+                    updatedKeys++;
+                }
+                else if (pinnedRun(keys[index]) != nullptr)
+                    evicted.push_back(index);
+            });
+        }
+        pin.release();
+        ///evicted again by a budget pass in between, or reached inside a scan
+        if (!evicted.empty() && tierDepth() == 0)
+        {
+            std::vector<char*> again;
+            for (size_t index : evicted)
+                again.push_back(keys[index]);
+            std::vector<const_snapshot_ptr> updated(again.size());
+            updatedKeys += updateValuesByKeys(again.data(), again.size(), updater, updated.data(), txn_id);
+            for (size_t i = 0; i < evicted.size(); i++)
+                results[evicted[i]] = updated[i];
+        }
+        return updatedKeys;
+    }
+
+    /// Resumable state of one OLC point lookup
+    private: struct mv_search_frame
+    {
+        enum State { START, NODE, LEAF, DONE };
+
+        const unsigned char* key;
+        int key_len;
+        art_node* node;
+        art_node* parent;
+        uint64_t parentVersion;
+        int level;
+        mv_art_leaf* leaf;
+        State state;
+    };
+
+    /**
+     * Advances a lookup by one node. Before returning it prefetches the
+     * node it needs next, so the caller should switch to another frame.
+     * @return true once frame.leaf holds the match (or NULL)
+     */
+    private: bool mv_search_step(mv_search_frame& f)
+    {
+        bool needRestart = false;
+        switch (f.state)
+        {
+            case mv_search_frame::START:
+            {
+                f.node = this->t->root;
+                f.parent = nullptr;
+                f.level = 0;
+                f.leaf = nullptr;
+                if (f.node == nullptr)
+                {
+                    f.state = mv_search_frame::DONE;
+                    return true;
+                }
+                if (IS_MV_LEAF(f.node))
+                {
+                    if (fingerprintMismatch(f.node, f.key, f.key_len))
+                    {
+                        f.state = mv_search_frame::DONE;
+                        return true;
+                    }
+                    mv_art_leaf* l = MV_LEAF_RAW(f.node);
+                    f.leaf = !mv_leaf_matches(l, f.key, f.key_len, 0) ? l : nullptr;
+                    f.state = mv_search_frame::DONE;
+                    return true;
+                }
+                f.state = mv_search_frame::NODE;
+                ART_PREFETCH(f.node);
+                return false;
+            }
+
+            case mv_search_frame::NODE:
+            {
+                art_node* node = f.node;
+                uint64_t v = node->readLockOrRestart(needRestart);
+                if (f.parent != nullptr)
+                    f.parent->readUnlockOrRestart(f.parentVersion, needRestart);
+                if (needRestart)
+                {
+                    f.state = mv_search_frame::START;
+                    return false;
+                }
+
+                // Bail if the prefix does not match
+                if (node->partial_len)
+                {
+                    int prefix_len = check_prefix(node, f.key, f.key_len, f.level);
+                    if (prefix_len != min(MAX_PREFIX_LEN, node->partial_len))
+                    {
+                        f.state = mv_search_frame::DONE;
+                        return true;
+                    }
+                    f.level = f.level + node->partial_len;
+                }
+
+                auto child = find_child(node, f.key[f.level]);
+                art_node* next = (child) ? *child : NULL;
+                node->readUnlockOrRestart(v, needRestart);
+                if (needRestart)
+                {
+                    f.state = mv_search_frame::START;
+                    return false;
+                }
+
+                if (next == nullptr)
+                {
+                    f.state = mv_search_frame::DONE;
+                    return true;
+                }
+
+                if (IS_MV_LEAF(next))
+                {
+                    ///a rejected leaf is neither prefetched nor compared
+                    if (fingerprintMismatch(next, f.key, f.key_len))
+                    {
+                        f.state = mv_search_frame::DONE;
+                        return true;
+                    }
+                    f.leaf = MV_LEAF_RAW(next);
+                    f.state = mv_search_frame::LEAF;
+                    ART_PREFETCH(f.leaf);
+                    return false;
+                }
+
+                f.parent = node;
+                f.parentVersion = v;
+                f.node = next;
+                f.level++;
+                ART_PREFETCH(next);
+                return false;
+            }
+
+            case mv_search_frame::LEAF:
+            {
+                // Check if the expanded path matches
+                if (mv_leaf_matches(f.leaf, f.key, f.key_len, f.level))
+                    f.leaf = nullptr;
+                f.state = mv_search_frame::DONE;
+                return true;
+            }
+
+            default:
+                return true;
+        }
+    }
+
+    /// Round robin over ART_INTERLEAVE_GROUP lookup frames, onDone(index, leaf) per key
+    private: template <typename OnDone>
+    void interleaved_search(char** keys, size_t count, OnDone onDone)
+    {
+        mv_search_frame frames[ART_INTERLEAVE_GROUP];
+        size_t keyIndex[ART_INTERLEAVE_GROUP];
+        size_t next = 0;
+        size_t inflight = 0;
+
+        for (int i = 0; i < ART_INTERLEAVE_GROUP; i++)
+        {
+            frames[i].state = mv_search_frame::DONE;
+            if (next < count)
+            {
+                frames[i].key = (const unsigned char*)keys[next];
+                frames[i].key_len = std::strlen(keys[next]);
+                frames[i].state = mv_search_frame::START;
+                keyIndex[i] = next++;
+                inflight++;
+            }
+        }
+
+        while (inflight > 0)
+        {
+            for (int i = 0; i < ART_INTERLEAVE_GROUP; i++)
+            {
+                if (frames[i].state == mv_search_frame::DONE)
+                    continue;
+                if (!mv_search_step(frames[i]))
+                    continue;
+
+                onDone(keyIndex[i], frames[i].leaf);
+                if (next < count)
+                {
+                    frames[i].key = (const unsigned char*)keys[next];
+                    frames[i].key_len = std::strlen(keys[next]);
+                    frames[i].state = mv_search_frame::START;
+                    keyIndex[i] = next++;
+                }
+                else
+                {
+                    inflight--;
+                }
+            }
+        }
+    }
+
     const_snapshot_ptr art_search_OCC(const unsigned char* key,  int key_len)
     {
+        mv_art_leaf* leaf = art_search_leaf_OCC(key, key_len);
+        return leaf ? leaf->_mvcc->current() : nullptr;
+    }
+
+    /// OLC point lookup returning the matching leaf or NULL
+    mv_art_leaf* art_search_leaf_OCC(const unsigned char* key,  int key_len)
+    {
+        ///a node is locked for the span of one insert, mostly; a lock held longer is read through as before
+        int lockedRestarts = 0;
 
         restart:
         bool needRestart = false;
@@ -1721,10 +2894,55 @@ class ArtCPP : public pfabric::BaseTable
         int level = 0;
         bool optimisticPrefixMatch = false;
         int prefix_len=0;
+        ///starts at this thread's finger if key passes through it, the path taken becomes the finger
+        Finger* f = fingerCaching.load() && !finger().recording ? &finger() : nullptr;
+        uint64_t frees = artNodeFrees.load();
 
         node = this->t->root;
-        v = node->readLockOrRestart(needRestart);
-        if (needRestart) goto restart;
+        ///an empty tree, or one holding a single key as after evicting all other ranges
+        if (node == nullptr)
+            return NULL;
+        if (IS_MV_LEAF(node))
+        {
+            if (fingerprintMismatch(node, key, key_len))
+                return NULL;
+            return !mv_leaf_matches(MV_LEAF_RAW(node), key, key_len, 0) ? MV_LEAF_RAW(node) : NULL;
+        }
+        if (f != nullptr)
+        {
+            int from = fingerFrame(*f, key, key_len);
+            if (from > 0)
+            {
+                f->stats.lookupHits++;
+                f->frames = from + 1;
+                node = f->path[from].node;
+                v = f->path[from].version;
+                level = f->path[from].depth;
+            }
+            else
+            {
+                fingerReset(*f, frees);
+                f->stats.lookupMisses++;
+            }
+            f->key.assign((const char*) key, key_len);
+        }
+        if (f == nullptr || f->frames == 0)
+        {
+            v = node->readLockOrRestart(needRestart);
+            if (needRestart) goto restart;
+            ///a prefix split of the root moves it down under a new root, it has no parent version to show that
+            if (node != this->t->root) goto restart;
+            if ((v & 0b10) != 0 && lockedRestarts++ < ART_LOCKED_READ_RESTARTS)
+            {
+                noteConflict(node, true);
+                ///a latched node is waited for, others are retried after a yield
+                if (!awaitLatch(node))
+                    boost::this_thread::yield();
+                goto restart;
+            }
+            if (f != nullptr && !fingerPush(*f, node, &this->t->root, v, 0))
+                f = nullptr;
+        }
 
         while (true)
         {
@@ -1734,7 +2952,15 @@ class ArtCPP : public pfabric::BaseTable
             {
                 prefix_len = check_prefix(node, key, key_len, level);
                 if (prefix_len != min(MAX_PREFIX_LEN, node->partial_len))
+                {
+                    ///a prefix split rewrites the prefix in place
+                    checkOrRestart(v, node, needRestart);
+                    if (needRestart) goto restart;
                     return NULL;
+                }
+                ///bytes past MAX_PREFIX_LEN are checked at the leaf only, nodes below are not on the path of key for sure
+                if (node->partial_len > MAX_PREFIX_LEN)
+                    f = nullptr;
                 level = level + node->partial_len;
             }
 
@@ -1745,7 +2971,11 @@ class ArtCPP : public pfabric::BaseTable
             node = (child) ? *child : NULL;
 
             checkOrRestart(v,parentNode,needRestart);
-            if (needRestart) goto restart;
+            if (needRestart)
+            {
+                noteConflict(parentNode, true);
+                goto restart;
+            }
 
             if (node == nullptr) {
                 return 0;
@@ -1756,28 +2986,38 @@ class ArtCPP : public pfabric::BaseTable
             {
                 parentNode->readUnlockOrRestart(v, needRestart);
                 if (needRestart) goto restart;
-                node = (art_node*)LEAF_RAW(node);
+                ///a key that does not hash like the leaf's is absent, the leaf is not read
+                if (fingerprintMismatch(node, key, key_len))
+                    return NULL;
+                node = (art_node*)MV_LEAF_RAW(node);
                 // Check if the expanded path matches
                 if (!mv_leaf_matches((mv_art_leaf*)node, key, key_len,level))
-                {
-                    mv_art_leaf* snapshot = ((mv_art_leaf*)node);
-                    if(snapshot != nullptr)
-                    {
-                        return snapshot->_mvcc->current();
-                    }
-                    else
-                        return nullptr;
-                }
+                    return (mv_art_leaf*)node;
                 return NULL;
             }
             level++;
 
             uint64_t nv = node->readLockOrRestart(needRestart);
             if (needRestart) goto restart;
+            ///a pinned node keeps its version while its slots change, the slot is read again instead
+            if (parentNode->pinned && *child != node) goto restart;
+            if ((nv & 0b10) != 0 && lockedRestarts++ < ART_LOCKED_READ_RESTARTS)
+            {
+                noteConflict(node, true);
+                if (!awaitLatch(node))
+                    boost::this_thread::yield();
+                goto restart;
+            }
 
             parentNode->readUnlockOrRestart(v, needRestart);
-            if (needRestart) goto restart;
+            if (needRestart)
+            {
+                noteConflict(parentNode, true);
+                goto restart;
+            }
             v = nv;
+            if (f != nullptr && !fingerPush(*f, node, child, v, level))
+                f = nullptr;
         }
     }
 
@@ -1793,9 +3033,14 @@ class ArtCPP : public pfabric::BaseTable
     */
     public: int iterate(art_callback cb, void *data,size_t txn_id)
     {
-        return mv_recursive_iter(this->t->root, cb, data,txn_id);
+        flushWriteBuffer();
+        TierPin pin(*this);
+        std::string path;
+        return mv_recursive_iter(this->t->root, cb, data,txn_id, path);
     }
-    private: int mv_recursive_iter(art_node *n, art_callback cb, void *data, size_t txn_id)
+
+    /// path holds the key bytes down to n, with setLeafSuffixes(); keys are rebuilt from it
+    private: int mv_recursive_iter(art_node *n, art_callback cb, void *data, size_t txn_id, std::string& path)
     {
         //RecursiveScopedLock _recursiveLock;
         //UpgradeLock _sharedLock(_access);
@@ -1811,20 +3056,23 @@ class ArtCPP : public pfabric::BaseTable
                 {
                     //return snapshot->_mvcc->current();
                     auto current = snapshot->_mvcc->current();
-                    ActiveTxnReadSet[txn_id].push_back(current);
-                    return cb(data, (const unsigned char *) snapshot->key, snapshot->key_len, current);
+                    trackRead(snapshot, current, txn_id);
+                    std::string key;
+                    return cb(data, mv_leaf_key(snapshot, path, key), snapshot->key_len, current);
                 }
                 return 0;
         }
 
         int idx, res;
+        size_t below = mv_path_enter(path, n);
         switch (n->type)
         {
             case NODE4:
                 for (int i=0; i < n->num_children; i++)
                 {
                     //_sharedLock.unlock();
-                    res = mv_recursive_iter(((art_node4*)n)->children[i], cb, data,txn_id);
+                    mv_path_child(path, below, ((art_node4*)n)->keys[i]);
+                    res = mv_recursive_iter(((art_node4*)n)->children[i], cb, data,txn_id, path);
                     if (res) return res;
                 }
                 break;
@@ -1833,7 +3081,8 @@ class ArtCPP : public pfabric::BaseTable
                 for (int i=0; i < n->num_children; i++)
                 {
                     //_sharedLock.unlock();
-                    res = mv_recursive_iter(((art_node16*)n)->children[i], cb, data,txn_id);
+                    mv_path_child(path, below, ((art_node16*)n)->keys[i]);
+                    res = mv_recursive_iter(((art_node16*)n)->children[i], cb, data,txn_id, path);
                     if (res) return res;
                 }
                 break;
@@ -1843,7 +3092,8 @@ class ArtCPP : public pfabric::BaseTable
                     idx = ((art_node48*)n)->keys[i];
                     if (!idx) continue;
                     //_sharedLock.unlock();
-                    res = mv_recursive_iter(((art_node48*)n)->children[idx-1], cb, data,txn_id);
+                    mv_path_child(path, below, i);
+                    res = mv_recursive_iter(((art_node48*)n)->children[idx-1], cb, data,txn_id, path);
                     if (res) return res;
                 }
                 break;
@@ -1853,7 +3103,8 @@ class ArtCPP : public pfabric::BaseTable
                 {
                     if (!((art_node256*)n)->children[i]) continue;
                     //_sharedLock.unlock();
-                    res = mv_recursive_iter(((art_node256*)n)->children[i], cb, data,txn_id);
+                    mv_path_child(path, below, i);
+                    res = mv_recursive_iter(((art_node256*)n)->children[i], cb, data,txn_id, path);
                     if (res) return res;
                 }
                 break;
@@ -1865,97 +3116,2510 @@ class ArtCPP : public pfabric::BaseTable
 
 
     /**
-    * Iterates through the entries pairs in the map,
-    * invoking a callback for each. The call back gets a
-    * key, value for each and returns an integer stop value.
-    * If the callback returns non-zero, then the iteration stops.
-    * @arg t The tree to iterate over
-    * @arg cb The callback function to invoke
-    * @arg data Opaque handle passed to the callback
-    * @return 0 on success, or the return of the callback.
-    */
-
+     * One garbage collection cycle on the collector pool, bounded by its budget.
+     * Deleted keys no running snapshot can read any more are removed in sorted
+     * batches, one task per subtree below the root, so workers never share a
+     * node; leaves hanging off the root itself are removed on the calling
+     * thread before and after the workers run. Removals write lock the nodes
+     * they change as inserts do, so a cycle may overlap foreground work. The
+     * remaining tasks prune version chains of the subtrees without a batch,
+     * resuming at the subtree the previous cycle stopped at. Unfinished work stays queued.
+     * With a memory budget the cycle ends with enforceMemoryBudget().
+     * The caller waits for the cycle, startBackgroundGC() runs cycles off it.
+     */
     public:  void GC()
     {
+        boost::mutex::scoped_lock cycle(gcCycleLock);
+        collectGarbage();
+        if (memoryBudget.load() > 0)
+            enforceMemoryBudget();
+    }
 
-        if(ActiveTxnWriteSet.size()>0) {
-            for (auto iter = ActiveTxnWriteSet.begin(); iter != ActiveTxnWriteSet.end(); iter++) {
-                int i = 0;
-                for (int i = 0; i < iter->second.size(); i++) {
-                    mv_art_leaf leaf = iter->second[i];
-                    auto currentVersion = leaf._mvcc->current()->end_version;
-                    if (currentVersion != INF) {
-                        keyStruct keyStruct1 = keyStruct();
-                        std::strcpy(keyStruct1.k, leaf.key);
-                        deletionList.push_back(keyStruct1);
-                    }
-                }
-            }
-
-            if(deletionList.size()>0)
-            {
-                std::cout<<"Deleting keys from ART"<<std::endl;
-            }
-            for (int j = 0; j < deletionList.size(); j++) {
-                art_deleteGC(deletionList[j].k);
-            }
+    private: void collectGarbage()
+    {
+        TierPin pin(*this);
+        ///an eviction may retire and free leaves this cycle found
+        LeafPin leaves(*this);
+        gc.beginCycle();
+        uint64_t watermark = activeTxnRegistry.refreshLowWatermark();
+        ///a delta checkpoint writes a Delete only for a leaf it finds, so deletes wait for the next checkpoint
+        uint64_t horizon = dirtyTracking.load() ? std::min<uint64_t>(watermark, checkpointedTs.load()) : watermark;
+        std::vector<keyStruct> candidates;
+        for (auto& queue : deletionQueues)
+        {
+            boost::mutex::scoped_lock guard(queue.lock);
+            candidates.insert(candidates.end(), queue.keys.begin(), queue.keys.end());
+            queue.keys.clear();
+        }
 
-            ActiveTxnWriteSet.clear();
-            deletionList.clear();
+        ///slot 256 collects keys whose leaf hangs off the root
+        std::vector<std::vector<keyStruct>> garbage(257);
+        std::vector<keyStruct> pending;
+        for (auto& candidate : candidates)
+        {
+            mv_art_leaf* leaf = art_search_leaf_OCC((const unsigned char*)candidate.k.data(), candidate.k.size());
+            if (leaf == nullptr)
+                continue;
+            auto endVersion = leaf->_mvcc->current()->end_version;
+            ///deletes of running transactions, or still visible to a snapshot, are not garbage yet
+            if (mvcc11::is_txn_id(endVersion) || (endVersion != INF && endVersion > horizon))
+                pending.push_back(candidate);
+            else if (endVersion != INF)
+                garbage[subtreeOf(candidate.k.c_str())].push_back(candidate);
+        }
+        requeueDeletions(pending, 0);
+
+        std::atomic<uint64_t> removed(0);
+        boost::mutex collapsedLock;
+        std::vector<keyStruct> collapsed;
+        removed += reclaimBatch(garbage[256], 0, watermark, garbage[256], collapsedLock);
+        std::vector<GarbageCollector::Task> tasks;
+        std::vector<size_t> batches;
+        for (size_t s = 0; s < 256; s++)
+        {
+            if (garbage[s].empty())
+                continue;
+            batches.push_back(s);
+            tasks.push_back([this, &garbage, &collapsed, &removed, &collapsedLock, s, watermark] {
+                removed += reclaimBatch(garbage[s], (unsigned char)s, watermark, collapsed, collapsedLock);
+            });
+        }
+        size_t deletionTasks = tasks.size();
+        ///a subtree losing leaves this cycle is pruned by a later one, a prune task would walk nodes the batch frees
+        std::vector<unsigned char> pruned;
+        for (size_t i = 0; i < 256; i++)
+        {
+            unsigned char s = (unsigned char)((pruneCursor + i) % 256);
+            if (!garbage[s].empty())
+                continue;
+            pruned.push_back(s);
+            tasks.push_back([this, s, watermark] {
+                pruneSubtree(s, watermark);
+            });
         }
+
+        size_t started = gc.runTasks(tasks);
+        for (size_t i = started; i < deletionTasks; i++)
+            requeueDeletions(garbage[batches[i]], 0);
+        if (started > deletionTasks && started - deletionTasks < pruned.size())
+            pruneCursor = pruned[started - deletionTasks];
+
+        removed += reclaimBatch(collapsed, 0, watermark, collapsed, collapsedLock);
+        if (t->root && IS_MV_LEAF(t->root))
+            countPruned(MV_LEAF_RAW(t->root)->_mvcc->prune(watermark));
+        t->size -= removed;
+        leaves.release();
+        freeRetiredLeaves();
+        gc.setBacklog(backlog());
+        gc.endCycle();
     }
 
-    auto art_deleteGC(char *key) {
-        int key_len = std::strlen(key);
-        mv_art_leaf *l = recursive_deleteGC(t->root, &t->root, (const unsigned char *)key, key_len, 0);
-        if (l) {
-            t->size--;
-            free(l);
-            return l;
+    /**
+     * Runs GC() cycles on the driver thread of the collector until
+     * stopBackgroundGC() or the table goes away.
+     * @arg intervalUs pause between cycles, the throttle may make it longer
+     */
+    public: void startBackgroundGC(uint64_t intervalUs = GC_INTERVAL_US)
+    {
+        gc.startDriver([this] { GC(); }, intervalUs);
+    }
+
+    /// Returns once the running background cycle finished
+    public: void stopBackgroundGC()
+    {
+        gc.stopDriver();
+    }
+
+    /// Collector running GC() cycles: worker count, cycle budget and throttle are set here
+    public: GarbageCollector& garbageCollector()
+    {
+        return gc;
+    }
+
+    public: GCStats gcStats() const
+    {
+        return gc.stats();
+    }
+
+    /**
+     * Memory budget of the table in bytes. Once set, every GC() cycle ends
+     * with enforceMemoryBudget(): the least recently used key ranges (keys
+     * sharing their first byte) are evicted to sorted, block-indexed runs in
+     * dir until the estimated footprint of the rest fits. Point reads of an
+     * evicted range go through the block cache; a write, or more than
+     * TIER_RELOAD_READS reads, loads the range back. Scans and predicate
+     * operations see resident ranges only. 0 loads every range back.
+     * Set it before the table is shared: operations running at the first
+     * call are not pinned.
+     */
+    public: void setMemoryBudget(size_t bytes, const std::string& dir = "tier")
+    {
+        boost::mutex::scoped_lock guard(tierLock);
+        if (tierDir != dir)
+        {
+            Checkpoint::createDirectory(dir);
+            tierDir = dir;
         }
+        memoryBudget.store(bytes);
+        if (bytes > 0)
+            tiering.store(true);
+        else
+            for (size_t c = 0; c < 256; c++)
+                reloadRange((unsigned char) c);
+    }
 
-        return l;
+    public: size_t getMemoryBudget() const
+    {
+        return memoryBudget.load();
     }
-     mv_art_leaf* recursive_deleteGC(art_node *n, art_node **ref, const unsigned char *key, int key_len, int depth) {
-        // Search terminated
-        if (!n) return NULL;
 
-        // Handle hitting a leaf node
-        if (IS_MV_LEAF(n)) {
-            mv_art_leaf *l = MV_LEAF_RAW(n);
-            if (!mv_leaf_matches(l, key, key_len, depth)) {
-                *ref = NULL;
-                return l;
-            }
-            return NULL;
+    /**
+     * Evicts cold key ranges, least recently accessed first, until the
+     * estimated footprint of the resident ranges fits the memory budget.
+     * A range stays if one of its versions is uncommitted or newer than the
+     * low watermark (with incremental checkpoints, the newest checkpoint).
+     * Starts a new access period, so the next pass sees what was used since.
+     * @return number of ranges evicted
+     */
+    public: size_t enforceMemoryBudget()
+    {
+        size_t budget = memoryBudget.load();
+        if (budget == 0)
+            return 0;
+        boost::mutex::scoped_lock guard(tierLock);
+        uint64_t bytes[256] = {0};
+        {
+            TierPin pin(*this);
+            if (t->root)
+                mv_recursive_footprint(t->root, bytes, -1);
+        }
+        uint64_t resident = 0;
+        std::vector<unsigned char> order;
+        for (size_t c = 0; c < 256; c++)
+        {
+            resident += bytes[c];
+            if (bytes[c] > 0 && tierRanges[c].state.load() == TierResident)
+                order.push_back((unsigned char) c);
         }
+        std::stable_sort(order.begin(), order.end(), [this](unsigned char a, unsigned char b) {
+            return tierRanges[a].lastAccess.load() < tierRanges[b].lastAccess.load();
+        });
+        accessPeriod.fetch_add(1);
 
-        // Bail if the prefix does not match
-        if (n->partial_len) {
-            int prefix_len = check_prefix(n, key, key_len, depth);
-            if (prefix_len != min(MAX_PREFIX_LEN, n->partial_len)) {
-                return NULL;
+        size_t evicted = 0;
+        for (unsigned char c : order)
+        {
+            if (resident <= budget)
+                break;
+            if (evictRange(c))
+            {
+                resident -= bytes[c];
+                evicted++;
             }
-            depth = depth + n->partial_len;
         }
+        freeRetiredLeaves();
+        residentEstimate.store(resident);
+        return evicted;
+    }
 
-        // Find child node
-        art_node **child = find_child(n, key[depth]);
-        if (!child) return NULL;
-
-        // If the child is leaf, delete from this node
-        if (IS_MV_LEAF(*child)) {
-            mv_art_leaf *l = MV_LEAF_RAW(*child);
-            if (!mv_leaf_matches(l, key, key_len, depth)) {
-                remove_child(n, ref, key[depth], child);
+    public: TierStats tierStats()
+    {
+        TierStats stats;
+        {
+            TierPin pin(*this);
+            for (size_t c = 0; c < 256; c++)
+                if (TierRun* run = pinnedRun((unsigned char) c))
+                {
+                    stats.evictedRanges++;
+                    stats.runRecords += run->records();
+                    stats.runBytes += run->bytes();
+                }
+        }
+        stats.residentBytes = residentEstimate.load();
+        stats.evictions = tierEvictions.load();
+        stats.reloads = tierReloads.load();
+        stats.runReads = tierRunReads.load();
+        stats.blockCacheHits = blockCache.hits();
+        stats.blockCacheMisses = blockCache.misses();
+        return stats;
+    }
+
+    /// Operations of this thread already pinned; nested ones ride on that pin
+    private: static int& tierDepth()
+    {
+        static thread_local int depth = 0;
+        return depth;
+    }
+
+    /// This thread installs writes the redo log or a checkpoint holds already: a reload or a buffer merge
+    private: static bool& replaying()
+    {
+        static thread_local bool replaying = false;
+        return replaying;
+    }
+
+    private: static size_t tierShard()
+    {
+        static thread_local size_t shard = std::hash<std::thread::id>()(std::this_thread::get_id()) % 16;
+        return shard;
+    }
+
+    /**
+     * Holds off the end of every eviction and reload while a scan walks the
+     * tree; a no-op until tiering is on. Operations nested in the scan ride
+     * on the pin.
+     */
+    private: class TierPin
+    {
+    public:
+        explicit TierPin(ArtCPP& table)
+                : mCount(table.tiering.load() ? &table.tierPins[tierShard()].count : nullptr)
+        {
+            if (mCount != nullptr)
+            {
+                mCount->fetch_add(1);
+                tierDepth()++;
+            }
+        }
+
+        ~TierPin()
+        {
+            release();
+        }
+
+        void release()
+        {
+            if (mCount != nullptr)
+            {
+                tierDepth()--;
+                mCount->fetch_sub(1);
+                mCount = nullptr;
+            }
+        }
+
+        TierPin(const TierPin&) = delete;
+        TierPin& operator=(const TierPin&) = delete;
+
+    private:
+        std::atomic<uint64_t>* mCount;
+    };
+
+    /**
+     * Entry of a point operation while tiering is on: records the access,
+     * waits out an eviction or reload of the key's range and pins it.
+     * A write, or a read once TIER_RELOAD_READS went to the run, loads an
+     * evicted range back first; other reads are served from the run.
+     * Nested operations of the same thread neither wait nor load.
+     */
+    private: class TierGuard
+    {
+    public:
+        TierGuard(ArtCPP& table, const char* key, bool write) : mRun(nullptr), mCount(nullptr)
+        {
+            if (!table.tiering.load())
+                return;
+            unsigned char c = (unsigned char) key[0];
+            if (tierDepth() > 0)
+            {
+                mRun = table.pinnedRun(c);
+                return;
+            }
+            TierRange& range = table.tierRanges[c];
+            uint64_t period = table.accessPeriod.load(std::memory_order_relaxed);
+            if (range.lastAccess.load(std::memory_order_relaxed) != period)
+                range.lastAccess.store(period, std::memory_order_relaxed);
+            std::atomic<uint64_t>& count = table.tierPins[tierShard()].count;
+            while (true)
+            {
+                count.fetch_add(1);
+                int state = range.state.load();
+                if (state == TierResident)
+                    break;
+                if (state == TierEvicted && !write && range.runReads.fetch_add(1) < TIER_RELOAD_READS)
+                {
+                    mRun = range.run.get();
+                    break;
+                }
+                count.fetch_sub(1);
+                if (state == TierEvicted)
+                    table.reloadRange(c);
+                else
+                    std::this_thread::yield();
+            }
+            mCount = &count;
+            tierDepth()++;
+        }
+
+        ~TierGuard()
+        {
+            if (mCount != nullptr)
+            {
+                tierDepth()--;
+                mCount->fetch_sub(1);
+            }
+        }
+
+        TierGuard(const TierGuard&) = delete;
+        TierGuard& operator=(const TierGuard&) = delete;
+
+        /// Run of the key's range if the key is not in the tree
+        TierRun* run() const
+        {
+            return mRun;
+        }
+
+    private:
+        TierRun* mRun;
+        std::atomic<uint64_t>* mCount;
+    };
+
+    /// Run of an evicted range, or one being loaded back; the caller holds a pin
+    private: TierRun* pinnedRun(unsigned char range)
+    {
+        int state = tierRanges[range].state.load();
+        return state == TierEvicted || state == TierLoading ? tierRanges[range].run.get() : nullptr;
+    }
+
+    private: TierRun* pinnedRun(const char* key)
+    {
+        return tiering.load() ? pinnedRun((unsigned char) key[0]) : nullptr;
+    }
+
+    /// Version of key in run, committed below every running snapshot
+    private: const_snapshot_ptr readRun(const TierRun& run, const char* key)
+    {
+        size_t key_len = std::strlen(key);
+        long block = run.findBlock(key, key_len);
+        if (block < 0)
+            return nullptr;
+        tierRunReads.fetch_add(1, std::memory_order_relaxed);
+        auto bytes = blockCache.get(run, block);
+        const_snapshot_ptr found;
+        RedoLog::scan(*bytes, [&](const RedoRecord& r) {
+            if (found == nullptr && r.keyLen == key_len && std::memcmp(r.key, key, key_len) == 0)
+                found = smart_ptr::make_shared<snapshot_type>(
+                        r.commitTs, INF, RedoCodec<RecordType>::decode(r.payload, r.payloadLen));
+        });
+        return found;
+    }
+
+    /// Returns once every pin taken before the call has been released
+    private: void synchronizeTier()
+    {
+        for (auto& pin : tierPins)
+            while (pin.count.load() != 0)
+                std::this_thread::yield();
+    }
+
+    /**
+     * Keeps the leaves a point operation finds, in the tree, the read cache
+     * or the hash index, from being freed until it returns; GC and evictions
+     * hold one while they look at leaves too. Leaves unlinked meanwhile go
+     * to retireLeaf() and freeRetiredLeaves() frees them.
+     */
+    private: class LeafPin
+    {
+    public:
+        explicit LeafPin(ArtCPP& table)
+        {
+            while (true)
+            {
+                uint64_t epoch = table.leafEpoch.load();
+                mCount = &table.leafPins[(epoch & 1) * 16 + tierShard()].count;
+                mCount->fetch_add(1);
+                ///counted in the parity a reclaimer flipped away from, it may not wait for it
+                if (table.leafEpoch.load() == epoch)
+                    break;
+                mCount->fetch_sub(1);
+            }
+            leafPinDepth()++;
+        }
+
+        ~LeafPin()
+        {
+            release();
+        }
+
+        void release()
+        {
+            if (mCount != nullptr)
+            {
+                leafPinDepth()--;
+                mCount->fetch_sub(1);
+                mCount = nullptr;
+            }
+        }
+
+        LeafPin(const LeafPin&) = delete;
+        LeafPin& operator=(const LeafPin&) = delete;
+
+    private:
+        std::atomic<uint64_t>* mCount;
+    };
+
+    /// Pins the calling thread holds, on any table
+    private: static int& leafPinDepth()
+    {
+        static thread_local int depth = 0;
+        return depth;
+    }
+
+    /// Frees l, unlinked from the tree, once the operations pinning leaves now are done
+    private: void retireLeaf(mv_art_leaf* l)
+    {
+        boost::mutex::scoped_lock guard(retiredLock);
+        retiredLeaves.push_back(l);
+    }
+
+    /**
+     * Frees the leaves retired before the call: new point operations count
+     * in the other parity of leafEpoch from now on, and the ones still in
+     * the old parity are waited for. A thread inside a point operation
+     * leaves them to the next call.
+     */
+    private: void freeRetiredLeaves()
+    {
+        if (leafPinDepth() > 0)
+            return;
+        boost::mutex::scoped_lock serial(leafReclaimLock);
+        std::vector<mv_art_leaf*> ready;
+        {
+            boost::mutex::scoped_lock guard(retiredLock);
+            ready.swap(retiredLeaves);
+        }
+        if (ready.empty())
+            return;
+        uint64_t epoch = leafEpoch.fetch_add(1);
+        for (size_t i = 0; i < 16; i++)
+            while (leafPins[(epoch & 1) * 16 + i].count.load() != 0)
+                std::this_thread::yield();
+        for (mv_art_leaf* l : ready)
+        {
+            delete l->_mvcc;
+            free(l);
+        }
+    }
+
+    /**
+     * Writes the leaves of a cold range to a run and removes them from the
+     * tree; deleted keys below the horizon are dropped on the way. The
+     * removed leaves are retired, enforceMemoryBudget() frees them.
+     * Point operations on the range wait until it is evicted.
+     * @return false if the range is empty or not cold
+     */
+    private: bool evictRange(unsigned char range)
+    {
+        TierRange& r = tierRanges[range];
+        int expected = TierResident;
+        if (!r.state.compare_exchange_strong(expected, TierEvicting))
+            return false;
+        synchronizeTier();
+        LeafPin pin(*this);
+
+        uint64_t watermark = activeTxnRegistry.refreshLowWatermark();
+        ///a delta checkpoint finds changes in the tree only
+        uint64_t horizon = dirtyTracking.load() ? std::min<uint64_t>(watermark, checkpointedTs.load()) : watermark;
+        std::vector<std::pair<mv_art_leaf*, std::string>> leaves;
+        std::string path;
+        if (t->root)
+            mv_recursive_collect(t->root, range, leaves, path);
+        bool cold = !leaves.empty();
+        for (auto& entry : leaves)
+        {
+            if (!cold)
+                break;
+            mv_art_leaf* l = entry.first;
+            countPruned(l->_mvcc->prune(watermark));
+            auto head = l->_mvcc->current();
+            size_t end = head->end_version;
+            cold = !mvcc11::is_txn_id(head->version) && head->version <= horizon &&
+                   (end == INF || (!mvcc11::is_txn_id(end) && end <= horizon));
+        }
+        if (!cold)
+        {
+            r.state.store(TierResident);
+            return false;
+        }
+
+        std::sort(leaves.begin(), leaves.end(), [](const std::pair<mv_art_leaf*, std::string>& a,
+                                                   const std::pair<mv_art_leaf*, std::string>& b) {
+            return a.second < b.second;
+        });
+        std::unique_ptr<TierRun> run(new TierRun(tierDir + "/range-" + std::to_string(range) + "-" +
+                                                 std::to_string(++tierRunSeq) + ".run"));
+        size_t deleted = 0;
+        for (auto& entry : leaves)
+        {
+            auto head = entry.first->_mvcc->current();
+            if (head->end_version == INF)
+                run->add(entry.second.data(), entry.second.size(), head->value, head->version);
+            else
+                deleted++;
+        }
+        run->finish();
+        for (auto& entry : leaves)
+        {
+            mv_art_leaf* removed = mv_deleteGC((const unsigned char*) entry.second.data(), entry.second.size());
+            if (removed != nullptr)
+                retireLeaf(removed);
+        }
+        t->size -= deleted;
+        r.run = std::move(run);
+        r.runReads.store(0);
+        r.state.store(TierEvicted);
+        tierEvictions.fetch_add(1);
+        return true;
+    }
+
+    /**
+     * Inserts the records of an evicted range back at their commit
+     * timestamps and removes its run. A leaf written while the range was
+     * pinned is newer than the run and stays.
+     */
+    private: void reloadRange(unsigned char range)
+    {
+        TierRange& r = tierRanges[range];
+        int expected = TierEvicted;
+        if (!r.state.compare_exchange_strong(expected, TierLoading))
+            return;
+        synchronizeTier();
+
+        tierDepth()++;
+        replaying() = true;
+        size_t inserted = 0;
+        r.run->forEach([&](const RedoRecord& record) {
+            if (art_search_leaf_OCC((const unsigned char*) record.key, record.keyLen) != nullptr)
+                return;
+            std::string key(record.key, record.keyLen);
+            RecordType value = RedoCodec<RecordType>::decode(record.payload, record.payloadLen);
+            insertOrUpdateByKey(&key[0], value, record.commitTs);
+            inserted++;
+        });
+        replaying() = false;
+        tierDepth()--;
+        ///the keys were counted while evicted
+        t->size -= inserted;
+        r.run.reset();
+        r.state.store(TierResident);
+        tierReloads.fetch_add(1);
+    }
+
+    /// Leaves whose key starts with range, with their keys; path holds the key bytes down to n
+    private: void mv_recursive_collect(art_node *n, unsigned char range,
+                                       std::vector<std::pair<mv_art_leaf*, std::string>>& leaves, std::string& path)
+    {
+        if (!n) return;
+        if (IS_MV_LEAF(n))
+        {
+            mv_art_leaf* l = MV_LEAF_RAW(n);
+            std::string key;
+            const unsigned char* k = mv_leaf_key(l, path, key);
+            if ((l->key_len > 0 ? k[0] : 0) == range)
+                leaves.emplace_back(l, std::string((const char*) k, l->key_len));
+            return;
+        }
+        size_t below = mv_path_enter(path, n);
+        ///below the root every key of a child shares its first byte
+        if (n == t->root && n->partial_len == 0)
+        {
+            art_node** child = find_child(n, range);
+            mv_path_child(path, below, range);
+            if (child)
+                mv_recursive_collect(*child, range, leaves, path);
+            return;
+        }
+
+        switch (n->type)
+        {
+            case NODE4:
+                for (int i=0; i < n->num_children; i++)
+                {
+                    mv_path_child(path, below, ((art_node4*)n)->keys[i]);
+                    mv_recursive_collect(((art_node4*)n)->children[i], range, leaves, path);
+                }
+                break;
+            case NODE16:
+                for (int i=0; i < n->num_children; i++)
+                {
+                    mv_path_child(path, below, ((art_node16*)n)->keys[i]);
+                    mv_recursive_collect(((art_node16*)n)->children[i], range, leaves, path);
+                }
+                break;
+            case NODE48:
+                for (int i=0; i < 256; i++)
+                {
+                    int idx = ((art_node48*)n)->keys[i];
+                    if (!idx)
+                        continue;
+                    mv_path_child(path, below, i);
+                    mv_recursive_collect(((art_node48*)n)->children[idx-1], range, leaves, path);
+                }
+                break;
+            case NODE256:
+                for (int i=0; i < 256; i++)
+                {
+                    if (!((art_node256*)n)->children[i])
+                        continue;
+                    mv_path_child(path, below, i);
+                    mv_recursive_collect(((art_node256*)n)->children[i], range, leaves, path);
+                }
+                break;
+            default:
+                abort();
+        }
+    }
+
+    /**
+     * Adds the bytes of nodes, leaves and versions below n to the range
+     * they belong to; range is -1 for the root, whose own bytes count nowhere.
+     */
+    private: void mv_recursive_footprint(art_node *n, uint64_t* bytes, int range)
+    {
+        if (!n) return;
+        if (IS_MV_LEAF(n))
+        {
+            mv_art_leaf* l = MV_LEAF_RAW(n);
+            ///versions the low watermark keeps, the others are unlinked on the way as GC() does
+            size_t versions = 0;
+            countPruned(l->_mvcc->prune(activeTxnRegistry.lowWatermark(), &versions));
+            ///a leaf keeping a suffix is below the root, range is its first key byte then
+            int first = range >= 0 ? range : l->key_len > 0 ? (unsigned char) l->key[0] : 0;
+            bytes[first] += mv_leaf_size(l) + sizeof(mvcc_type) + versions * sizeof(snapshot_type);
+            return;
+        }
+        auto below = [&](int c) {
+            return range >= 0 ? range : n->partial_len > 0 ? (int) n->partial[0] : c;
+        };
+
+        switch (n->type)
+        {
+            case NODE4:
+                if (range >= 0) bytes[range] += sizeof(art_node4);
+                for (int i=0; i < n->num_children; i++)
+                    mv_recursive_footprint(((art_node4*)n)->children[i], bytes, below(((art_node4*)n)->keys[i]));
+                break;
+            case NODE16:
+                if (range >= 0) bytes[range] += sizeof(art_node16);
+                for (int i=0; i < n->num_children; i++)
+                    mv_recursive_footprint(((art_node16*)n)->children[i], bytes, below(((art_node16*)n)->keys[i]));
+                break;
+            case NODE48:
+                if (range >= 0) bytes[range] += sizeof(art_node48);
+                for (int i=0; i < 256; i++)
+                {
+                    int idx = ((art_node48*)n)->keys[i];
+                    if (idx)
+                        mv_recursive_footprint(((art_node48*)n)->children[idx-1], bytes, below(i));
+                }
+                break;
+            case NODE256:
+                if (range >= 0) bytes[range] += sizeof(art_node256);
+                for (int i=0; i < 256; i++)
+                    mv_recursive_footprint(((art_node256*)n)->children[i], bytes, below(i));
+                break;
+            default:
+                abort();
+        }
+    }
+
+    /**
+     * Puts a write buffer in front of the tree. Autocommit inserts (the
+     * size_t txn_id variant outside a TxnContext) are logged and go to a
+     * small sorted batch of their partition instead of the tree; a full
+     * batch is merged into the tree in key order by a background merger,
+     * so a burst of fresh keys shares paths and node growth per batch.
+     * Point lookups check the buffer before the tree. Other writes to a
+     * partition, scans, checkpoints and art_size() merge what is buffered
+     * first. A buffered write that conflicts at merge time is dropped, like
+     * a failed autocommit write.
+     * @arg entries writes a partition absorbs before its batch is merged
+     */
+    public: void enableWriteBuffer(size_t entries = ART_WRITE_BUFFER_ENTRIES)
+    {
+        std::lock_guard<std::mutex> guard(mergerLock);
+        writeBuffer.setCapacity(entries);
+        bufferWrites.store(true);
+        if (merger == nullptr)
+        {
+            mergerStop = false;
+            merger.reset(new boost::thread([this] { runMerger(); }));
+        }
+    }
+
+    /// Merges every buffered write and stops the merger
+    public: void disableWriteBuffer()
+    {
+        bufferWrites.store(false);
+        {
+            std::lock_guard<std::mutex> guard(mergerLock);
+            mergerStop = true;
+        }
+        mergerWake.notify_all();
+        if (merger != nullptr)
+        {
+            merger->join();
+            merger.reset();
+        }
+        flushWriteBuffer();
+    }
+
+    /// Merges every buffered write on the calling thread
+    public: void flushWriteBuffer()
+    {
+        if (writeBuffer.size() == 0 || replaying())
+            return;
+        for (size_t p = 0; p < ART_WRITE_BUFFER_PARTITIONS; p++)
+        {
+            writeBuffer.seal(p);
+            mergePartition(p, true);
+        }
+    }
+
+    public: WriteBufferStats writeBufferStats() const
+    {
+        return writeBuffer.stats();
+    }
+
+    /// Not a write of the TxnContext running on this thread
+    private: bool autocommit(size_t txn_id)
+    {
+        TxnContext* txn = TxnContext::current();
+        return txn == nullptr || txn->id() != txn_id;
+    }
+
+    /**
+     * Adds an autocommit insert to the write buffer and logs it. A writer
+     * whose partition has ART_WRITE_BUFFER_MAX_SEALED batches waiting merges
+     * them itself.
+     * @return the version it replaces in the buffer or the tree, NULL for a new key
+     */
+    private: const_snapshot_ptr bufferWrite(char* key, RecordType& value, size_t txn_id)
+    {
+        size_t key_len = std::strlen(key);
+        const_snapshot_ptr version = smart_ptr::make_shared<snapshot_type>(txn_id, INF, value);
+        ///the tree is read first, the merger may apply the new write as soon as it is buffered
+        const_snapshot_ptr below;
+        {
+            TierPin pin(*this);
+            mv_art_leaf* leaf = art_search_leaf_OCC((const unsigned char*) key, key_len);
+            below = leaf != nullptr ? leaf->_mvcc->current() : nullptr;
+        }
+        bool sealed = false;
+        const_snapshot_ptr replaced = writeBuffer.put(key, key_len, version, sealed);
+        ///logged once buffered, a checkpoint merging the buffer after its log offset finds every record before it
+        if (redoLog != nullptr)
+        {
+            redoLog->appendPut(key, key_len, value);
+            redoLog->seal(txn_id, false);
+        }
+        if (sealed)
+        {
+            size_t p = WriteBuffer<const_snapshot_ptr>::partitionOf(key);
+            if (writeBuffer.sealedBatches(p) > ART_WRITE_BUFFER_MAX_SEALED)
+                mergePartition(p, true);
+            else
+                mergerWake.notify_one();
+        }
+        return replaced != nullptr ? replaced : below;
+    }
+
+    /// Merges the buffered writes of key's partition, so a write bypassing the buffer lands after them
+    private: void drainBuffered(const char* key)
+    {
+        if (writeBuffer.size() == 0 || replaying())
+            return;
+        size_t p = WriteBuffer<const_snapshot_ptr>::partitionOf(key);
+        writeBuffer.seal(p);
+        mergePartition(p, true);
+    }
+
+    private: size_t mergePartition(size_t p, bool writer)
+    {
+        return writeBuffer.merge(p, [this](const typename WriteBuffer<const_snapshot_ptr>::Entry& entry) {
+            std::string key = entry.key;
+            RecordType value = entry.version->value;
+            replaying() = true;
+            insertOrUpdateByKey(&key[0], value, entry.version->version);
+            replaying() = false;
+        }, writer);
+    }
+
+    /**
+     * Background merger: merges sealed batches when a writer seals one, and
+     * every ART_WRITE_BUFFER_FLUSH_US seals and merges whatever is buffered.
+     */
+    private: void runMerger()
+    {
+        auto lastSeal = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(mergerLock);
+        while (!mergerStop)
+        {
+            mergerWake.wait_for(lock, std::chrono::microseconds(ART_WRITE_BUFFER_FLUSH_US));
+            lock.unlock();
+            auto now = std::chrono::steady_clock::now();
+            bool sealAll = now - lastSeal >= std::chrono::microseconds(ART_WRITE_BUFFER_FLUSH_US);
+            if (sealAll)
+                lastSeal = now;
+            for (size_t p = 0; p < ART_WRITE_BUFFER_PARTITIONS && writeBuffer.size() > 0; p++)
+            {
+                if (sealAll)
+                    writeBuffer.seal(p);
+                mergePartition(p, false);
+            }
+            lock.lock();
+        }
+    }
+
+    /**
+     * Gives an empty table a partitioned root: a Node256 indexed by the
+     * first key byte and, for bytes == 2, a Node256 in every slot indexed by
+     * the second. These nodes are pinned: never locked, grown, shrunk or
+     * replaced, so writers below different slots share no lock. An empty or
+     * leaf slot is taken over by CAS, a node in a slot is locked on its own
+     * when it grows or splits, and lookups read the slot again rather than
+     * validating its pinned parent. Inserts count keys per first byte
+     * instead of in t->size. Two bytes cost 256 more Node256, about 530 KB.
+     * Called before the table is shared, it replaces an empty root.
+     * @arg bytes 1 for 256 slots, 2 for 65536
+     * @return false if the table holds keys or bytes is not 1 or 2
+     */
+    public: bool partitionRoot(int bytes = 1)
+    {
+        flushWriteBuffer();
+        if (bytes < 1 || bytes > 2 || minimum(t->root) != nullptr)
+            return false;
+        destroy_node(t->root);
+        art_node* root = alloc_node(NODE256);
+        root->pinned = 1;
+        if (bytes == 2)
+            for (int c = 0; c < 256; c++)
+            {
+                art_node* slot = alloc_node(NODE256);
+                slot->pinned = 1;
+                ((art_node256*)root)->children[c] = slot;
+            }
+        rootPartitionBytes = bytes;
+        t->root = root;
+        return true;
+    }
+
+    public: int getRootPartitionBytes() const
+    {
+        return rootPartitionBytes;
+    }
+
+    /**
+     * Per-thread fingers, off by default. A thread remembers the inner nodes
+     * of its last insertion path together with their OLC versions. An insert
+     * or point lookup whose key shares the bytes above one of them starts at
+     * the deepest one that is unchanged instead of at the root, so ascending
+     * keys skip the upper levels. A thread keeps one finger per table type;
+     * switching tables starts over at the root.
+     */
+    public: void setFingerCaching(bool on)
+    {
+        fingerCaching.store(on);
+    }
+
+    public: bool getFingerCaching() const
+    {
+        return fingerCaching.load();
+    }
+
+    /// Point operations of the calling thread on this table, and how many started at its finger
+    public: FingerStats fingerStats()
+    {
+        Finger& f = finger();
+        return f.owner == fingerOwner ? f.stats : FingerStats();
+    }
+
+    private: static Finger& finger()
+    {
+        static thread_local Finger finger;
+        return finger;
+    }
+
+    private: static uint64_t nextFingerOwner()
+    {
+        static std::atomic<uint64_t> owners(0);
+        return ++owners;
+    }
+
+    /**
+     * Deepest frame below the root of this thread's finger that key passes
+     * through and whose node is unchanged since, -1 if there is none. No
+     * node was freed since the finger was taken, so every frame still points
+     * at a live node, and an unchanged version means the same children and
+     * prefix.
+     */
+    private: int fingerFrame(Finger& f, const unsigned char* key, int key_len)
+    {
+        if (f.owner != fingerOwner || f.frames < 2 || f.frees != artNodeFrees.load())
+            return -1;
+        int shared = 0, most = std::min<int>(key_len, f.key.size());
+        while (shared < most && key[shared] == (unsigned char) f.key[shared])
+            shared++;
+        for (int i = f.frames - 1; i > 0; i--)
+        {
+            const FingerFrame& frame = f.path[i];
+            if (frame.depth <= shared && frame.depth < key_len && frame.node->version.load() == frame.version)
+                return i;
+        }
+        return -1;
+    }
+
+    /**
+     * Inserts key starting at fingerFrame(), or at the root, and makes the
+     * path it took the finger of this thread.
+     */
+    private: const_snapshot_ptr fingerInsert(const unsigned char* key, int key_len, RecordType& value, int* old,
+                                             size_t txn_id)
+    {
+        Finger& f = finger();
+        int from = fingerFrame(f, key, key_len);
+        ///a node that grows is swapped in its parent under the parent's lock, the parent has to be unchanged too
+        if (from > 0 && f.path[from - 1].node->version.load() != f.path[from - 1].version)
+            from = -1;
+        const_snapshot_ptr replaced;
+        if (from > 0)
+        {
+            f.stats.insertHits++;
+            const FingerFrame start = f.path[from], parent = f.path[from - 1];
+            f.frames = from;
+            f.recording = true;
+            replaced = mv_recursive_insert(start.node, start.ref, key, key_len, value, start.depth, old, txn_id,
+                                           parent.version, parent.node, false);
+        }
+        else
+        {
+            fingerReset(f, artNodeFrees.load());
+            f.stats.insertMisses++;
+            f.recording = true;
+            replaced = mv_recursive_insert(t->root, &t->root, key, key_len, value, 0, old, txn_id, 0, t->root, false);
+        }
+        f.recording = false;
+        fingerTake(f, key, key_len);
+        return replaced;
+    }
+
+    /// Empties the finger for a path taken from the root; frees is read before the root pointer
+    private: void fingerReset(Finger& f, uint64_t frees)
+    {
+        if (f.owner != fingerOwner)
+            f.stats = FingerStats();
+        f.owner = fingerOwner;
+        f.frees = frees;
+        f.frames = 0;
+    }
+
+    /**
+     * Appends a node a lookup passed with its validated version.
+     * @return false if the node was locked or the finger is full, the path ends above it
+     */
+    private: static bool fingerPush(Finger& f, art_node* n, art_node** ref, uint64_t version, int depth)
+    {
+        if (f.frames == ART_FINGER_DEPTH || (version & 0b11) != 0)
+            return false;
+        f.path[f.frames++] = FingerFrame{n, ref, version, depth};
+        return true;
+    }
+
+    /// Records an inner node the insert running on this thread passes, fingerTake() reads its version
+    private: void fingerStep(art_node* n, art_node** ref, int depth)
+    {
+        Finger& f = finger();
+        if (f.recording && f.frames < ART_FINGER_DEPTH)
+            f.path[f.frames++] = FingerFrame{n, ref, 0, depth};
+    }
+
+    /**
+     * Keeps the recorded path down to the first node that is no longer
+     * linked at its slot or is locked, each with the version it has now.
+     * Nothing is kept if a node was freed meanwhile, it may be one of them.
+     */
+    private: void fingerTake(Finger& f, const unsigned char* key, int key_len)
+    {
+        int kept = 0;
+        if (artNodeFrees.load() == f.frees)
+        {
+            for (; kept < f.frames; kept++)
+            {
+                FingerFrame& frame = f.path[kept];
+                ///a restarted insert records from the root again
+                if (kept > 0 && frame.depth <= f.path[kept - 1].depth)
+                    break;
+                uint64_t v = frame.node->version.load();
+                if ((v & 0b11) != 0 || *frame.ref != frame.node || frame.node->version.load() != v)
+                    break;
+                frame.version = v;
+            }
+        }
+        f.frames = kept;
+        f.key.assign((const char*) key, key_len);
+    }
+
+    /**
+     * Flat combining on hot nodes, off by default. Inserts that lose the write
+     * lock of a node count the conflict; after ART_COMBINING_THRESHOLD in
+     * quick succession the node is hot and gets a publication list. A loser
+     * that would add its leaf to a hot node publishes the leaf there instead
+     * of restarting, and the writer holding the lock adds every published
+     * leaf that still fits before it releases the node. A node that loses no
+     * lock for ART_COMBINING_WINDOW_US gives its list up. Off, every loser
+     * restarts.
+     */
+    public: void setCombining(bool on)
+    {
+        combining.store(on);
+    }
+
+    public: bool getCombining() const
+    {
+        return combining.load();
+    }
+
+    public: ContentionStats contentionStats() const
+    {
+        ContentionStats stats;
+        stats.conflicts = lockConflicts.load();
+        stats.restarts = insertRestarts.load();
+        stats.published = publishedInserts.load();
+        stats.combined = combinedInserts.load();
+        stats.readRestarts = readRestarts.load();
+        stats.latchWaits = latchWaits.load();
+        uint64_t now = combiningClock();
+        for (const CombiningSlot& s : combiningSlots)
+        {
+            if (s.node.load() == nullptr)
+                continue;
+            if (now - s.lastConflict.load() < ART_COMBINING_WINDOW_US)
+                stats.hotNodes++;
+            for (const std::atomic<CombiningRecord*>& record : s.records)
+                stats.pending += record.load() != nullptr;
+            if (s.latched.load() && now - s.lastConflict.load() < ART_LATCH_CALM_US)
+                stats.latchedNodes++;
+        }
+        return stats;
+    }
+
+    /**
+     * Contention-adaptive locking, off by default. Nodes whose lookups
+     * restart and whose inserts lose locks ART_LATCH_THRESHOLD times in
+     * quick succession are latched: their writers also hold a reader-writer
+     * latch while they hold the node's lock, and lookups and inserts that
+     * find the node locked wait on the latch instead of spinning through
+     * restarts. Versions are validated as before, the latch only orders the
+     * waiting. A node without conflicts for ART_LATCH_CALM_US goes back to
+     * optimistic locking alone.
+     */
+    public: void setAdaptiveLatching(bool on)
+    {
+        latching.store(on);
+    }
+
+    public: bool getAdaptiveLatching() const
+    {
+        return latching.load();
+    }
+
+    /**
+     * Leaf fingerprints, off by default, built with ART_LEAF_FINGERPRINTS. Every
+     * tagged pointer to a leaf keeps the top byte of the key's hash in the
+     * bits above the address, and a point lookup that ends at a leaf compares
+     * it with the byte of the key it looks for: a mismatch means the key is
+     * absent, without a cache miss on the leaf. Keys that match still have
+     * their leaf compared, one in 256 absent keys among them. The bytes are
+     * kept either way; this only switches the comparison. Where heap pointers
+     * use their top byte (LA57, ARM TBI/MTE, HWASan) no bytes are kept and
+     * fingerprints stay off, see leafFingerprintsAvailable().
+     */
+    public: void setLeafFingerprints(bool on)
+    {
+        leafFingerprints.store(on && leafFingerprintsAvailable());
+    }
+
+    public: bool getLeafFingerprints() const
+    {
+        return leafFingerprintsAvailable() && leafFingerprints.load();
+    }
+
+    /// true if built with ART_LEAF_FINGERPRINTS and the top byte of heap pointers is free
+    public: static bool leafFingerprintsAvailable()
+    {
+#if ART_LEAF_FINGERPRINTS
+        return LEAF_TAG_MASK != 1;
+#else
+        return false;
+#endif
+    }
+
+    /// Point lookups answered absent by a leaf fingerprint, without reading the leaf
+    public: uint64_t fingerprintRejects() const
+    {
+        return fingerprintRejected.load();
+    }
+
+    /**
+     * Suffix-only leaf keys, off by default (ART_LEAF_SUFFIXES). A leaf
+     * keeps its key length and only the key bytes past the depth it is
+     * inserted at; the bytes before are those of the path down to it. So
+     * that the path holds all of them, a prefix longer than MAX_PREFIX_LEN
+     * becomes a chain of nodes instead of one node with an optimistic
+     * prefix, and deletes do not pull a last leaf up or merge prefixes past
+     * MAX_PREFIX_LEN. A lookup that ends at a leaf has matched the path
+     * byte by byte and compares the suffix. Scans rebuild each key from the
+     * path. The read cache and the hash index need whole keys in the
+     * leaves, the cache is bypassed and enableHashIndex() refuses.
+     * @return false if the table holds keys or has a hash index, the mode stays
+     */
+    public: bool setLeafSuffixes(bool on = true)
+    {
+        flushWriteBuffer();
+        if (minimum(t->root) != nullptr || hashIndex != nullptr)
+            return false;
+        leafSuffixes = on;
+        return true;
+    }
+
+    public: bool getLeafSuffixes() const
+    {
+        return leafSuffixes;
+    }
+
+    /**
+     * Bytes of the nodes, leaves and versions of the tree, as
+     * enforceMemoryBudget() estimates them; versions below the low
+     * watermark are unlinked on the way.
+     */
+    public: uint64_t estimatedFootprint()
+    {
+        flushWriteBuffer();
+        uint64_t bytes[256] = {0};
+        TierPin pin(*this);
+        if (t->root)
+            mv_recursive_footprint(t->root, bytes, -1);
+        uint64_t total = 0;
+        for (size_t c = 0; c < 256; c++)
+            total += bytes[c];
+        return total;
+    }
+
+    /**
+     * Per-thread read cache, off by default. Point lookups remember the leaf
+     * they found in a direct-mapped cache of ART_READ_CACHE_ENTRIES keys per
+     * thread, and a repeated lookup of a key returns its leaf without walking
+     * the tree. Updates add versions to the leaf, so the entry stays valid
+     * until the leaf is unlinked: deletes by GC(), evicted ranges and
+     * destroying the tree first bump a counter the key hashes to, and an
+     * entry whose counter moved is dropped. An unlinked leaf is freed once
+     * the point operations that may hold it returned, see LeafPin. A miss replaces an entry only
+     * after it stopped being hit, so the hottest keys stay. A thread keeps
+     * one cache per table type; switching tables empties it.
+     */
+    public: void setReadCaching(bool on)
+    {
+        readCaching.store(on);
+    }
+
+    public: bool getReadCaching() const
+    {
+        return readCaching.load();
+    }
+
+    /// Point lookups of the calling thread on this table that went through its read cache
+    public: ReadCacheStats readCacheStats()
+    {
+        ReadCache& c = readCache();
+        return c.owner == fingerOwner ? c.stats : ReadCacheStats();
+    }
+
+    private: static ReadCache& readCache()
+    {
+        static thread_local std::unique_ptr<ReadCache> cache(new ReadCache());
+        return *cache;
+    }
+
+    /// FNV-1a of key; the low bits pick the cache entry, the high ones the stripe of leafUnlinks
+    private: static uint64_t keyHash(const unsigned char* key, int key_len)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (int i = 0; i < key_len; i++)
+            hash = (hash ^ key[i]) * 1099511628211ull;
+        return hash;
+    }
+
+    private: std::atomic<uint64_t>& leafUnlinksOf(uint64_t hash)
+    {
+        return leafUnlinks[(hash >> 32) % ART_READ_CACHE_STRIPES];
+    }
+
+    /// Called before the leaf of key is unlinked, every cached pointer to it is stale from now on
+    private: void readCacheInvalidate(const unsigned char* key, int key_len)
+    {
+        leafUnlinksOf(keyHash(key, key_len)).fetch_add(1);
+    }
+
+    /**
+     * art_search_leaf_OCC() through this thread's read cache. The stripe of
+     * key is read before the tree is, so a leaf unlinked after the lookup
+     * found it leaves a stamp behind that no longer matches.
+     */
+    private: mv_art_leaf* cachedSearch(const unsigned char* key, int key_len)
+    {
+        ///an entry is matched by its leaf, one that keeps a suffix only cannot tell the rest of the key
+        if (!readCaching.load(std::memory_order_relaxed) || leafSuffixes)
+            return pointSearch(key, key_len);
+        ReadCache& c = readCache();
+        if (c.owner != fingerOwner)
+        {
+            for (ReadCacheEntry& e : c.entries)
+                e = ReadCacheEntry();
+            c.stats = ReadCacheStats();
+            c.owner = fingerOwner;
+        }
+        uint64_t hash = keyHash(key, key_len);
+        uint64_t stamp = leafUnlinksOf(hash).load(std::memory_order_acquire);
+        ReadCacheEntry& e = c.entries[hash & (ART_READ_CACHE_ENTRIES - 1)];
+        if (e.leaf != nullptr && e.hash == hash)
+        {
+            if (e.stamp == stamp && !mv_leaf_matches(e.leaf, key, key_len, 0))
+            {
+                c.stats.hits++;
+                if (e.hits < 3)
+                    e.hits++;
+                return e.leaf;
+            }
+            if (e.stamp != stamp)
+            {
+                c.stats.stale++;
+                e = ReadCacheEntry();
+            }
+        }
+        c.stats.misses++;
+        mv_art_leaf* leaf = pointSearch(key, key_len);
+        if (leaf == nullptr)
+            return nullptr;
+        if (e.leaf != nullptr && e.hits > 0)
+        {
+            c.stats.kept++;
+            e.hits--;
+            return leaf;
+        }
+        e.hash = hash;
+        e.leaf = leaf;
+        e.stamp = stamp;
+        e.hits = 0;
+        return leaf;
+    }
+
+    /**
+     * Keeps a hash index of every key next to the tree. Point lookups
+     * (findValueByKey) take the leaf from the index instead of walking the
+     * tree; scans, prefix and range operations still use the tree. New
+     * leaves are added as they are linked and removed before GC() or an
+     * eviction unlinks them. A slot takes 16 bytes and the index fills 25-50%
+     * of them, 32-64 bytes per key, plus the smaller tables it outgrew, which
+     * are kept until it is disabled. Called before the table is shared or
+     * while no writer runs, it indexes the keys already there. A table
+     * with setLeafSuffixes() gets none, the index compares whole keys.
+     * @arg capacity slots to start with, at least enough for the keys there
+     * @return false if the table has an index already or keeps suffixes in its leaves
+     */
+    public: bool enableHashIndex(size_t capacity = ART_HASH_INDEX_CAPACITY)
+    {
+        if (hashIndex != nullptr || leafSuffixes)
+            return false;
+        capacity = std::max<size_t>(capacity, art_size() * 100 / ART_HASH_INDEX_LOAD_PERCENT);
+        std::unique_ptr<HashIndex<mv_art_leaf>> index(new HashIndex<mv_art_leaf>(capacity));
+        auto add = [&index](mv_art_leaf* l) { index->insert(l); };
+        mv_recursive_leaves(t->root, add);
+        hashIndex = std::move(index);
+        return true;
+    }
+
+    /// Point lookups walk the tree again; while no other thread uses the table
+    public: void disableHashIndex()
+    {
+        hashIndex.reset();
+    }
+
+    public: bool hasHashIndex() const
+    {
+        return hashIndex != nullptr;
+    }
+
+    public: HashIndexStats hashIndexStats()
+    {
+        return hashIndex != nullptr ? hashIndex->stats() : HashIndexStats();
+    }
+
+    /// Leaf of key from the hash index if there is one, from the tree otherwise
+    private: mv_art_leaf* pointSearch(const unsigned char* key, int key_len)
+    {
+        if (hashIndex != nullptr)
+            return hashIndex->find(key, key_len);
+        return art_search_leaf_OCC(key, key_len);
+    }
+
+    private: template <typename Fn>
+    void mv_recursive_leaves(art_node *n, Fn& fn)
+    {
+        if (!n) return;
+        if (IS_MV_LEAF(n))
+        {
+            fn(MV_LEAF_RAW(n));
+            return;
+        }
+
+        switch (n->type)
+        {
+            case NODE4:
+                for (int i=0; i < n->num_children; i++)
+                    mv_recursive_leaves(((art_node4*)n)->children[i], fn);
+                break;
+            case NODE16:
+                for (int i=0; i < n->num_children; i++)
+                    mv_recursive_leaves(((art_node16*)n)->children[i], fn);
+                break;
+            case NODE48:
+                for (int i=0; i < 256; i++)
+                {
+                    int idx = ((art_node48*)n)->keys[i];
+                    if (idx)
+                        mv_recursive_leaves(((art_node48*)n)->children[idx-1], fn);
+                }
+                break;
+            case NODE256:
+                for (int i=0; i < 256; i++)
+                    if (((art_node256*)n)->children[i])
+                        mv_recursive_leaves(((art_node256*)n)->children[i], fn);
+                break;
+            default:
+                abort();
+        }
+    }
+
+    private: static uint64_t combiningClock()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    private: static size_t combiningSlotOf(const art_node* n)
+    {
+        return (size_t) ((((uintptr_t) n >> 4) * 0x9E3779B97F4A7C15ull) >> 40) % ART_COMBINING_NODES;
+    }
+
+    private: static CombiningRecord& combiningRecord()
+    {
+        static thread_local CombiningRecord record;
+        return record;
+    }
+
+    private: const_snapshot_ptr restartInsert(int* old)
+    {
+        *old = InsertRestart;
+        return nullptr;
+    }
+
+    /// Counts the write lock of n an insert lost and starts the insert over
+    private: const_snapshot_ptr lostLock(art_node* n, int* old)
+    {
+        noteConflict(n);
+        return restartInsert(old);
+    }
+
+    /**
+     * Counts a write lock of n that an insert lost, or found taken, or a
+     * restart of a lookup at n, and latches n once it conflicts often.
+     * @return the publication list of n once n is hot, nullptr before, for a
+     * lookup or with combining off
+     */
+    private: CombiningSlot* noteConflict(art_node* n, bool lookup = false)
+    {
+        (lookup ? readRestarts : lockConflicts).fetch_add(1, std::memory_order_relaxed);
+        if (!combining.load() && !latching.load())
+            return nullptr;
+        CombiningSlot& s = combiningSlots[combiningSlotOf(n)];
+        uint64_t now = combiningClock();
+        uint64_t last = s.lastConflict.load();
+        art_node* owner = s.node.load();
+        if (owner != n)
+        {
+            ///the slot of a node that cooled down goes to the next node that conflicts
+            if (owner != nullptr && now - last < (s.latched.load() ? ART_LATCH_CALM_US : ART_COMBINING_WINDOW_US))
+                return nullptr;
+            if (!s.node.compare_exchange_strong(owner, n))
+                return nullptr;
+            s.conflicts.store(0);
+            s.latched.store(false);
+        }
+        else if (now - last >= ART_COMBINING_WINDOW_US)
+            s.conflicts.store(0);
+        s.lastConflict.store(now);
+        uint32_t conflicts = s.conflicts.fetch_add(1) + 1;
+        if (conflicts >= ART_LATCH_THRESHOLD && latching.load())
+            s.latched.store(true);
+        return !lookup && combining.load() && conflicts >= ART_COMBINING_THRESHOLD ? &s : nullptr;
+    }
+
+    /**
+     * Latch of n while n is latched, nullptr for a calm node, which is
+     * unlatched here, or with adaptive latching off. Needs no access to n.
+     */
+    private: Mutex* latchOf(const art_node* n)
+    {
+        CombiningSlot& s = combiningSlots[combiningSlotOf(n)];
+        if (!s.latched.load(std::memory_order_relaxed) || s.node.load() != n)
+            return nullptr;
+        if (!latching.load() || combiningClock() - s.lastConflict.load() >= ART_LATCH_CALM_US)
+        {
+            s.latched.store(false);
+            return nullptr;
+        }
+        return &s.latch;
+    }
+
+    /**
+     * Waits until the writer that holds n, a latched node, releases it.
+     * @return false if there was nothing to wait for, the caller retries as before
+     */
+    private: bool awaitLatch(const art_node* n)
+    {
+        Mutex* latch = latchOf(n);
+        ///the lock of n may have been taken before n was latched, its holder does not hold the latch then
+        if (latch == nullptr || latch->try_lock_shared())
+        {
+            if (latch != nullptr)
+                latch->unlock_shared();
+            return false;
+        }
+        latchWaits.fetch_add(1, std::memory_order_relaxed);
+        SharedLock wait(*latch);
+        return true;
+    }
+
+    /// Holds the latch of a latched node exclusively for the span of a write lock on it
+    private: class NodeLatch
+    {
+    public:
+        NodeLatch(ArtCPP& tree, const art_node* n) : latch(n != nullptr ? tree.latchOf(n) : nullptr)
+        {
+            if (latch != nullptr)
+                latch->lock();
+        }
+
+        ~NodeLatch()
+        {
+            release();
+        }
+
+        void release()
+        {
+            if (latch != nullptr)
+                latch->unlock();
+            latch = nullptr;
+        }
+
+    private:
+        Mutex* latch;
+    };
+
+    /**
+     * Hands the add of leaf l at byte of n, which the caller descended with
+     * version, to the writer holding n's lock.
+     * @return true if the holder added l, false if the insert has to restart:
+     * the list was full, the holder released n without taking l, or n changed
+     */
+    private: bool publishInsert(CombiningSlot& s, art_node* n, uint64_t version, unsigned char byte, mv_art_leaf* l)
+    {
+        CombiningRecord& r = combiningRecord();
+        uint64_t seq = ((r.state.load() >> 2) + 1) << 2;
+        r.node = n;
+        r.version = version;
+        r.byte = byte;
+        r.leaf = l;
+        r.state.store(seq | CombinePending);
+        int at = 0;
+        for (; at < ART_COMBINING_RECORDS; at++)
+        {
+            CombiningRecord* none = nullptr;
+            if (s.records[at].compare_exchange_strong(none, &r))
+                break;
+        }
+        if (at == ART_COMBINING_RECORDS)
+        {
+            r.state.store(seq | CombineRefused);
+            return false;
+        }
+        publishedInserts.fetch_add(1, std::memory_order_relaxed);
+        uint64_t pending = seq | CombinePending;
+        for (int waits = 0; r.state.load() == pending && waits < ART_COMBINING_WAIT; waits++)
+            boost::this_thread::yield();
+        ///withdrawn, unless the holder took it meanwhile and settles it shortly
+        if (!r.state.compare_exchange_strong(pending, seq | CombineRefused))
+            while (r.state.load() == (seq | CombineTaken))
+                boost::this_thread::yield();
+        s.records[at].store(nullptr);
+        return r.state.load() == (seq | CombineAdded);
+    }
+
+    /**
+     * Adds the leaves other writers published on the list of n, which the
+     * caller locked from version on. A leaf is refused if its writer
+     * descended with another version of n than this one or the locked one,
+     * if its byte was taken meanwhile or if n is full. Releases the list of
+     * a node that cooled down.
+     */
+    private: void combine(art_node* n, art_node** ref, uint64_t version)
+    {
+        CombiningSlot& s = combiningSlots[combiningSlotOf(n)];
+        if (s.node.load() != n)
+            return;
+        if (combiningClock() - s.lastConflict.load() >= ART_COMBINING_WINDOW_US)
+        {
+            art_node* owner = n;
+            s.node.compare_exchange_strong(owner, nullptr);
+            return;
+        }
+        uint64_t added = 0;
+        for (std::atomic<CombiningRecord*>& record : s.records)
+        {
+            CombiningRecord* r = record.load();
+            if (r == nullptr)
+                continue;
+            uint64_t state = r->state.load();
+            if ((state & 0b11) != CombinePending || r->node != n)
+                continue;
+            uint64_t seen = r->version;
+            unsigned char byte = r->byte;
+            mv_art_leaf* l = r->leaf;
+            ///the fields read above belong to this insert only if it is still pending
+            if (!r->state.compare_exchange_strong(state, (state & ~0b11ull) | CombineTaken))
+                continue;
+            bool fits = (seen == version || seen == version + 0b10) && isNodeFull(n) && find_child(n, byte) == nullptr;
+            if (fits)
+            {
+                add_child(n, ref, byte, SET_MV_LEAF(l));
+                added++;
+            }
+            r->state.store((state & ~0b11ull) | (fits ? CombineAdded : CombineRefused));
+        }
+        combinedInserts.fetch_add(added, std::memory_order_relaxed);
+    }
+
+    /**
+     * Write-locks the inner node the path of key ends at, as an insert adding
+     * key there does, and adds the inserts other writers publish on it until
+     * done(), asked after every pass, returns true. For tests of combining and
+     * latching: the node stays locked however long other writers and lookups take.
+     * @return inserts added while the node was held, 0 if key ends at no inner node
+     */
+    public: template <typename Done>
+    size_t holdNode(const char* key, Done done)
+    {
+        int key_len = std::strlen(key);
+        while (true)
+        {
+            art_node** ref = &t->root;
+            art_node* n = t->root;
+            int depth = 0;
+            while (n != nullptr && !IS_MV_LEAF(n))
+            {
+                depth += n->partial_len;
+                art_node** child = depth < key_len ? find_child(n, key[depth]) : nullptr;
+                if (child == nullptr || *child == nullptr || IS_MV_LEAF(*child))
+                    break;
+                ref = child;
+                n = *child;
+                depth++;
+            }
+            if (n == nullptr || IS_MV_LEAF(n) || n->pinned)
+                return 0;
+            bool needRestart = false;
+            uint64_t version = n->readLockOrRestart(needRestart);
+            NodeLatch latch(*this, n);
+            if (upgradeToWriteLockOrRestart(n, version, needRestart))
+            {
+                latch.release();
+                boost::this_thread::yield();
+                continue;
+            }
+            uint64_t before = combinedInserts.load();
+            while (true)
+            {
+                combine(n, ref, version);
+                if (done())
+                    break;
+                boost::this_thread::yield();
+            }
+            n->writeUnlock();
+            return combinedInserts.load() - before;
+        }
+    }
+
+    /**
+     * Logs every committed insert, update and delete to log from now on,
+     * nullptr stops logging. The table does not own the log.
+     */
+    public: void setRedoLog(RedoLog* log)
+    {
+        redoLog = log;
+    }
+
+    public: RedoLog* getRedoLog() const
+    {
+        return redoLog;
+    }
+
+    /**
+     * Fuzzy checkpoint of the table into dir, taken while writers keep going.
+     * The records visible at a fresh snapshot are written; the snapshot sits
+     * in the active transaction registry, so pruning and GC keep every version
+     * it reads, and no node or leaf is locked. Root subtrees are spread over
+     * the partition files, each file is scanned and written by one of threads.
+     * Once the manifest is published the previous checkpoint's files are
+     * removed and, with a redo log, the records the checkpoint covers.
+     */
+    public: CheckpointInfo checkpoint(const std::string& dir, size_t partitions = CHECKPOINT_PARTITIONS,
+                                      size_t threads = CHECKPOINT_THREADS)
+    {
+        return writeCheckpoint(dir, partitions, threads, false);
+    }
+
+    /**
+     * Checkpoint writing only what changed since the previous checkpoint in
+     * dir: writes raise a dirty epoch on the nodes of their path, and the scan
+     * skips every subtree not written since that checkpoint began. Below a
+     * dirty node a leaf is written if its visible version committed after the
+     * previous snapshot, or as a Delete if it was deleted since. The delta is
+     * chained onto the previous checkpoint in the manifest; the first call,
+     * a different dir or CHECKPOINT_MAX_DELTAS deltas in the chain start over
+     * with a full checkpoint.
+     */
+    public: CheckpointInfo incrementalCheckpoint(const std::string& dir, size_t partitions = CHECKPOINT_PARTITIONS,
+                                                 size_t threads = CHECKPOINT_THREADS)
+    {
+        return writeCheckpoint(dir, partitions, threads, true);
+    }
+
+    private: CheckpointInfo writeCheckpoint(const std::string& dir, size_t partitions, size_t threads, bool incremental)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        Checkpoint::createDirectory(dir);
+        partitions = std::max<size_t>(1, std::min<size_t>(partitions, 256));
+        threads = std::max<size_t>(1, std::min(threads, partitions));
+
+        std::vector<CheckpointInfo> chain;
+        bool hadChain = Checkpoint::readManifest(dir, chain);
+        CheckpointScan scan;
+        scan.delta = incremental && dirtyTracking.load() && hadChain && checkpointDir == dir
+                     && chain.back().ts == checkpointedTs.load() && chain.size() <= CHECKPOINT_MAX_DELTAS;
+        scan.sinceTs = scan.delta ? chain.back().ts : 0;
+        scan.sinceEpoch = checkpointEpoch;
+        if (incremental)
+            dirtyTracking.store(true);
+        ///writes from here on carry the new epoch, the next delta starts there
+        uint32_t nextEpoch = artCheckpointEpoch.fetch_add(1) + 1;
+
+        CheckpointInfo info;
+        ///every record logged before this offset is installed, the snapshot taken next sees it;
+        ///the ones after it are replayed even if the snapshot has them, so commits sealed so far go first
+        if (redoLog != nullptr)
+        {
+            redoLog->flush();
+            info.logOffset = redoLog->writtenBytes();
+        }
+        ///buffered writes are logged after they are buffered: those before the offset reach the tree here
+        flushWriteBuffer();
+        info.delta = scan.delta;
+        ActiveTxnRegistry::Handle slot = activeTxnRegistry.enter(info.ts);
+        scan.ts = info.ts;
+
+        std::vector<std::unique_ptr<CheckpointFile>> files;
+        ///evicted ranges stay evicted, or in memory, until the scan is done
+        TierPin pin(*this);
+        try
+        {
+            for (size_t p = 0; p < partitions; p++)
+            {
+                info.files.push_back(Checkpoint::partitionFile(info.ts, p));
+                files.emplace_back(new CheckpointFile(dir + "/" + info.files.back()));
+            }
+            runOnThreads(threads, [&](size_t first)
+            {
+                for (size_t p = first; p < partitions; p += threads)
+                {
+                    if (p == 0 && t->root && IS_MV_LEAF(t->root))
+                    {
+                        std::string path;
+                        mv_recursive_checkpoint(t->root, scan, *files[p], path);
+                    }
+                    for (size_t b = p; b < 256; b += partitions)
+                    {
+                        checkpointSubtree((unsigned char) b, scan, *files[p]);
+                        ///runs hold no changes since they were written, deltas skip them
+                        if (!scan.delta)
+                            checkpointRun((unsigned char) b, scan, *files[p]);
+                    }
+                    files[p]->close();
+                }
+            });
+        }
+        catch (...)
+        {
+            activeTxnRegistry.leave(slot);
+            throw;
+        }
+        activeTxnRegistry.leave(slot);
+
+        for (auto& file : files)
+        {
+            info.records += file->records();
+            info.bytes += file->bytes();
+        }
+        if (scan.delta)
+        {
+            chain.push_back(info);
+            Checkpoint::writeManifest(dir, chain);
+        }
+        else
+        {
+            Checkpoint::writeManifest(dir, info);
+            for (auto& previous : chain)
+                for (auto& file : previous.files)
+                    if (std::find(info.files.begin(), info.files.end(), file) == info.files.end())
+                        ::unlink((dir + "/" + file).c_str());
+        }
+        checkpointDir = dir;
+        checkpointEpoch = nextEpoch;
+        checkpointedTs.store(info.ts);
+        if (redoLog != nullptr)
+            info.truncatedLogBytes = redoLog->truncate(info.ts, info.logOffset);
+        info.durationUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - start).count();
+        return info;
+    }
+
+    /**
+     * Rebuilds the table after a crash: the newest checkpoint chain in dir,
+     * then the records of the redo log at logPath committed or logged after
+     * it began. Records logged after that may be in the checkpoint already,
+     * applying them again leaves the same value.
+     * Checkpoint files are read by threads in parallel, the full checkpoint
+     * is loaded through bulkLoad(), deltas and log records are applied in
+     * commit timestamp order per thread, so the writes of one key stay
+     * ordered without a global order.
+     * A thread owns the keys whose first byte maps to it: grown nodes are freed
+     * at once, so two threads must not modify the same node. A serial pass
+     * first plants one key per first byte, after that no thread touches the root.
+     * Versions keep their commit timestamps and the clock is moved past the
+     * newest one. Expects an empty table that no transaction is using.
+     */
+    public: RecoveryStats recover(const std::string& dir, const std::string& logPath,
+                                  size_t threads = RECOVERY_THREADS)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        RecoveryStats stats;
+        stats.threads = threads = std::max<size_t>(1, threads);
+        RedoLog* log = redoLog;
+        ///recovered writes are in the files already
+        redoLog = nullptr;
+        ///the partitioned replay relies on every write reaching the tree on its thread
+        bool buffering = bufferWrites.exchange(false);
+        bool planted[256] = {false};
+        auto owner = [threads](const RedoRecord& r) {
+            return firstByte(r) % threads;
+        };
+
+        std::vector<CheckpointInfo> chain;
+        uint64_t newest = 0, logOffset = 0;
+        if (Checkpoint::readManifest(dir, chain))
+        {
+            const CheckpointInfo& info = chain.front();
+            std::vector<std::vector<uint8_t>> files(info.files.size());
+            ///records[reader][owner]
+            std::vector<std::vector<std::vector<RedoRecord>>> records(threads, std::vector<std::vector<RedoRecord>>(threads));
+            runOnThreads(threads, [&](size_t reader)
+            {
+                for (size_t p = reader; p < files.size(); p += threads)
+                {
+                    files[p] = RedoLog::readFile(dir + "/" + info.files[p]);
+                    RedoLog::scan(files[p], [&](const RedoRecord& r) {
+                        records[reader][owner(r)].push_back(r);
+                    });
+                }
+            });
+            const RedoRecord* plantedBy[256] = {nullptr};
+            for (auto& reader : records)
+                for (auto& owned : reader)
+                    for (auto& r : owned)
+                        if (!planted[firstByte(r)])
+                        {
+                            loadRecords(&r, 1, info.ts);
+                            planted[firstByte(r)] = true;
+                            plantedBy[firstByte(r)] = &r;
+                        }
+            runOnThreads(threads, [&](size_t self)
+            {
+                std::vector<RedoRecord> batch;
+                for (auto& reader : records)
+                    for (auto& r : reader[self])
+                    {
+                        if (plantedBy[firstByte(r)] == &r)
+                            continue;
+                        batch.push_back(r);
+                        if (batch.size() == RECOVERY_BATCH_SIZE)
+                        {
+                            loadRecords(batch.data(), batch.size(), info.ts);
+                            batch.clear();
+                        }
+                    }
+                loadRecords(batch.data(), batch.size(), info.ts);
+            });
+            for (auto& reader : records)
+                for (auto& owned : reader)
+                    stats.checkpointRecords += owned.size();
+
+            ///deltas on top, oldest first, each one like a batch of log records at its timestamp
+            for (size_t d = 1; d < chain.size(); d++)
+            {
+                const CheckpointInfo& delta = chain[d];
+                std::vector<std::vector<uint8_t>> deltaFiles(delta.files.size());
+                std::vector<std::vector<std::vector<RedoRecord>>> deltaRecords(threads, std::vector<std::vector<RedoRecord>>(threads));
+                runOnThreads(threads, [&](size_t reader)
+                {
+                    for (size_t p = reader; p < deltaFiles.size(); p += threads)
+                    {
+                        deltaFiles[p] = RedoLog::readFile(dir + "/" + delta.files[p]);
+                        RedoLog::scan(deltaFiles[p], [&](const RedoRecord& r) {
+                            deltaRecords[reader][owner(r)].push_back(r);
+                        });
+                    }
+                });
+                std::vector<std::vector<RedoRecord>> partitions(threads);
+                for (auto& reader : deltaRecords)
+                    for (size_t p = 0; p < threads; p++)
+                        partitions[p].insert(partitions[p].end(), reader[p].begin(), reader[p].end());
+                for (auto& owned : partitions)
+                    stats.checkpointRecords += owned.size();
+                replayPartitions(partitions, planted, threads);
+            }
+            newest = stats.checkpointTs = chain.back().ts;
+            logOffset = chain.back().logOffset;
+            stats.deltas = chain.size() - 1;
+        }
+        auto loadEnd = std::chrono::high_resolution_clock::now();
+
+        std::vector<uint8_t> data = RedoLog::readFile(logPath);
+        std::vector<std::vector<RedoRecord>> partitions(threads);
+        ///an autocommit timestamp is published before its write is installed, the snapshot may miss it
+        RedoLog::scanSince(data, stats.checkpointTs, logOffset, [&](const RedoRecord& r, bool sinceCheckpoint)
+        {
+            if (r.commitTs <= stats.checkpointTs && !sinceCheckpoint)
+            {
+                stats.skippedRecords++;
+                return;
+            }
+            newest = std::max(newest, r.commitTs);
+            partitions[owner(r)].push_back(r);
+        });
+        replayPartitions(partitions, planted, threads);
+        for (auto& records : partitions)
+            stats.replayedRecords += records.size();
+        txnClock.advanceTo(newest);
+        redoLog = log;
+        bufferWrites.store(buffering);
+
+        auto end = std::chrono::high_resolution_clock::now();
+        stats.loadUs = std::chrono::duration_cast<std::chrono::microseconds>(loadEnd - start).count();
+        stats.replayUs = std::chrono::duration_cast<std::chrono::microseconds>(end - loadEnd).count();
+        stats.totalUs = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        return stats;
+    }
+
+    /**
+     * Loads records committed at ts, in key order so consecutive inserts
+     * share their path down the tree. Threads may load batches concurrently
+     * as long as no two of them insert below the same node.
+     * @arg keys NUL-terminated keys
+     * @return number of records loaded
+     */
+    public: size_t bulkLoad(char** keys, RecordType* records, size_t count, size_t ts)
+    {
+        std::vector<size_t> order(count);
+        for (size_t i = 0; i < count; i++)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), [keys](size_t a, size_t b) {
+            return std::strcmp(keys[a], keys[b]) < 0;
+        });
+        for (size_t i : order)
+            insertOrUpdateByKey(keys[i], records[i], ts);
+        return count;
+    }
+
+    /// Decodes checkpoint records and hands them to bulkLoad()
+    private: void loadRecords(const RedoRecord* records, size_t count, uint64_t ts)
+    {
+        std::vector<char> keyBytes;
+        std::vector<size_t> keyOffsets;
+        std::vector<RecordType> values;
+        values.reserve(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            const RedoRecord& r = records[i];
+            keyOffsets.push_back(keyBytes.size());
+            keyBytes.insert(keyBytes.end(), r.key, r.key + r.keyLen);
+            keyBytes.push_back('\0');
+            values.push_back(RedoCodec<RecordType>::decode(r.payload, r.payloadLen));
+        }
+        std::vector<char*> keys;
+        for (size_t offset : keyOffsets)
+            keys.push_back(&keyBytes[offset]);
+        bulkLoad(keys.data(), values.data(), count, ts);
+    }
+
+    /**
+     * Applies records partitioned by owning thread in commit timestamp order.
+     * For a first byte new to the tree the records up to its first insert
+     * are applied serially, so the threads never add a child to the root.
+     */
+    private: void replayPartitions(std::vector<std::vector<RedoRecord>>& partitions, bool* planted, size_t threads)
+    {
+        ///stable: the writes of one commit keep their log order
+        runOnThreads(threads, [&](size_t self)
+        {
+            std::stable_sort(partitions[self].begin(), partitions[self].end(), [](const RedoRecord& a, const RedoRecord& b) {
+                return a.commitTs < b.commitTs;
+            });
+        });
+        std::vector<std::vector<bool>> applied(threads);
+        for (size_t p = 0; p < threads; p++)
+        {
+            applied[p].resize(partitions[p].size());
+            for (size_t i = 0; i < partitions[p].size(); i++)
+            {
+                const RedoRecord& r = partitions[p][i];
+                if (planted[firstByte(r)])
+                    continue;
+                replayRecord(r);
+                applied[p][i] = true;
+                planted[firstByte(r)] = r.op == RedoOp::Put;
+            }
+        }
+        runOnThreads(threads, [&](size_t self)
+        {
+            for (size_t i = 0; i < partitions[self].size(); i++)
+                if (!applied[self][i])
+                    replayRecord(partitions[self][i]);
+        });
+    }
+
+    private: static unsigned char firstByte(const RedoRecord& r)
+    {
+        return r.keyLen == 0 ? 0 : (unsigned char) r.key[0];
+    }
+
+    private: void replayRecord(const RedoRecord& r)
+    {
+        std::string key(r.key, r.keyLen);
+        if (r.op == RedoOp::Delete)
+            deleteByKey(&key[0], r.commitTs);
+        else
+        {
+            RecordType record = RedoCodec<RecordType>::decode(r.payload, r.payloadLen);
+            insertOrUpdateByKey(&key[0], record, r.commitTs);
+        }
+    }
+
+    /// Runs fn(0..threads-1), fn(0) on the caller, and rethrows the first failure
+    private: template <typename Fn>
+    void runOnThreads(size_t threads, Fn fn)
+    {
+        std::vector<std::exception_ptr> errors(threads);
+        auto guarded = [&](size_t i)
+        {
+            try
+            {
+                fn(i);
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        };
+        std::vector<std::unique_ptr<boost::thread>> workers;
+        for (size_t i = 1; i < threads; i++)
+            workers.emplace_back(new boost::thread(guarded, i));
+        guarded(0);
+        for (auto& worker : workers)
+            worker->join();
+        for (auto& error : errors)
+            if (error)
+                std::rethrow_exception(error);
+    }
+
+    /// Snapshot a checkpoint scans and, for a delta, the checkpoint it continues
+    private: struct CheckpointScan
+    {
+        uint64_t ts = 0;
+        bool delta = false;
+        uint64_t sinceTs = 0;
+        ///nodes with an older dirty epoch were not written since the previous checkpoint began
+        uint32_t sinceEpoch = 0;
+    };
+
+    private: void checkpointSubtree(unsigned char subtree, const CheckpointScan& scan, CheckpointFile& out)
+    {
+        art_node* root = t->root;
+        if (!root || IS_MV_LEAF(root))
+            return;
+        if (scan.delta && root->dirtyEpoch.load() < scan.sinceEpoch)
+            return;
+        art_node** child = find_child(root, subtree);
+        std::string path;
+        mv_path_child(path, mv_path_enter(path, root), subtree);
+        if (child && *child)
+            mv_recursive_checkpoint(*child, scan, out, path);
+    }
+
+    /// Records of an evicted range not shadowed by a leaf written while the range was pinned
+    private: void checkpointRun(unsigned char range, const CheckpointScan& scan, CheckpointFile& out)
+    {
+        TierRun* run = pinnedRun(range);
+        if (run == nullptr)
+            return;
+        run->forEach([&](const RedoRecord& r) {
+            if (art_search_leaf_OCC((const unsigned char*) r.key, r.keyLen) == nullptr)
+                out.add(r.key, r.keyLen, RedoCodec<RecordType>::decode(r.payload, r.payloadLen), scan.ts);
+        });
+    }
+
+    /// path holds the key bytes down to n, leaves keeping a suffix get their keys from it
+    private: void mv_recursive_checkpoint(art_node *n, const CheckpointScan& scan, CheckpointFile& out, std::string& path)
+    {
+        if (!n) return;
+        if (IS_MV_LEAF(n))
+        {
+            mv_art_leaf* l = MV_LEAF_RAW(n);
+            std::string keyBytes;
+            const char* key = (const char*) mv_leaf_key(l, path, keyBytes);
+            auto head = l->_mvcc->current();
+            size_t end = head->end_version;
+            ///a write the snapshot does not see yet: its path has to be dirty for the next delta
+            if (dirtyTracking.load() && (mvcc11::is_txn_id(head->version) || head->version > scan.ts ||
+                                         mvcc11::is_txn_id(end) || (end != INF && end > scan.ts)))
+                markDirty((const unsigned char*) key, l->key_len);
+            auto visible = l->_mvcc->visible(scan.ts, MVCC11_READ_ONLY_TXN_ID);
+            if (visible != nullptr)
+            {
+                if (!scan.delta || visible->version > scan.sinceTs)
+                    out.add(key, l->key_len, visible->value, scan.ts);
+            }
+            else if (scan.delta && end != INF && !mvcc11::is_txn_id(end) && end > scan.sinceTs)
+                out.remove(key, l->key_len, scan.ts);
+            return;
+        }
+        if (scan.delta && n->dirtyEpoch.load() < scan.sinceEpoch)
+            return;
+
+        size_t below = mv_path_enter(path, n);
+        switch (n->type)
+        {
+            case NODE4:
+                for (int i=0; i < n->num_children; i++)
+                {
+                    mv_path_child(path, below, ((art_node4*)n)->keys[i]);
+                    mv_recursive_checkpoint(((art_node4*)n)->children[i], scan, out, path);
+                }
+                break;
+            case NODE16:
+                for (int i=0; i < n->num_children; i++)
+                {
+                    mv_path_child(path, below, ((art_node16*)n)->keys[i]);
+                    mv_recursive_checkpoint(((art_node16*)n)->children[i], scan, out, path);
+                }
+                break;
+            case NODE48:
+                for (int i=0; i < 256; i++)
+                {
+                    int idx = ((art_node48*)n)->keys[i];
+                    if (!idx)
+                        continue;
+                    mv_path_child(path, below, i);
+                    mv_recursive_checkpoint(((art_node48*)n)->children[idx-1], scan, out, path);
+                }
+                break;
+            case NODE256:
+                for (int i=0; i < 256; i++)
+                {
+                    if (!((art_node256*)n)->children[i])
+                        continue;
+                    mv_path_child(path, below, i);
+                    mv_recursive_checkpoint(((art_node256*)n)->children[i], scan, out, path);
+                }
+                break;
+            default:
+                abort();
+        }
+    }
+
+    /// Deleted keys waiting for a GC() cycle
+    public: size_t backlog()
+    {
+        size_t queued = 0;
+        for (auto& queue : deletionQueues)
+        {
+            boost::mutex::scoped_lock guard(queue.lock);
+            queued += queue.keys.size();
+        }
+        return queued;
+    }
+
+    /// Root child byte of the subtree holding key, 256 if its leaf hangs off the root
+    private: size_t subtreeOf(const char* key)
+    {
+        art_node* root = t->root;
+        int key_len = std::strlen(key);
+        if (!root || IS_MV_LEAF(root) || (int)root->partial_len >= key_len)
+            return 256;
+        unsigned char c = key[root->partial_len];
+        art_node** child = find_child(root, c);
+        if (!child || !*child || IS_MV_LEAF(*child))
+            return 256;
+        return c;
+    }
+
+    /**
+     * Removes a sorted batch of garbage keys, consecutive keys share most of their path.
+     * Keys left once the budget is spent are queued again; once the subtree
+     * collapsed into a leaf of the root its keys move to the serial root batch.
+     * @return number of leaves removed
+     */
+    private: uint64_t reclaimBatch(std::vector<keyStruct>& keys, unsigned char subtree, uint64_t watermark,
+                                   std::vector<keyStruct>& collapsed, boost::mutex& collapsedLock)
+    {
+        bool serial = &keys == &collapsed;
+        std::sort(keys.begin(), keys.end(), [](const keyStruct& a, const keyStruct& b) {
+            return a.k < b.k;
+        });
+        uint64_t removed = 0;
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            if (gc.expired())
+            {
+                requeueDeletions(keys, i);
+                break;
+            }
+            if (!serial && subtreeOf(keys[i].k.c_str()) != subtree)
+            {
+                boost::mutex::scoped_lock guard(collapsedLock);
+                collapsed.push_back(keys[i]);
+                continue;
+            }
+            removed += reclaimLeaf(keys[i].k, watermark);
+        }
+        return removed;
+    }
+
+    /// Unlinks and frees the leaf of key if its delete is still below the watermark
+    private: bool reclaimLeaf(const std::string& key, uint64_t watermark)
+    {
+        int key_len = key.size();
+        mv_art_leaf* leaf = art_search_leaf_OCC((const unsigned char*)key.data(), key_len);
+        if (leaf == nullptr)
+            return false;
+        ///re-inserted since the candidate was checked
+        auto endVersion = leaf->_mvcc->current()->end_version;
+        if (endVersion == INF || mvcc11::is_txn_id(endVersion) || endVersion > watermark)
+            return false;
+        mv_art_leaf* l = mv_deleteGC((const unsigned char*)key.data(), key_len);
+        if (l == nullptr)
+            return false;
+        size_t kept = 0;
+        size_t pruned = l->_mvcc->prune(watermark, &kept);
+        gc.addReclaimed(mv_leaf_size(l) + sizeof(mvcc_type) + (kept + pruned) * sizeof(snapshot_type),
+                        1, pruned);
+        retireLeaf(l);
+        return true;
+    }
+
+    private: void pruneSubtree(unsigned char subtree, uint64_t watermark)
+    {
+        art_node* root = t->root;
+        if (!root || IS_MV_LEAF(root))
+            return;
+        art_node** child = find_child(root, subtree);
+        if (child && *child)
+            countPruned(mv_recursive_prune(*child, watermark));
+    }
+
+    private: void countPruned(size_t versions)
+    {
+        if (versions > 0)
+            gc.addReclaimed(versions * sizeof(snapshot_type), 0, versions);
+    }
+
+    /**
+     * Background half of version pruning: writers and readers prune the chains
+     * they touch, this pass covers keys nobody touches any more.
+     * @return number of versions unlinked
+     */
+    public: size_t pruneVersions()
+    {
+        TierPin pin(*this);
+        size_t pruned = mv_recursive_prune(t->root, activeTxnRegistry.refreshLowWatermark());
+        countPruned(pruned);
+        return pruned;
+    }
+    private: size_t mv_recursive_prune(art_node *n, size_t watermark)
+    {
+        if (!n) return 0;
+        if (IS_MV_LEAF(n))
+            return MV_LEAF_RAW(n)->_mvcc->prune(watermark);
+
+        size_t pruned = 0;
+        switch (n->type)
+        {
+            case NODE4:
+                for (int i=0; i < n->num_children; i++)
+                    pruned += mv_recursive_prune(((art_node4*)n)->children[i], watermark);
+                break;
+            case NODE16:
+                for (int i=0; i < n->num_children; i++)
+                    pruned += mv_recursive_prune(((art_node16*)n)->children[i], watermark);
+                break;
+            case NODE48:
+                for (int i=0; i < 256; i++)
+                {
+                    int idx = ((art_node48*)n)->keys[i];
+                    if (idx)
+                        pruned += mv_recursive_prune(((art_node48*)n)->children[idx-1], watermark);
+                }
+                break;
+            case NODE256:
+                for (int i=0; i < 256; i++)
+                    pruned += mv_recursive_prune(((art_node256*)n)->children[i], watermark);
+                break;
+            default:
+                abort();
+        }
+        return pruned;
+    }
+
+    /**
+     * Calls fn(snapshot_type&) on every version linked into a chain, for
+     * owners of state the versions point to (value segments). A version
+     * unlinked by a concurrent pruner may be visited or not.
+     */
+    public: template <typename Fn>
+    void forEachVersion(Fn fn)
+    {
+        TierPin pin(*this);
+        mv_recursive_versions(t->root, fn);
+    }
+
+    private: template <typename Fn>
+    void mv_recursive_versions(art_node *n, Fn& fn)
+    {
+        if (!n) return;
+        if (IS_MV_LEAF(n))
+        {
+            MV_LEAF_RAW(n)->_mvcc->for_each_version(fn);
+            return;
+        }
+
+        switch (n->type)
+        {
+            case NODE4:
+                for (int i=0; i < n->num_children; i++)
+                    mv_recursive_versions(((art_node4*)n)->children[i], fn);
+                break;
+            case NODE16:
+                for (int i=0; i < n->num_children; i++)
+                    mv_recursive_versions(((art_node16*)n)->children[i], fn);
+                break;
+            case NODE48:
+                for (int i=0; i < 256; i++)
+                {
+                    int idx = ((art_node48*)n)->keys[i];
+                    if (idx)
+                        mv_recursive_versions(((art_node48*)n)->children[idx-1], fn);
+                }
+                break;
+            case NODE256:
+                for (int i=0; i < 256; i++)
+                    mv_recursive_versions(((art_node256*)n)->children[i], fn);
+                break;
+            default:
+                abort();
+        }
+    }
+
+    public: auto art_deleteGC(char *key) {
+        int key_len = std::strlen(key);
+        mv_art_leaf *l = mv_deleteGC((const unsigned char *)key, key_len);
+        if (l) {
+            t->size--;
+            retireLeaf(l);
+            return l;
+        }
+
+        return l;
+    }
+    /**
+     * Unlinks the leaf of key from the tree while foreground threads run.
+     * The node a leaf is removed from and its parent are write locked like an
+     * insert locks them, so optimistic readers and writers that saw them
+     * before restart; a node freed on the way stays locked. GC gives up on a
+     * node another writer holds and starts over from the root.
+     * @return the unlinked leaf, freeing it is up to the caller
+     */
+    private: mv_art_leaf* mv_deleteGC(const unsigned char *key, int key_len)
+    {
+        while (true)
+        {
+            bool restart = false;
+            mv_art_leaf *l = recursive_deleteGC(t->root, &t->root, key, key_len, 0, nullptr, restart);
+            if (!restart)
+                return l;
+            boost::this_thread::yield();
+        }
+    }
+
+    /// Write lock for GC, false if another writer holds n or n was retired
+    private: static bool gcTryLock(art_node *n)
+    {
+        uint64_t v = n->version.load();
+        return (v & 0b11) == 0 && n->version.compare_exchange_strong(v, v + 0b10);
+    }
+
+    /// Unlocks what gcTryLock() took on n and its parent, unless n was freed
+    private: static void gcUnlock(art_node *n, art_node **ref, bool lockNode, art_node *parent, bool lockParent)
+    {
+        if (lockNode && *ref == n)
+            n->writeUnlock();
+        if (lockParent)
+            parent->writeUnlock();
+    }
+
+    private: mv_art_leaf* recursive_deleteGC(art_node *n, art_node **ref, const unsigned char *key, int key_len,
+                                             int depth, art_node *parent, bool &restart) {
+        // Search terminated
+        if (!n) return NULL;
+
+        // Handle hitting a leaf node
+        if (IS_MV_LEAF(n)) {
+            mv_art_leaf *l = MV_LEAF_RAW(n);
+            if (!mv_leaf_matches(l, key, key_len, depth)) {
+                ///only the root is a lone leaf, an insert splitting it swaps it out
+                if (!casChild(ref, n, nullptr)) {
+                    restart = true;
+                    return NULL;
+                }
+                readCacheInvalidate(key, key_len);
+                if (hashIndex != nullptr)
+                    hashIndex->erase(l);
                 return l;
             }
             return NULL;
+        }
+
+        // Bail if the prefix does not match
+        if (n->partial_len) {
+            int prefix_len = check_prefix(n, key, key_len, depth);
+            if (prefix_len != min(MAX_PREFIX_LEN, n->partial_len)) {
+                return NULL;
+            }
+            depth = depth + n->partial_len;
+        }
+
+        // Find child node
+        art_node **child = find_child(n, key[depth]);
+        if (!child) return NULL;
+
+        // If the child is leaf, delete from this node
+        art_node *seen = *child;
+        if (IS_MV_LEAF(seen)) {
+            mv_art_leaf *l = MV_LEAF_RAW(seen);
+            if (mv_leaf_matches(l, key, key_len, depth))
+                return NULL;
+            ///a slot of a pinned node is taken and cleared by CAS, it is never resized
+            bool lockParent = parent != nullptr && !parent->pinned;
+            bool lockNode = !n->pinned;
+            if (lockParent && !gcTryLock(parent)) {
+                restart = true;
+                return NULL;
+            }
+            if (lockNode && !gcTryLock(n)) {
+                gcUnlock(n, ref, false, parent, lockParent);
+                restart = true;
+                return NULL;
+            }
+            ///n or its slots may have moved between the reads above and the locks
+            child = *ref == n ? find_child(n, key[depth]) : nullptr;
+            if (child == nullptr || *child != seen || (!lockNode && !casChild(child, seen, nullptr))) {
+                gcUnlock(n, ref, lockNode, parent, lockParent);
+                restart = true;
+                return NULL;
+            }
+            readCacheInvalidate(key, key_len);
+            if (hashIndex != nullptr)
+                hashIndex->erase(l);
+            if (lockNode) {
+                remove_child(n, ref, key[depth], child, leafSuffixes);
+                mv_drop_empty_root(ref);
+            }
+            gcUnlock(n, ref, lockNode, parent, lockParent);
+            return l;
 
             // Recurse
         } else {
-            return recursive_deleteGC(*child, child, key, key_len, depth+1);
+            mv_art_leaf *l = recursive_deleteGC(seen, child, key, key_len, depth+1, n, restart);
+            if (l != nullptr && leafSuffixes)
+                mv_drop_empty_child(n, ref, parent, key[depth]);
+            return l;
+        }
+    }
+
+    /**
+     * Unlinks the node4 below n at byte c once it kept the path of its last
+     * leaf. If a writer holds one of the nodes the empty node4 stays, that
+     * writer may be filling it.
+     */
+    private: void mv_drop_empty_child(art_node *n, art_node **ref, art_node *parent, unsigned char c)
+    {
+        bool lockParent = parent != nullptr && !parent->pinned;
+        bool lockNode = !n->pinned;
+        if (lockParent && !gcTryLock(parent))
+            return;
+        if (lockNode && !gcTryLock(n))
+        {
+            gcUnlock(n, ref, false, parent, lockParent);
+            return;
+        }
+        art_node **child = *ref == n ? find_child(n, c) : nullptr;
+        art_node *empty = child != nullptr ? *child : nullptr;
+        if (empty != nullptr && !IS_MV_LEAF(empty) && empty->type == NODE4 && empty->num_children == 0 &&
+            gcTryLock(empty))
+        {
+            remove_child(n, ref, c, child, true);
+            artNodeFrees.fetch_add(1);
+            free(empty);
+            mv_drop_empty_root(ref);
         }
+        gcUnlock(n, ref, lockNode, parent, lockParent);
+    }
+
+    /// Unlinks a root node4 that lost its last child, setLeafSuffixes() keeps such nodes until their parent drops them
+    private: void mv_drop_empty_root(art_node **ref)
+    {
+        art_node *n = *ref;
+        if (ref != &t->root || n == nullptr || IS_MV_LEAF(n) || n->type != NODE4 || n->num_children != 0)
+            return;
+        *ref = nullptr;
+        artNodeFrees.fetch_add(1);
+        free(n);
     }
 
     /**
@@ -1972,6 +5636,8 @@ class ArtCPP : public pfabric::BaseTable
      */
     public: int mv_art_iterByPredicate(std::shared_ptr<art_tree> t,art_callback cb, void *data, Pred filter, size_t txn_id)
     {
+        flushWriteBuffer();
+        TierPin pin(*this);
 
         return recursive_iterByPredicate(t->root, cb, data,filter, txn_id);
     }
@@ -2046,11 +5712,15 @@ class ArtCPP : public pfabric::BaseTable
      */
     public: int updateAllByPredicate(Updater updater,size_t txn_id,Predicate filter)
     {
+        flushWriteBuffer();
+        TierPin pin(*this);
         uint64_t out[] = {0, 0};
-        return recursive_UpdateByPredicate(t->root,updater,txn_id, out,filter);
+        std::string path;
+        return recursive_UpdateByPredicate(t->root,updater,txn_id, out,filter, path);
     }
 
-    private: int recursive_UpdateByPredicate(art_node *n, Updater updater,  size_t txn_id,void *data, Predicate filter)
+    private: int recursive_UpdateByPredicate(art_node *n, Updater updater,  size_t txn_id,void *data, Predicate filter,
+                                             std::string& path)
     {
         if (!n) return 0;
         if (IS_MV_LEAF(n))
@@ -2065,7 +5735,8 @@ class ArtCPP : public pfabric::BaseTable
                 {
                     std::cout<<snapshot->_mvcc->current()->value;
                     auto updated = snapshot->_mvcc->update(txn_id, updater);
-                    ActiveTxnWriteSet[txn_id].push_back(*snapshot);
+                    std::string key;
+                    trackWrite(snapshot, mv_leaf_key(snapshot, path, key), snapshot->key_len, updated, txn_id);
                     notifyObservers(updated, pfabric::TableParams::Update, pfabric::TableParams::Immediate);
                 }
                 return 0;
@@ -2073,13 +5744,15 @@ class ArtCPP : public pfabric::BaseTable
         }
 
         int idx, res;
+        size_t below = mv_path_enter(path, n);
         switch (n->type)
         {
             case NODE4:
                 for (int i=0; i < n->num_children; i++)
                 {
                     //_sharedLock.unlock();
-                    res = recursive_UpdateByPredicate(((art_node4*)n)->children[i],updater,txn_id,data,filter);
+                    mv_path_child(path, below, ((art_node4*)n)->keys[i]);
+                    res = recursive_UpdateByPredicate(((art_node4*)n)->children[i],updater,txn_id,data,filter, path);
                     if (res) return res;
                 }
                 break;
@@ -2088,7 +5761,8 @@ class ArtCPP : public pfabric::BaseTable
                 for (int i=0; i < n->num_children; i++)
                 {
                     //_sharedLock.unlock();
-                    res = recursive_UpdateByPredicate(((art_node16*)n)->children[i],updater,txn_id,data,filter);
+                    mv_path_child(path, below, ((art_node16*)n)->keys[i]);
+                    res = recursive_UpdateByPredicate(((art_node16*)n)->children[i],updater,txn_id,data,filter, path);
                     if (res) return res;
                 }
                 break;
@@ -2098,7 +5772,8 @@ class ArtCPP : public pfabric::BaseTable
                     idx = ((art_node48*)n)->keys[i];
                     if (!idx) continue;
                     //_sharedLock.unlock();
-                    res = recursive_UpdateByPredicate(((art_node48*)n)->children[idx-1],updater,txn_id,data,filter);
+                    mv_path_child(path, below, i);
+                    res = recursive_UpdateByPredicate(((art_node48*)n)->children[idx-1],updater,txn_id,data,filter, path);
                     if (res) return res;
                 }
                 break;
@@ -2108,7 +5783,8 @@ class ArtCPP : public pfabric::BaseTable
                 {
                     if (!((art_node256*)n)->children[i]) continue;
                     //_sharedLock.unlock();
-                    res = recursive_UpdateByPredicate(((art_node256*)n)->children[i],updater,txn_id,data,filter);
+                    mv_path_child(path, below, i);
+                    res = recursive_UpdateByPredicate(((art_node256*)n)->children[i],updater,txn_id,data,filter, path);
                     if (res) return res;
                 }
                 break;
@@ -2130,6 +5806,8 @@ class ArtCPP : public pfabric::BaseTable
      */
     public: int mv_art_delete_by_predicate(std::shared_ptr<art_tree> t,art_callback cb,RecordType& value,size_t txn_id,void *data, Pred filter)
     {
+        flushWriteBuffer();
+        TierPin pin(*this);
         return recursive_delete_by_predicate(t->root,cb,value,txn_id, data,filter);
     }
     private: int recursive_delete_by_predicate(art_node *n,art_callback cb,RecordType& value,size_t txn_id,void *data,Pred predicate)
@@ -2200,6 +5878,10 @@ class ArtCPP : public pfabric::BaseTable
     {
         t = std::make_shared<art_tree>();
         art_tree_init(t);
+        if (ART_ROOT_PARTITION_BYTES > 0)
+            partitionRoot(ART_ROOT_PARTITION_BYTES);
+        if (ART_LEAF_SUFFIXES)
+            setLeafSuffixes(true);
     }
 };
 
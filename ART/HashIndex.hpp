@@ -0,0 +1,328 @@
+//
+// Created by Players Inc on 19/10/2026.
+//
+
+#ifndef MVCCART_HASHINDEX_HPP
+#define MVCCART_HASHINDEX_HPP
+
+#include <boost/thread.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+/// Slots of a new hash index, a power of two; the index grows as keys arrive
+#ifndef ART_HASH_INDEX_CAPACITY
+#define ART_HASH_INDEX_CAPACITY 1024
+#endif
+
+/// Percent of its slots a table of the hash index fills, live or removed, before it moves to a new one
+#ifndef ART_HASH_INDEX_LOAD_PERCENT
+#define ART_HASH_INDEX_LOAD_PERCENT 50
+#endif
+
+/// Slots of a replaced table each insert moves to the new one while a move is under way
+#ifndef ART_HASH_INDEX_MOVE_SLOTS
+#define ART_HASH_INDEX_MOVE_SLOTS 64
+#endif
+
+
+struct HashIndexStats
+{
+    uint64_t entries = 0;
+    ///slots of the newest table, the one a move under way fills
+    uint64_t capacity = 0;
+    ///bytes of the current table and of the tables it replaced, those are kept until the index goes
+    uint64_t bytes = 0;
+    uint64_t resizes = 0;
+};
+
+
+/**
+ * Lock-free hash index from keys to the leaves holding them: linear probing
+ * over 16-byte slots of (hash, leaf). Keys are compared in the leaf, a
+ * slot does not copy them. The hash of a slot is set once; removing a leaf
+ * leaves a tombstone that a later insert with the same hash reuses.
+ * A table past ART_HASH_INDEX_LOAD_PERCENT moves to one sized for twice
+ * its live entries. The move is spread over the inserts that follow, each
+ * takes the next ART_HASH_INDEX_MOVE_SLOTS slots, copies them to the new
+ * table and freezes them, so no insert pays for the whole table while the
+ * tree may hold a node lock. Writers that meet a frozen slot go on in the
+ * new table, and lookups check the new table after the old one until the
+ * last slot is moved.
+ * Replaced tables are freed with the index, a lookup may still probe one.
+ * Leaf needs key and key_len members. Holds one entry per leaf, the caller
+ * keeps at most one leaf per key.
+ */
+template <typename Leaf>
+class HashIndex
+{
+public:
+
+    explicit HashIndex(size_t capacity = ART_HASH_INDEX_CAPACITY)
+            : mCurrent(new Table(roundUp(capacity))), mEntries(0), mResizes(0)
+    {
+        mTables.emplace_back(mCurrent.load());
+    }
+
+    HashIndex(const HashIndex&) = delete;
+    HashIndex& operator=(const HashIndex&) = delete;
+
+    /// Leaf holding key, nullptr if there is none
+    Leaf* find(const unsigned char* key, int keyLen) const
+    {
+        uint64_t h = hash(key, keyLen);
+        for (Table* t = mCurrent.load(); t != nullptr; t = t->next.load())
+        {
+            for (size_t i = h & t->mask, probes = 0; probes <= t->mask; i = (i + 1) & t->mask, probes++)
+            {
+                Slot& s = t->slots[i];
+                uint64_t slotHash = s.hash.load();
+                Leaf* l = s.leaf.load();
+                if (slotHash == 0 && l != moved())
+                    break;
+                if (slotHash == h && l != nullptr && l != moved() && matches(l, key, keyLen))
+                    return l;
+            }
+        }
+        return nullptr;
+    }
+
+    /// Adds a leaf that was just linked into the tree, a leaf already held is left alone
+    void insert(Leaf* leaf)
+    {
+        uint64_t h = hash((const unsigned char*) leaf->key, leaf->key_len);
+        Table* t = mCurrent.load();
+        while (!place(t, h, leaf))
+        {
+            ///a frozen slot or a full table: the rest of the index is in the next one
+            Table* next = t->next.load();
+            if (next == nullptr)
+            {
+                grow(t);
+                boost::this_thread::yield();
+                continue;
+            }
+            t = next;
+        }
+        mEntries.fetch_add(1);
+        Table* current = mCurrent.load();
+        if (current->next.load() != nullptr)
+            moveSlots(current);
+        else if (t == current && t->taken.load() * 100 > (t->mask + 1) * ART_HASH_INDEX_LOAD_PERCENT)
+            grow(t);
+    }
+
+    /**
+     * Removes leaf before it is unlinked from the tree and freed.
+     * @return false if the index does not hold it
+     */
+    bool erase(const Leaf* leaf)
+    {
+        uint64_t h = hash((const unsigned char*) leaf->key, leaf->key_len);
+        for (Table* t = mCurrent.load(); t != nullptr; t = t->next.load())
+            if (remove(t, h, leaf))
+            {
+                mEntries.fetch_sub(1);
+                return true;
+            }
+        return false;
+    }
+
+    /// Drops every entry, while no other thread uses the index
+    void clear()
+    {
+        boost::mutex::scoped_lock guard(mGrowLock);
+        Table* t = new Table(roundUp(ART_HASH_INDEX_CAPACITY));
+        mTables.clear();
+        mTables.emplace_back(t);
+        mCurrent.store(t);
+        mEntries.store(0);
+    }
+
+    HashIndexStats stats()
+    {
+        boost::mutex::scoped_lock guard(mGrowLock);
+        HashIndexStats stats;
+        stats.entries = mEntries.load();
+        stats.capacity = mTables.back()->mask + 1;
+        for (const std::unique_ptr<Table>& t : mTables)
+            stats.bytes += sizeof(Table) + (t->mask + 1) * sizeof(Slot);
+        stats.resizes = mResizes.load();
+        return stats;
+    }
+
+    /// FNV-1a of key with a final mix for the low bits probing starts from; never 0, that marks a free slot
+    static uint64_t hash(const unsigned char* key, int keyLen)
+    {
+        uint64_t h = 14695981039346656037ull;
+        for (int i = 0; i < keyLen; i++)
+            h = (h ^ key[i]) * 1099511628211ull;
+        h ^= h >> 29;
+        h *= 0xbf58476d1ce4e5b9ull;
+        h ^= h >> 32;
+        return h == 0 ? 1 : h;
+    }
+
+private:
+
+    struct Slot
+    {
+        std::atomic<uint64_t> hash{0};
+        ///nullptr while free or removed, moved() once the slot was copied to the next table
+        std::atomic<Leaf*> leaf{nullptr};
+    };
+
+    struct Table
+    {
+        explicit Table(size_t capacity) : mask(capacity - 1), slots(new Slot[capacity]) {}
+        const size_t mask;
+        std::unique_ptr<Slot[]> slots;
+        ///slots with a hash, live or removed
+        std::atomic<size_t> taken{0};
+        ///set when the move to a larger table begins
+        std::atomic<Table*> next{nullptr};
+        ///slots handed to movers, and slots moved and frozen
+        std::atomic<size_t> claimed{0};
+        std::atomic<size_t> moved{0};
+    };
+
+    static Leaf* moved()
+    {
+        return reinterpret_cast<Leaf*>(uintptr_t(1));
+    }
+
+    static size_t roundUp(size_t capacity)
+    {
+        size_t c = 16;
+        while (c < capacity)
+            c <<= 1;
+        return c;
+    }
+
+    static bool matches(const Leaf* l, const unsigned char* key, int keyLen)
+    {
+        return l->key_len == (uint32_t) keyLen && std::memcmp(l->key, key, keyLen) == 0;
+    }
+
+    /**
+     * Puts leaf in the first free or removed slot of hash h in t.
+     * @return false if t is frozen on the way or full, leaf goes to the next table
+     */
+    static bool place(Table* t, uint64_t h, Leaf* leaf)
+    {
+        for (size_t i = h & t->mask, probes = 0; probes <= t->mask; i = (i + 1) & t->mask, probes++)
+        {
+            Slot& s = t->slots[i];
+            uint64_t slotHash = s.hash.load();
+            if (slotHash == 0)
+            {
+                if (s.hash.compare_exchange_strong(slotHash, h))
+                {
+                    t->taken.fetch_add(1);
+                    slotHash = h;
+                }
+            }
+            Leaf* l = s.leaf.load();
+            if (l == moved())
+                return false;
+            if (slotHash != h)
+                continue;
+            if (l == leaf)
+                return true;
+            if (l == nullptr && s.leaf.compare_exchange_strong(l, leaf))
+                return true;
+            if (l == moved())
+                return false;
+        }
+        return false;
+    }
+
+    static bool remove(Table* t, uint64_t h, const Leaf* leaf)
+    {
+        for (size_t i = h & t->mask, probes = 0; probes <= t->mask; i = (i + 1) & t->mask, probes++)
+        {
+            Slot& s = t->slots[i];
+            uint64_t slotHash = s.hash.load();
+            Leaf* l = s.leaf.load();
+            if (slotHash == 0 && l != moved())
+                return false;
+            if (slotHash == h && l == leaf && s.leaf.compare_exchange_strong(l, nullptr))
+                return true;
+        }
+        return false;
+    }
+
+    /**
+     * Starts moving t to a new table sized for twice its live entries, unless
+     * t is no longer current or a move is under way; then helps the move of
+     * the current table, see moveSlots().
+     */
+    void grow(Table* t)
+    {
+        {
+            boost::mutex::scoped_try_lock guard(mGrowLock);
+            if (guard.owns_lock() && t == mCurrent.load() && t->next.load() == nullptr)
+            {
+                size_t capacity = t->mask + 1;
+                while (mEntries.load() * 200 > capacity * ART_HASH_INDEX_LOAD_PERCENT)
+                    capacity <<= 1;
+                Table* next = new Table(capacity);
+                mTables.emplace_back(next);
+                t->next.store(next);
+            }
+        }
+        Table* current = mCurrent.load();
+        if (current->next.load() != nullptr)
+            moveSlots(current);
+    }
+
+    /**
+     * Moves the next ART_HASH_INDEX_MOVE_SLOTS slots of t to its new table.
+     * Every slot is copied before it is frozen, a leaf removed in between is
+     * taken out of the new table again. The thread that moves the last slot
+     * makes the new table current. The new table has at least the slots of t
+     * and starts at most a quarter full, the inserts that go to it while t
+     * moves cannot fill it first.
+     */
+    void moveSlots(Table* t)
+    {
+        Table* next = t->next.load();
+        size_t begin = t->claimed.fetch_add(ART_HASH_INDEX_MOVE_SLOTS);
+        if (begin > t->mask)
+            return;
+        size_t end = std::min(begin + ART_HASH_INDEX_MOVE_SLOTS, t->mask + 1);
+        for (size_t i = begin; i < end; i++)
+        {
+            Slot& s = t->slots[i];
+            while (true)
+            {
+                Leaf* l = s.leaf.load();
+                if (l != nullptr)
+                    while (!place(next, s.hash.load(), l))
+                        boost::this_thread::yield();
+                Leaf* copied = l;
+                if (s.leaf.compare_exchange_strong(l, moved()))
+                    break;
+                if (copied != nullptr)
+                    remove(next, s.hash.load(), copied);
+            }
+        }
+        if (t->moved.fetch_add(end - begin) + (end - begin) == t->mask + 1)
+        {
+            mCurrent.store(next);
+            mResizes.fetch_add(1);
+        }
+    }
+
+    std::atomic<Table*> mCurrent;
+    ///every table the index had, the current one last
+    std::vector<std::unique_ptr<Table>> mTables;
+    boost::mutex mGrowLock;
+    std::atomic<size_t> mEntries;
+    std::atomic<uint64_t> mResizes;
+};
+
+#endif //MVCCART_HASHINDEX_HPP
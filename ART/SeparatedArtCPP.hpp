@@ -0,0 +1,172 @@
+//
+// Created by Players Inc on 19/10/2026.
+//
+
+#ifndef MVCCART_SEPARATEDARTCPP_HPP
+#define MVCCART_SEPARATEDARTCPP_HPP
+
+#include <memory>
+#include <vector>
+#include "ART/ArtCPP.hpp"
+#include "Transactions/ValueStore.hpp"
+
+namespace mvcc11 {
+
+    /// Compaction replaces handles in the versions holding them, an undo ring would copy them away
+    template <>
+    struct is_inplace_updatable<ValueHandle>
+    {
+        static constexpr bool value = false;
+    };
+
+} // namespace mvcc11
+
+
+/**
+ * Table with key-value separation: records live in the segments of a
+ * ValueStore, the tree and its version chains hold one ValueHandle per
+ * version. Reads resolve the handle through the hot record cache, a miss
+ * decodes the mapped bytes.
+ * GC() runs the GC of the index, then marks the handles of every version
+ * still linked; live records of sparse segments are copied to the active
+ * segment, their handles replaced in place, and the old segments unmapped
+ * once no reader can hold their handles any more.
+ * Segments are not recovered: the redo log and checkpoints of the index
+ * would hold handles, so a separated table is not durable.
+ */
+template <typename RecordType, typename KeyType = DefaultKeyType>
+class SeparatedArtCPP
+{
+public:
+
+    typedef ArtCPP<ValueHandle, KeyType> Index;
+    typedef std::shared_ptr<const RecordType> RecordPtr;
+
+    explicit SeparatedArtCPP(const std::string& dir, size_t segmentSize = VALUE_STORE_SEGMENT_SIZE,
+                             size_t cacheEntries = VALUE_STORE_CACHE_ENTRIES)
+            : mStore(dir, segmentSize), mCache(cacheEntries) {}
+
+    /// Appends value to the store and inserts or updates key with its handle
+    public: auto insertOrUpdateByKey(char* key, const RecordType& value, size_t txn_id)
+    {
+        ValueStore::Pin pin(mStore);
+        ValueHandle handle = append(value);
+        return mIndex.insertOrUpdateByKey(key, handle, txn_id);
+    }
+
+    public: auto insertOrUpdateByKey(char* key, const RecordType& value, TxnContext& txn)
+    {
+        ValueStore::Pin pin(mStore);
+        ValueHandle handle = append(value);
+        return mIndex.insertOrUpdateByKey(key, handle, txn);
+    }
+
+    public: auto deleteByKey(char* key, size_t txn_id)
+    {
+        return mIndex.deleteByKey(key, txn_id);
+    }
+
+    public: auto deleteByKey(char* key, TxnContext& txn)
+    {
+        return mIndex.deleteByKey(key, txn);
+    }
+
+    /// Record of the newest version of key, like ArtCPP::findValueByKey()
+    public: RecordPtr findValueByKey(char* key, size_t txn_id)
+    {
+        ValueStore::Pin pin(mStore);
+        auto version = mIndex.findValueByKey(key, txn_id);
+        return version == nullptr ? nullptr : resolve(version->value);
+    }
+
+    /// Record visible to txn, nullptr if there is none
+    public: RecordPtr findValueByKey(char* key, TxnContext& txn)
+    {
+        ValueStore::Pin pin(mStore);
+        auto version = mIndex.findValueByKey(key, txn);
+        return version == nullptr ? nullptr : resolve(version->value);
+    }
+
+    /**
+     * Index GC and a full version sweep, then segment compaction driven by
+     * the versions they left:
+     * a sealed segment whose linked versions hold less than
+     * VALUE_STORE_COMPACT_PERCENT of its bytes is emptied and retired.
+     * @return number of segments retired
+     */
+    public: size_t GC()
+    {
+        boost::mutex::scoped_lock guard(mGCLock);
+        mIndex.GC();
+        mIndex.pruneVersions();
+        mStore.beginMark();
+        mIndex.forEachVersion([this](auto& version) {
+            mStore.markLive(version.value.load());
+        });
+        std::vector<uint32_t> victims = mStore.victims();
+        if (victims.empty())
+            return 0;
+
+        ///writers that appended to a victim before it was sealed have linked their versions after this
+        mStore.synchronize();
+        std::vector<bool> victim(1 << 16);
+        for (uint32_t id : victims)
+            victim[id] = true;
+        mIndex.forEachVersion([this, &victim](auto& version) {
+            ValueHandle handle = version.value.load();
+            if (victim[handle.segment()])
+                version.value.store(mStore.relocate(handle));
+        });
+        mStore.retire(victims);
+        return victims.size();
+    }
+
+    public: Index& index()
+    {
+        return mIndex;
+    }
+
+    public: ValueStoreStats storeStats() const
+    {
+        return mStore.stats();
+    }
+
+    public: ValueCache<RecordType>& cache()
+    {
+        return mCache;
+    }
+
+    public: size_t art_size()
+    {
+        return mIndex.art_size();
+    }
+
+    private: ValueHandle append(const RecordType& value)
+    {
+        static thread_local StreamType bytes;
+        bytes.clear();
+        RedoCodec<RecordType>::encode(value, bytes);
+        return mStore.append(bytes.data(), bytes.size());
+    }
+
+    /// Caller holds a Pin
+    private: RecordPtr resolve(const ValueHandle& stored)
+    {
+        ValueHandle handle = stored.load();
+        RecordPtr record = mCache.find(handle);
+        if (record == nullptr)
+        {
+            record = std::make_shared<const RecordType>(
+                    RedoCodec<RecordType>::decode(mStore.data(handle), handle.length()));
+            mCache.insert(handle, record);
+        }
+        return record;
+    }
+
+    private: Index mIndex;
+    private: ValueStore mStore;
+    private: ValueCache<RecordType> mCache;
+    private: boost::mutex mGCLock;
+};
+
+#endif //MVCCART_SEPARATEDARTCPP_HPP
@@ -0,0 +1,269 @@
+//
+// Created by Players Inc on 19/10/2026.
+//
+
+#ifndef MVCCART_WRITEBUFFER_HPP
+#define MVCCART_WRITEBUFFER_HPP
+
+#include <boost/thread.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/// Entries a partition of the write buffer absorbs before its batch is sealed for the merger
+#ifndef ART_WRITE_BUFFER_ENTRIES
+#define ART_WRITE_BUFFER_ENTRIES 1024
+#endif
+
+/// Partitions of the write buffer, a key belongs to one by its first byte
+#ifndef ART_WRITE_BUFFER_PARTITIONS
+#define ART_WRITE_BUFFER_PARTITIONS 16
+#endif
+
+/// Buffered writes reach the tree at most this late, the merger seals idle batches as often
+#ifndef ART_WRITE_BUFFER_FLUSH_US
+#define ART_WRITE_BUFFER_FLUSH_US 1000
+#endif
+
+/// Sealed batches a partition holds before writers merge them instead of waiting for the merger
+#ifndef ART_WRITE_BUFFER_MAX_SEALED
+#define ART_WRITE_BUFFER_MAX_SEALED 4
+#endif
+
+
+struct WriteBufferStats
+{
+    uint64_t buffered = 0;
+    uint64_t absorbed = 0;
+    uint64_t merged = 0;
+    uint64_t batches = 0;
+    ///batches merged on a caller's thread: the merger fell behind, or a flush
+    uint64_t writerBatches = 0;
+};
+
+
+/**
+ * Write buffer in front of a tree: per partition a small sorted batch
+ * absorbs writes; a full batch is sealed and queued, and merged into the
+ * tree oldest first, in key order. A sealed batch stays visible to find()
+ * until it is merged, so a lookup that checks the buffer before the tree
+ * never misses a write.
+ * Holds one VersionPtr per key and batch; a newer write to a buffered key
+ * replaces it in the active batch.
+ */
+template <typename VersionPtr>
+class WriteBuffer
+{
+public:
+
+    struct Entry
+    {
+        std::string key;
+        VersionPtr version;
+    };
+    typedef std::vector<Entry> Batch;
+
+    explicit WriteBuffer(size_t capacity = ART_WRITE_BUFFER_ENTRIES)
+            : mCapacity(std::max<size_t>(1, capacity)), mEntries(0), mAbsorbed(0), mMerged(0), mBatches(0),
+              mWriterBatches(0) {}
+
+    WriteBuffer(const WriteBuffer&) = delete;
+    WriteBuffer& operator=(const WriteBuffer&) = delete;
+
+    static size_t partitionOf(const char* key)
+    {
+        return (unsigned char) key[0] % ART_WRITE_BUFFER_PARTITIONS;
+    }
+
+    void setCapacity(size_t capacity)
+    {
+        mCapacity.store(std::max<size_t>(1, capacity));
+    }
+
+    /**
+     * Adds the write of key, replacing an earlier one in the active batch.
+     * @arg sealed set if the batch is full now and was queued for merging
+     * @return the version it shadows, nullptr if no batch holds key
+     */
+    VersionPtr put(const char* key, size_t keyLen, const VersionPtr& version, bool& sealed)
+    {
+        Partition& p = mPartitions[partitionOf(key)];
+        boost::mutex::scoped_lock guard(p.lock);
+        mAbsorbed.fetch_add(1, std::memory_order_relaxed);
+        auto it = lowerBound(p.active, key, keyLen);
+        VersionPtr replaced;
+        if (it != p.active.end() && equals(*it, key, keyLen))
+        {
+            replaced = it->version;
+            it->version = version;
+        }
+        else
+        {
+            replaced = findSealed(p, key, keyLen);
+            p.active.insert(it, Entry{std::string(key, keyLen), version});
+            mEntries.fetch_add(1);
+        }
+        sealed = p.active.size() >= mCapacity;
+        if (sealed)
+            sealLocked(p);
+        return replaced;
+    }
+
+    /**
+     * Newest buffered version of key that accept(version) takes, searching
+     * the active batch, then the sealed ones newest first.
+     */
+    template <typename Accept>
+    VersionPtr find(const char* key, size_t keyLen, Accept accept)
+    {
+        if (mEntries.load() == 0)
+            return nullptr;
+        Partition& p = mPartitions[partitionOf(key)];
+        boost::mutex::scoped_lock guard(p.lock);
+        auto it = lowerBound(p.active, key, keyLen);
+        if (it != p.active.end() && equals(*it, key, keyLen) && accept(*it->version))
+            return it->version;
+        return findSealed(p, key, keyLen, accept);
+    }
+
+    /// Seals the active batch of partition, if it holds any write
+    void seal(size_t partition)
+    {
+        Partition& p = mPartitions[partition];
+        boost::mutex::scoped_lock guard(p.lock);
+        sealLocked(p);
+    }
+
+    /**
+     * Hands the sealed batches of partition, oldest first, to apply(const Entry&)
+     * and drops each once it is applied. One merge runs at a time over all
+     * partitions, so merged writes reach the tree in the order they were sealed.
+     * @arg writer merged on a caller's thread rather than by the merger
+     * @return number of entries applied
+     */
+    template <typename Apply>
+    size_t merge(size_t partition, Apply apply, bool writer = false)
+    {
+        Partition& p = mPartitions[partition];
+        boost::mutex::scoped_lock merging(mMergeLock);
+        size_t applied = 0;
+        while (true)
+        {
+            std::shared_ptr<const Batch> batch;
+            {
+                boost::mutex::scoped_lock guard(p.lock);
+                if (p.sealed.empty())
+                    break;
+                batch = p.sealed.front();
+            }
+            for (const Entry& entry : *batch)
+                apply(entry);
+            {
+                boost::mutex::scoped_lock guard(p.lock);
+                p.sealed.pop_front();
+            }
+            mEntries.fetch_sub(batch->size());
+            applied += batch->size();
+            mBatches.fetch_add(1, std::memory_order_relaxed);
+            if (writer)
+                mWriterBatches.fetch_add(1, std::memory_order_relaxed);
+        }
+        mMerged.fetch_add(applied, std::memory_order_relaxed);
+        return applied;
+    }
+
+    size_t sealedBatches(size_t partition)
+    {
+        Partition& p = mPartitions[partition];
+        boost::mutex::scoped_lock guard(p.lock);
+        return p.sealed.size();
+    }
+
+    /// Writes buffered in any partition, active or sealed
+    size_t size() const
+    {
+        return mEntries.load();
+    }
+
+    WriteBufferStats stats() const
+    {
+        WriteBufferStats stats;
+        stats.buffered = mEntries.load();
+        stats.absorbed = mAbsorbed.load();
+        stats.merged = mMerged.load();
+        stats.batches = mBatches.load();
+        stats.writerBatches = mWriterBatches.load();
+        return stats;
+    }
+
+private:
+
+    struct Partition
+    {
+        boost::mutex lock;
+        Batch active;
+        std::deque<std::shared_ptr<const Batch>> sealed;
+    };
+
+    template <typename Accept>
+    static VersionPtr findSealed(Partition& p, const char* key, size_t keyLen, Accept accept)
+    {
+        for (auto batch = p.sealed.rbegin(); batch != p.sealed.rend(); ++batch)
+        {
+            auto found = lowerBound(**batch, key, keyLen);
+            if (found != (*batch)->end() && equals(*found, key, keyLen) && accept(*found->version))
+                return found->version;
+        }
+        return nullptr;
+    }
+
+    static VersionPtr findSealed(Partition& p, const char* key, size_t keyLen)
+    {
+        return findSealed(p, key, keyLen, [](const typename VersionPtr::element_type&) { return true; });
+    }
+
+    void sealLocked(Partition& p)
+    {
+        if (p.active.empty())
+            return;
+        std::shared_ptr<Batch> batch = std::make_shared<Batch>();
+        batch->swap(p.active);
+        p.active.reserve(mCapacity.load());
+        p.sealed.push_back(batch);
+    }
+
+    static typename Batch::const_iterator lowerBound(const Batch& batch, const char* key, size_t keyLen)
+    {
+        return std::lower_bound(batch.begin(), batch.end(), key, [keyLen](const Entry& e, const char* k) {
+            return e.key.compare(0, std::string::npos, k, keyLen) < 0;
+        });
+    }
+
+    static typename Batch::iterator lowerBound(Batch& batch, const char* key, size_t keyLen)
+    {
+        return std::lower_bound(batch.begin(), batch.end(), key, [keyLen](const Entry& e, const char* k) {
+            return e.key.compare(0, std::string::npos, k, keyLen) < 0;
+        });
+    }
+
+    static bool equals(const Entry& e, const char* key, size_t keyLen)
+    {
+        return e.key.size() == keyLen && std::memcmp(e.key.data(), key, keyLen) == 0;
+    }
+
+    std::atomic<size_t> mCapacity;
+    Partition mPartitions[ART_WRITE_BUFFER_PARTITIONS];
+    boost::mutex mMergeLock;
+    std::atomic<size_t> mEntries;
+    std::atomic<uint64_t> mAbsorbed;
+    std::atomic<uint64_t> mMerged;
+    std::atomic<uint64_t> mBatches;
+    std::atomic<uint64_t> mWriterBatches;
+};
+
+#endif //MVCCART_WRITEBUFFER_HPP
@@ -6,6 +6,7 @@
 #include <boost/lexical_cast.hpp>
 #include "mvcc/mvcc.hpp"
 #include "ART/ArtCPP.hpp"
+#include "ART/SeparatedArtCPP.hpp"
 #include "Transactions/transactionManager.h"
 
 #include <atomic>
@@ -15,6 +16,10 @@
 #include <condition_variable>
 #include <future>
 #include <cassert>
+#include <algorithm>
+#include <array>
+#include <map>
+#include <random>
 #include "core/Tuple.hpp"
 #include <boost/tuple/tuple.hpp>
 
@@ -41,6 +46,86 @@ typedef pfabric::Tuple<unsigned long, int,string, double> RecordType;
 typedef char KeyType[20];
 typedef ArtCPP<RecordType,KeyType> ARTTupleContainer;
 typedef std::function <void(ARTTupleContainer&,size_t id)> TableOperationOnTupleFunc;
+typedef std::function <void(ARTTupleContainer&,size_t id,std::pair<int,int>)> TransactionLambda;
+
+/// integer-only record, selected for in-place updates at compile time
+struct CounterRecord
+{
+    unsigned long id;
+    long balance;
+};
+typedef ArtCPP<CounterRecord> ARTCounterContainer;
+
+/// Heap allocations made by this thread, counted by the operator new below
+static thread_local size_t threadAllocations = 0;
+
+void* operator new(std::size_t size)
+{
+    threadAllocations++;
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+/// Transaction ids start over before and after a test case run with it
+struct TxnIdFixture
+{
+    TxnIdFixture()
+    {
+        reset_transaction_ID();
+    }
+
+    ~TxnIdFixture()
+    {
+        reset_transaction_ID();
+    }
+};
+
+static char* keyOf(char* key)
+{
+    return key;
+}
+
+static char* keyOf(std::array<char, 20>& key)
+{
+    return key.data();
+}
+
+/// A table for one test case, freed after it
+template <typename Table>
+struct TableFixture : TxnIdFixture
+{
+    std::unique_ptr<Table> table{new Table()};
+
+    /**
+     * Inserts the first count keys as tuples (i, i, INIT, 0.0) in one transaction.
+     * @return id of the loading transaction
+     */
+    template <typename Keys>
+    size_t load(Keys& keys, int count)
+    {
+        size_t loader = get_new_transaction_ID();
+        for (int i = 0; i < count; i++)
+        {
+            RecordType tuple((unsigned long) i, i, INIT, 0.0);
+            table->insertOrUpdateByKey(keyOf(keys[i]), tuple, loader);
+        }
+        return loader;
+    }
+};
+
+typedef TableFixture<ARTTupleContainer> TupleTableFixture;
+typedef TableFixture<ARTCounterContainer> CounterTableFixture;
 
 
 
@@ -151,5 +236,2364 @@ BOOST_AUTO_TEST_SUITE(MVCC_TESTS)
         BOOST_REQUIRE(init->value == INIT);
     }
 
+    BOOST_AUTO_TEST_CASE(test_inplace_update_keeps_head_snapshot)
+    {
+        cout << "test_inplace_update_keeps_head_snapshot" << endl;
+        BOOST_REQUIRE((std::is_same<mvcc11::select_mvcc<CounterRecord>::type,
+                                    mvcc11::inplace_mvcc<CounterRecord>>::value));
+        BOOST_REQUIRE((std::is_same<mvcc11::select_mvcc<RecordType>::type,
+                                    mvcc11::mvcc<RecordType>>::value));
+
+        mvcc11::inplace_mvcc<CounterRecord> x{1, CounterRecord{7, 100}};
+        auto head = x.current();
+        for (size_t txn = 2; txn < 50; txn++)
+        {
+            auto updated = x.update(txn, [](CounterRecord const &r) {
+                return CounterRecord{r.id, r.balance + 1};
+            });
+            BOOST_REQUIRE(updated->version == txn);
+            BOOST_REQUIRE(updated->value.balance == 100 + (long) txn - 1);
+        }
+        ///the head changes in place, a snapshot handed out before keeps what it read
+        BOOST_REQUIRE(head->version == 1);
+        BOOST_REQUIRE(head->value.balance == 100);
+
+        CounterRecord out;
+        BOOST_REQUIRE(x.read(out) == 49);
+        BOOST_REQUIRE(out.balance == 148);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_inplace_undo_read_and_rollback)
+    {
+        cout << "test_inplace_undo_read_and_rollback" << endl;
+        mvcc11::inplace_mvcc<CounterRecord> x{1, CounterRecord{7, 100}};
+        x.overwriteMV(5, CounterRecord{7, 200});
+        x.overwriteMV(9, CounterRecord{7, 300});
+
+        CounterRecord out;
+        BOOST_REQUIRE(x.read_as_of(3, out));
+        BOOST_REQUIRE(out.balance == 100);
+        BOOST_REQUIRE(x.read_as_of(6, out));
+        BOOST_REQUIRE(out.balance == 200);
+        BOOST_REQUIRE(x.read_as_of(9, out));
+        BOOST_REQUIRE(out.balance == 300);
+
+        x.overwriteMV(12, CounterRecord{7, 400});
+        x.overwriteMV(12, CounterRecord{7, 500});
+        BOOST_REQUIRE(x.rollback(12));
+        BOOST_REQUIRE(x.read(out) == 9);
+        BOOST_REQUIRE(out.balance == 300);
+        BOOST_REQUIRE(!x.rollback(12));
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_inplace_updates_through_art, CounterTableFixture)
+    {
+        cout << "test_inplace_updates_through_art" << endl;
+        char keys[3][20] = {"alpha", "beta", "gamma"};
+        for (unsigned long i = 0; i < 3; i++)
+        {
+            CounterRecord record{i, 0};
+            table->insertOrUpdateByKey(keys[i], record, 1);
+        }
+
+        auto head = table->findValueByKey(keys[1], 2);
+        ARTCounterContainer::Updater deposit = [](CounterRecord &r) {
+            return CounterRecord{r.id, r.balance + 10};
+        };
+        for (size_t txn = 2; txn < 12; txn++)
+        {
+            auto updated = table->insertOrUpdateByKey(keys[1], deposit, txn);
+            BOOST_REQUIRE(updated->value.balance == ((long) txn - 1) * 10);
+        }
+        BOOST_REQUIRE(head->value.balance == 0);
+        BOOST_REQUIRE(table->findValueByKey(keys[1], 12)->value.balance == 100);
+        BOOST_REQUIRE(table->findValueByKey(keys[0], 12)->value.balance == 0);
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_inplace_updates_do_not_allocate, CounterTableFixture)
+    {
+        cout << "test_inplace_updates_do_not_allocate" << endl;
+        char key[20] = "account";
+        CounterRecord record{1, 0};
+        table->insertOrUpdateByKey(key, record, get_new_transaction_ID());
+        ARTCounterContainer::Updater deposit = [](CounterRecord &r) {
+            return CounterRecord{r.id, r.balance + 1};
+        };
+        ///the first writes fill the undo ring and the snapshot pool of this thread
+        for (int i = 0; i < 2 * MVCC11_INPLACE_UNDO_DEPTH; i++)
+            table->insertOrUpdateByKey(key, deposit, get_new_transaction_ID());
+
+        size_t before = threadAllocations;
+        for (int i = 0; i < 1000; i++)
+        {
+            auto updated = table->insertOrUpdateByKey(key, deposit, get_new_transaction_ID());
+            BOOST_REQUIRE(updated != nullptr);
+        }
+        BOOST_REQUIRE(threadAllocations == before);
+        table->findValueByKey(key, get_new_transaction_ID());
+        BOOST_REQUIRE(threadAllocations == before);
+
+        ///a snapshot still held is not reused, the next copy comes from elsewhere
+        auto held = table->findValueByKey(key, get_new_transaction_ID());
+        table->insertOrUpdateByKey(key, deposit, get_new_transaction_ID());
+        BOOST_REQUIRE(held->value.balance == 2 * MVCC11_INPLACE_UNDO_DEPTH + 1000);
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_inplace_snapshot_outlives_the_undo_ring, CounterTableFixture)
+    {
+        cout << "test_inplace_snapshot_outlives_the_undo_ring" << endl;
+        char key[20] = "account";
+        CounterRecord record{1, 1010};
+        table->insertOrUpdateByKey(key, record, get_new_transaction_ID());
+        ARTCounterContainer::Updater deposit = [](CounterRecord &r) {
+            return CounterRecord{r.id, r.balance + 10};
+        };
+        const int updates = 3 * MVCC11_INPLACE_UNDO_DEPTH;
+
+        ///autocommit updates push the version the reader sees out of the ring
+        TxnContext reader;
+        reader.begin();
+        BOOST_REQUIRE(table->findValueByKey(key, reader)->value.balance == 1010);
+        for (int i = 0; i < updates; i++)
+            table->insertOrUpdateByKey(key, deposit, get_new_transaction_ID());
+        auto seen = table->findValueByKey(key, reader);
+        BOOST_REQUIRE(seen != nullptr && seen->value.balance == 1010);
+        table->pruneVersions();
+        BOOST_REQUIRE(table->findValueByKey(key, reader)->value.balance == 1010);
+        BOOST_REQUIRE(reader.commit());
+        BOOST_REQUIRE(table->findValueByKey(key, get_new_transaction_ID())->value.balance == 1010 + 10 * updates);
+
+        ///one transaction writing the key more often than the ring holds still rolls back
+        TxnContext writer;
+        writer.begin();
+        for (int i = 0; i < updates; i++)
+            BOOST_REQUIRE(table->insertOrUpdateByKey(key, deposit, writer) != nullptr);
+        BOOST_REQUIRE(table->findValueByKey(key, writer)->value.balance == 1010 + 20 * updates);
+        writer.abort();
+        BOOST_REQUIRE(table->findValueByKey(key, get_new_transaction_ID())->value.balance == 1010 + 10 * updates);
+
+        ///with no reader left the images that overflowed the ring are freed
+        BOOST_REQUIRE(table->pruneVersions() == updates - MVCC11_INPLACE_UNDO_DEPTH + 0u);
+        for (int i = 0; i < updates; i++)
+            table->insertOrUpdateByKey(key, deposit, get_new_transaction_ID());
+        BOOST_REQUIRE(table->findValueByKey(key, get_new_transaction_ID())->value.balance == 1010 + 20 * updates);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_executor_reports_commit_and_abort)
+    {
+        cout << "test_executor_reports_commit_and_abort" << endl;
+        TransactionExecutor executor(4);
+        std::atomic<int> ran{0};
+        std::vector<std::future<TxnStatus>> results;
+
+        auto start_time = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < 10000; i++)
+        {
+            results.push_back(executor.submit([&ran, i]() {
+                ran++;
+                if (i % 100 == 0)
+                    throw TransactionAbort();
+            }));
+        }
+
+        int aborted = 0;
+        for (auto& result : results)
+        {
+            if (result.get() == TxnStatus::Aborted)
+                aborted++;
+        }
+        auto end_time = std::chrono::high_resolution_clock::now();
+
+        BOOST_REQUIRE(ran == 10000);
+        BOOST_REQUIRE(aborted == 100);
+        cout << "10000 transactions on 4 workers::"
+             << std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() << ":" << endl;
+    }
+
+    BOOST_AUTO_TEST_CASE(test_executor_runs_nested_submissions)
+    {
+        cout << "test_executor_runs_nested_submissions" << endl;
+        TransactionExecutor executor(2, true);
+        std::atomic<int> ran{0};
+
+        auto outer = executor.submit([&]() {
+            ///queued on this worker's own deque, other workers steal them
+            std::vector<std::future<TxnStatus>> inner;
+            for (int i = 0; i < 64; i++)
+                inner.push_back(executor.submit([&ran]() { ran++; }));
+            for (auto& f : inner)
+                executor.wait(f);
+        });
+
+        BOOST_REQUIRE(executor.wait(outer) == TxnStatus::Committed);
+        BOOST_REQUIRE(ran == 64);
+
+        ///a single worker runs what its transaction waits for inline
+        TransactionExecutor single(1);
+        std::function<void(int)> nest = [&](int depth) {
+            ran++;
+            if (depth == 0)
+                return;
+            auto inner = single.submit([&, depth]() { nest(depth - 1); });
+            if (single.wait(inner) != TxnStatus::Committed)
+                throw TransactionAbort();
+        };
+        auto deep = single.submit([&]() { nest(16); });
+        BOOST_REQUIRE(single.wait(deep) == TxnStatus::Committed);
+        BOOST_REQUIRE(ran == 64 + 17);
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_txn_context_commit_stamps_versions, TupleTableFixture)
+    {
+        cout << "test_txn_context_commit_stamps_versions" << endl;
+        char keys[2][20] = {"k1", "k2"};
+        size_t loader = load(keys, 2);
+
+        TxnContext writer, reader;
+        writer.begin();
+        reader.begin();
+        ARTTupleContainer::Updater overwrite = [](RecordType &r) {
+            return RecordType(r.getAttribute<0>(), r.getAttribute<1>() + 1, UPDATED, 0.0);
+        };
+        BOOST_REQUIRE(table->insertOrUpdateByKey(keys[0], overwrite, writer) != nullptr);
+
+        ///own write visible to the writer only
+        BOOST_REQUIRE(table->findValueByKey(keys[0], writer)->value.getAttribute<2>() == UPDATED);
+        BOOST_REQUIRE(table->findValueByKey(keys[0], reader)->value.getAttribute<2>() == INIT);
+
+        BOOST_REQUIRE(writer.commit());
+        BOOST_REQUIRE(writer.commitTs() > reader.beginTs());
+        auto committed = table->findValueByKey(keys[0], loader);
+        BOOST_REQUIRE(committed->version == writer.commitTs());
+        BOOST_REQUIRE(committed->_older_snapshot->end_version == writer.commitTs());
+
+        ///reader keeps its snapshot, a new transaction sees the commit
+        BOOST_REQUIRE(table->findValueByKey(keys[0], reader)->value.getAttribute<2>() == INIT);
+        BOOST_REQUIRE(reader.commit());
+        TxnContext later;
+        later.begin();
+        BOOST_REQUIRE(table->findValueByKey(keys[0], later)->value.getAttribute<2>() == UPDATED);
+        BOOST_REQUIRE(table->findValueByKey(keys[1], later)->value.getAttribute<2>() == INIT);
+        BOOST_REQUIRE(later.commit());
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_txn_context_abort_unlinks_versions, TupleTableFixture)
+    {
+        cout << "test_txn_context_abort_unlinks_versions" << endl;
+        char keys[3][20] = {"k1", "k2", "k3"};
+        size_t loader = load(keys, 2);
+        auto head = table->findValueByKey(keys[0], loader);
+
+        TxnContext txn;
+        txn.begin();
+        RecordType tuple((unsigned long) 9, 9, OVERWRITTEN, 0.0);
+        table->insertOrUpdateByKey(keys[0], tuple, txn);
+        table->insertOrUpdateByKey(keys[0], tuple, txn);
+        table->insertOrUpdateByKey(keys[2], tuple, txn);
+        table->deleteByKey(keys[1], txn);
+        BOOST_REQUIRE(txn.writeCount() == 4);
+        BOOST_REQUIRE(table->findValueByKey(keys[1], txn) == nullptr);
+        txn.abort();
+
+        BOOST_REQUIRE(table->findValueByKey(keys[0], loader).get() == head.get());
+        BOOST_REQUIRE(head->end_version == INF);
+        TxnContext after;
+        after.begin();
+        BOOST_REQUIRE(table->findValueByKey(keys[2], after) == nullptr);
+        BOOST_REQUIRE(table->findValueByKey(keys[1], after)->value.getAttribute<2>() == INIT);
+        BOOST_REQUIRE(after.commit());
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_txn_context_first_updater_wins, CounterTableFixture)
+    {
+        cout << "test_txn_context_first_updater_wins" << endl;
+        char key[20] = "account";
+        char other[20] = "other";
+        CounterRecord record{1, 0};
+        size_t loader = get_new_transaction_ID();
+        table->insertOrUpdateByKey(key, record, loader);
+        table->insertOrUpdateByKey(other, record, loader);
+        ARTCounterContainer::Updater deposit = [](CounterRecord &r) {
+            return CounterRecord{r.id, r.balance + 10};
+        };
+
+        ///concurrent writer of an uncommitted version loses immediately
+        TxnContext first, second;
+        first.begin();
+        second.begin();
+        table->insertOrUpdateByKey(key, deposit, first);
+        table->insertOrUpdateByKey(key, deposit, second);
+        BOOST_REQUIRE(second.isRollbackOnly());
+        BOOST_REQUIRE(!second.commit());
+        BOOST_REQUIRE(first.commit());
+
+        ///a version committed after begin() cannot be overwritten
+        TxnContext stale, fresh;
+        stale.begin();
+        fresh.begin();
+        table->insertOrUpdateByKey(key, deposit, fresh);
+        BOOST_REQUIRE(fresh.commit());
+        table->insertOrUpdateByKey(key, deposit, stale);
+        BOOST_REQUIRE(!stale.commit());
+        BOOST_REQUIRE(stale.state() == TxnContext::State::Aborted);
+
+        TxnContext check;
+        check.begin();
+        BOOST_REQUIRE(table->findValueByKey(key, check)->value.balance == 20);
+        BOOST_REQUIRE(check.commit());
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_txn_sets_are_released_to_the_arena, TupleTableFixture)
+    {
+        cout << "test_txn_sets_are_released_to_the_arena" << endl;
+        char keys[1000][20];
+        for (int i = 0; i < 1000; i++)
+            std::sprintf(keys[i], "key%04d", i);
+        load(keys, 1000);
+
+        int64_t blocksBefore = TxnArena::liveBlocks();
+        auto start_time = std::chrono::high_resolution_clock::now();
+        for (int round = 0; round < 2000; round++)
+        {
+            TxnContext txn;
+            txn.begin();
+            for (int i = 0; i < 1000; i++)
+                BOOST_REQUIRE(table->findValueByKey(keys[(i * 7 + round) % 1000], txn) != nullptr);
+            BOOST_REQUIRE(txn.readCount() == 1000);
+            BOOST_REQUIRE(txn.commit());
+            BOOST_REQUIRE(txn.readCount() == 0);
+        }
+        auto end_time = std::chrono::high_resolution_clock::now();
+
+        ///read sets of 2M lookups reuse the same few blocks
+        BOOST_REQUIRE(TxnArena::liveBlocks() - blocksBefore <= 16);
+        cout << "2000 read-only transactions x 1000 lookups::"
+             << std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() << ":" << endl;
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_read_only_transactions_skip_bookkeeping, TupleTableFixture)
+    {
+        cout << "test_read_only_transactions_skip_bookkeeping" << endl;
+        char keys[100][20];
+        for (int i = 0; i < 100; i++)
+            std::sprintf(keys[i], "key%04d", i);
+        size_t loader = load(keys, 100);
+
+        size_t statusEntries = TransactionsStatus.size();
+        TxnContext reader;
+        reader.beginReadOnly();
+        BOOST_REQUIRE(reader.beginTs() == txnClock.readTimestamp());
+
+        TxnContext writer;
+        writer.begin();
+        RecordType tuple((unsigned long) 0, 0, UPDATED, 0.0);
+        table->insertOrUpdateByKey(keys[0], tuple, writer);
+        BOOST_REQUIRE(writer.commit());
+
+        ///snapshot kept without a read set
+        BOOST_REQUIRE(table->findValueByKey(keys[0], reader)->value.getAttribute<2>() == INIT);
+        BOOST_REQUIRE(reader.readCount() == 0);
+        BOOST_REQUIRE(reader.commit());
+
+        ///legacy Transaction bodies read the snapshot taken at construction
+        std::atomic<int> updatedSeen{0};
+        TransactionLambda scan = [&updatedSeen](ARTTupleContainer &ART, size_t id, std::pair<int,int> range) {
+            char key[20];
+            for (int i = range.first; i < range.second; i++)
+            {
+                std::sprintf(key, "key%04d", i);
+                if (ART.findValueByKey(key, id)->value.getAttribute<2>() == UPDATED)
+                    updatedSeen++;
+            }
+        };
+        auto t1 = new Transaction<TransactionLambda, ARTTupleContainer>(scan, *table, std::make_pair(0, 100), TxnMode::ReadOnly);
+        t1->CollectTransaction();
+        BOOST_REQUIRE(t1->status == "Committed");
+        BOOST_REQUIRE(updatedSeen == 1);
+        BOOST_REQUIRE(TransactionsStatus.size() == statusEntries);
+
+        ///writes are refused
+        TxnContext readOnly;
+        readOnly.beginReadOnly();
+        BOOST_REQUIRE(table->insertOrUpdateByKey(keys[1], tuple, readOnly) == nullptr);
+        BOOST_REQUIRE(!readOnly.commit());
+        BOOST_REQUIRE(table->findValueByKey(keys[1], loader)->value.getAttribute<2>() == INIT);
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_read_only_transactions_scale_with_threads, TupleTableFixture)
+    {
+        cout << "test_read_only_transactions_scale_with_threads" << endl;
+        static char keys[10000][20];
+        for (int i = 0; i < 10000; i++)
+            std::sprintf(keys[i], "key%05d", i);
+        load(keys, 10000);
+
+        for (int threads = 1; threads <= 8; threads *= 2)
+        {
+            std::atomic<long> found{0};
+            auto start_time = std::chrono::high_resolution_clock::now();
+            std::vector<std::thread> readers;
+            for (int t = 0; t < threads; t++)
+            {
+                readers.emplace_back([&, t]() {
+                    for (int round = 0; round < 100; round++)
+                    {
+                        TxnContext txn;
+                        txn.beginReadOnly();
+                        long hits = 0;
+                        for (int i = 0; i < 1000; i++)
+                            hits += table->findValueByKey(keys[(i * 13 + round * 7 + t) % 10000], txn) != nullptr;
+                        txn.commit();
+                        found += hits;
+                    }
+                });
+            }
+            for (auto& reader : readers)
+                reader.join();
+            auto end_time = std::chrono::high_resolution_clock::now();
+
+            BOOST_REQUIRE(found == threads * 100 * 1000);
+            cout << threads << " threads x 100 read-only transactions x 1000 lookups::"
+                 << std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() << ":" << endl;
+        }
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_timestamp_service_at_64_threads, TxnIdFixture)
+    {
+        cout << "test_timestamp_service_at_64_threads" << endl;
+        const int threads = 64;
+        const int perThread = 20000;
+        std::vector<std::vector<size_t>> txnIds(threads), commitIds(threads);
+
+        auto allocate = [&](std::vector<std::vector<size_t>> &out, bool ordered) {
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; t++)
+            {
+                workers.emplace_back([&out, t, perThread, ordered]() {
+                    out[t].reserve(perThread);
+                    for (int i = 0; i < perThread; i++)
+                        out[t].push_back(ordered ? get_new_transaction_ID() : txnClock.nextTxnId());
+                });
+            }
+            for (auto& worker : workers)
+                worker.join();
+        };
+
+        auto start_time = std::chrono::high_resolution_clock::now();
+        allocate(txnIds, false);
+        auto mid_time = std::chrono::high_resolution_clock::now();
+        allocate(commitIds, true);
+        auto end_time = std::chrono::high_resolution_clock::now();
+
+        for (auto ids : {&txnIds, &commitIds})
+        {
+            std::vector<size_t> all;
+            for (auto& perThreadIds : *ids)
+            {
+                ///every thread sees its own ids strictly increasing
+                BOOST_REQUIRE(std::is_sorted(perThreadIds.begin(), perThreadIds.end()));
+                all.insert(all.end(), perThreadIds.begin(), perThreadIds.end());
+            }
+            std::sort(all.begin(), all.end());
+            BOOST_REQUIRE(std::adjacent_find(all.begin(), all.end()) == all.end());
+        }
+        ///ordered ids are also published, 1..N without gaps
+        BOOST_REQUIRE(txnClock.readTimestamp() == (uint64_t)threads * perThread);
+        BOOST_REQUIRE(mvcc11::is_txn_id(txnIds[0][0]));
+        BOOST_REQUIRE(!mvcc11::is_txn_id(INF));
+
+        auto batched = std::chrono::duration_cast<std::chrono::microseconds>(mid_time - start_time).count();
+        auto ordered = std::chrono::duration_cast<std::chrono::microseconds>(end_time - mid_time).count();
+        cout << "64 threads x " << perThread << " batched txn ids::" << batched << ":"
+             << (threads * perThread) / std::max<long>(1, batched) << " ids/us" << endl;
+        cout << "64 threads x " << perThread << " ordered commit timestamps::" << ordered << ":"
+             << (threads * perThread) / std::max<long>(1, ordered) << " ids/us" << endl;
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_autocommit_ids_never_wait_for_other_commits, TxnIdFixture)
+    {
+        cout << "test_autocommit_ids_never_wait_for_other_commits" << endl;
+        ///a commit that drew its timestamp but is still stamping holds back only the read timestamp
+        uint64_t stamping = txnClock.acquireCommitTimestamp();
+        std::vector<size_t> ids;
+        std::thread([&]() {
+            for (int i = 0; i < 100; i++)
+                ids.push_back(get_new_transaction_ID());
+        }).join();
+        BOOST_REQUIRE(ids.front() == stamping + 1 && ids.back() == stamping + 100);
+        BOOST_REQUIRE(txnClock.readTimestamp() == stamping - 1);
+        txnClock.publish(stamping);
+        BOOST_REQUIRE(txnClock.readTimestamp() == stamping + 100);
+
+        ///explicit commits return published while autocommit ids are drawn around them
+        const int threads = 16;
+        const int perThread = 20000;
+        std::atomic<bool> ordered(true);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++)
+            workers.emplace_back([&, t]() {
+                for (int i = 0; i < perThread; i++)
+                {
+                    if ((i + t) % 2 == 0)
+                    {
+                        uint64_t commitTs = txnClock.acquireCommitTimestamp();
+                        txnClock.publish(commitTs);
+                        if (txnClock.readTimestamp() < commitTs)
+                            ordered = false;
+                    }
+                    else
+                        get_new_transaction_ID();
+                }
+            });
+        for (auto& worker : workers)
+            worker.join();
+        BOOST_REQUIRE(ordered.load());
+        BOOST_REQUIRE(txnClock.readTimestamp() == stamping + 100 + (uint64_t)threads * perThread);
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_gc_reclaims_keys_longer_than_key_type, TupleTableFixture)
+    {
+        cout << "test_gc_reclaims_keys_longer_than_key_type" << endl;
+        ///the keys differ only past the 20 bytes of the table's KeyType
+        const int numKeys = 64;
+        std::vector<std::string> keys;
+        for (int i = 0; i < numKeys; i++)
+            keys.push_back("a-long-shared-key-prefix-" + std::to_string(1000 + i));
+        for (int i = 0; i < numKeys; i++)
+        {
+            RecordType tuple((unsigned long) i, i, INIT, 0.0);
+            table->insertOrUpdateByKey(&keys[i][0], tuple, get_new_transaction_ID());
+        }
+        for (int i = 0; i < numKeys; i += 2)
+            BOOST_REQUIRE(table->deleteByKey(&keys[i][0], get_new_transaction_ID()) != nullptr);
+        BOOST_REQUIRE(table->backlog() == numKeys / 2 + 0u);
+
+        table->GC();
+        GCStats stats = table->gcStats();
+        BOOST_REQUIRE(stats.reclaimedKeys == numKeys / 2 + 0u && table->backlog() == 0u);
+        for (int i = 0; i < numKeys; i++)
+            BOOST_REQUIRE((table->findValueByKey(&keys[i][0], get_new_transaction_ID()) == nullptr) == (i % 2 == 0));
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_low_watermark_tracks_oldest_active_transaction, TupleTableFixture)
+    {
+        cout << "test_low_watermark_tracks_oldest_active_transaction" << endl;
+        char keys[3][20] = {"key0000", "key0001", "key0002"};
+        load(keys, 3);
+        BOOST_REQUIRE(activeTxnRegistry.refreshLowWatermark() == txnClock.readTimestamp());
+
+        TxnContext oldest, reader, deleter;
+        oldest.begin();
+        get_new_transaction_ID();
+        reader.beginReadOnly();
+        BOOST_REQUIRE(reader.beginTs() > oldest.beginTs());
+        BOOST_REQUIRE(activeTxnRegistry.refreshLowWatermark() == oldest.beginTs());
+        BOOST_REQUIRE(activeTxnRegistry.lowWatermark() == oldest.beginTs());
+        BOOST_REQUIRE(activeTxnRegistry.activeCount() == 2);
+        BOOST_REQUIRE(oldest.commit());
+        BOOST_REQUIRE(activeTxnRegistry.refreshLowWatermark() == reader.beginTs());
+
+        ///the reader still sees the deleted key, GC has to keep it
+        deleter.begin();
+        BOOST_REQUIRE(table->deleteByKey(keys[1], deleter) != nullptr);
+        BOOST_REQUIRE(deleter.commit());
+        table->GC();
+        BOOST_REQUIRE(table->findValueByKey(keys[1], reader) != nullptr);
+        BOOST_REQUIRE(reader.commit());
+
+        BOOST_REQUIRE(activeTxnRegistry.activeCount() == 0);
+        BOOST_REQUIRE(activeTxnRegistry.refreshLowWatermark() == txnClock.readTimestamp());
+        table->GC();
+        BOOST_REQUIRE(table->findValueByKey(keys[1], get_new_transaction_ID()) == nullptr);
+        BOOST_REQUIRE(table->findValueByKey(keys[2], get_new_transaction_ID()) != nullptr);
+
+        ///the watermark never moves backwards while 32 threads come and go
+        const int threads = 32;
+        const int perThread = 2000;
+        std::atomic<bool> done(false);
+        std::atomic<bool> monotonic(true);
+        std::thread collector([&]() {
+            uint64_t previous = activeTxnRegistry.lowWatermark();
+            while (!done.load())
+            {
+                uint64_t watermark = activeTxnRegistry.refreshLowWatermark();
+                if (watermark < previous)
+                    monotonic = false;
+                previous = watermark;
+            }
+        });
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++)
+            workers.emplace_back([&]() {
+                for (int i = 0; i < perThread; i++)
+                {
+                    TxnContext txn;
+                    txn.begin();
+                    ///a snapshot is never older than the watermark GC works with
+                    if (txn.beginTs() < activeTxnRegistry.lowWatermark())
+                        monotonic = false;
+                    txn.commit();
+                    get_new_transaction_ID();
+                }
+            });
+        for (auto& worker : workers)
+            worker.join();
+        done = true;
+        collector.join();
+        BOOST_REQUIRE(monotonic.load());
+        BOOST_REQUIRE(activeTxnRegistry.activeCount() == 0);
+        BOOST_REQUIRE(activeTxnRegistry.refreshLowWatermark() == txnClock.readTimestamp());
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_threads_enter_through_their_own_slot, TxnIdFixture)
+    {
+        cout << "test_threads_enter_through_their_own_slot" << endl;
+        uint64_t outerTs, innerTs, ts;
+        ActiveTxnRegistry::Handle own = activeTxnRegistry.enter(ts);
+        activeTxnRegistry.leave(own);
+        for (int i = 0; i < 100; i++)
+        {
+            BOOST_REQUIRE(activeTxnRegistry.enter(ts) == own);
+            activeTxnRegistry.leave(own);
+        }
+        BOOST_REQUIRE(activeTxnRegistry.activeCount() == 0);
+
+        ///a nested transaction claims another slot, the watermark sees both
+        get_new_transaction_ID();
+        BOOST_REQUIRE(activeTxnRegistry.enter(outerTs) == own);
+        get_new_transaction_ID();
+        ActiveTxnRegistry::Handle nested = activeTxnRegistry.enter(innerTs);
+        BOOST_REQUIRE(nested != own);
+        BOOST_REQUIRE(activeTxnRegistry.activeCount() == 2);
+        BOOST_REQUIRE(activeTxnRegistry.refreshLowWatermark() == outerTs);
+        activeTxnRegistry.leave(own);
+        BOOST_REQUIRE(activeTxnRegistry.refreshLowWatermark() == innerTs);
+        activeTxnRegistry.leave(nested);
+        BOOST_REQUIRE(activeTxnRegistry.activeCount() == 0);
+        BOOST_REQUIRE(activeTxnRegistry.refreshLowWatermark() == txnClock.readTimestamp());
+        BOOST_REQUIRE(activeTxnRegistry.enter(ts) == own);
+        activeTxnRegistry.leave(own);
+
+        ///a thread that exited hands its slot to the next one
+        ActiveTxnRegistry::Handle exited, adopted;
+        std::thread([&]() { exited = activeTxnRegistry.enter(ts); activeTxnRegistry.leave(exited); }).join();
+        std::thread([&]() { adopted = activeTxnRegistry.enter(ts); activeTxnRegistry.leave(adopted); }).join();
+        BOOST_REQUIRE(exited != own);
+        BOOST_REQUIRE(adopted == exited);
+        BOOST_REQUIRE(activeTxnRegistry.activeCount() == 0);
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_version_chains_are_pruned_below_the_watermark, TupleTableFixture)
+    {
+        cout << "test_version_chains_are_pruned_below_the_watermark" << endl;
+        char keys[2][20] = {"key0000", "key0001"};
+        size_t loader = load(keys, 2);
+        auto chainLength = [&](char* key) {
+            size_t length = 0;
+            for (auto v = table->findValueByKey(key, loader); v != nullptr; v = v->_older_snapshot)
+                length++;
+            return length;
+        };
+        ARTTupleContainer::Updater bump = [](RecordType &r) {
+            return RecordType(r.getAttribute<0>(), r.getAttribute<1>() + 1, UPDATED, 0.0);
+        };
+
+        ///a hot key never grows past MAX_VERSION_DEPTH, even with a stale cached watermark
+        for (int i = 0; i < 1000; i++)
+            table->insertOrUpdateByKey(keys[0], bump, get_new_transaction_ID());
+        BOOST_REQUIRE(chainLength(keys[0]) <= MAX_VERSION_DEPTH + 1);
+
+        ///a running snapshot pins every version it may still read
+        TxnContext reader;
+        reader.begin();
+        int seen = table->findValueByKey(keys[0], reader)->value.getAttribute<1>();
+        for (int i = 0; i < 50; i++)
+            table->insertOrUpdateByKey(keys[0], bump, get_new_transaction_ID());
+        table->pruneVersions();
+        BOOST_REQUIRE(chainLength(keys[0]) >= 51);
+        BOOST_REQUIRE(table->findValueByKey(keys[0], reader)->value.getAttribute<1>() == seen);
+        BOOST_REQUIRE(reader.commit());
+
+        ///the sweeper covers the now cold key, only the head survives
+        BOOST_REQUIRE(table->pruneVersions() >= 50);
+        BOOST_REQUIRE(chainLength(keys[0]) == 1);
+        BOOST_REQUIRE(chainLength(keys[1]) == 1);
+        BOOST_REQUIRE(table->findValueByKey(keys[0], get_new_transaction_ID())->value.getAttribute<1>() == seen + 50);
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_parallel_gc_reclaims_deleted_subtrees_within_budget, TupleTableFixture)
+    {
+        cout << "test_parallel_gc_reclaims_deleted_subtrees_within_budget" << endl;
+        const int numKeys = 4096;
+        std::vector<std::array<char, 20>> keys(numKeys);
+        ///16 subtrees below the root
+        for (int i = 0; i < numKeys; i++)
+            sprintf(keys[i].data(), "%c%05d", 'a' + i % 16, i);
+        load(keys, numKeys);
+        for (int i = 0; i < numKeys; i += 2)
+            table->deleteByKey(keys[i].data(), get_new_transaction_ID());
+        BOOST_REQUIRE(table->backlog() == numKeys / 2);
+
+        ///no budget, no work: everything stays queued
+        table->garbageCollector().setCycleBudget(0);
+        table->GC();
+        BOOST_REQUIRE(table->backlog() == numKeys / 2);
+        BOOST_REQUIRE(table->gcStats().reclaimedKeys == 0);
+
+        table->garbageCollector().setWorkers(4);
+        table->garbageCollector().setCycleBudget(1000000);
+        table->garbageCollector().setThrottle(100);
+        table->GC();
+        GCStats stats = table->gcStats();
+        BOOST_REQUIRE(stats.cycles == 2);
+        BOOST_REQUIRE(stats.reclaimedKeys == numKeys / 2);
+        BOOST_REQUIRE(stats.reclaimedBytes >= stats.reclaimedKeys * sizeof(ARTTupleContainer::snapshot_type));
+        BOOST_REQUIRE(stats.backlog == 0);
+        BOOST_REQUIRE(table->art_size() == numKeys / 2 + 0u);
+        for (int i = 0; i < numKeys; i++)
+            BOOST_REQUIRE((table->findValueByKey(keys[i].data(), get_new_transaction_ID()) == nullptr) == (i % 2 == 0));
+        cout << "reclaimed " << stats.reclaimedKeys << " keys, " << stats.reclaimedBytes << " bytes in "
+             << stats.lastCycleUs << " us on " << table->garbageCollector().workers() << " workers" << endl;
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_background_gc_runs_beside_writers, TupleTableFixture)
+    {
+        cout << "test_background_gc_runs_beside_writers" << endl;
+        const int numKeys = 4096;
+        std::vector<std::array<char, 20>> keys(numKeys);
+        for (int i = 0; i < numKeys; i++)
+            sprintf(keys[i].data(), "%c%05d", 'a' + i % 16, i);
+        load(keys, numKeys);
+
+        table->startBackgroundGC(100);
+        ///writers keep inserting into and reading the subtrees the driver removes keys from
+        std::atomic<long> missed{0};
+        std::vector<std::thread> writers;
+        for (int w = 0; w < 2; w++)
+            writers.emplace_back([&, w] {
+                char key[20];
+                for (int i = w; i < numKeys; i += 2)
+                {
+                    sprintf(key, "%c%05dx", 'a' + i % 16, i);
+                    RecordType tuple((unsigned long) i, i, UPDATED, 0.0);
+                    table->insertOrUpdateByKey(key, tuple, get_new_transaction_ID());
+                    if (i % 4 == 1)
+                        table->deleteByKey(keys[i - 1].data(), get_new_transaction_ID());
+                    missed += table->findValueByKey(keys[i | 1].data(), get_new_transaction_ID()) == nullptr;
+                }
+            });
+        for (auto& writer : writers)
+            writer.join();
+        BOOST_REQUIRE(missed == 0);
+        for (int waits = 0; table->backlog() > 0 && waits < 5000; waits++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        table->stopBackgroundGC();
+
+        BOOST_REQUIRE(table->backlog() == 0u);
+        BOOST_REQUIRE(table->gcStats().reclaimedKeys == numKeys / 4u);
+        size_t reader = get_new_transaction_ID();
+        char key[20];
+        for (int i = 0; i < numKeys; i++)
+        {
+            BOOST_REQUIRE((table->findValueByKey(keys[i].data(), reader) == nullptr) == (i % 4 == 0));
+            sprintf(key, "%c%05dx", 'a' + i % 16, i);
+            BOOST_REQUIRE(table->findValueByKey(key, reader) != nullptr);
+        }
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_redo_log_group_commit, TupleTableFixture)
+    {
+        cout << "test_redo_log_group_commit" << endl;
+        const std::string path = "mvcc_redo_test.log";
+        ::unlink(path.c_str());
+        const int numThreads = 4, txnsPerThread = 50;
+        char keys[8][20] = {"key00", "key01", "key02", "key03", "key04", "key05", "key06", "key07"};
+        {
+            RedoLog log(path, 8, 2000);
+            table->setRedoLog(&log);
+            load(keys, 3);
+
+            TxnContext txn;
+            txn.begin();
+            RecordType tuple((unsigned long) 9, 9, OVERWRITTEN, 0.0);
+            table->insertOrUpdateByKey(keys[0], tuple, txn);
+            table->deleteByKey(keys[1], txn);
+            BOOST_REQUIRE(txn.commit());
+            txn.durable().wait();
+            BOOST_REQUIRE(log.stats().commits == 4);
+
+            ///aborted writes never reach the file
+            txn.begin();
+            table->insertOrUpdateByKey(keys[2], tuple, txn);
+            txn.abort();
+
+            ///concurrent commits share fdatasyncs, every future completes on its group flush
+            std::vector<std::thread> threads;
+            for (int t = 0; t < numThreads; t++)
+                threads.emplace_back([&, t] {
+                    std::vector<std::shared_future<void>> durable;
+                    for (int i = 0; i < txnsPerThread; i++)
+                    {
+                        TxnContext writer;
+                        writer.begin();
+                        RecordType value((unsigned long) t, i, UPDATED, 0.0);
+                        table->insertOrUpdateByKey(keys[4 + t], value, writer);
+                        if (writer.commit())
+                            durable.push_back(writer.durable());
+                    }
+                    for (auto& f : durable)
+                        f.wait();
+                });
+            for (auto& thread : threads)
+                thread.join();
+            RedoLog::Stats stats = log.stats();
+            BOOST_REQUIRE(stats.commits == 4u + numThreads * txnsPerThread);
+            BOOST_REQUIRE(stats.groups < stats.commits);
+            cout << stats.commits << " commits in " << stats.groups << " groups, " << stats.bytes << " bytes" << endl;
+            table->setRedoLog(nullptr);
+        }
+
+        ///replaying the newest record per key rebuilds the table
+        std::map<std::string, std::pair<uint64_t, RedoOp>> newest;
+        size_t records = RedoLog::scan(path, [&](const RedoRecord& r) {
+            std::string key(r.key, r.keyLen);
+            if (newest.count(key) == 0 || newest[key].first < r.commitTs)
+                newest[key] = std::make_pair(r.commitTs, r.op);
+        });
+        BOOST_REQUIRE(records == 5u + numThreads * txnsPerThread);
+        TxnContext reader;
+        reader.beginReadOnly();
+        BOOST_REQUIRE(newest.size() == 3u + numThreads);
+        BOOST_REQUIRE(newest["key01"].second == RedoOp::Delete);
+        BOOST_REQUIRE(table->findValueByKey(keys[1], reader) == nullptr);
+        RedoLog::scan(path, [&](const RedoRecord& r) {
+            std::string key(r.key, r.keyLen);
+            if (r.op != RedoOp::Put || newest[key].first != r.commitTs)
+                return;
+            RecordType value = RedoCodec<RecordType>::decode(r.payload, r.payloadLen);
+            auto current = table->findValueByKey(const_cast<char*>(key.c_str()), reader);
+            BOOST_REQUIRE(current != nullptr);
+            BOOST_REQUIRE(value.getAttribute<1>() == current->value.getAttribute<1>());
+            BOOST_REQUIRE(value.getAttribute<2>() == current->value.getAttribute<2>());
+        });
+        BOOST_REQUIRE(reader.commit());
+        ::unlink(path.c_str());
+    }
+
+    BOOST_AUTO_TEST_CASE(test_redo_log_buffers_per_log_and_thread)
+    {
+        cout << "test_redo_log_buffers_per_log_and_thread" << endl;
+        const std::string first = "mvcc_redo_first.log", second = "mvcc_redo_second.log";
+        ::unlink(first.c_str());
+        ::unlink(second.c_str());
+        {
+            RedoLog a(first), b(second);
+            ///a commit left open in one log survives commits of the same thread in another one
+            for (int round = 0; round < 3; round++)
+            {
+                a.appendDelete("open", 4);
+                b.appendDelete("other", 5);
+                b.seal(2 * round + 1, false);
+                a.appendDelete("closed", 6);
+                a.seal(2 * round + 2, false);
+            }
+            a.flush();
+            b.flush();
+        }
+        std::vector<std::string> keys;
+        BOOST_REQUIRE(RedoLog::scan(first, [&](const RedoRecord& r) {
+            keys.push_back(std::string(r.key, r.keyLen));
+            BOOST_REQUIRE(r.commitTs % 2 == 0);
+        }) == 6u);
+        for (size_t i = 0; i < keys.size(); i++)
+            BOOST_REQUIRE(keys[i] == (i % 2 == 0 ? "open" : "closed"));
+        BOOST_REQUIRE(RedoLog::scan(second, [](const RedoRecord& r) {
+            BOOST_REQUIRE(std::string(r.key, r.keyLen) == "other");
+        }) == 3u);
+        ::unlink(first.c_str());
+        ::unlink(second.c_str());
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_fuzzy_checkpoint_under_concurrent_writers, TupleTableFixture)
+    {
+        cout << "test_fuzzy_checkpoint_under_concurrent_writers" << endl;
+        const std::string dir = "mvcc_checkpoint_test";
+        const std::string logPath = dir + "/redo.log";
+        Checkpoint::createDirectory(dir);
+        ::unlink(logPath.c_str());
+        RedoLog log(logPath);
+        table->setRedoLog(&log);
+        const int numKeys = 4096;
+        std::vector<std::array<char, 20>> keys(numKeys);
+        for (int i = 0; i < numKeys; i++)
+            sprintf(keys[i].data(), "%c%05d", 'a' + i % 16, i);
+        size_t loader = load(keys, numKeys);
+        log.flush();
+
+        ///a writer commits one update per key while the checkpoint runs
+        std::vector<uint64_t> committedAt(numKeys, 0);
+        std::atomic<bool> started(false);
+        std::thread writer([&] {
+            for (int i = 0; i < numKeys; i++)
+            {
+                TxnContext txn;
+                txn.begin();
+                RecordType tuple((unsigned long) i, i + numKeys, UPDATED, 0.0);
+                table->insertOrUpdateByKey(keys[i].data(), tuple, txn);
+                if (txn.commit())
+                    committedAt[i] = txn.commitTs();
+                started = true;
+            }
+        });
+        while (!started)
+            std::this_thread::yield();
+        CheckpointInfo info = table->checkpoint(dir, 8, 2);
+        writer.join();
+        log.flush();
+
+        CheckpointInfo manifest;
+        BOOST_REQUIRE(Checkpoint::readManifest(dir, manifest));
+        BOOST_REQUIRE(manifest.ts == info.ts);
+        BOOST_REQUIRE(manifest.files.size() == 8u);
+        BOOST_REQUIRE(info.records == numKeys + 0u);
+
+        ///every key holds exactly the value committed at or before the snapshot
+        std::map<std::string, int> checkpointed;
+        for (auto& file : manifest.files)
+            RedoLog::scan(dir + "/" + file, [&](const RedoRecord& r) {
+                BOOST_REQUIRE(r.commitTs == info.ts);
+                checkpointed[std::string(r.key, r.keyLen)] =
+                        RedoCodec<RecordType>::decode(r.payload, r.payloadLen).getAttribute<1>();
+            });
+        BOOST_REQUIRE(checkpointed.size() == numKeys + 0u);
+        for (int i = 0; i < numKeys; i++)
+        {
+            bool updated = committedAt[i] != 0 && committedAt[i] <= info.ts;
+            BOOST_REQUIRE(checkpointed[keys[i].data()] == (updated ? i + numKeys : i));
+        }
+
+        ///the load is covered by the checkpoint, updates after it stay in the log
+        size_t newer = 0;
+        RedoLog::scan(logPath, [&](const RedoRecord& r) {
+            BOOST_REQUIRE(r.commitTs != loader);
+            newer += r.commitTs > info.ts;
+        });
+        BOOST_REQUIRE(newer == (size_t) std::count_if(committedAt.begin(), committedAt.end(),
+                                                     [&](uint64_t ts) { return ts > info.ts; }));
+        BOOST_REQUIRE(info.truncatedLogBytes > 0);
+
+        ///a newer checkpoint replaces the files of the previous one
+        RecordType tuple((unsigned long) 0, 0, OVERWRITTEN, 0.0);
+        table->insertOrUpdateByKey(keys[0].data(), tuple, get_new_transaction_ID());
+        CheckpointInfo second = table->checkpoint(dir, 4, 1);
+        BOOST_REQUIRE(second.ts > info.ts);
+        BOOST_REQUIRE(::access((dir + "/" + manifest.files[0]).c_str(), F_OK) != 0);
+        cout << info.records << " records, " << info.bytes << " bytes in " << info.durationUs << " us, "
+             << info.truncatedLogBytes << " log bytes truncated, " << newer << " updates after the snapshot" << endl;
+        table->setRedoLog(nullptr);
+        for (auto& file : second.files)
+            ::unlink((dir + "/" + file).c_str());
+        ::unlink(Checkpoint::manifestPath(dir).c_str());
+        ::unlink(logPath.c_str());
+        ::rmdir(dir.c_str());
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_parallel_recovery_from_checkpoint_and_log, TupleTableFixture)
+    {
+        cout << "test_parallel_recovery_from_checkpoint_and_log" << endl;
+        const std::string dir = "mvcc_recovery_test";
+        const std::string logPath = dir + "/redo.log";
+        Checkpoint::createDirectory(dir);
+        ::unlink(logPath.c_str());
+        const int numKeys = 4096, inserted = 512;
+        std::vector<std::array<char, 20>> keys(numKeys + inserted);
+        for (int i = 0; i < numKeys + inserted; i++)
+            sprintf(keys[i].data(), "%c%05d", 'a' + i % 16, i);
+        {
+            RedoLog log(logPath);
+            table->setRedoLog(&log);
+            load(keys, numKeys);
+            table->checkpoint(dir, 8, 2);
+
+            ///after the checkpoint: repeated updates, deletes and new keys, only in the log
+            for (int round = 1; round <= 3; round++)
+                for (int i = 0; i < numKeys; i += 2)
+                {
+                    TxnContext txn;
+                    txn.begin();
+                    RecordType tuple((unsigned long) i, i + round * numKeys, UPDATED, 0.0);
+                    table->insertOrUpdateByKey(keys[i].data(), tuple, txn);
+                    if (i % 14 == 0)
+                        table->deleteByKey(keys[i + 1].data(), txn);
+                    BOOST_REQUIRE(txn.commit());
+                }
+            for (int i = numKeys; i < numKeys + inserted; i++)
+            {
+                RecordType tuple((unsigned long) i, i, INIT, 0.0);
+                table->insertOrUpdateByKey(keys[i].data(), tuple, get_new_transaction_ID());
+            }
+            table->setRedoLog(nullptr);
+        }
+
+        for (size_t threads : {1, 4})
+        {
+            std::unique_ptr<ARTTupleContainer> recovered(new ARTTupleContainer());
+            RecoveryStats stats = recovered->recover(dir, logPath, threads);
+            BOOST_REQUIRE(stats.checkpointRecords == numKeys + 0u);
+            BOOST_REQUIRE(stats.replayedRecords == 3 * (numKeys / 2 + numKeys / 14 + 1) + inserted + 0u);
+
+            TxnContext reader;
+            reader.beginReadOnly();
+            for (int i = 0; i < numKeys + inserted; i++)
+            {
+                auto expected = table->findValueByKey(keys[i].data(), reader);
+                auto actual = recovered->findValueByKey(keys[i].data(), reader);
+                BOOST_REQUIRE((expected == nullptr) == (actual == nullptr));
+                if (expected != nullptr)
+                    BOOST_REQUIRE(expected->value.getAttribute<1>() == actual->value.getAttribute<1>());
+            }
+            BOOST_REQUIRE(reader.commit());
+
+            ///new commits are stamped after everything recovered
+            TxnContext txn;
+            txn.begin();
+            RecordType tuple((unsigned long) 0, 0, OVERWRITTEN, 0.0);
+            recovered->insertOrUpdateByKey(keys[0].data(), tuple, txn);
+            BOOST_REQUIRE(txn.commit());
+            BOOST_REQUIRE(recovered->findValueByKey(keys[0].data(), get_new_transaction_ID())->value.getAttribute<2>() == OVERWRITTEN);
+            cout << threads << " threads: " << stats.checkpointRecords << " checkpoint records in " << stats.loadUs
+                 << " us, " << stats.replayedRecords << " log records in " << stats.replayUs << " us" << endl;
+        }
+
+        CheckpointInfo manifest;
+        BOOST_REQUIRE(Checkpoint::readManifest(dir, manifest));
+        for (auto& file : manifest.files)
+            ::unlink((dir + "/" + file).c_str());
+        ::unlink(Checkpoint::manifestPath(dir).c_str());
+        ::unlink(logPath.c_str());
+        ::rmdir(dir.c_str());
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_recovery_replays_autocommit_installed_after_checkpoint, TupleTableFixture)
+    {
+        cout << "test_recovery_replays_autocommit_installed_after_checkpoint" << endl;
+        const std::string dir = "mvcc_autocommit_recovery_test";
+        const std::string logPath = dir + "/redo.log";
+        Checkpoint::createDirectory(dir);
+        ::unlink(logPath.c_str());
+        const int numKeys = 256;
+        std::vector<std::array<char, 20>> keys(numKeys + 2);
+        for (int i = 0; i < numKeys + 2; i++)
+            sprintf(keys[i].data(), "key%05d", i);
+        RedoLog log(logPath);
+        table->setRedoLog(&log);
+        load(keys, numKeys);
+
+        ///ids are published when handed out, the checkpoint snapshot covers them before they are written
+        size_t early = get_new_transaction_ID();
+        CheckpointInfo truncated = table->checkpoint(dir, 4, 1);
+        BOOST_REQUIRE(truncated.ts >= early);
+        RecordType tuple((unsigned long) numKeys, numKeys, INIT, 0.0);
+        table->insertOrUpdateByKey(keys[numKeys].data(), tuple, early);
+
+        ///a checkpoint that left the log as it was, the way a crash before truncate() does
+        early = get_new_transaction_ID();
+        table->setRedoLog(nullptr);
+        log.flush();
+        CheckpointInfo untruncated = table->checkpoint(dir, 4, 1);
+        BOOST_REQUIRE(untruncated.ts >= early && untruncated.logOffset == 0u);
+        table->setRedoLog(&log);
+        RecordType later((unsigned long) numKeys + 1, numKeys + 1, INIT, 0.0);
+        table->insertOrUpdateByKey(keys[numKeys + 1].data(), later, early);
+        table->setRedoLog(nullptr);
+        log.flush();
+
+        std::unique_ptr<ARTTupleContainer> recovered(new ARTTupleContainer());
+        RecoveryStats stats = recovered->recover(dir, logPath, 2);
+        BOOST_REQUIRE(stats.checkpointTs == untruncated.ts);
+        for (int i = 0; i < numKeys + 2; i++)
+        {
+            auto actual = recovered->findValueByKey(keys[i].data(), get_new_transaction_ID());
+            BOOST_REQUIRE(actual != nullptr && actual->value.getAttribute<1>() == i);
+        }
+
+        CheckpointInfo manifest;
+        BOOST_REQUIRE(Checkpoint::readManifest(dir, manifest));
+        for (auto& file : manifest.files)
+            ::unlink((dir + "/" + file).c_str());
+        ::unlink(Checkpoint::manifestPath(dir).c_str());
+        ::unlink(logPath.c_str());
+        ::rmdir(dir.c_str());
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_incremental_checkpoint_chain, TupleTableFixture)
+    {
+        cout << "test_incremental_checkpoint_chain" << endl;
+        const std::string dir = "mvcc_incremental_test";
+        const std::string logPath = dir + "/redo.log";
+        Checkpoint::createDirectory(dir);
+        ::unlink(logPath.c_str());
+        const int numKeys = 8192, inserted = 256;
+        std::vector<std::array<char, 20>> keys(numKeys + inserted);
+        for (int i = 0; i < numKeys + inserted; i++)
+            sprintf(keys[i].data(), "%c%05d", 'a' + i % 16, i);
+        auto update = [&](int first, int count, int stride, int value) {
+            for (int i = first; i < first + count * stride; i += stride)
+            {
+                TxnContext txn;
+                txn.begin();
+                RecordType tuple((unsigned long) i, value, UPDATED, 0.0);
+                table->insertOrUpdateByKey(keys[i].data(), tuple, txn);
+                BOOST_REQUIRE(txn.commit());
+            }
+        };
+
+        RedoLog log(logPath);
+        table->setRedoLog(&log);
+        load(keys, numKeys);
+        CheckpointInfo full = table->incrementalCheckpoint(dir, 8, 2);
+        BOOST_REQUIRE(!full.delta);
+        BOOST_REQUIRE(full.records == numKeys + 0u);
+
+        ///a delta holds exactly the keys written since the previous checkpoint
+        update(0, 64, 97, 1);
+        for (int i = 1; i < 8 * 101; i += 101)
+        {
+            TxnContext txn;
+            txn.begin();
+            table->deleteByKey(keys[i].data(), txn);
+            BOOST_REQUIRE(txn.commit());
+        }
+        CheckpointInfo small = table->incrementalCheckpoint(dir, 8, 2);
+        BOOST_REQUIRE(small.delta);
+        BOOST_REQUIRE(small.records == 64 + 8u);
+
+        ///ten times the updates, ten times the bytes; a write still open at the snapshot goes into the next delta
+        update(3, 640, 11, 2);
+        TxnContext open;
+        open.begin();
+        RecordType late((unsigned long) 5, 3, OVERWRITTEN, 0.0);
+        table->insertOrUpdateByKey(keys[5].data(), late, open);
+        CheckpointInfo large = table->incrementalCheckpoint(dir, 8, 2);
+        BOOST_REQUIRE(large.delta);
+        BOOST_REQUIRE(large.records == 640u);
+        BOOST_REQUIRE(large.bytes > 5 * small.bytes && large.bytes < full.bytes / 4);
+        BOOST_REQUIRE(open.commit());
+        for (int i = numKeys; i < numKeys + inserted; i++)
+        {
+            RecordType tuple((unsigned long) i, i, INIT, 0.0);
+            table->insertOrUpdateByKey(keys[i].data(), tuple, get_new_transaction_ID());
+        }
+        CheckpointInfo last = table->incrementalCheckpoint(dir, 8, 2);
+        BOOST_REQUIRE(last.delta);
+        BOOST_REQUIRE(last.records == inserted + 1u);
+        update(7, 32, 13, 4);
+        table->setRedoLog(nullptr);
+        log.flush();
+
+        std::vector<CheckpointInfo> chain;
+        BOOST_REQUIRE(Checkpoint::readManifest(dir, chain));
+        BOOST_REQUIRE(chain.size() == 4u);
+        BOOST_REQUIRE(!chain[0].delta && chain[3].ts == last.ts);
+
+        for (size_t threads : {1, 4})
+        {
+            std::unique_ptr<ARTTupleContainer> recovered(new ARTTupleContainer());
+            RecoveryStats stats = recovered->recover(dir, logPath, threads);
+            BOOST_REQUIRE(stats.deltas == 3u);
+            BOOST_REQUIRE(stats.checkpointTs == last.ts);
+            BOOST_REQUIRE(stats.replayedRecords == 32u);
+
+            TxnContext reader;
+            reader.beginReadOnly();
+            for (int i = 0; i < numKeys + inserted; i++)
+            {
+                auto expected = table->findValueByKey(keys[i].data(), reader);
+                auto actual = recovered->findValueByKey(keys[i].data(), reader);
+                BOOST_REQUIRE((expected == nullptr) == (actual == nullptr));
+                if (expected != nullptr)
+                    BOOST_REQUIRE(expected->value.getAttribute<1>() == actual->value.getAttribute<1>());
+            }
+            BOOST_REQUIRE(reader.commit());
+            cout << threads << " threads: " << stats.checkpointRecords << " records from a full checkpoint and "
+                 << stats.deltas << " deltas in " << stats.loadUs << " us" << endl;
+        }
+        cout << "full " << full.bytes << " bytes in " << full.durationUs << " us, deltas " << small.bytes << " bytes in "
+             << small.durationUs << " us, " << large.bytes << " bytes in " << large.durationUs << " us" << endl;
+
+        for (auto& info : chain)
+            for (auto& file : info.files)
+                ::unlink((dir + "/" + file).c_str());
+        ::unlink(Checkpoint::manifestPath(dir).c_str());
+        ::unlink(logPath.c_str());
+        ::rmdir(dir.c_str());
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_value_separation_with_compaction, TxnIdFixture)
+    {
+        cout << "test_value_separation_with_compaction" << endl;
+        const std::string dir = "mvcc_value_store_test";
+        ///small segments, so the records of a few thousand keys fill dozens of them
+        SeparatedArtCPP<RecordType, KeyType> table(dir, 64 * 1024, 1024);
+        const int numKeys = 2048;
+        std::vector<std::array<char, 20>> keys(numKeys);
+        for (int i = 0; i < numKeys; i++)
+            sprintf(keys[i].data(), "%c%05d", 'a' + i % 16, i);
+        const std::string payload(200, 'x');
+        auto expectedRound = [](int i) { return i % 3 == 0 ? 2 : 3; };
+
+        for (int round = 0; round <= 3; round++)
+            for (int i = 0; i < numKeys; i++)
+                if (round < 3 || i % 3 != 0)
+                {
+                    RecordType tuple((unsigned long) i, round, payload + std::to_string(i), 0.0);
+                    table.insertOrUpdateByKey(keys[i].data(), tuple, get_new_transaction_ID());
+                }
+        BOOST_REQUIRE(table.art_size() == numKeys + 0u);
+        ValueStoreStats before = table.storeStats();
+
+        ///readers keep resolving records while compaction moves them
+        std::atomic<bool> stop(false);
+        std::atomic<int> wrong(0);
+        std::thread reader([&] {
+            for (int i = 0; !stop; i = (i + 7) % numKeys)
+            {
+                TxnContext txn;
+                txn.beginReadOnly();
+                auto record = table.findValueByKey(keys[i].data(), txn);
+                if (record == nullptr || record->getAttribute<1>() != expectedRound(i) ||
+                    record->getAttribute<2>() != payload + std::to_string(i))
+                    wrong++;
+                txn.commit();
+            }
+        });
+        size_t retired = table.GC();
+        stop = true;
+        reader.join();
+        BOOST_REQUIRE(wrong == 0);
+
+        ValueStoreStats after = table.storeStats();
+        BOOST_REQUIRE(retired > 0);
+        BOOST_REQUIRE(after.segments < before.segments);
+        BOOST_REQUIRE(after.relocatedBytes > 0);
+        BOOST_REQUIRE(after.retiredSegments == retired);
+        TxnContext check;
+        check.beginReadOnly();
+        for (int i = 0; i < numKeys; i++)
+        {
+            auto record = table.findValueByKey(keys[i].data(), check);
+            BOOST_REQUIRE(record != nullptr);
+            BOOST_REQUIRE(record->getAttribute<1>() == expectedRound(i));
+            BOOST_REQUIRE(record->getAttribute<2>() == payload + std::to_string(i));
+        }
+        BOOST_REQUIRE(check.commit());
+
+        ///hot records come from the cache, deleted keys resolve to nothing
+        uint64_t hits = table.cache().hits();
+        for (int repeat = 0; repeat < 10; repeat++)
+            BOOST_REQUIRE(table.findValueByKey(keys[1].data(), get_new_transaction_ID()) != nullptr);
+        BOOST_REQUIRE(table.cache().hits() >= hits + 9);
+        for (int i = 0; i < numKeys; i += 4)
+        {
+            TxnContext txn;
+            txn.begin();
+            table.deleteByKey(keys[i].data(), txn);
+            BOOST_REQUIRE(txn.commit());
+        }
+        table.GC();
+        TxnContext reread;
+        reread.beginReadOnly();
+        for (int i = 0; i < numKeys; i++)
+            BOOST_REQUIRE((table.findValueByKey(keys[i].data(), reread) == nullptr) == (i % 4 == 0));
+        BOOST_REQUIRE(reread.commit());
+        cout << before.segments << " segments, " << before.appendedBytes << " bytes appended; after GC "
+             << after.segments << " segments, " << after.liveBytes << " live bytes, " << after.relocatedBytes
+             << " bytes relocated, cache " << table.cache().hits() << " hits " << table.cache().misses()
+             << " misses" << endl;
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_tiering_under_memory_budget, TupleTableFixture)
+    {
+        cout << "test_tiering_under_memory_budget" << endl;
+        const std::string dir = "mvcc_tier_test";
+        const std::string checkpointDir = dir + "_checkpoint";
+        const int numKeys = 4096;
+        std::vector<std::array<char, 20>> keys(numKeys);
+        for (int i = 0; i < numKeys; i++)
+            sprintf(keys[i].data(), "%c%05d", 'a' + i % 16, i);
+        load(keys, numKeys);
+        ///the newest visible version, -1 once deleted
+        auto value = [&](int i) {
+            TxnContext txn;
+            txn.beginReadOnly();
+            auto version = table->findValueByKey(keys[i].data(), txn);
+            txn.commit();
+            return version == nullptr ? -1 : version->value.getAttribute<1>();
+        };
+
+        ///a budget nothing fits into evicts every range, the keys stay readable from the runs
+        table->setMemoryBudget(1, dir);
+        table->GC();
+        TierStats evicted = table->tierStats();
+        BOOST_REQUIRE(evicted.evictedRanges == 16);
+        BOOST_REQUIRE(evicted.runRecords == numKeys + 0u);
+        BOOST_REQUIRE(table->art_size() == numKeys + 0u);
+        BOOST_REQUIRE(table->findValueByKey((char*) "a99999", get_new_transaction_ID()) == nullptr);
+        BOOST_REQUIRE(table->findValueByKey((char*) "a00001", get_new_transaction_ID()) == nullptr);
+        TxnContext snapshot;
+        snapshot.beginReadOnly();
+        for (int i = 1; i < numKeys; i++)
+            if (i % 16 == 0)
+                continue;
+            else if (i / 16 % 2 == 0)
+                BOOST_REQUIRE(value(i) == i);
+            else
+            {
+                auto version = table->findValueByKey(keys[i].data(), snapshot);
+                BOOST_REQUIRE(version != nullptr && version->value.getAttribute<2>() == INIT);
+            }
+        BOOST_REQUIRE(snapshot.commit());
+        TierStats read = table->tierStats();
+        BOOST_REQUIRE(read.reloads == 0);
+        BOOST_REQUIRE(read.evictedRanges == 16);
+        BOOST_REQUIRE(read.runReads >= numKeys - numKeys / 16u);
+        BOOST_REQUIRE(read.blockCacheHits > 0);
+
+        ///TIER_RELOAD_READS reads of a range load it back, so does a write or a delete
+        for (int i = 0; i < numKeys; i++)
+            BOOST_REQUIRE(value(i) == i);
+        BOOST_REQUIRE(table->tierStats().evictedRanges == 0);
+        table->GC();
+        BOOST_REQUIRE(table->tierStats().evictedRanges == 16);
+        RecordType updated((unsigned long) 2, -2, UPDATED, 0.0);
+        table->insertOrUpdateByKey(keys[2].data(), updated, get_new_transaction_ID());
+        TxnContext txn;
+        txn.begin();
+        table->deleteByKey(keys[3].data(), txn);
+        BOOST_REQUIRE(txn.commit());
+        BOOST_REQUIRE(table->tierStats().evictedRanges == 14);
+        BOOST_REQUIRE(value(2) == -2 && value(3) == -1 && value(18) == 18 && value(19) == 19);
+
+        ///a full checkpoint covers the runs
+        table->GC();
+        BOOST_REQUIRE(table->tierStats().evictedRanges == 16);
+        CheckpointInfo info = table->checkpoint(checkpointDir, 4, 2);
+        BOOST_REQUIRE(info.records == numKeys - 1u);
+        std::unique_ptr<ARTTupleContainer> recovered(new ARTTupleContainer());
+        recovered->recover(checkpointDir, checkpointDir + "/redo.log", 2);
+        for (int i = 0; i < numKeys; i++)
+        {
+            auto version = recovered->findValueByKey(keys[i].data(), get_new_transaction_ID());
+            BOOST_REQUIRE((version == nullptr) == (i == 3));
+            if (version != nullptr)
+                BOOST_REQUIRE(version->value.getAttribute<1>() == (i == 2 ? -2 : i));
+        }
+
+        ///readers keep going while ranges move out and back in
+        std::atomic<bool> stop(false);
+        std::atomic<int> wrong(0);
+        std::thread reader([&] {
+            for (int i = 0; !stop; i = (i + 7) % numKeys)
+                if (i != 3 && value(i) != (i == 2 ? -2 : i))
+                    wrong++;
+        });
+        for (int round = 0; round < 4; round++)
+        {
+            table->setMemoryBudget(0, dir);
+            table->setMemoryBudget(1, dir);
+            table->GC();
+        }
+        stop = true;
+        reader.join();
+        BOOST_REQUIRE(wrong == 0);
+
+        table->setMemoryBudget(0, dir);
+        TierStats loaded = table->tierStats();
+        BOOST_REQUIRE(loaded.evictedRanges == 0);
+        BOOST_REQUIRE(loaded.evictions >= 16 * 3);
+        for (int i = 0; i < numKeys; i++)
+            BOOST_REQUIRE(value(i) == (i == 3 ? -1 : i == 2 ? -2 : i));
+        cout << loaded.evictions << " evictions, " << loaded.reloads << " reloads, " << loaded.runReads
+             << " run reads, block cache " << loaded.blockCacheHits << " hits " << loaded.blockCacheMisses
+             << " misses" << endl;
+        for (auto& file : info.files)
+            ::unlink((checkpointDir + "/" + file).c_str());
+        ::unlink(Checkpoint::manifestPath(checkpointDir).c_str());
+        ::rmdir(checkpointDir.c_str());
+        ::rmdir(dir.c_str());
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_write_buffer_in_front_of_the_tree, TupleTableFixture)
+    {
+        cout << "test_write_buffer_in_front_of_the_tree" << endl;
+        const std::string dir = "mvcc_write_buffer_test";
+        const std::string logPath = dir + "/redo.log";
+        Checkpoint::createDirectory(dir);
+        ::unlink(logPath.c_str());
+        RedoLog log(logPath);
+        table->setRedoLog(&log);
+        table->enableWriteBuffer(64);
+        const int numKeys = 4096;
+        std::vector<std::array<char, 20>> keys(numKeys);
+        for (int i = 0; i < numKeys; i++)
+            sprintf(keys[i].data(), "%c%05d", 'a' + i % 16, i);
+
+        ///readers find every write as soon as it returned, buffered, being merged or merged
+        std::atomic<int> written(0);
+        std::atomic<bool> stop(false);
+        std::atomic<int> wrong(0);
+        std::thread reader([&] {
+            for (int n = 0; !stop; n++)
+            {
+                int upTo = written.load();
+                if (upTo == 0)
+                    continue;
+                int i = (int) ((n * 7919ull) % upTo);
+                auto version = table->findValueByKey(keys[i].data(), get_new_transaction_ID());
+                if (version == nullptr || version->value.getAttribute<1>() != i)
+                    wrong++;
+            }
+        });
+        for (int i = 0; i < numKeys; i++)
+        {
+            RecordType tuple((unsigned long) i, i, INIT, 0.0);
+            BOOST_REQUIRE(table->insertOrUpdateByKey(keys[i].data(), tuple, get_new_transaction_ID()) == nullptr);
+            written = i + 1;
+        }
+        stop = true;
+        reader.join();
+        BOOST_REQUIRE(wrong == 0);
+        BOOST_REQUIRE(table->writeBufferStats().absorbed == numKeys + 0u);
+
+        ///a snapshot older than a buffered write reads the version below it
+        TxnContext before;
+        before.begin();
+        RecordType overwritten((unsigned long) 1, -1, OVERWRITTEN, 0.0);
+        BOOST_REQUIRE(table->insertOrUpdateByKey(keys[1].data(), overwritten, get_new_transaction_ID()) != nullptr);
+        BOOST_REQUIRE(table->findValueByKey(keys[1].data(), before)->value.getAttribute<1>() == 1);
+        BOOST_REQUIRE(table->findValueByKey(keys[1].data(), get_new_transaction_ID())->value.getAttribute<1>() == -1);
+        BOOST_REQUIRE(before.commit());
+
+        ///writes bypassing the buffer land after the buffered ones of their partition
+        RecordType buffered((unsigned long) 2, -2, OVERWRITTEN, 0.0);
+        table->insertOrUpdateByKey(keys[2].data(), buffered, get_new_transaction_ID());
+        TxnContext txn;
+        txn.begin();
+        RecordType committed((unsigned long) 2, -20, UPDATED, 0.0);
+        table->insertOrUpdateByKey(keys[2].data(), committed, txn);
+        BOOST_REQUIRE(txn.commit());
+        BOOST_REQUIRE(table->findValueByKey(keys[2].data(), get_new_transaction_ID())->value.getAttribute<1>() == -20);
+        RecordType buffered3((unsigned long) 3, -3, OVERWRITTEN, 0.0);
+        table->insertOrUpdateByKey(keys[3].data(), buffered3, get_new_transaction_ID());
+        table->insertOrUpdateByKey(keys[3].data(), [](RecordType& r) {
+            return RecordType(r.getAttribute<0>(), r.getAttribute<1>() * 10, UPDATED, 0.0);
+        }, get_new_transaction_ID());
+        BOOST_REQUIRE(table->findValueByKey(keys[3].data(), get_new_transaction_ID())->value.getAttribute<1>() == -30);
+
+        ///scans and the size see buffered writes
+        RecordType fresh((unsigned long) numKeys, numKeys, INIT, 0.0);
+        char freshKey[] = "q99999";
+        table->insertOrUpdateByKey(freshKey, fresh, get_new_transaction_ID());
+        BOOST_REQUIRE(table->writeBufferStats().buffered > 0);
+        BOOST_REQUIRE(table->art_size() == numKeys + 1u);
+        uint64_t scanned[] = {0, 0};
+        table->iterate([](void* data, const unsigned char*, uint32_t, ARTTupleContainer::const_snapshot_ptr) {
+            ((uint64_t*) data)[0]++;
+            return 0;
+        }, scanned, get_new_transaction_ID());
+        BOOST_REQUIRE(scanned[0] == numKeys + 1u);
+
+        ///buffered writes are logged when they are buffered
+        for (int i = 0; i < numKeys; i += 2)
+        {
+            RecordType tuple((unsigned long) i, i + 1, UPDATED, 0.0);
+            table->insertOrUpdateByKey(keys[i].data(), tuple, get_new_transaction_ID());
+        }
+        log.flush();
+        std::unique_ptr<ARTTupleContainer> recovered(new ARTTupleContainer());
+        recovered->recover(dir, logPath, 2);
+        table->disableWriteBuffer();
+        BOOST_REQUIRE(table->writeBufferStats().buffered == 0);
+        WriteBufferStats stats = table->writeBufferStats();
+        BOOST_REQUIRE(stats.merged == stats.absorbed);
+        BOOST_REQUIRE(stats.batches > 0);
+        for (int i = 0; i < numKeys; i++)
+        {
+            auto expected = table->findValueByKey(keys[i].data(), get_new_transaction_ID());
+            auto version = recovered->findValueByKey(keys[i].data(), get_new_transaction_ID());
+            BOOST_REQUIRE(version != nullptr);
+            BOOST_REQUIRE(version->value.getAttribute<1>() == expected->value.getAttribute<1>());
+            if (i > 3)
+                BOOST_REQUIRE(expected->value.getAttribute<1>() == (i % 2 == 0 ? i + 1 : i));
+        }
+        cout << stats.absorbed << " writes absorbed, " << stats.batches << " batches merged, "
+             << stats.writerBatches << " on writer threads" << endl;
+        table->setRedoLog(nullptr);
+        ::unlink(logPath.c_str());
+        ::rmdir(dir.c_str());
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_finger_on_ascending_keys, TupleTableFixture)
+    {
+        cout << "test_finger_on_ascending_keys" << endl;
+        BOOST_REQUIRE(!table->getFingerCaching());
+        table->setFingerCaching(true);
+        const int numKeys = 16384;
+        std::vector<std::array<char, 20>> keys(numKeys);
+        for (int i = 0; i < numKeys; i++)
+            sprintf(keys[i].data(), "%08d", i);
+        auto value = [&](int i) {
+            auto version = table->findValueByKey(keys[i].data(), get_new_transaction_ID());
+            return version == nullptr ? -1 : version->value.getAttribute<1>();
+        };
+
+        ///the first half arrives sorted, the second nearly sorted: shuffled within windows of 8
+        std::vector<int> order(numKeys);
+        for (int i = 0; i < numKeys; i++)
+            order[i] = i;
+        std::mt19937 rng(43);
+        for (int i = numKeys / 2; i < numKeys; i += 8)
+            std::shuffle(order.begin() + i, order.begin() + i + 8, rng);
+
+        ///a reader without a finger of its own finds every key written so far
+        std::atomic<int> written(0);
+        std::atomic<bool> stop(false);
+        std::atomic<int> wrong(0);
+        std::thread reader([&] {
+            for (int n = 0; !stop; n++)
+            {
+                int upTo = written.load();
+                if (upTo == 0)
+                    continue;
+                int i = (int) ((n * 7919ull) % upTo);
+                if (value(i) != i)
+                    wrong++;
+            }
+        });
+        for (int i = 0; i < numKeys; i++)
+        {
+            RecordType tuple((unsigned long) order[i], order[i], INIT, 0.0);
+            BOOST_REQUIRE(table->insertOrUpdateByKey(keys[order[i]].data(), tuple, get_new_transaction_ID()) == nullptr);
+            if (i < numKeys / 2 || i % 8 == 7)
+                written = i + 1;
+        }
+        stop = true;
+        reader.join();
+        BOOST_REQUIRE(wrong == 0);
+        BOOST_REQUIRE(table->art_size() == numKeys + 0u);
+        FingerStats inserted = table->fingerStats();
+        BOOST_REQUIRE(inserted.insertHits + inserted.insertMisses == numKeys + 0u);
+        ///only inserts that grow a node, or follow one that did, start at the root
+        BOOST_REQUIRE(inserted.insertHits > numKeys * 3u / 4);
+
+        ///ascending lookups start at the finger; keys past the end and absent bytes miss cleanly
+        for (int i = 0; i < numKeys; i++)
+            BOOST_REQUIRE(value(i) == i);
+        BOOST_REQUIRE(table->findValueByKey((char*) "00016384", get_new_transaction_ID()) == nullptr);
+        BOOST_REQUIRE(table->findValueByKey((char*) "0001638", get_new_transaction_ID()) == nullptr);
+        BOOST_REQUIRE(table->findValueByKey((char*) "00016383x", get_new_transaction_ID()) == nullptr);
+        BOOST_REQUIRE(table->fingerStats().lookupHits > 0);
+
+        ///removing keys frees and shrinks nodes under the finger, it is dropped rather than followed
+        for (int i = numKeys - 64; i < numKeys; i++)
+            if (i % 4 != 0)
+                table->deleteByKey(keys[i].data(), get_new_transaction_ID());
+        table->GC();
+        for (int i = numKeys - 64; i < numKeys; i++)
+            BOOST_REQUIRE(value(i) == (i % 4 != 0 ? -1 : i));
+        for (int i = numKeys - 64; i < numKeys; i++)
+        {
+            RecordType tuple((unsigned long) i, -i, UPDATED, 0.0);
+            table->insertOrUpdateByKey(keys[i].data(), tuple, get_new_transaction_ID());
+        }
+        for (int i = numKeys - 128; i < numKeys; i++)
+            BOOST_REQUIRE(value(i) == (i >= numKeys - 64 ? -i : i));
+
+        table->setFingerCaching(false);
+        FingerStats before = table->fingerStats();
+        for (int i = 0; i < numKeys - 128; i++)
+            BOOST_REQUIRE(value(i) == i);
+        BOOST_REQUIRE(table->fingerStats().lookupHits == before.lookupHits);
+        table->setFingerCaching(true);
+
+        ///a second table on the same thread does not follow the first one's finger
+        std::unique_ptr<ARTTupleContainer> other(new ARTTupleContainer());
+        other->setFingerCaching(true);
+        for (int i = 0; i < 64; i++)
+        {
+            RecordType tuple((unsigned long) i, i, INIT, 0.0);
+            other->insertOrUpdateByKey(keys[numKeys - 1 - i].data(), tuple, get_new_transaction_ID());
+        }
+        BOOST_REQUIRE(other->fingerStats().insertHits + other->fingerStats().insertMisses == 64u);
+        BOOST_REQUIRE(value(numKeys - 1) == -(numKeys - 1));
+        BOOST_REQUIRE(other->findValueByKey(keys[numKeys - 65].data(), get_new_transaction_ID()) == nullptr);
+
+        ///splitting a leaf of a long key leaves the key intact
+        char longA[20] = "100000000000001", longB[20] = "100000000000002";
+        RecordType tuple(1ul, 1, INIT, 0.0);
+        other->insertOrUpdateByKey(longA, tuple, get_new_transaction_ID());
+        other->insertOrUpdateByKey(longB, tuple, get_new_transaction_ID());
+        BOOST_REQUIRE(other->findValueByKey(longA, get_new_transaction_ID()) != nullptr);
+        BOOST_REQUIRE(other->findValueByKey(longB, get_new_transaction_ID()) != nullptr);
+        cout << inserted.insertHits << " of " << numKeys << " inserts and " << before.lookupHits
+             << " lookups started at the finger" << endl;
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_partitioned_root, TxnIdFixture)
+    {
+        cout << "test_partitioned_root" << endl;
+        std::unique_ptr<ARTTupleContainer> plain(new ARTTupleContainer());
+        char taken[] = "a0";
+        RecordType first(0ul, 0, INIT, 0.0);
+        plain->insertOrUpdateByKey(taken, first, get_new_transaction_ID());
+        ///only a table without keys is partitioned
+        BOOST_REQUIRE(!plain->partitionRoot(1));
+
+        const int numThreads = 4, perThread = 4096, numKeys = numThreads * perThread;
+        for (int bytes : {1, 2})
+        {
+            std::unique_ptr<ARTTupleContainer> table(new ARTTupleContainer());
+            BOOST_REQUIRE(!table->partitionRoot(3));
+            BOOST_REQUIRE(table->partitionRoot(bytes));
+            BOOST_REQUIRE(table->getRootPartitionBytes() == bytes);
+            BOOST_REQUIRE(table->art_size() == 0u);
+            BOOST_REQUIRE(table->findValueByKey(taken, get_new_transaction_ID()) == nullptr);
+
+            ///each writer owns its root slots; below two bytes they share the first byte and own the second
+            std::vector<std::array<char, 20>> keys(numKeys);
+            for (int w = 0; w < numThreads; w++)
+                for (int i = 0; i < perThread; i++)
+                {
+                    if (bytes == 1)
+                        sprintf(keys[w * perThread + i].data(), "%c%05d", 'a' + w * 4 + i % 4, i);
+                    else
+                        sprintf(keys[w * perThread + i].data(), "%c%c%05d", 'a' + i % 4, 'A' + w, i);
+                }
+            std::atomic<int> written[numThreads];
+            for (auto& count : written)
+                count = 0;
+            std::atomic<bool> stop(false);
+            std::atomic<int> wrong(0);
+            std::thread reader([&] {
+                for (int n = 0; !stop; n++)
+                {
+                    int w = n % numThreads, upTo = written[w].load();
+                    if (upTo == 0)
+                        continue;
+                    int k = w * perThread + (int) ((n * 7919ull) % upTo);
+                    auto version = table->findValueByKey(keys[k].data(), get_new_transaction_ID());
+                    if (version == nullptr || version->value.getAttribute<1>() != k)
+                        wrong++;
+                }
+            });
+            std::vector<std::thread> writers;
+            for (int w = 0; w < numThreads; w++)
+                writers.emplace_back([&, w] {
+                    for (int i = 0; i < perThread; i++)
+                    {
+                        int k = w * perThread + i;
+                        RecordType tuple((unsigned long) k, k, INIT, 0.0);
+                        table->insertOrUpdateByKey(keys[k].data(), tuple, get_new_transaction_ID());
+                        written[w] = i + 1;
+                    }
+                });
+            for (auto& writer : writers)
+                writer.join();
+            stop = true;
+            reader.join();
+            BOOST_REQUIRE(wrong == 0);
+            BOOST_REQUIRE(table->art_size() == numKeys + 0u);
+            for (int k = 0; k < numKeys; k++)
+                BOOST_REQUIRE(table->findValueByKey(keys[k].data(), get_new_transaction_ID())->value.getAttribute<1>() == k);
+
+            ///scans cross the slots in key order
+            struct Scan
+            {
+                std::string last;
+                uint64_t keys = 0;
+                bool sorted = true;
+            } scan;
+            table->iterate([](void* data, const unsigned char* key, uint32_t keyLen, ARTTupleContainer::const_snapshot_ptr) {
+                Scan* s = (Scan*) data;
+                std::string k((const char*) key, keyLen);
+                s->sorted = s->sorted && (s->keys == 0 || s->last < k);
+                s->last = k;
+                s->keys++;
+                return 0;
+            }, &scan, get_new_transaction_ID());
+            BOOST_REQUIRE(scan.keys == numKeys + 0u);
+            BOOST_REQUIRE(scan.sorted);
+
+            ///removed leaves leave the pinned nodes in place
+            for (int k = 0; k < numKeys; k += 3)
+                table->deleteByKey(keys[k].data(), get_new_transaction_ID());
+            ///a cycle stops at its budget, the rest of the deleted keys waits for the next one
+            for (int cycle = 0; cycle < 100 && table->backlog() > 0; cycle++)
+                table->GC();
+            BOOST_REQUIRE(table->backlog() == 0u);
+            for (int k = 0; k < numKeys; k++)
+            {
+                auto version = table->findValueByKey(keys[k].data(), get_new_transaction_ID());
+                BOOST_REQUIRE(k % 3 == 0 ? version == nullptr : version->value.getAttribute<1>() == k);
+            }
+            for (int k = 0; k < numKeys; k += 3)
+            {
+                RecordType tuple((unsigned long) k, -k, UPDATED, 0.0);
+                BOOST_REQUIRE(table->insertOrUpdateByKey(keys[k].data(), tuple, get_new_transaction_ID()) == nullptr);
+                BOOST_REQUIRE(table->findValueByKey(keys[k].data(), get_new_transaction_ID())->value.getAttribute<1>() == -k);
+            }
+        }
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_flat_combining, TxnIdFixture)
+    {
+        cout << "test_flat_combining" << endl;
+        ///every writer adds leaves to the same few nodes below "hot", interleaved with the others
+        const int numThreads = 8, perThread = 2048, numKeys = numThreads * perThread;
+        std::vector<std::array<char, 20>> keys(numKeys);
+        for (int i = 0; i < perThread; i++)
+            for (int w = 0; w < numThreads; w++)
+                sprintf(keys[w * perThread + i].data(), "hot%c%c%04d", 'A' + i % 48, 'a' + w, i);
+        for (bool combining : {true, false})
+        {
+            std::unique_ptr<ARTTupleContainer> table(new ARTTupleContainer());
+            BOOST_REQUIRE(!table->getCombining());
+            table->setCombining(combining);
+            BOOST_REQUIRE(table->getCombining() == combining);
+            std::vector<std::thread> writers;
+            for (int w = 0; w < numThreads; w++)
+                writers.emplace_back([&, w] {
+                    for (int i = 0; i < perThread; i++)
+                    {
+                        int k = w * perThread + i;
+                        RecordType tuple((unsigned long) k, k, INIT, 0.0);
+                        table->insertOrUpdateByKey(keys[k].data(), tuple, get_new_transaction_ID());
+                    }
+                });
+            for (auto& writer : writers)
+                writer.join();
+            BOOST_REQUIRE(table->art_size() == numKeys + 0u);
+            for (int k = 0; k < numKeys; k++)
+                BOOST_REQUIRE(table->findValueByKey(keys[k].data(), get_new_transaction_ID())->value.getAttribute<1>() == k);
+
+            ContentionStats stats = table->contentionStats();
+            cout << "combining " << combining << ": conflicts " << stats.conflicts << ", restarts " << stats.restarts
+                 << ", published " << stats.published << ", combined " << stats.combined << endl;
+            BOOST_REQUIRE(stats.combined <= stats.published);
+            if (!combining)
+                BOOST_REQUIRE(stats.published == 0u && stats.hotNodes == 0u);
+        }
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_flat_combining_on_held_node, TupleTableFixture)
+    {
+        cout << "test_flat_combining_on_held_node" << endl;
+        ///a root node16 with room for the three inserts published on it
+        const int numKeys = 8, loaded = 5, numThreads = numKeys - loaded;
+        std::vector<std::array<char, 20>> keys(numKeys);
+        for (int i = 0; i < numKeys; i++)
+            sprintf(keys[i].data(), "%c1", 'a' + i);
+        load(keys, loaded);
+        table->setCombining(true);
+
+        ///the holder keeps the root locked until every writer was added by it
+        std::atomic<int> finished(0);
+        std::vector<std::thread> writers;
+        size_t combined = table->holdNode(keys[loaded].data(), [&] {
+            if (writers.empty())
+                for (int k = loaded; k < numKeys; k++)
+                    writers.emplace_back([&, k] {
+                        RecordType tuple((unsigned long) k, k, INIT, 0.0);
+                        table->insertOrUpdateByKey(keys[k].data(), tuple, get_new_transaction_ID());
+                        finished++;
+                    });
+            return finished.load() == numThreads;
+        });
+        for (auto& writer : writers)
+            writer.join();
+        BOOST_REQUIRE(combined == numThreads + 0u);
+
+        ContentionStats stats = table->contentionStats();
+        BOOST_REQUIRE(stats.combined == numThreads + 0u && stats.published >= numThreads + 0u);
+        BOOST_REQUIRE(stats.pending == 0u);
+        BOOST_REQUIRE(table->art_size() == numKeys + 0u);
+        for (int k = 0; k < numKeys; k++)
+            BOOST_REQUIRE(table->findValueByKey(keys[k].data(), get_new_transaction_ID())->value.getAttribute<1>() == k);
+
+        ///a node that cooled down gives its list up to the next holder
+        std::this_thread::sleep_for(std::chrono::microseconds(2 * ART_COMBINING_WINDOW_US));
+        BOOST_REQUIRE(table->holdNode(keys[loaded].data(), [] { return true; }) == 0u);
+        stats = table->contentionStats();
+        BOOST_REQUIRE(stats.hotNodes == 0u && stats.pending == 0u);
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_adaptive_latching, TxnIdFixture)
+    {
+        cout << "test_adaptive_latching" << endl;
+        ///writers keep adding leaves below "hot" while readers look up what they wrote so far
+        const int numThreads = 4, perThread = 4096, numKeys = numThreads * perThread;
+        std::vector<std::array<char, 20>> keys(numKeys);
+        for (int w = 0; w < numThreads; w++)
+            for (int i = 0; i < perThread; i++)
+                sprintf(keys[w * perThread + i].data(), "hot%c%c%04d", 'A' + i % 48, 'a' + w, i);
+        for (bool latching : {true, false})
+        {
+            std::unique_ptr<ARTTupleContainer> table(new ARTTupleContainer());
+            BOOST_REQUIRE(!table->getAdaptiveLatching());
+            table->setAdaptiveLatching(latching);
+            BOOST_REQUIRE(table->getAdaptiveLatching() == latching);
+            std::atomic<int> written[numThreads];
+            for (auto& count : written)
+                count = 0;
+            std::atomic<bool> stop(false);
+            std::atomic<int> wrong(0);
+            std::vector<std::thread> readers;
+            for (int r = 0; r < 2; r++)
+                readers.emplace_back([&, r] {
+                    for (int n = r; !stop; n++)
+                    {
+                        int w = n % numThreads, upTo = written[w].load();
+                        if (upTo == 0)
+                            continue;
+                        int k = w * perThread + (int) ((n * 7919ull) % upTo);
+                        auto version = table->findValueByKey(keys[k].data(), get_new_transaction_ID());
+                        if (version == nullptr || version->value.getAttribute<1>() != k)
+                            wrong++;
+                    }
+                });
+            std::vector<std::thread> writers;
+            for (int w = 0; w < numThreads; w++)
+                writers.emplace_back([&, w] {
+                    for (int i = 0; i < perThread; i++)
+                    {
+                        int k = w * perThread + i;
+                        RecordType tuple((unsigned long) k, k, INIT, 0.0);
+                        table->insertOrUpdateByKey(keys[k].data(), tuple, get_new_transaction_ID());
+                        written[w] = i + 1;
+                    }
+                });
+            for (auto& writer : writers)
+                writer.join();
+            stop = true;
+            for (auto& reader : readers)
+                reader.join();
+            BOOST_REQUIRE(wrong == 0);
+            BOOST_REQUIRE(table->art_size() == numKeys + 0u);
+            for (int k = 0; k < numKeys; k++)
+                BOOST_REQUIRE(table->findValueByKey(keys[k].data(), get_new_transaction_ID())->value.getAttribute<1>() == k);
+
+            ContentionStats stats = table->contentionStats();
+            cout << "latching " << latching << ": read restarts " << stats.readRestarts << ", conflicts "
+                 << stats.conflicts << ", latch waits " << stats.latchWaits << endl;
+            if (!latching)
+                BOOST_REQUIRE(stats.latchWaits == 0u && stats.latchedNodes == 0u);
+        }
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_adaptive_latching_on_held_node, TupleTableFixture)
+    {
+        cout << "test_adaptive_latching_on_held_node" << endl;
+        const int numKeys = 5;
+        std::vector<std::array<char, 20>> keys(numKeys);
+        for (int i = 0; i < numKeys; i++)
+            sprintf(keys[i].data(), "%c1", 'a' + i);
+        load(keys, numKeys);
+        table->setAdaptiveLatching(true);
+        auto lookup = [&](int k) {
+            auto version = table->findValueByKey(keys[k].data(), get_new_transaction_ID());
+            return version != nullptr && version->value.getAttribute<1>() == k;
+        };
+
+        ///lookups restart at the held root until it is latched; the holder took it unlatched, nobody waits
+        std::atomic<bool> stop(false);
+        std::atomic<int> wrong(0);
+        std::unique_ptr<std::thread> reader;
+        table->holdNode(keys[0].data(), [&] {
+            if (!reader)
+                reader.reset(new std::thread([&] {
+                    for (int i = 0; !stop.load(); i++)
+                        wrong += !lookup(i % numKeys);
+                }));
+            return table->contentionStats().latchedNodes == 1u;
+        });
+        ContentionStats latched = table->contentionStats();
+        BOOST_REQUIRE(latched.readRestarts >= ART_LATCH_THRESHOLD && latched.latchWaits == 0u);
+
+        ///a holder of the latched root holds its latch too, lookups wait on it instead of restarting
+        table->holdNode(keys[0].data(), [&] {
+            return table->contentionStats().latchWaits > 0u;
+        });
+        stop = true;
+        reader->join();
+        BOOST_REQUIRE(wrong.load() == 0);
+        ContentionStats waited = table->contentionStats();
+        BOOST_REQUIRE(waited.latchWaits > 0u);
+
+        ///calm for ART_LATCH_CALM_US, the root is unlatched and a lookup at it restarts optimistically again
+        std::this_thread::sleep_for(std::chrono::microseconds(2 * ART_LATCH_CALM_US));
+        BOOST_REQUIRE(table->contentionStats().latchedNodes == 0u);
+        std::atomic<bool> found(false), looked(false);
+        reader.reset();
+        table->holdNode(keys[0].data(), [&] {
+            if (!reader)
+                reader.reset(new std::thread([&] {
+                    found = lookup(1);
+                    looked = true;
+                }));
+            return looked.load();
+        });
+        reader->join();
+        ContentionStats calm = table->contentionStats();
+        BOOST_REQUIRE(found.load());
+        BOOST_REQUIRE(calm.latchWaits == waited.latchWaits && calm.readRestarts > waited.readRestarts);
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_read_cache_under_deletes_and_gc, TupleTableFixture)
+    {
+        cout << "test_read_cache_under_deletes_and_gc" << endl;
+        BOOST_REQUIRE(!table->getReadCaching());
+        table->setReadCaching(true);
+        const int numKeys = 4096;
+        std::vector<std::array<char, 20>> keys(numKeys);
+        for (int i = 0; i < numKeys; i++)
+            sprintf(keys[i].data(), "key%06d", i);
+        load(keys, numKeys);
+        auto value = [&](int i) {
+            auto version = table->findValueByKey(keys[i].data(), get_new_transaction_ID());
+            return version == nullptr ? -1 : version->value.getAttribute<1>();
+        };
+
+        ///the second round of lookups of the hot keys is answered from the cache, updates included
+        for (int round = 0; round < 2; round++)
+            for (int i = 0; i < 64; i++)
+                BOOST_REQUIRE(value(i) == i);
+        ReadCacheStats warm = table->readCacheStats();
+        BOOST_REQUIRE(warm.hits >= 64u);
+        RecordType updated(0ul, -1000, UPDATED, 0.0);
+        table->insertOrUpdateByKey(keys[0].data(), updated, get_new_transaction_ID());
+        BOOST_REQUIRE(value(0) == -1000);
+        BOOST_REQUIRE(table->readCacheStats().hits == warm.hits + 1);
+
+        ///leaves GC() frees are not followed, a re-inserted key is found at its new leaf
+        for (int i = 0; i < 64; i += 2)
+            table->deleteByKey(keys[i].data(), get_new_transaction_ID());
+        table->GC();
+        for (int i = 0; i < 64; i++)
+            BOOST_REQUIRE(value(i) == (i % 2 == 0 ? -1 : i));
+        BOOST_REQUIRE(table->readCacheStats().stale > 0u);
+        for (int i = 0; i < 64; i += 2)
+        {
+            RecordType tuple((unsigned long) i, -i, UPDATED, 0.0);
+            table->insertOrUpdateByKey(keys[i].data(), tuple, get_new_transaction_ID());
+        }
+        for (int i = 0; i < 64; i++)
+            BOOST_REQUIRE(value(i) == (i % 2 == 0 ? -i : i));
+
+        ///readers hammer a hot set while a writer deletes and re-inserts half of it and GC() runs
+        ///beside the lookups; freed leaves wait for the lookups that may hold them, entries must not follow them
+        std::atomic<bool> stop(false);
+        std::atomic<int> wrong(0);
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 3; r++)
+            readers.emplace_back([&, r] {
+                for (int n = r; !stop; n++)
+                {
+                    int i = (int) ((n * 7919ull) % 256);
+                    int v = value(i);
+                    if (v != -1 && v != i && v != -i)
+                        wrong++;
+                    if (i % 2 == 1 && v != i)
+                        wrong++;
+                }
+            });
+        for (int round = 0; round < 20; round++)
+        {
+            for (int i = 0; i < 256; i += 2)
+                table->deleteByKey(keys[i].data(), get_new_transaction_ID());
+            table->GC();
+            for (int i = 0; i < 256; i += 2)
+            {
+                RecordType tuple((unsigned long) i, round % 2 == 0 ? i : -i, UPDATED, 0.0);
+                table->insertOrUpdateByKey(keys[i].data(), tuple, get_new_transaction_ID());
+            }
+        }
+        stop = true;
+        for (auto& reader : readers)
+            reader.join();
+        BOOST_REQUIRE(wrong == 0);
+        BOOST_REQUIRE(table->art_size() == numKeys + 0u);
+
+        ///off, lookups go to the tree only
+        table->setReadCaching(false);
+        ReadCacheStats before = table->readCacheStats();
+        for (int i = 256; i < numKeys; i++)
+            BOOST_REQUIRE(value(i) == i);
+        BOOST_REQUIRE(table->readCacheStats().hits == before.hits);
+        BOOST_REQUIRE(table->readCacheStats().misses == before.misses);
+        cout << warm.hits << " hits warm, " << before.hits << " hits, " << before.misses << " misses, "
+             << before.stale << " stale" << endl;
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_hash_index_next_to_the_tree, TupleTableFixture)
+    {
+        cout << "test_hash_index_next_to_the_tree" << endl;
+        const int numThreads = 4, perThread = 8192, numKeys = numThreads * perThread;
+        std::vector<std::array<char, 20>> keys(numKeys);
+        for (int k = 0; k < numKeys; k++)
+            sprintf(keys[k].data(), "idx%c%06d", 'a' + k % numThreads, k);
+        auto value = [&](int k) {
+            auto version = table->findValueByKey(keys[k].data(), get_new_transaction_ID());
+            return version == nullptr ? -1 : version->value.getAttribute<1>();
+        };
+
+        ///keys already in the tree are indexed when the index is enabled
+        load(keys, 1000);
+        BOOST_REQUIRE(!table->hasHashIndex());
+        BOOST_REQUIRE(table->enableHashIndex(16));
+        BOOST_REQUIRE(table->hasHashIndex());
+        BOOST_REQUIRE(table->hashIndexStats().entries == 1000u);
+
+        ///writers grow the index from 16 slots while readers look up what they wrote so far
+        std::atomic<int> written[numThreads];
+        for (auto& count : written)
+            count = 0;
+        std::atomic<bool> stop(false);
+        std::atomic<int> wrong(0);
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 2; r++)
+            readers.emplace_back([&, r] {
+                for (int n = r; !stop; n++)
+                {
+                    int w = n % numThreads, upTo = written[w].load();
+                    if (upTo == 0)
+                        continue;
+                    int k = (int) ((n * 7919ull) % upTo) * numThreads + w;
+                    if (k >= 1000 && value(k) != k)
+                        wrong++;
+                }
+            });
+        std::vector<std::thread> writers;
+        for (int w = 0; w < numThreads; w++)
+            writers.emplace_back([&, w] {
+                for (int i = 0; i < perThread; i++)
+                {
+                    int k = i * numThreads + w;
+                    if (k >= 1000)
+                    {
+                        RecordType tuple((unsigned long) k, k, INIT, 0.0);
+                        table->insertOrUpdateByKey(keys[k].data(), tuple, get_new_transaction_ID());
+                    }
+                    written[w] = i + 1;
+                }
+            });
+        for (auto& writer : writers)
+            writer.join();
+        stop = true;
+        for (auto& reader : readers)
+            reader.join();
+        BOOST_REQUIRE(wrong == 0);
+        HashIndexStats grown = table->hashIndexStats();
+        BOOST_REQUIRE(grown.entries == numKeys + 0u);
+        BOOST_REQUIRE(grown.resizes > 0u);
+        BOOST_REQUIRE(grown.capacity >= numKeys * 2u);
+        for (int k = 0; k < numKeys; k++)
+            BOOST_REQUIRE(value(k) == k);
+        char absent[20] = "idxa999999", prefix[20] = "idxa";
+        BOOST_REQUIRE(table->findValueByKey(absent, get_new_transaction_ID()) == nullptr);
+        BOOST_REQUIRE(table->findValueByKey(prefix, get_new_transaction_ID()) == nullptr);
+
+        ///updates keep their leaf; leaves GC() frees leave the index, re-inserted keys come back
+        RecordType updated(0ul, -1, UPDATED, 0.0);
+        table->insertOrUpdateByKey(keys[0].data(), updated, get_new_transaction_ID());
+        BOOST_REQUIRE(value(0) == -1);
+        for (int k = 1; k < numKeys; k += 3)
+            table->deleteByKey(keys[k].data(), get_new_transaction_ID());
+        ///a cycle stops at its budget, the rest of the deleted keys waits for the next one
+        for (int cycle = 0; cycle < 100 && table->backlog() > 0; cycle++)
+            table->GC();
+        BOOST_REQUIRE(table->backlog() == 0u);
+        BOOST_REQUIRE(table->hashIndexStats().entries == table->art_size());
+        for (int k = 1; k < numKeys; k += 3)
+        {
+            BOOST_REQUIRE(value(k) == -1);
+            RecordType tuple((unsigned long) k, -k, UPDATED, 0.0);
+            table->insertOrUpdateByKey(keys[k].data(), tuple, get_new_transaction_ID());
+        }
+        for (int k = 1; k < numKeys; k++)
+            BOOST_REQUIRE(value(k) == (k % 3 == 1 ? -k : k));
+        BOOST_REQUIRE(table->hashIndexStats().entries == numKeys + 0u);
+
+        ///scans still walk the tree in key order
+        struct Scan
+        {
+            std::string last;
+            uint64_t keys = 0;
+            bool sorted = true;
+        } scan;
+        table->iterate([](void* data, const unsigned char* key, uint32_t keyLen, ARTTupleContainer::const_snapshot_ptr) {
+            Scan* s = (Scan*) data;
+            std::string k((const char*) key, keyLen);
+            s->sorted = s->sorted && (s->keys == 0 || s->last < k);
+            s->last = k;
+            s->keys++;
+            return 0;
+        }, &scan, get_new_transaction_ID());
+        BOOST_REQUIRE(scan.keys == numKeys + 0u);
+        BOOST_REQUIRE(scan.sorted);
+
+        table->disableHashIndex();
+        BOOST_REQUIRE(table->hashIndexStats().entries == 0u);
+        for (int k = 1; k < numKeys; k++)
+            BOOST_REQUIRE(value(k) == (k % 3 == 1 ? -k : k));
+        cout << grown.entries << " keys in " << grown.capacity << " slots, " << grown.bytes << " bytes, "
+             << grown.resizes << " resizes" << endl;
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_leaf_fingerprints, TupleTableFixture)
+    {
+        cout << "test_leaf_fingerprints" << endl;
+        const int numKeys = 20000;
+        std::vector<std::array<char, 20>> keys(numKeys), absent(numKeys);
+        for (int k = 0; k < numKeys; k++)
+        {
+            sprintf(keys[k].data(), "fp%06dx", k);
+            ///same path as the key down to its leaf, only the last byte differs
+            sprintf(absent[k].data(), "fp%06dy", k);
+        }
+        BOOST_REQUIRE(!table->getLeafFingerprints());
+        table->setLeafFingerprints(true);
+        BOOST_REQUIRE(table->getLeafFingerprints() == table->leafFingerprintsAvailable());
+        load(keys, numKeys);
+        auto value = [&](char* key) {
+            auto version = table->findValueByKey(key, get_new_transaction_ID());
+            return version == nullptr ? -1 : version->value.getAttribute<1>();
+        };
+        ///every step-th key is deleted, none for step 0
+        auto check = [&](int step) {
+            for (int k = 0; k < numKeys; k++)
+            {
+                BOOST_REQUIRE(value(keys[k].data()) == (step > 0 && k % step == 0 ? -1 : k));
+                BOOST_REQUIRE(value(absent[k].data()) == -1);
+            }
+            ///batched lookups check the fingerprints as well
+            std::vector<char*> batch;
+            for (int k = 0; k < numKeys; k++)
+            {
+                batch.push_back(keys[k].data());
+                batch.push_back(absent[k].data());
+            }
+            std::vector<ARTTupleContainer::const_snapshot_ptr> results(batch.size());
+            size_t found = table->findValuesByKeys(batch.data(), batch.size(), results.data(), get_new_transaction_ID());
+            BOOST_REQUIRE(found == numKeys - (step > 0 ? (numKeys + step - 1u) / step : 0u));
+            for (size_t i = 0; i < batch.size(); i++)
+                BOOST_REQUIRE((results[i] != nullptr) == (i % 2 == 0 && (step == 0 || (i / 2) % step != 0)));
+        };
+
+        ///absent keys end at the leaf of their neighbour, all but one in 256 are turned away by its fingerprint
+        uint64_t before = table->fingerprintRejects();
+        check(0);
+        uint64_t rejected = table->fingerprintRejects() - before;
+        if (table->leafFingerprintsAvailable())
+            BOOST_REQUIRE(rejected > numKeys * 2 * 9 / 10u && rejected <= numKeys * 2u);
+        else
+            BOOST_REQUIRE(rejected == 0u);
+
+        ///grown and split nodes move the tagged pointers along, GC unlinks them
+        for (int k = 0; k < numKeys; k += 7)
+            table->deleteByKey(keys[k].data(), get_new_transaction_ID());
+        for (int cycle = 0; cycle < 100 && table->backlog() > 0; cycle++)
+            table->GC();
+        BOOST_REQUIRE(table->backlog() == 0u);
+        check(7);
+
+        ///without the comparison the answers are the same, only the leaves are read
+        table->setLeafFingerprints(false);
+        BOOST_REQUIRE(!table->getLeafFingerprints());
+        before = table->fingerprintRejects();
+        check(7);
+        BOOST_REQUIRE(table->fingerprintRejects() == before);
+        table->setLeafFingerprints(true);
+
+        struct Scan
+        {
+            uint64_t keys = 0;
+            bool intact = true;
+        } scan;
+        table->iterate([](void* data, const unsigned char* key, uint32_t keyLen, ARTTupleContainer::const_snapshot_ptr) {
+            Scan* s = (Scan*) data;
+            s->intact = s->intact && std::string((const char*) key, keyLen).find('x') != std::string::npos;
+            s->keys++;
+            return 0;
+        }, &scan, get_new_transaction_ID());
+        BOOST_REQUIRE(scan.keys == numKeys - (numKeys + 6u) / 7);
+        BOOST_REQUIRE(scan.intact);
+        cout << rejected << " of " << numKeys * 2 << " lookups rejected by a fingerprint" << endl;
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_leaf_suffixes, TxnIdFixture)
+    {
+        cout << "test_leaf_suffixes" << endl;
+        const int numUrls = 6000, numShort = 2000;
+        ///long shared prefixes become node chains, short keys can be prefixes of others
+        std::vector<std::string> keys;
+        for (int k = 0; k < numUrls; k++)
+        {
+            char url[96];
+            sprintf(url, "https://www.%s.com/catalog/category-%02d/item-%05d", k % 3 ? "shop" : "store", k % 17, k);
+            keys.push_back(url);
+        }
+        for (int k = 0; k < numShort; k++)
+        {
+            char key[20];
+            sprintf(key, k % 10 == 0 ? "s/%d" : "s/%04d", k);
+            keys.push_back(key);
+        }
+        std::vector<std::string> sorted(keys);
+        std::sort(sorted.begin(), sorted.end());
+        sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+        struct Scan
+        {
+            std::vector<std::string> keys;
+        };
+        auto collect = [](void* data, const unsigned char* key, uint32_t keyLen, ARTTupleContainer::const_snapshot_ptr) {
+            ((Scan*) data)->keys.emplace_back((const char*) key, keyLen);
+            return 0;
+        };
+        ///the same operations on a table with whole keys and one with suffixes
+        auto run = [&](bool suffixes, uint64_t& footprint) {
+            std::unique_ptr<ARTTupleContainer> table(new ARTTupleContainer());
+            BOOST_REQUIRE(table->setLeafSuffixes(suffixes));
+            ///reloads insert below long prefixes, where a lookup must not leave a finger
+            table->setFingerCaching(true);
+            BOOST_REQUIRE(table->getLeafSuffixes() == suffixes);
+            auto value = [&](const std::string& key) {
+                auto version = table->findValueByKey((char*) key.c_str(), get_new_transaction_ID());
+                return version == nullptr ? -1 : version->value.getAttribute<1>();
+            };
+            for (size_t k = 0; k < keys.size(); k++)
+            {
+                RecordType tuple((unsigned long) k, (int) k, INIT, 0.0);
+                table->insertOrUpdateByKey((char*) keys[k].c_str(), tuple, get_new_transaction_ID());
+            }
+            BOOST_REQUIRE(!table->setLeafSuffixes(!suffixes));
+            BOOST_REQUIRE(table->getLeafSuffixes() == suffixes);
+            footprint = table->estimatedFootprint();
+            for (size_t k = 0; k < keys.size(); k++)
+                BOOST_REQUIRE(value(keys[k]) == (int) k);
+            for (const char* absent : {"https://www.shop.com/catalog/category-01/item-9", "https://www.shop.com/",
+                                       "https://www.shop.com/catalog/category-01/item-000011", "s/", "s/99999", "t"})
+                BOOST_REQUIRE(value(absent) == -1);
+
+            ///scans hand out whole keys in order
+            Scan all;
+            table->iterate(collect, &all, get_new_transaction_ID());
+            BOOST_REQUIRE(all.keys == sorted);
+            Scan prefixed;
+            std::string prefix = "https://www.store.com/catalog/category-03/";
+            table->art_iter_prefix((const unsigned char*) prefix.data(), prefix.size(), collect, &prefixed,
+                                   get_new_transaction_ID());
+            size_t expected = 0;
+            for (const std::string& key : sorted)
+                expected += key.compare(0, prefix.size(), prefix) == 0;
+            BOOST_REQUIRE(prefixed.keys.size() == expected && expected > 0);
+            for (const std::string& key : prefixed.keys)
+                BOOST_REQUIRE(key.compare(0, prefix.size(), prefix) == 0);
+
+            ///updates, deletes GC() unlinks and re-inserted keys
+            RecordType updated(0ul, -5, UPDATED, 0.0);
+            table->insertOrUpdateByKey((char*) keys[5].c_str(), updated, get_new_transaction_ID());
+            BOOST_REQUIRE(value(keys[5]) == -5);
+            for (int k = numUrls; k < numUrls + numShort; k += 3)
+                table->deleteByKey((char*) keys[k].c_str(), get_new_transaction_ID());
+            for (int cycle = 0; cycle < 100 && table->backlog() > 0; cycle++)
+                table->GC();
+            BOOST_REQUIRE(table->backlog() == 0u);
+            BOOST_REQUIRE(table->art_size() == keys.size() - (numShort + 2u) / 3);
+            for (int k = numUrls; k < numUrls + numShort; k++)
+                BOOST_REQUIRE(value(keys[k]) == ((k - numUrls) % 3 == 0 ? -1 : k));
+            for (int k = numUrls; k < numUrls + numShort; k += 3)
+            {
+                RecordType tuple((unsigned long) k, k, INIT, 0.0);
+                table->insertOrUpdateByKey((char*) keys[k].c_str(), tuple, get_new_transaction_ID());
+            }
+            Scan again;
+            table->iterate(collect, &again, get_new_transaction_ID());
+            BOOST_REQUIRE(again.keys == sorted);
+
+            ///a checkpoint writes whole keys, recovering into either mode gives the same table
+            std::string dir = suffixes ? "leaf_suffixes_checkpoint" : "leaf_suffixes_checkpoint_full";
+            CheckpointInfo info = table->checkpoint(dir, 4, 2);
+            BOOST_REQUIRE(info.records == keys.size());
+            std::unique_ptr<ARTTupleContainer> recovered(new ARTTupleContainer());
+            BOOST_REQUIRE(recovered->setLeafSuffixes(!suffixes));
+            recovered->recover(dir, dir + "/redo.log", 2);
+            Scan restored;
+            recovered->iterate(collect, &restored, get_new_transaction_ID());
+            BOOST_REQUIRE(restored.keys == sorted);
+            auto version = recovered->findValueByKey((char*) keys[5].c_str(), get_new_transaction_ID());
+            BOOST_REQUIRE(version != nullptr && version->value.getAttribute<1>() == -5);
+
+            ///evicted ranges are written with whole keys and come back the same
+            recovered.reset(new ARTTupleContainer());
+            BOOST_REQUIRE(recovered->setLeafSuffixes(suffixes));
+            recovered->recover(dir, dir + "/redo.log", 2);
+            recovered->setMemoryBudget(1, dir + "/tier");
+            recovered->GC();
+            BOOST_REQUIRE(recovered->tierStats().evictedRanges == 2u);
+            version = recovered->findValueByKey((char*) keys[7].c_str(), get_new_transaction_ID());
+            BOOST_REQUIRE(version != nullptr && version->value.getAttribute<1>() == 7);
+            recovered->setMemoryBudget(0, dir + "/tier");
+            Scan reloaded;
+            recovered->iterate(collect, &reloaded, get_new_transaction_ID());
+            BOOST_REQUIRE(reloaded.keys == sorted);
+            return table;
+        };
+
+        uint64_t whole = 0, suffix = 0;
+        auto full = run(false, whole);
+        auto table = run(true, suffix);
+        BOOST_REQUIRE(suffix < whole);
+
+        ///the hash index needs whole keys in the leaves
+        BOOST_REQUIRE(!table->enableHashIndex());
+        BOOST_REQUIRE(!table->hasHashIndex());
+        BOOST_REQUIRE(full->enableHashIndex());
+        BOOST_REQUIRE(full->hasHashIndex());
+        cout << keys.size() << " keys in " << whole << " bytes with whole keys, " << suffix
+             << " with suffixes" << endl;
+    }
+
+    BOOST_FIXTURE_TEST_CASE(test_hash_index_refused_with_leaf_suffixes, TxnIdFixture)
+    {
+        cout << "test_hash_index_refused_with_leaf_suffixes" << endl;
+        ///suffix mode first: the index is refused and lookups walk the tree
+        ARTTupleContainer suffixes;
+        BOOST_REQUIRE(suffixes.setLeafSuffixes(true));
+        BOOST_REQUIRE(!suffixes.enableHashIndex());
+        BOOST_REQUIRE(!suffixes.hasHashIndex());
+        char keys[100][20];
+        for (int k = 0; k < 100; k++)
+        {
+            sprintf(keys[k], "suffix%03d", k);
+            RecordType tuple((unsigned long) k, k, INIT, 0.0);
+            suffixes.insertOrUpdateByKey(keys[k], tuple, get_new_transaction_ID());
+        }
+        BOOST_REQUIRE(!suffixes.enableHashIndex());
+        BOOST_REQUIRE(suffixes.hashIndexStats().entries == 0u);
+        for (int k = 0; k < 100; k++)
+        {
+            auto version = suffixes.findValueByKey(keys[k], get_new_transaction_ID());
+            BOOST_REQUIRE(version != nullptr && version->value.getAttribute<1>() == k);
+        }
+
+        ///index first: suffix mode is refused, a second index too
+        ARTTupleContainer indexed;
+        BOOST_REQUIRE(indexed.enableHashIndex());
+        BOOST_REQUIRE(!indexed.enableHashIndex());
+        BOOST_REQUIRE(!indexed.setLeafSuffixes(true));
+        BOOST_REQUIRE(!indexed.getLeafSuffixes());
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,229 @@
+//
+// Created by Players Inc on 19/10/2026.
+//
+
+#ifndef MVCCART_ACTIVETXNREGISTRY_HPP
+#define MVCCART_ACTIVETXNREGISTRY_HPP
+
+#include <atomic>
+#include <algorithm>
+#include <functional>
+#include <stdint.h>
+#include <thread>
+#include "TransactionClock.hpp"
+
+/// Transactions that can be active at the same time
+#ifndef ACTIVE_TXN_REGISTRY_SLOTS
+#define ACTIVE_TXN_REGISTRY_SLOTS 1024
+#endif
+
+
+/**
+ * Lock-free registry of the begin timestamps of running transactions.
+ * Every transaction owns one cache-line sized slot. Each thread is assigned
+ * a slot of its own once, parked while it runs no transaction, so enter and
+ * leave are plain stores on a private cache line; a transaction nested in
+ * another one on the same thread claims a free slot by CAS instead. The
+ * slot of a thread that exited is handed to the next new thread.
+ * lowWatermark() is one load of the cached minimum: no version ending at
+ * or below it is visible to any running or future transaction.
+ * refreshLowWatermark() recomputes it by scanning the slots in use and is
+ * meant for the GC side, never for transaction threads.
+ */
+class ActiveTxnRegistry
+{
+    static constexpr uint64_t Empty = MVCC11_INF_VERSION;
+    ///slot claimed, begin timestamp not read yet
+    static constexpr uint64_t Entering = MVCC11_INF_VERSION - 1;
+    ///slot assigned to a thread that runs no transaction in it now
+    static constexpr uint64_t Parked = MVCC11_INF_VERSION - 2;
+    ///at most half of the slots are assigned, the rest stay free for claim()
+    static constexpr size_t AssignableSlots = ACTIVE_TXN_REGISTRY_SLOTS / 2;
+    static constexpr size_t NoSlot = ACTIVE_TXN_REGISTRY_SLOTS;
+
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> beginTs;
+        ///assigned to a thread once, parked rather than emptied from then on
+        std::atomic<bool> assigned;
+        ///the thread it is assigned to is running
+        std::atomic<bool> owned;
+    };
+
+public:
+
+    typedef size_t Handle;
+
+    ActiveTxnRegistry() : mUsedSlots(0), mAssignedSlots(0), mLowWatermark(0)
+    {
+        for (auto& slot : mSlots)
+        {
+            slot.beginTs.store(Empty, std::memory_order_relaxed);
+            slot.assigned.store(false, std::memory_order_relaxed);
+            slot.owned.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Registers a transaction and takes its snapshot. The thread's own slot
+     * is marked with one store; it is ordered before the clock is read, as
+     * refreshLowWatermark() has to find it or see the newer timestamp.
+     * That ordering is the one fence left, no slot is searched or CAS'd.
+     * @arg beginTs receives the read timestamp the transaction must use
+     * @return handle to pass to leave()
+     */
+    Handle enter(uint64_t& beginTs)
+    {
+        Handle slot = own();
+        ///only this thread unparks its slot, a nested transaction finds it in use
+        if (slot != NoSlot && mSlots[slot].beginTs.load(std::memory_order_acquire) == Parked)
+            mSlots[slot].beginTs.store(Entering, std::memory_order_seq_cst);
+        else
+            slot = claim();
+        beginTs = clock().readTimestamp();
+        mSlots[slot].beginTs.store(beginTs, std::memory_order_release);
+        return slot;
+    }
+
+    /// May be called on another thread than enter()
+    void leave(Handle slot)
+    {
+        bool assigned = mSlots[slot].assigned.load(std::memory_order_relaxed);
+        mSlots[slot].beginTs.store(assigned ? Parked : Empty, std::memory_order_release);
+    }
+
+    uint64_t lowWatermark() const
+    {
+        return mLowWatermark.load(std::memory_order_acquire);
+    }
+
+    /// Scans the slots in use, advances the watermark and returns it
+    uint64_t refreshLowWatermark()
+    {
+        uint64_t previous = lowWatermark();
+        uint64_t watermark = clock().readTimestamp();
+        size_t used = mUsedSlots.load(std::memory_order_acquire);
+        for (size_t i = 0; i < used; i++)
+        {
+            uint64_t ts = mSlots[i].beginTs.load(std::memory_order_seq_cst);
+            if (ts == Empty || ts == Parked)
+                continue;
+            ///an entering transaction reads the clock after its claim, never below previous
+            watermark = std::min(watermark, ts == Entering ? previous : ts);
+        }
+        while (watermark > previous &&
+               !mLowWatermark.compare_exchange_weak(previous, watermark, std::memory_order_acq_rel))
+        {
+        }
+        return lowWatermark();
+    }
+
+    size_t activeCount() const
+    {
+        size_t active = 0;
+        size_t used = mUsedSlots.load(std::memory_order_acquire);
+        for (size_t i = 0; i < used; i++)
+        {
+            uint64_t ts = mSlots[i].beginTs.load(std::memory_order_relaxed);
+            active += ts != Empty && ts != Parked;
+        }
+        return active;
+    }
+
+    /// Follows TransactionClock::reset(), only valid while no transaction is running
+    void reset()
+    {
+        mLowWatermark.store(0);
+    }
+
+private:
+
+    static TransactionClock& clock()
+    {
+        return txnClock;
+    }
+
+    ///slot of the calling thread, given back to the registry when the thread exits
+    struct Owner
+    {
+        ActiveTxnRegistry* registry = nullptr;
+        Handle slot = 0;
+
+        ~Owner()
+        {
+            if (registry != nullptr && slot != NoSlot)
+                registry->mSlots[slot].owned.store(false, std::memory_order_release);
+        }
+    };
+
+    /// Slot assigned to the calling thread, assigned on its first transaction
+    Handle own()
+    {
+        static thread_local Owner owner;
+        if (owner.registry != this)
+        {
+            owner.slot = assign();
+            owner.registry = this;
+        }
+        return owner.slot;
+    }
+
+    /// Slot of a thread that exited, a free one assigned from now on, or NoSlot once too many are
+    Handle assign()
+    {
+        size_t used = mUsedSlots.load(std::memory_order_acquire);
+        for (size_t i = 0; i < used; i++)
+        {
+            bool owned = false;
+            if (mSlots[i].assigned.load(std::memory_order_acquire) && !mSlots[i].owned.load(std::memory_order_relaxed) &&
+                mSlots[i].owned.compare_exchange_strong(owned, true, std::memory_order_acq_rel))
+                return i;
+        }
+        if (mAssignedSlots.fetch_add(1, std::memory_order_relaxed) >= AssignableSlots)
+        {
+            mAssignedSlots.fetch_sub(1, std::memory_order_relaxed);
+            return NoSlot;
+        }
+        Handle slot = claim();
+        mSlots[slot].owned.store(true, std::memory_order_relaxed);
+        mSlots[slot].assigned.store(true, std::memory_order_release);
+        mSlots[slot].beginTs.store(Parked, std::memory_order_release);
+        return slot;
+    }
+
+    /// Free slot for a transaction nested in the one of the thread's own slot
+    Handle claim()
+    {
+        static thread_local size_t hint = std::hash<std::thread::id>()(std::this_thread::get_id()) % ACTIVE_TXN_REGISTRY_SLOTS;
+        while (true)
+        {
+            for (size_t i = 0; i < ACTIVE_TXN_REGISTRY_SLOTS; i++)
+            {
+                size_t slot = (hint + i) % ACTIVE_TXN_REGISTRY_SLOTS;
+                uint64_t expected = Empty;
+                if (mSlots[slot].beginTs.load(std::memory_order_relaxed) == Empty &&
+                    mSlots[slot].beginTs.compare_exchange_strong(expected, Entering, std::memory_order_seq_cst))
+                {
+                    hint = slot;
+                    size_t used = mUsedSlots.load(std::memory_order_relaxed);
+                    while (used <= slot &&
+                           !mUsedSlots.compare_exchange_weak(used, slot + 1, std::memory_order_acq_rel))
+                    {
+                    }
+                    return slot;
+                }
+            }
+            ///more concurrent transactions than slots
+            std::this_thread::yield();
+        }
+    }
+
+    Slot mSlots[ACTIVE_TXN_REGISTRY_SLOTS];
+    std::atomic<size_t> mUsedSlots;
+    std::atomic<size_t> mAssignedSlots;
+    alignas(64) std::atomic<uint64_t> mLowWatermark;
+};
+
+ActiveTxnRegistry activeTxnRegistry;
+
+#endif //MVCCART_ACTIVETXNREGISTRY_HPP
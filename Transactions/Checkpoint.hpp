@@ -0,0 +1,269 @@
+//
+// Created by Players Inc on 19/10/2026.
+//
+
+#ifndef MVCCART_CHECKPOINT_HPP
+#define MVCCART_CHECKPOINT_HPP
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "RedoLog.hpp"
+
+/// Files a checkpoint is split into, every root subtree goes to one of them
+#ifndef CHECKPOINT_PARTITIONS
+#define CHECKPOINT_PARTITIONS 16
+#endif
+
+/// Threads scanning the tree for a checkpoint, each one a core at most
+#ifndef CHECKPOINT_THREADS
+#define CHECKPOINT_THREADS 2
+#endif
+
+/// Bytes a partition file collects before handing them to the kernel in one write
+#ifndef CHECKPOINT_WRITE_SIZE
+#define CHECKPOINT_WRITE_SIZE (1 << 20)
+#endif
+
+/// Delta checkpoints chained onto a full one before incrementalCheckpoint() starts a new chain
+#ifndef CHECKPOINT_MAX_DELTAS
+#define CHECKPOINT_MAX_DELTAS 8
+#endif
+
+
+/// Threads loading checkpoint partitions and replaying the redo log
+#ifndef RECOVERY_THREADS
+#define RECOVERY_THREADS 4
+#endif
+
+/// Checkpoint records one recovery thread decodes before loading them as a sorted batch
+#ifndef RECOVERY_BATCH_SIZE
+#define RECOVERY_BATCH_SIZE 4096
+#endif
+
+
+/// What a checkpoint wrote, also the content of its manifest
+struct CheckpointInfo
+{
+    ///snapshot the checkpoint holds, log records up to it are redundant
+    uint64_t ts = 0;
+    ///redo log bytes written when it began, records after them may be missing from it
+    uint64_t logOffset = 0;
+    ///only what changed since the previous checkpoint of the chain, Deletes included
+    bool delta = false;
+    uint64_t records = 0;
+    uint64_t bytes = 0;
+    uint64_t durationUs = 0;
+    uint64_t truncatedLogBytes = 0;
+    ///partition files, relative to the checkpoint directory
+    std::vector<std::string> files;
+};
+
+
+/// Where recovery spent its time
+struct RecoveryStats
+{
+    uint64_t checkpointTs = 0;
+    ///records of the full checkpoint and of the deltas chained onto it
+    uint64_t checkpointRecords = 0;
+    size_t deltas = 0;
+    ///log records newer than the checkpoint, applied in per-key commit order
+    uint64_t replayedRecords = 0;
+    uint64_t skippedRecords = 0;
+    uint64_t loadUs = 0;
+    uint64_t replayUs = 0;
+    uint64_t totalUs = 0;
+    size_t threads = 0;
+};
+
+
+/**
+ * One partition file of a checkpoint, written front to back by one thread.
+ * Records use the redo log format (RedoLog::scan() reads them back), stamped
+ * with the checkpoint timestamp; only delta checkpoints hold Deletes.
+ */
+class CheckpointFile
+{
+public:
+
+    explicit CheckpointFile(const std::string& path) : mPath(path), mRecords(0), mBytes(0)
+    {
+        mFd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (mFd < 0)
+            throw std::runtime_error("cannot open checkpoint file " + path);
+        mBuffer.reserve(CHECKPOINT_WRITE_SIZE + 4096);
+    }
+
+    CheckpointFile(const CheckpointFile&) = delete;
+    CheckpointFile& operator=(const CheckpointFile&) = delete;
+
+    ~CheckpointFile()
+    {
+        if (mFd >= 0)
+            ::close(mFd);
+    }
+
+    template <typename RecordType>
+    void add(const char* key, size_t keyLen, const RecordType& record, uint64_t ts)
+    {
+        RedoLog::encodePut(mBuffer, key, keyLen, record, ts);
+        mRecords++;
+        if (mBuffer.size() >= CHECKPOINT_WRITE_SIZE)
+            writeBuffer();
+    }
+
+    void remove(const char* key, size_t keyLen, uint64_t ts)
+    {
+        RedoLog::encodeDelete(mBuffer, key, keyLen, ts);
+        mRecords++;
+        if (mBuffer.size() >= CHECKPOINT_WRITE_SIZE)
+            writeBuffer();
+    }
+
+    /// Writes the rest and makes the file durable
+    void close()
+    {
+        writeBuffer();
+#ifdef __APPLE__
+        ::fsync(mFd);
+#else
+        ::fdatasync(mFd);
+#endif
+        ::close(mFd);
+        mFd = -1;
+    }
+
+    uint64_t records() const { return mRecords; }
+    uint64_t bytes() const { return mBytes; }
+
+private:
+
+    void writeBuffer()
+    {
+        size_t done = 0;
+        while (done < mBuffer.size())
+        {
+            ssize_t written = ::write(mFd, mBuffer.data() + done, mBuffer.size() - done);
+            if (written < 0)
+                throw std::runtime_error("checkpoint write failed " + mPath);
+            done += written;
+        }
+        mBytes += mBuffer.size();
+        mBuffer.clear();
+    }
+
+    std::string mPath;
+    int mFd;
+    StreamType mBuffer;
+    uint64_t mRecords;
+    uint64_t mBytes;
+};
+
+
+/**
+ * File names and the manifest of a directory. The manifest names a chain:
+ * a full checkpoint followed by the deltas taken after it, oldest first.
+ */
+class Checkpoint
+{
+public:
+
+    static std::string partitionFile(uint64_t ts, size_t partition)
+    {
+        return "checkpoint-" + std::to_string(ts) + "-" + std::to_string(partition) + ".ckp";
+    }
+
+    static std::string manifestPath(const std::string& dir)
+    {
+        return dir + "/CHECKPOINT";
+    }
+
+    static void createDirectory(const std::string& dir)
+    {
+        if (::mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+            throw std::runtime_error("cannot create checkpoint directory " + dir);
+    }
+
+    /**
+     * Publishes a checkpoint whose files are durable: the manifest is written
+     * aside and renamed over the old one, a crash leaves either manifest.
+     */
+    static void writeManifest(const std::string& dir, const std::vector<CheckpointInfo>& chain)
+    {
+        std::string tmp = manifestPath(dir) + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::trunc);
+            for (auto& info : chain)
+            {
+                out << "ts " << info.ts << "\n"
+                    << "log " << info.logOffset << "\n"
+                    << "delta " << info.delta << "\n"
+                    << "records " << info.records << "\n"
+                    << "bytes " << info.bytes << "\n"
+                    << "files " << info.files.size() << "\n";
+                for (auto& file : info.files)
+                    out << file << "\n";
+            }
+            if (!out)
+                throw std::runtime_error("cannot write checkpoint manifest " + tmp);
+        }
+        int fd = ::open(tmp.c_str(), O_RDONLY);
+        if (fd >= 0)
+        {
+            ::fsync(fd);
+            ::close(fd);
+        }
+        if (::rename(tmp.c_str(), manifestPath(dir).c_str()) != 0)
+            throw std::runtime_error("cannot publish checkpoint manifest in " + dir);
+        fd = ::open(dir.c_str(), O_RDONLY);
+        if (fd >= 0)
+        {
+            ::fsync(fd);
+            ::close(fd);
+        }
+    }
+
+    static void writeManifest(const std::string& dir, const CheckpointInfo& info)
+    {
+        writeManifest(dir, std::vector<CheckpointInfo>(1, info));
+    }
+
+    /// @return false if dir holds no complete checkpoint
+    static bool readManifest(const std::string& dir, std::vector<CheckpointInfo>& chain)
+    {
+        std::ifstream in(manifestPath(dir));
+        std::string field;
+        CheckpointInfo info;
+        size_t files = 0;
+        chain.clear();
+        while (in >> field >> info.ts >> field >> info.logOffset >> field >> info.delta >> field >> info.records
+                  >> field >> info.bytes >> field >> files)
+        {
+            info.files.resize(files);
+            for (auto& file : info.files)
+                if (!(in >> file))
+                    return false;
+            chain.push_back(info);
+        }
+        return !chain.empty() && !chain.front().delta;
+    }
+
+    /// Newest checkpoint of the chain in dir
+    static bool readManifest(const std::string& dir, CheckpointInfo& info)
+    {
+        std::vector<CheckpointInfo> chain;
+        if (!readManifest(dir, chain))
+            return false;
+        info = chain.back();
+        return true;
+    }
+};
+
+#endif //MVCCART_CHECKPOINT_HPP
@@ -33,24 +33,26 @@ auto hr_now() -> decltype(std::chrono::high_resolution_clock::now())
     return std::chrono::high_resolution_clock::now();
 }
 
+/// One GC interval: running transactions are tracked by ActiveTxnRegistry, not per epoch
 class Epoch
 {
 
     public:
         int EpochId;
-        std::vector<size_t> TxnSet;
         int counter;
+        ///low watermark of the active transaction registry when the epoch was closed
+        uint64_t lowWatermark;
 
-        void addTxnToEpoch(size_t Tid)
+        void addTxnToEpoch()
         {
-            TxnSet.push_back(Tid);
             counter++;
         }
 
         Epoch()
         {
-            TxnSet.clear();
+            EpochId=0;
             counter=0;
+            lowWatermark=0;
         }
 };
 
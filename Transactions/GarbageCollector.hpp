@@ -0,0 +1,322 @@
+//
+// Created by Players Inc on 19/10/2026.
+//
+
+#ifndef MVCCART_GARBAGECOLLECTOR_HPP
+#define MVCCART_GARBAGECOLLECTOR_HPP
+
+#include <boost/thread.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+/// Threads running the tasks of a GC cycle, 0 runs them on the calling thread
+#ifndef GC_WORKERS
+#define GC_WORKERS 2
+#endif
+
+/// Wall time one GC cycle may take, tasks not started by then wait for the next cycle
+#ifndef GC_CYCLE_BUDGET_US
+#define GC_CYCLE_BUDGET_US 5000
+#endif
+
+/// Share of a core a GC worker may use, the driver thread pauses for the rest after every cycle
+#ifndef GC_THROTTLE_PERCENT
+#define GC_THROTTLE_PERCENT 50
+#endif
+
+/// Pause between two cycles of the driver thread when the throttle asks for less
+#ifndef GC_INTERVAL_US
+#define GC_INTERVAL_US 1000
+#endif
+
+/// Queues deleted keys are spread over, writers only share one with threads hashing alike
+#ifndef GC_QUEUE_PARTITIONS
+#define GC_QUEUE_PARTITIONS 16
+#endif
+
+
+/// Point-in-time copy of the collector metrics
+struct GCStats
+{
+    uint64_t cycles;
+    uint64_t reclaimedBytes;
+    uint64_t reclaimedKeys;
+    uint64_t prunedVersions;
+    uint64_t lastCycleUs;
+    uint64_t maxCycleUs;
+    ///deleted keys still queued after the last cycle
+    uint64_t backlog;
+};
+
+
+/**
+ * Worker pool running garbage collection cycles off the foreground threads.
+ * A cycle is a list of independent tasks, one per subtree, handed out in
+ * order until all ran or the cycle budget is spent; runTasks() reports how
+ * many were started so the caller can keep the rest for the next cycle.
+ * Work that must not overlap the tasks runs on the caller between
+ * beginCycle() and endCycle() and shares the same budget.
+ * startDriver() runs cycles on a thread of the collector, so foreground
+ * threads never wait for one. Between two cycles the driver pauses long
+ * enough that GC never takes more than GC_THROTTLE_PERCENT of a core per
+ * thread; the pause is not part of any cycle or its budget.
+ */
+class GarbageCollector
+{
+public:
+
+    typedef std::function<void()> Task;
+
+    GarbageCollector(size_t numWorkers = GC_WORKERS, uint64_t budgetUs = GC_CYCLE_BUDGET_US,
+                     unsigned throttlePercent = GC_THROTTLE_PERCENT)
+            : mNumWorkers(numWorkers), mBudgetUs(budgetUs), mThrottlePercent(throttlePercent),
+              mTasks(nullptr), mNextTask(0), mRunning(0), mGeneration(0), mStop(false), mDriverStop(false),
+              mCycles(0), mReclaimedBytes(0), mReclaimedKeys(0), mPrunedVersions(0),
+              mLastCycleUs(0), mMaxCycleUs(0), mBacklog(0)
+    {
+    }
+
+    GarbageCollector(const GarbageCollector&) = delete;
+    GarbageCollector& operator=(const GarbageCollector&) = delete;
+
+    ~GarbageCollector()
+    {
+        stopDriver();
+        stopWorkers();
+    }
+
+    /// Resizes the pool, only between cycles
+    void setWorkers(size_t numWorkers)
+    {
+        stopWorkers();
+        mNumWorkers = numWorkers;
+    }
+
+    void setCycleBudget(uint64_t budgetUs)
+    {
+        mBudgetUs = budgetUs;
+    }
+
+    void setThrottle(unsigned throttlePercent)
+    {
+        mThrottlePercent = std::max(1u, std::min(100u, throttlePercent));
+    }
+
+    size_t workers() const
+    {
+        return mNumWorkers;
+    }
+
+    /**
+     * Starts the driver thread calling cycle, which runs one cycle, until
+     * stopDriver(). It waits intervalUs between cycles, or the throttle
+     * pause of the last cycle if that is longer.
+     */
+    void startDriver(std::function<void()> cycle, uint64_t intervalUs = GC_INTERVAL_US)
+    {
+        stopDriver();
+        mDriverStop = false;
+        mDriver.reset(new boost::thread([this, cycle, intervalUs] {
+            std::unique_lock<std::mutex> guard(mDriverLock);
+            while (!mDriverStop)
+            {
+                guard.unlock();
+                cycle();
+                guard.lock();
+                mDriverWake.wait_for(guard, std::max(std::chrono::microseconds(intervalUs), throttlePause()),
+                                     [this] { return mDriverStop; });
+            }
+        }));
+    }
+
+    /// Waits for the running cycle of the driver thread and ends it
+    void stopDriver()
+    {
+        if (!mDriver)
+            return;
+        {
+            std::lock_guard<std::mutex> guard(mDriverLock);
+            mDriverStop = true;
+        }
+        mDriverWake.notify_all();
+        mDriver->join();
+        mDriver.reset();
+    }
+
+    bool driving() const
+    {
+        return mDriver != nullptr;
+    }
+
+    /// Starts the budget of a cycle, cycles must not overlap
+    void beginCycle()
+    {
+        mCycleStart = std::chrono::high_resolution_clock::now();
+        mDeadline = mCycleStart + std::chrono::microseconds(mBudgetUs);
+    }
+
+    /**
+     * Runs tasks in order on the pool and waits for the started ones.
+     * @return number of tasks started, always a prefix of tasks
+     */
+    size_t runTasks(std::vector<Task>& tasks)
+    {
+        mNextTask.store(0);
+        if (mNumWorkers == 0 || tasks.size() <= 1)
+            drain(tasks);
+        else
+        {
+            startWorkers();
+            std::unique_lock<std::mutex> guard(mLock);
+            mTasks = &tasks;
+            mRunning = mWorkers.size();
+            mGeneration++;
+            mWake.notify_all();
+            mDone.wait(guard, [this] { return mRunning == 0; });
+            mTasks = nullptr;
+        }
+        return std::min(mNextTask.load(), tasks.size());
+    }
+
+    void endCycle()
+    {
+        uint64_t cycleUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - mCycleStart).count();
+        mCycles++;
+        mLastCycleUs = cycleUs;
+        uint64_t maxUs = mMaxCycleUs.load();
+        while (cycleUs > maxUs && !mMaxCycleUs.compare_exchange_weak(maxUs, cycleUs)) {}
+    }
+
+    size_t runCycle(std::vector<Task>& tasks)
+    {
+        beginCycle();
+        size_t started = runTasks(tasks);
+        endCycle();
+        return started;
+    }
+
+    /// True once the running cycle used up its budget, long tasks check it to stop early
+    bool expired() const
+    {
+        return std::chrono::high_resolution_clock::now() >= mDeadline;
+    }
+
+    void addReclaimed(uint64_t bytes, uint64_t keys, uint64_t versions)
+    {
+        mReclaimedBytes += bytes;
+        mReclaimedKeys += keys;
+        mPrunedVersions += versions;
+    }
+
+    void setBacklog(uint64_t backlog)
+    {
+        mBacklog = backlog;
+    }
+
+    GCStats stats() const
+    {
+        return GCStats{mCycles.load(), mReclaimedBytes.load(), mReclaimedKeys.load(), mPrunedVersions.load(),
+                       mLastCycleUs.load(), mMaxCycleUs.load(), mBacklog.load()};
+    }
+
+private:
+
+    void drain(std::vector<Task>& tasks)
+    {
+        while (!expired())
+        {
+            size_t next = mNextTask.fetch_add(1);
+            if (next >= tasks.size())
+                return;
+            tasks[next]();
+        }
+    }
+
+    /// No thread of a cycle is busy for longer than the cycle, it idles for the rest of its share after it
+    std::chrono::microseconds throttlePause() const
+    {
+        unsigned percent = std::max(1u, std::min(100u, mThrottlePercent));
+        return std::chrono::microseconds(mLastCycleUs.load() * (100 - percent) / percent);
+    }
+
+    /// seen is the generation at start, so a restarted worker waits for the next cycle
+    void workerLoop(uint64_t seen)
+    {
+        while (true)
+        {
+            std::vector<Task>* tasks;
+            {
+                std::unique_lock<std::mutex> guard(mLock);
+                mWake.wait(guard, [&] { return mStop || mGeneration != seen; });
+                if (mStop)
+                    return;
+                seen = mGeneration;
+                tasks = mTasks;
+            }
+            drain(*tasks);
+            std::lock_guard<std::mutex> guard(mLock);
+            if (--mRunning == 0)
+                mDone.notify_one();
+        }
+    }
+
+    void startWorkers()
+    {
+        if (!mWorkers.empty())
+            return;
+        mStop = false;
+        for (size_t i = 0; i < mNumWorkers; i++)
+            mWorkers.emplace_back(new boost::thread(&GarbageCollector::workerLoop, this, mGeneration));
+    }
+
+    void stopWorkers()
+    {
+        {
+            std::lock_guard<std::mutex> guard(mLock);
+            mStop = true;
+        }
+        mWake.notify_all();
+        for (auto& worker : mWorkers)
+            worker->join();
+        mWorkers.clear();
+    }
+
+    size_t mNumWorkers;
+    uint64_t mBudgetUs;
+    unsigned mThrottlePercent;
+    std::chrono::high_resolution_clock::time_point mCycleStart;
+    std::chrono::high_resolution_clock::time_point mDeadline;
+
+    std::vector<std::unique_ptr<boost::thread>> mWorkers;
+    std::mutex mLock;
+    std::condition_variable mWake;
+    std::condition_variable mDone;
+    std::vector<Task>* mTasks;
+    std::atomic<size_t> mNextTask;
+    size_t mRunning;
+    uint64_t mGeneration;
+    bool mStop;
+
+    std::unique_ptr<boost::thread> mDriver;
+    std::mutex mDriverLock;
+    std::condition_variable mDriverWake;
+    bool mDriverStop;
+
+    std::atomic<uint64_t> mCycles;
+    std::atomic<uint64_t> mReclaimedBytes;
+    std::atomic<uint64_t> mReclaimedKeys;
+    std::atomic<uint64_t> mPrunedVersions;
+    std::atomic<uint64_t> mLastCycleUs;
+    std::atomic<uint64_t> mMaxCycleUs;
+    std::atomic<uint64_t> mBacklog;
+};
+
+#endif //MVCCART_GARBAGECOLLECTOR_HPP
@@ -27,6 +27,7 @@
 #include <queue>
 #include <atomic>
 #include "Epochs.hpp"
+#include "ActiveTxnRegistry.hpp"
 #define EPOCH_TIME_ELPSE_SLEEP_MS 50
 
 
@@ -71,30 +72,19 @@ void EpochThread()
 
     while(true)
     {
-            ///If no new transaction has been registered
-            /// in the recent active_epoch, chance for GC
-            if(myEpochGlobal.ActiveEpoch.counter==0)
+            ///Versions that ended at or below the low watermark are invisible to every
+            /// running transaction, GC only pays off once the oldest one has moved on
+            uint64_t watermark = activeTxnRegistry.refreshLowWatermark();
+            if(myEpochGlobal.EpochsPast.empty() || watermark > myEpochGlobal.EpochsPast.back().lowWatermark)
             {
-
-                ///Trigger GC but check if all Epochs counters are 0
-                bool isAllEpochsFlushed = true;
-                for(int i=0; i < myEpochGlobal.EpochsPast.size(); i++)
-                {
-                    if(myEpochGlobal.EpochsPast[i].counter!=0)
-                    {
-                        isAllEpochsFlushed = false;
-                    }
-                }
-                /// if all previous epoch's counter is 0
-                if (isAllEpochsFlushed)
-                {
-                    mImmediateGC();
-                    isAllEpochsFlushed = false;
-                    myEpochGlobal.EpochsPast.clear();
-                }
+                mImmediateGC();
+                myEpochGlobal.EpochsPast.clear();
             }
+        myEpochGlobal.ActiveEpoch.lowWatermark = watermark;
         myEpochGlobal.EpochsPast.push_back(myEpochGlobal.ActiveEpoch);
+        int nextEpochId = myEpochGlobal.ActiveEpoch.EpochId + 1;
         myEpochGlobal.ActiveEpoch = Epoch();
+        myEpochGlobal.ActiveEpoch.EpochId = nextEpochId;
         std::this_thread::sleep_for(std::chrono::milliseconds(EPOCH_TIME_ELPSE_SLEEP_MS));
     }
 }
@@ -27,6 +27,7 @@
 #include <boost/random/uniform_int_distribution.hpp>
 #include <boost/random/variate_generator.hpp>
 #include "fmt-master/fmt/format.h"
+#include "Transactions/ZipfGenerator.hpp"
 
 using namespace std;
 typedef pfabric::Tuple<string,unsigned long, int,string, double> RecordType;
@@ -160,6 +161,49 @@ auto ReadIntensiveSmall = [](ARTTupleContainer &ARTWithTuples, size_t id,std::pa
 };
 
 
+/// ReadIntensiveSmall issuing its probes as interleaved batches
+auto ReadIntensiveSmallBatched = [](ARTTupleContainer &ARTWithTuples, size_t id,std::pair<int,int> range)
+{
+    random::mt19937 rng(current_time_nanoseconds());
+    random::uniform_int_distribution<> randomKeys1(range.first,range.second);
+
+    ///Reading 60 values from ART in one batch
+    char* keysToFind[60];
+    const_snapshot_ptr ReadSet[60];
+    for (int i = 0; i < 60; i++)
+    {
+        keysToFind[i] = KeysToStore[randomKeys1(rng)];
+    }
+    size_t found = ARTWithTuples.findValuesByKeys(keysToFind, 60, ReadSet, id);
+
+    ///Updating the first 20 keys that were read
+    char* keysToUpdate[20];
+    const_snapshot_ptr WriteSet[20];
+    size_t toUpdate = 0;
+    for (int i = 0; i < 60 && toUpdate < 20; i++)
+    {
+        if (ReadSet[i] != nullptr)
+            keysToUpdate[toUpdate++] = keysToFind[i];
+    }
+    size_t updated = ARTWithTuples.updateValuesByKeys(keysToUpdate, toUpdate, updater, WriteSet, id);
+
+    ///Reading back the updated keys
+    const_snapshot_ptr Evaluated[20];
+    size_t reread = ARTWithTuples.findValuesByKeys(keysToUpdate, toUpdate, Evaluated, id);
+    for (size_t i = 0; i < toUpdate; i++)
+    {
+        if (Evaluated[i] != nullptr)
+        {
+            auto tp = Evaluated[i]->value;
+            Evaluater(tp);
+        }
+    }
+
+    cout<<"Total Cached missed out of 80 random keys Reads  ="<<(60 - found) + (toUpdate - reread)<<" by transaction#"<<id<<endl;
+    cout<<"Total Cached missed out of 20 keys from WriteSet/Updated ="<<toUpdate - updated<<" by transaction#"<<id<<endl;
+};
+
+
 auto ReadIntensiveMedium = [](ARTTupleContainer &ARTWithTuples, size_t id,std::pair<int,int> range)
 {
     std::vector<RecordType> WriteSet;
@@ -227,4 +271,44 @@ auto ReadIntensiveMedium = [](ARTTupleContainer &ARTWithTuples, size_t id,std::p
     cout<<"Total Cached missed out of 200 keys from WriteSet/Updated ="<<totalCachedUpdateMissed<<" by transaction#"<<id<<endl;
 };
 
+///nanoseconds each lookup of ReadZipfTimed took, appended by every transaction once it is done
+std::mutex lookupLatenciesLock;
+std::vector<uint64_t> lookupLatencies;
+
+auto ReadZipfTimed = [](ARTTupleContainer &ARTWithTuples, size_t id,std::pair<int,int> range)
+{
+    std::mt19937_64 rng(current_time_nanoseconds() + id);
+    std::vector<uint64_t> latencies;
+    latencies.reserve(range.second - range.first);
+    int totalCachedMissed=0;
+    for (int i = range.first; i < range.second; i++)
+    {
+        char* keysToFind = KeysToStore[zipfKeys()(rng)];
+        auto start = std::chrono::high_resolution_clock::now();
+        auto val = ARTWithTuples.findValueByKey(keysToFind,id);
+        latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count());
+        if(val == nullptr)
+        {
+            totalCachedMissed++;
+        }
+    }
+    std::lock_guard<std::mutex> guard(lookupLatenciesLock);
+    lookupLatencies.insert(lookupLatencies.end(), latencies.begin(), latencies.end());
+    cout<<"Total Cached missed out of "<<range.second-range.first<<" Zipfian Reads  ="<<totalCachedMissed<<" by transaction#"<<id<<endl;
+};
+
+///inserts new keys next to Zipfian hot ones, the nodes above the hot keys grow and split
+auto WriteZipfSiblings = [](ARTTupleContainer &ARTWithTuples, size_t id,std::pair<int,int> range)
+{
+    std::mt19937_64 rng(current_time_nanoseconds() + id);
+    char key[48];
+    for (int i = range.first; i < range.second; i++)
+    {
+        int hot = (int) zipfKeys()(rng);
+        ///the words end in a newline, a sibling goes before it so that no key is a prefix of another
+        snprintf(key, sizeof key, "%.*s#%d\n", (int) strlen(KeysToStore[hot]) - 1, KeysToStore[hot], i);
+        ARTWithTuples.insertOrUpdateByKey(key, vectorValues[hot], id);
+    }
+};
+
 #endif //MVCCART_TRANSACTIONTEMPLATES_H
@@ -27,6 +27,7 @@
 #include <boost/random/uniform_int_distribution.hpp>
 #include <boost/random/variate_generator.hpp>
 #include "fmt-master/fmt/format.h"
+#include "Transactions/ZipfGenerator.hpp"
 
 using namespace std;
 typedef pfabric::Tuple<string,unsigned long, int,string, double> RecordType;
@@ -181,4 +182,87 @@ auto ReadOnlyLong = [](ARTTupleContainer &ARTWithTuples, size_t id, std::string
     cout<<"Total Cached missed out of 100000 random keys ="<<totalCachedMissed<<" by transaction#"<<id<<endl;
 };
 
+///lookups of ReadOnlyZipf answered by the read cache of the thread running them
+std::atomic<uint64_t> zipfReadCacheHits(0);
+
+auto ReadOnlyZipf = [](ARTTupleContainer &ARTWithTuples, size_t id,std::pair<int,int> range)
+{
+    std::mt19937_64 rng(current_time_nanoseconds() + id);
+    ReadCacheStats before = ARTWithTuples.readCacheStats();
+    int totalCachedMissed=0;
+    for (int i = range.first; i < range.second; i++)
+    {
+        char* keysToFind = KeysToStore[zipfKeys()(rng)];
+        auto val = ARTWithTuples.findValueByKey(keysToFind,id);
+        if(val == nullptr)
+        {
+            totalCachedMissed++;
+        }
+        else
+        {
+            auto tp = val->value;
+            Evaluater(tp);
+        }
+    }
+    zipfReadCacheHits.fetch_add(ARTWithTuples.readCacheStats().hits - before.hits);
+    cout<<"Total Cached missed out of "<<range.second-range.first<<" Zipfian keys ="<<totalCachedMissed<<" by transaction#"<<id<<endl;
+};
+
+auto ReadOnlyUniform = [](ARTTupleContainer &ARTWithTuples, size_t id,std::pair<int,int> range)
+{
+    random::mt19937 rng(current_time_nanoseconds() + id);
+    random::uniform_int_distribution<> randomKeys1(range.first,range.second - 1);
+    int totalCachedMissed=0;
+    for (int i = 0; i < 50000; i++)
+    {
+        char* keysToFind = KeysToStore[randomKeys1(rng)];
+        auto val = ARTWithTuples.findValueByKey(keysToFind,id);
+        if(val == nullptr)
+        {
+            totalCachedMissed++;
+        }
+        else
+        {
+            auto tp = val->value;
+            Evaluater(tp);
+        }
+    }
+    cout<<"Total Cached missed out of 50000 random keys ="<<totalCachedMissed<<" by transaction#"<<id<<endl;
+};
+
+/**
+ * Uniform lookups of which every other one is for a key that is not stored:
+ * a stored key with its last byte changed, that follows the path of the key
+ * down to the key's leaf.
+ */
+auto ReadOnlyHalfMisses = [](ARTTupleContainer &ARTWithTuples, size_t id,std::pair<int,int> range)
+{
+    random::mt19937 rng(current_time_nanoseconds() + id);
+    random::uniform_int_distribution<> randomKeys1(range.first,range.second - 1);
+    char absent[20];
+    int totalMissed=0;
+    for (int i = 0; i < 50000; i++)
+    {
+        char* keysToFind = KeysToStore[randomKeys1(rng)];
+        size_t keyLen = strlen(keysToFind);
+        if (i % 2 == 1 && keyLen > 0)
+        {
+            strcpy(absent, keysToFind);
+            absent[keyLen - 1] = '\x01';
+            keysToFind = absent;
+        }
+        auto val = ARTWithTuples.findValueByKey(keysToFind,id);
+        if(val == nullptr)
+        {
+            totalMissed++;
+        }
+        else
+        {
+            auto tp = val->value;
+            Evaluater(tp);
+        }
+    }
+    cout<<"Total missed out of 50000 random keys, half of them absent ="<<totalMissed<<" by transaction#"<<id<<endl;
+};
+
 #endif //MVCCART_TRANSACTIONTEMPLATES_H
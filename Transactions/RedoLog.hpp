@@ -0,0 +1,641 @@
+//
+// Created by Players Inc on 19/10/2026.
+//
+
+#ifndef MVCCART_REDOLOG_HPP
+#define MVCCART_REDOLOG_HPP
+
+#include <boost/thread.hpp>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "core/serialize.hpp"
+
+/// Commits the log writer waits for before it syncs a group early
+#ifndef REDO_LOG_GROUP_SIZE
+#define REDO_LOG_GROUP_SIZE 256
+#endif
+
+/// Longest a sealed commit waits for its group to be synced
+#ifndef REDO_LOG_GROUP_LATENCY_US
+#define REDO_LOG_GROUP_LATENCY_US 1000
+#endif
+
+/// Initial capacity of the per-thread log buffers
+#ifndef REDO_LOG_BUFFER_SIZE
+#define REDO_LOG_BUFFER_SIZE (64 * 1024)
+#endif
+
+
+/// Kind of change a redo record carries
+enum class RedoOp : uint8_t
+{
+    Put = 1,
+    Delete = 2,
+    ///written by truncate(): the records after it were logged after its checkpoint began
+    Mark = 3
+};
+
+/// One decoded redo record, key and payload point into the scan buffer
+struct RedoRecord
+{
+    RedoOp op;
+    uint64_t commitTs;
+    const char* key;
+    uint16_t keyLen;
+    const uint8_t* payload;
+    uint32_t payloadLen;
+};
+
+
+/**
+ * Byte image of a record in the log. Trivially copyable records are copied
+ * as they are, everything else goes through serializeToStream and the
+ * stream constructor (pfabric::Tuple).
+ */
+template <typename RecordType, bool Raw = std::is_trivially_copyable<RecordType>::value>
+struct RedoCodec
+{
+    static void encode(const RecordType& record, StreamType& out)
+    {
+        record.serializeToStream(out);
+    }
+
+    static RecordType decode(const uint8_t* data, size_t len)
+    {
+        StreamType stream(data, data + len);
+        return RecordType(stream);
+    }
+};
+
+template <typename RecordType>
+struct RedoCodec<RecordType, true>
+{
+    static void encode(const RecordType& record, StreamType& out)
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&record);
+        out.insert(out.end(), bytes, bytes + sizeof(RecordType));
+    }
+
+    static RecordType decode(const uint8_t* data, size_t len)
+    {
+        RecordType record;
+        std::memcpy(&record, data, std::min(len, sizeof(RecordType)));
+        return record;
+    }
+};
+
+
+/**
+ * Write-ahead redo log of committed writes with group commit.
+ * Writers serialize records into a buffer of their own thread; seal()
+ * stamps the records of one commit with its commit timestamp and hands
+ * them to the log writer thread, which collects the sealed bytes of all
+ * threads, writes them with one call and makes them durable with one
+ * fdatasync per group. The future seal() returns completes once the
+ * group holding the commit is on disk.
+ * Records of different threads are not in commit order in the file,
+ * replay orders them per key by commit timestamp.
+ *
+ * Record layout: u32 length of the rest, u32 checksum of the rest,
+ * u8 op, u64 commit ts, u16 key length, key, payload.
+ */
+class RedoLog
+{
+    static constexpr size_t HeaderSize = 4 + 4;
+    static constexpr size_t BodyFixedSize = 1 + 8 + 2;
+
+    struct FlushGroup
+    {
+        std::promise<void> done;
+        std::shared_future<void> future;
+
+        FlushGroup() : future(done.get_future().share()) {}
+    };
+
+    struct ThreadBuffer
+    {
+        std::mutex lock;
+        ///records of the running commit, only touched by the owning thread
+        StreamType open;
+        ///offsets of the records in open, patched with the commit timestamp by seal()
+        std::vector<size_t> openRecords;
+        ///sealed records waiting for the log writer
+        StreamType sealed;
+        size_t sealedCommits = 0;
+    };
+
+public:
+
+    struct Stats
+    {
+        uint64_t commits;
+        uint64_t groups;
+        uint64_t bytes;
+    };
+
+    /**
+     * Opens or creates the log file and starts the log writer.
+     * @arg path log file, appended to if it exists
+     * @arg groupSize commits that trigger a sync before groupLatencyUs passed
+     */
+    explicit RedoLog(const std::string& path, size_t groupSize = REDO_LOG_GROUP_SIZE,
+                     uint64_t groupLatencyUs = REDO_LOG_GROUP_LATENCY_US)
+            : mPath(path), mGroupSize(groupSize), mGroupLatencyUs(groupLatencyUs), mId(nextLogId()),
+              mPending(0), mStop(false), mCommits(0), mGroups(0), mBytes(0)
+    {
+        mFd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (mFd < 0)
+            throw std::runtime_error("cannot open redo log " + path);
+        mFileSize = (uint64_t)::lseek(mFd, 0, SEEK_END);
+        std::atomic_store(&mGroup, std::make_shared<FlushGroup>());
+        mWriter = new boost::thread(&RedoLog::writerLoop, this);
+    }
+
+    RedoLog(const RedoLog&) = delete;
+    RedoLog& operator=(const RedoLog&) = delete;
+
+    ~RedoLog()
+    {
+        {
+            std::lock_guard<std::mutex> guard(mWriterLock);
+            mStop = true;
+        }
+        mWakeWriter.notify_one();
+        mWriter->join();
+        delete mWriter;
+        ::close(mFd);
+    }
+
+    /**
+     * Adds a record to the running commit of the calling thread.
+     * @arg payload serialized record, nullptr for a delete
+     */
+    void append(RedoOp op, const char* key, size_t keyLen, const uint8_t* payload, size_t payloadLen)
+    {
+        ThreadBuffer& buffer = local();
+        size_t start = beginRecord(buffer.open, op, key, keyLen);
+        if (payloadLen > 0)
+            buffer.open.insert(buffer.open.end(), payload, payload + payloadLen);
+        endRecord(buffer.open, start);
+        buffer.openRecords.push_back(start);
+    }
+
+    template <typename RecordType>
+    void appendPut(const char* key, size_t keyLen, const RecordType& record)
+    {
+        ThreadBuffer& buffer = local();
+        size_t start = beginRecord(buffer.open, RedoOp::Put, key, keyLen);
+        RedoCodec<RecordType>::encode(record, buffer.open);
+        endRecord(buffer.open, start);
+        buffer.openRecords.push_back(start);
+    }
+
+    void appendDelete(const char* key, size_t keyLen)
+    {
+        append(RedoOp::Delete, key, keyLen, nullptr, 0);
+    }
+
+    /**
+     * Seals the records appended since the last seal()/discard() as one commit.
+     * @arg wantFuture false for fire-and-forget commits
+     * @return completes when the commit is durable, invalid if not wanted
+     */
+    std::shared_future<void> seal(uint64_t commitTs, bool wantFuture = true)
+    {
+        ThreadBuffer& buffer = local();
+        for (size_t start : buffer.openRecords)
+            finishRecord(buffer.open, start, commitTs);
+
+        std::shared_future<void> durable;
+        size_t pending;
+        {
+            std::lock_guard<std::mutex> guard(buffer.lock);
+            ///taken under the buffer lock: the writer swaps this buffer only after starting a new group
+            if (wantFuture)
+                durable = std::atomic_load(&mGroup)->future;
+            buffer.sealed.insert(buffer.sealed.end(), buffer.open.begin(), buffer.open.end());
+            buffer.sealedCommits++;
+            pending = mPending.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+        buffer.open.clear();
+        buffer.openRecords.clear();
+        if (pending == mGroupSize)
+            mWakeWriter.notify_one();
+        return durable;
+    }
+
+    /// Drops the records of an aborted commit
+    void discard()
+    {
+        ThreadBuffer& buffer = local();
+        buffer.open.clear();
+        buffer.openRecords.clear();
+    }
+
+    /// Blocks until everything sealed so far is durable
+    void flush()
+    {
+        std::shared_future<void> durable = std::atomic_load(&mGroup)->future;
+        mWakeWriter.notify_one();
+        durable.wait();
+    }
+
+    Stats stats() const
+    {
+        return Stats{mCommits.load(), mGroups.load(), mBytes.load()};
+    }
+
+    const std::string& path() const
+    {
+        return mPath;
+    }
+
+    /**
+     * Bytes written to the file so far. Every record before this offset was
+     * installed in the table before the call.
+     */
+    uint64_t writtenBytes() const
+    {
+        return mFileSize.load();
+    }
+
+    /**
+     * Drops the records a checkpoint made redundant: those committed at or
+     * before checkpointTs in the first upToOffset bytes. The records from
+     * upToOffset on follow a Mark stamped with checkpointTs, so scanSince()
+     * still tells them apart once their offsets moved. The file is rewritten
+     * and swapped in by rename; commits keep buffering meanwhile, only the
+     * log writer waits.
+     * @return bytes removed from the log
+     */
+    uint64_t truncate(uint64_t checkpointTs, uint64_t upToOffset)
+    {
+        std::lock_guard<std::mutex> guard(mFileLock);
+        std::vector<uint8_t> data = readFile(mPath);
+        StreamType kept;
+        bool marked = false;
+        forEachRecord(data, [&](size_t pos, size_t size, const RedoRecord& record) {
+            if (pos >= upToOffset && !marked)
+            {
+                encodeMark(kept, checkpointTs);
+                marked = true;
+            }
+            if (record.op != RedoOp::Mark && (pos >= upToOffset || record.commitTs > checkpointTs))
+                kept.insert(kept.end(), data.begin() + pos, data.begin() + pos + size);
+        });
+        if (!marked)
+            encodeMark(kept, checkpointTs);
+        ///a torn tail is not a record, it is dropped with the rest
+        std::string tmp = mPath + ".truncate";
+        int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            throw std::runtime_error("cannot open " + tmp);
+        std::vector<struct iovec> iov;
+        if (!kept.empty())
+            iov.push_back({kept.data(), kept.size()});
+        writeAll(fd, iov);
+        syncFile(fd);
+        ::close(fd);
+        if (::rename(tmp.c_str(), mPath.c_str()) != 0)
+            throw std::runtime_error("cannot replace redo log " + mPath);
+        ::close(mFd);
+        mFd = ::open(mPath.c_str(), O_WRONLY | O_APPEND);
+        if (mFd < 0)
+            throw std::runtime_error("cannot reopen redo log " + mPath);
+        mFileSize = kept.size();
+        return data.size() - kept.size();
+    }
+
+    /**
+     * Appends one complete Put record in log format, for files written
+     * outside a log (checkpoints).
+     */
+    template <typename RecordType>
+    static void encodePut(StreamType& out, const char* key, size_t keyLen, const RecordType& record, uint64_t ts)
+    {
+        size_t start = beginRecord(out, RedoOp::Put, key, keyLen);
+        RedoCodec<RecordType>::encode(record, out);
+        endRecord(out, start);
+        finishRecord(out, start, ts);
+    }
+
+    /// Appends one complete Delete record in log format
+    static void encodeDelete(StreamType& out, const char* key, size_t keyLen, uint64_t ts)
+    {
+        size_t start = beginRecord(out, RedoOp::Delete, key, keyLen);
+        endRecord(out, start);
+        finishRecord(out, start, ts);
+    }
+
+    static void encodeMark(StreamType& out, uint64_t checkpointTs)
+    {
+        size_t start = beginRecord(out, RedoOp::Mark, nullptr, 0);
+        endRecord(out, start);
+        finishRecord(out, start, checkpointTs);
+    }
+
+    /**
+     * Reads a log file front to back, stopping at the first torn or corrupt record.
+     * @arg visitor called with every RedoRecord
+     * @return number of records visited
+     */
+    template <typename Visitor>
+    static size_t scan(const std::string& path, Visitor visitor)
+    {
+        return scan(readFile(path), visitor);
+    }
+
+    /// Same over a file read with readFile(), records point into data
+    template <typename Visitor>
+    static size_t scan(const std::vector<uint8_t>& data, Visitor visitor)
+    {
+        return scanSince(data, 0, 0, [&](const RedoRecord& record, bool) {
+            visitor(record);
+        });
+    }
+
+    /**
+     * Reads a log next to a checkpoint, before or after truncate() ran for it.
+     * @arg logOffset writtenBytes() when the checkpoint began
+     * @arg visitor called with every RedoRecord and whether it was logged
+     * after the checkpoint began: past the Mark of checkpointTs if the log has
+     * one, else from logOffset on
+     * @return number of records visited
+     */
+    template <typename Visitor>
+    static size_t scanSince(const std::vector<uint8_t>& data, uint64_t checkpointTs, uint64_t logOffset,
+                            Visitor visitor)
+    {
+        forEachRecord(data, [&](size_t pos, size_t size, const RedoRecord& record) {
+            if (record.op == RedoOp::Mark && record.commitTs == checkpointTs)
+                logOffset = pos + size;
+        });
+        size_t records = 0;
+        forEachRecord(data, [&](size_t pos, size_t, const RedoRecord& record) {
+            if (record.op == RedoOp::Mark)
+                return;
+            visitor(record, pos >= logOffset);
+            records++;
+        });
+        return records;
+    }
+
+    static std::vector<uint8_t> readFile(const std::string& path)
+    {
+        std::vector<uint8_t> data;
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return data;
+        uint8_t chunk[1 << 16];
+        ssize_t got;
+        while ((got = ::read(fd, chunk, sizeof(chunk))) > 0)
+            data.insert(data.end(), chunk, chunk + got);
+        ::close(fd);
+        return data;
+    }
+
+private:
+
+    /// Calls fn(offset, size, record) for every intact record, returns the end of the last one
+    template <typename Fn>
+    static size_t forEachRecord(const std::vector<uint8_t>& data, Fn fn)
+    {
+        size_t pos = 0;
+        while (pos + HeaderSize + BodyFixedSize <= data.size())
+        {
+            uint32_t length = load<uint32_t>(&data[pos]);
+            uint32_t checksum = load<uint32_t>(&data[pos + 4]);
+            const uint8_t* body = &data[pos + HeaderSize];
+            if (length < BodyFixedSize || pos + HeaderSize + length > data.size() || fnv1a(body, length) != checksum)
+                break;
+            RedoRecord record;
+            record.op = static_cast<RedoOp>(body[0]);
+            record.commitTs = load<uint64_t>(body + 1);
+            record.keyLen = load<uint16_t>(body + 9);
+            if (BodyFixedSize + record.keyLen > length)
+                break;
+            record.key = reinterpret_cast<const char*>(body + BodyFixedSize);
+            record.payload = body + BodyFixedSize + record.keyLen;
+            record.payloadLen = length - BodyFixedSize - record.keyLen;
+            fn(pos, HeaderSize + length, record);
+            pos += HeaderSize + length;
+        }
+        return pos;
+    }
+
+    static void syncFile(int fd)
+    {
+#ifdef __APPLE__
+        ::fsync(fd);
+#else
+        ::fdatasync(fd);
+#endif
+    }
+
+    static uint64_t nextLogId()
+    {
+        static std::atomic<uint64_t> ids(0);
+        return ++ids;
+    }
+
+    template <typename T>
+    static T load(const uint8_t* p)
+    {
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    static void store(StreamType& out, size_t pos, T value)
+    {
+        std::memcpy(&out[pos], &value, sizeof(T));
+    }
+
+    static uint32_t fnv1a(const uint8_t* p, size_t len)
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < len; i++)
+            hash = (hash ^ p[i]) * 16777619u;
+        return hash;
+    }
+
+    static size_t beginRecord(StreamType& out, RedoOp op, const char* key, size_t keyLen)
+    {
+        size_t start = out.size();
+        out.resize(start + HeaderSize + BodyFixedSize);
+        out[start + HeaderSize] = static_cast<uint8_t>(op);
+        store<uint16_t>(out, start + HeaderSize + 9, (uint16_t)keyLen);
+        out.insert(out.end(), key, key + keyLen);
+        return start;
+    }
+
+    /// Sets the length once the payload is written
+    static void endRecord(StreamType& out, size_t start)
+    {
+        store<uint32_t>(out, start, (uint32_t)(out.size() - start - HeaderSize));
+    }
+
+    /// Stamps the commit timestamp, the checksum covers it
+    static void finishRecord(StreamType& out, size_t start, uint64_t commitTs)
+    {
+        size_t body = start + HeaderSize;
+        uint32_t length = load<uint32_t>(&out[start]);
+        store<uint64_t>(out, body + 1, commitTs);
+        store<uint32_t>(out, start + 4, fnv1a(&out[body], length));
+    }
+
+    /**
+     * Buffer of the calling thread in this log. A thread keeps one per log
+     * it writes to, so switching between logs neither adds buffers nor
+     * leaves open records behind; the last one used is looked up first.
+     */
+    ThreadBuffer& local()
+    {
+        struct Cache
+        {
+            uint64_t logId = 0;
+            ThreadBuffer* buffer = nullptr;
+            ///log ids are never reused, entries of closed logs are not looked up again
+            std::unordered_map<uint64_t, ThreadBuffer*> buffers;
+        };
+        static thread_local Cache cache;
+        if (cache.logId != mId)
+        {
+            ThreadBuffer*& buffer = cache.buffers[mId];
+            if (buffer == nullptr)
+            {
+                std::lock_guard<std::mutex> guard(mBuffersLock);
+                mBuffers.emplace_back(new ThreadBuffer());
+                mBuffers.back()->open.reserve(REDO_LOG_BUFFER_SIZE);
+                buffer = mBuffers.back().get();
+            }
+            cache.buffer = buffer;
+            cache.logId = mId;
+        }
+        return *cache.buffer;
+    }
+
+    void writerLoop()
+    {
+        while (true)
+        {
+            bool stop;
+            {
+                std::unique_lock<std::mutex> guard(mWriterLock);
+                mWakeWriter.wait_for(guard, std::chrono::microseconds(mGroupLatencyUs), [this] {
+                    return mStop || mPending.load(std::memory_order_relaxed) >= mGroupSize;
+                });
+                stop = mStop;
+            }
+            syncGroup();
+            if (stop)
+                return;
+        }
+    }
+
+    /// Writes all sealed commits with one write and one fdatasync, then completes their group
+    void syncGroup()
+    {
+        auto group = std::atomic_load(&mGroup);
+        std::atomic_store(&mGroup, std::make_shared<FlushGroup>());
+
+        std::vector<StreamType> chunks;
+        size_t commits = 0;
+        {
+            std::lock_guard<std::mutex> guard(mBuffersLock);
+            for (auto& buffer : mBuffers)
+            {
+                std::lock_guard<std::mutex> bufferGuard(buffer->lock);
+                if (buffer->sealedCommits == 0)
+                    continue;
+                chunks.emplace_back();
+                chunks.back().swap(buffer->sealed);
+                commits += buffer->sealedCommits;
+                buffer->sealedCommits = 0;
+            }
+        }
+        mPending.fetch_sub(commits, std::memory_order_relaxed);
+
+        if (commits > 0)
+        {
+            std::vector<struct iovec> iov;
+            size_t bytes = 0;
+            for (auto& chunk : chunks)
+            {
+                iov.push_back({chunk.data(), chunk.size()});
+                bytes += chunk.size();
+            }
+            {
+                std::lock_guard<std::mutex> guard(mFileLock);
+                writeAll(mFd, iov);
+                syncFile(mFd);
+                mFileSize += bytes;
+            }
+            mCommits += commits;
+            mGroups++;
+            mBytes += bytes;
+        }
+        group->done.set_value();
+    }
+
+    void writeAll(int fd, std::vector<struct iovec>& iov)
+    {
+        size_t first = 0;
+        while (first < iov.size())
+        {
+            ssize_t written = ::writev(fd, &iov[first], (int)std::min<size_t>(iov.size() - first, IOV_MAX));
+            if (written < 0)
+                throw std::runtime_error("redo log write failed " + mPath);
+            while (first < iov.size() && (size_t)written >= iov[first].iov_len)
+                written -= iov[first++].iov_len;
+            if (first < iov.size())
+            {
+                iov[first].iov_base = (uint8_t*)iov[first].iov_base + written;
+                iov[first].iov_len -= written;
+            }
+        }
+    }
+
+    std::string mPath;
+    int mFd;
+    size_t mGroupSize;
+    uint64_t mGroupLatencyUs;
+    uint64_t mId;
+
+    ///held by the log writer around write+sync and by truncate()
+    std::mutex mFileLock;
+    std::atomic<uint64_t> mFileSize;
+
+    std::mutex mBuffersLock;
+    std::vector<std::unique_ptr<ThreadBuffer>> mBuffers;
+    std::shared_ptr<FlushGroup> mGroup;
+    std::atomic<size_t> mPending;
+
+    boost::thread* mWriter;
+    std::mutex mWriterLock;
+    std::condition_variable mWakeWriter;
+    bool mStop;
+
+    std::atomic<uint64_t> mCommits;
+    std::atomic<uint64_t> mGroups;
+    std::atomic<uint64_t> mBytes;
+};
+
+#endif //MVCCART_REDOLOG_HPP
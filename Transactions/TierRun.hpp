@@ -0,0 +1,249 @@
+//
+// Created by Players Inc on 19/10/2026.
+//
+
+#ifndef MVCCART_TIERRUN_HPP
+#define MVCCART_TIERRUN_HPP
+
+#include <boost/thread.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "RedoLog.hpp"
+
+/// Bytes of one block of a run, the unit a lookup reads and the block cache keeps
+#ifndef TIER_BLOCK_SIZE
+#define TIER_BLOCK_SIZE 4096
+#endif
+
+/// Blocks the block cache of a table keeps over all runs
+#ifndef TIER_BLOCK_CACHE_BLOCKS
+#define TIER_BLOCK_CACHE_BLOCKS 1024
+#endif
+
+/// Point reads an evicted key range serves from its run before it is loaded back
+#ifndef TIER_RELOAD_READS
+#define TIER_RELOAD_READS 256
+#endif
+
+
+/// Where tiering stands, counters since the memory budget was set
+struct TierStats
+{
+    uint64_t evictedRanges = 0;
+    uint64_t residentBytes = 0;
+    uint64_t runRecords = 0;
+    uint64_t runBytes = 0;
+    uint64_t evictions = 0;
+    uint64_t reloads = 0;
+    uint64_t runReads = 0;
+    uint64_t blockCacheHits = 0;
+    uint64_t blockCacheMisses = 0;
+};
+
+
+/**
+ * Immutable run of one evicted key range, sorted by key. Records use the
+ * redo log format and are cut into blocks of about TIER_BLOCK_SIZE bytes;
+ * the first key of every block stays in memory, so a lookup reads one block.
+ * Written front to back with add() and finish(), removed with the object.
+ */
+class TierRun
+{
+    struct Block
+    {
+        std::string firstKey;
+        uint64_t offset;
+        uint32_t length;
+    };
+
+public:
+
+    explicit TierRun(const std::string& path) : mPath(path), mId(nextId()), mRecords(0), mBytes(0)
+    {
+        mFd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (mFd < 0)
+            throw std::runtime_error("cannot create tier run " + path);
+    }
+
+    TierRun(const TierRun&) = delete;
+    TierRun& operator=(const TierRun&) = delete;
+
+    ~TierRun()
+    {
+        ::close(mFd);
+        ::unlink(mPath.c_str());
+    }
+
+    /// Appends a record, keys have to come in ascending order
+    template <typename RecordType>
+    void add(const char* key, size_t keyLen, const RecordType& record, uint64_t ts)
+    {
+        if (mBuffer.empty())
+            mBlocks.push_back(Block{std::string(key, keyLen), mBytes, 0});
+        RedoLog::encodePut(mBuffer, key, keyLen, record, ts);
+        mRecords++;
+        if (mBuffer.size() >= TIER_BLOCK_SIZE)
+            writeBlock();
+    }
+
+    /// Writes the last block and makes the run durable
+    void finish()
+    {
+        writeBlock();
+#ifdef __APPLE__
+        ::fsync(mFd);
+#else
+        ::fdatasync(mFd);
+#endif
+    }
+
+    /// Block that holds key if the run does, -1 if key sorts before the run
+    long findBlock(const char* key, size_t keyLen) const
+    {
+        std::string wanted(key, keyLen);
+        auto it = std::upper_bound(mBlocks.begin(), mBlocks.end(), wanted,
+                                   [](const std::string& k, const Block& b) { return k < b.firstKey; });
+        return (long)(it - mBlocks.begin()) - 1;
+    }
+
+    std::vector<uint8_t> readBlock(size_t block) const
+    {
+        const Block& b = mBlocks[block];
+        std::vector<uint8_t> bytes(b.length);
+        size_t done = 0;
+        while (done < bytes.size())
+        {
+            ssize_t got = ::pread(mFd, bytes.data() + done, bytes.size() - done, b.offset + done);
+            if (got <= 0)
+                throw std::runtime_error("cannot read tier run " + mPath);
+            done += got;
+        }
+        return bytes;
+    }
+
+    /// Calls visitor(const RedoRecord&) on every record in key order
+    template <typename Visitor>
+    void forEach(Visitor visitor) const
+    {
+        for (size_t b = 0; b < mBlocks.size(); b++)
+        {
+            std::vector<uint8_t> bytes = readBlock(b);
+            RedoLog::scan(bytes, visitor);
+        }
+    }
+
+    uint64_t id() const { return mId; }
+    size_t blocks() const { return mBlocks.size(); }
+    uint64_t records() const { return mRecords; }
+    uint64_t bytes() const { return mBytes; }
+
+private:
+
+    void writeBlock()
+    {
+        size_t done = 0;
+        while (done < mBuffer.size())
+        {
+            ssize_t written = ::write(mFd, mBuffer.data() + done, mBuffer.size() - done);
+            if (written < 0)
+                throw std::runtime_error("tier run write failed " + mPath);
+            done += written;
+        }
+        if (!mBuffer.empty())
+            mBlocks.back().length = (uint32_t) mBuffer.size();
+        mBytes += mBuffer.size();
+        mBuffer.clear();
+    }
+
+    static uint64_t nextId()
+    {
+        static std::atomic<uint64_t> ids(0);
+        return ++ids;
+    }
+
+    std::string mPath;
+    int mFd;
+    uint64_t mId;
+    std::vector<Block> mBlocks;
+    StreamType mBuffer;
+    uint64_t mRecords;
+    uint64_t mBytes;
+};
+
+
+/**
+ * Blocks recently read from runs, LRU per shard. Runs are immutable and
+ * their ids never reused, so a cached block never goes stale; the blocks of
+ * a run loaded back just age out.
+ */
+class TierBlockCache
+{
+    typedef std::shared_ptr<const std::vector<uint8_t>> Entry;
+
+    struct Shard
+    {
+        boost::mutex lock;
+        std::list<std::pair<uint64_t, Entry>> lru;
+        std::unordered_map<uint64_t, std::list<std::pair<uint64_t, Entry>>::iterator> index;
+    };
+
+    static constexpr size_t Shards = 16;
+
+public:
+
+    explicit TierBlockCache(size_t capacity = TIER_BLOCK_CACHE_BLOCKS)
+            : mShardCapacity(std::max<size_t>(1, capacity / Shards)), mHits(0), mMisses(0) {}
+
+    /// Block of run, read from disk on a miss
+    Entry get(const TierRun& run, size_t block)
+    {
+        uint64_t key = (run.id() << 32) | block;
+        Shard& shard = mShards[(key * 0x9E3779B97F4A7C15ull) >> 32 & (Shards - 1)];
+        {
+            boost::mutex::scoped_lock guard(shard.lock);
+            auto it = shard.index.find(key);
+            if (it != shard.index.end())
+            {
+                shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+                mHits.fetch_add(1, std::memory_order_relaxed);
+                return it->second->second;
+            }
+        }
+        mMisses.fetch_add(1, std::memory_order_relaxed);
+        Entry bytes = std::make_shared<const std::vector<uint8_t>>(run.readBlock(block));
+        boost::mutex::scoped_lock guard(shard.lock);
+        if (!shard.index.count(key))
+        {
+            shard.lru.emplace_front(key, bytes);
+            shard.index[key] = shard.lru.begin();
+            if (shard.lru.size() > mShardCapacity)
+            {
+                shard.index.erase(shard.lru.back().first);
+                shard.lru.pop_back();
+            }
+        }
+        return bytes;
+    }
+
+    uint64_t hits() const { return mHits.load(); }
+    uint64_t misses() const { return mMisses.load(); }
+
+private:
+
+    size_t mShardCapacity;
+    Shard mShards[Shards];
+    std::atomic<uint64_t> mHits;
+    std::atomic<uint64_t> mMisses;
+};
+
+#endif //MVCCART_TIERRUN_HPP
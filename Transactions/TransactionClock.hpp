@@ -0,0 +1,158 @@
+//
+// Created by Players Inc on 19/10/2026.
+//
+
+#ifndef MVCCART_TRANSACTIONCLOCK_HPP
+#define MVCCART_TRANSACTIONCLOCK_HPP
+
+#include <atomic>
+#include <stdint.h>
+#include <thread>
+#include "mvcc/snapshot.hpp"
+
+/// Transaction ids a thread reserves with one fetch_add
+#ifndef TXN_ID_BATCH_SIZE
+#define TXN_ID_BATCH_SIZE 1024
+#endif
+
+/// Commit timestamps that may be drawn ahead of the newest published one
+#ifndef TXN_PUBLISH_WINDOW
+#define TXN_PUBLISH_WINDOW 4096
+#endif
+
+static_assert(sizeof(size_t) == sizeof(uint64_t), "versions and timestamps are 64-bit");
+
+
+/**
+ * 64-bit timestamp service with two independent paths.
+ * Commit timestamps are strictly ordered: drawn with one fetch_add and
+ * published only after every smaller one, so a reader taking
+ * readTimestamp() sees all commits up to it fully stamped. A committer
+ * marks its timestamp ready and whoever finds the next one ready moves the
+ * read timestamp on, so a commit never waits for a later one to be drawn
+ * and an autocommit timestamp does not wait at all.
+ * Transaction ids only need to be unique: every thread reserves a range of
+ * TXN_ID_BATCH_SIZE ids and hands them out without shared writes.
+ */
+class TransactionClock
+{
+    struct IdRange
+    {
+        uint64_t next;
+        uint64_t end;
+        uint64_t generation;
+    };
+
+public:
+
+    TransactionClock() : mCommitCounter(0), mReadTs(0), mTxnCounter(0), mGeneration(0)
+    {
+        for (auto& ready : mReady)
+            ready.store(0, std::memory_order_relaxed);
+    }
+
+    /// Newest fully committed timestamp, the snapshot of a new reader
+    uint64_t readTimestamp() const
+    {
+        return mReadTs.load(std::memory_order_acquire);
+    }
+
+    /// Reserves the next commit timestamp, must be followed by publish()
+    uint64_t acquireCommitTimestamp()
+    {
+        return mCommitCounter.fetch_add(1, std::memory_order_acq_rel) + 1;
+    }
+
+    /// Makes a stamped commit visible to new readers in timestamp order, returns once it is
+    void publish(uint64_t commitTs)
+    {
+        markReady(commitTs);
+        while (mReadTs.load(std::memory_order_acquire) < commitTs)
+        {
+            std::this_thread::yield();
+            advance();
+        }
+    }
+
+    /**
+     * Timestamp for a write that is visible immediately (legacy size_t id API).
+     * Never waits for other commits: it is published with the ones before it,
+     * at once unless an explicit commit before it is still being stamped.
+     */
+    uint64_t autoCommitTimestamp()
+    {
+        uint64_t ts = acquireCommitTimestamp();
+        markReady(ts);
+        return ts;
+    }
+
+    /// Unique id of an explicit transaction, tagged so it never equals a timestamp
+    size_t nextTxnId()
+    {
+        static thread_local IdRange range = {0, 0, 0};
+        uint64_t generation = mGeneration.load(std::memory_order_relaxed);
+        if (range.next == range.end || range.generation != generation)
+        {
+            range.next = mTxnCounter.fetch_add(TXN_ID_BATCH_SIZE, std::memory_order_relaxed) + 1;
+            range.end = range.next + TXN_ID_BATCH_SIZE;
+            range.generation = generation;
+        }
+        return MVCC11_TXN_ID_FLAG | range.next++;
+    }
+
+    /// Moves both clocks past ts (recovered versions), only valid while no transaction is running
+    void advanceTo(uint64_t ts)
+    {
+        if (mCommitCounter.load() < ts)
+            mCommitCounter.store(ts);
+        if (mReadTs.load() < ts)
+            mReadTs.store(ts);
+    }
+
+    /// Only valid while no transaction is running, drops all reserved id ranges
+    void reset()
+    {
+        for (auto& ready : mReady)
+            ready.store(0, std::memory_order_relaxed);
+        mCommitCounter.store(0);
+        mReadTs.store(0);
+        mTxnCounter.store(0);
+        mGeneration.fetch_add(1);
+    }
+
+private:
+
+    void markReady(uint64_t commitTs)
+    {
+        ///the slot of commitTs is free once the one TXN_PUBLISH_WINDOW before it is published
+        while (commitTs - mReadTs.load(std::memory_order_acquire) > TXN_PUBLISH_WINDOW)
+            std::this_thread::yield();
+        ///ordered before the read timestamp is loaded, see advance()
+        mReady[commitTs % TXN_PUBLISH_WINDOW].store(commitTs, std::memory_order_seq_cst);
+        advance();
+    }
+
+    /// Publishes every ready timestamp following the read timestamp
+    void advance()
+    {
+        uint64_t readTs = mReadTs.load(std::memory_order_seq_cst);
+        ///a committer marking readTs + 1 after this load finds the new read timestamp itself
+        while (mReady[(readTs + 1) % TXN_PUBLISH_WINDOW].load(std::memory_order_seq_cst) == readTs + 1)
+        {
+            if (mReadTs.compare_exchange_weak(readTs, readTs + 1, std::memory_order_seq_cst))
+                readTs++;
+        }
+    }
+
+    ///read timestamp on its own cache line, readers never share it with a RMW target
+    alignas(64) std::atomic<uint64_t> mCommitCounter;
+    alignas(64) std::atomic<uint64_t> mReadTs;
+    alignas(64) std::atomic<uint64_t> mTxnCounter;
+    std::atomic<uint64_t> mGeneration;
+    ///mReady[ts % TXN_PUBLISH_WINDOW] == ts once commit ts may be published
+    alignas(64) std::atomic<uint64_t> mReady[TXN_PUBLISH_WINDOW];
+};
+
+TransactionClock txnClock;
+
+#endif //MVCCART_TRANSACTIONCLOCK_HPP
@@ -0,0 +1,266 @@
+//
+// Created by Players Inc on 19/10/2026.
+//
+
+#ifndef MVCCART_TRANSACTIONEXECUTOR_HPP
+#define MVCCART_TRANSACTIONEXECUTOR_HPP
+
+#include <iostream>
+#include <boost/thread.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/// Number of pool workers, 0 means one per hardware thread
+#ifndef TRANSACTION_EXECUTOR_WORKERS
+#define TRANSACTION_EXECUTOR_WORKERS 0
+#endif
+
+/// Pin worker i to core i (mod #cores) when set to 1
+#ifndef TRANSACTION_EXECUTOR_PIN_CORES
+#define TRANSACTION_EXECUTOR_PIN_CORES 0
+#endif
+
+/// Outcome of a transaction handed to the executor
+enum class TxnStatus
+{
+    Committed,
+    Aborted
+};
+
+/// Thrown by a transaction body to abort itself
+struct TransactionAbort {};
+
+
+/**
+ * Fixed-size pool of transaction workers.
+ * Every worker owns a deque: it pops its own work LIFO and, when empty,
+ * steals FIFO from the other workers before going idle. submit() returns a
+ * future that carries the commit/abort status of the transaction body;
+ * wait() on it runs queued work meanwhile, so a body may submit and wait
+ * for nested transactions even on a single worker.
+ */
+class TransactionExecutor
+{
+    struct Task
+    {
+        std::function<void()> body;
+        std::promise<TxnStatus> status;
+    };
+
+    struct Worker
+    {
+        std::mutex lock;
+        std::deque<Task> tasks;
+        boost::thread* thread;
+    };
+
+public:
+
+    TransactionExecutor(size_t numWorkers = TRANSACTION_EXECUTOR_WORKERS,
+                        bool pinToCores = TRANSACTION_EXECUTOR_PIN_CORES)
+            : mPending(0), mNextWorker(0), mStop(false)
+    {
+        if (numWorkers == 0)
+            numWorkers = std::max(1u, boost::thread::hardware_concurrency());
+
+        for (size_t i = 0; i < numWorkers; i++)
+            mWorkers.emplace_back(new Worker());
+
+        for (size_t i = 0; i < numWorkers; i++)
+        {
+            mWorkers[i]->thread = new boost::thread(&TransactionExecutor::workerLoop, this, i);
+            if (pinToCores)
+                pinWorker(i, i);
+        }
+    }
+
+    ~TransactionExecutor()
+    {
+        {
+            std::lock_guard<std::mutex> guard(mIdleLock);
+            mStop = true;
+        }
+        mIdle.notify_all();
+        for (auto& worker : mWorkers)
+        {
+            worker->thread->join();
+            delete worker->thread;
+        }
+    }
+
+    /**
+     * Queues a transaction body on the pool.
+     * Called from a worker the task goes to that worker's own deque,
+     * otherwise workers are chosen round robin.
+     * @return future completing with Aborted if the body throws
+     */
+    template <typename TxnFunc>
+    std::future<TxnStatus> submit(TxnFunc txnFunc)
+    {
+        Task task;
+        task.body = std::function<void()>(std::move(txnFunc));
+        auto future = task.status.get_future();
+
+        size_t target = (currentWorker() < mWorkers.size())
+                        ? currentWorker()
+                        : mNextWorker.fetch_add(1, std::memory_order_relaxed) % mWorkers.size();
+        {
+            ///counted before a taker can decrement it, take() waits for mIdleLock
+            std::lock_guard<std::mutex> idle(mIdleLock);
+            std::lock_guard<std::mutex> guard(mWorkers[target]->lock);
+            mWorkers[target]->tasks.push_back(std::move(task));
+            mPending++;
+        }
+        mIdle.notify_one();
+        return future;
+    }
+
+    /**
+     * Waits for a submitted transaction, running queued ones inline while
+     * it is not done: the calling worker's own first, then stolen ones.
+     * @return the status the future carries
+     */
+    TxnStatus wait(std::future<TxnStatus>& future)
+    {
+        while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            Task task;
+            if (take(currentWorker(), task))
+                run(task);
+            else
+                std::this_thread::yield();
+        }
+        return future.get();
+    }
+
+    /// Binds a worker thread to a core, no-op where affinity is unsupported
+    bool pinWorker(size_t worker, size_t core)
+    {
+#ifdef __linux__
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(core % std::max(1u, boost::thread::hardware_concurrency()), &cpus);
+        return pthread_setaffinity_np(mWorkers[worker]->thread->native_handle(),
+                                      sizeof(cpu_set_t), &cpus) == 0;
+#else
+        (void)worker;
+        (void)core;
+        return false;
+#endif
+    }
+
+    size_t size() const
+    {
+        return mWorkers.size();
+    }
+
+private:
+
+    static size_t& currentWorker()
+    {
+        static thread_local size_t index = (size_t)-1;
+        return index;
+    }
+
+    bool popLocal(size_t self, Task& task)
+    {
+        std::lock_guard<std::mutex> guard(mWorkers[self]->lock);
+        if (mWorkers[self]->tasks.empty())
+            return false;
+        task = std::move(mWorkers[self]->tasks.back());
+        mWorkers[self]->tasks.pop_back();
+        return true;
+    }
+
+    /// Steals from every worker but self, which is out of range for other threads
+    bool steal(size_t self, Task& task)
+    {
+        for (size_t i = 1; i <= mWorkers.size(); i++)
+        {
+            size_t index = (self + i) % mWorkers.size();
+            if (index == self)
+                continue;
+            Worker& victim = *mWorkers[index];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty())
+            {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// Pops or steals a task and uncounts it, only ever after a successful pop
+    bool take(size_t self, Task& task)
+    {
+        bool found = (self < mWorkers.size() && popLocal(self, task)) || steal(self, task);
+        if (found)
+        {
+            std::lock_guard<std::mutex> guard(mIdleLock);
+            mPending--;
+        }
+        return found;
+    }
+
+    void workerLoop(size_t self)
+    {
+        currentWorker() = self;
+        while (true)
+        {
+            Task task;
+            if (take(self, task))
+            {
+                run(task);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> idle(mIdleLock);
+            mIdle.wait(idle, [this] { return mStop || mPending > 0; });
+            if (mStop && mPending == 0)
+                return;
+        }
+    }
+
+    static void run(Task& task)
+    {
+        try
+        {
+            task.body();
+            task.status.set_value(TxnStatus::Committed);
+        }
+        catch (...)
+        {
+            task.status.set_value(TxnStatus::Aborted);
+        }
+    }
+
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+    std::mutex mIdleLock;
+    std::condition_variable mIdle;
+    size_t mPending;
+    std::atomic<size_t> mNextWorker;
+    bool mStop;
+};
+
+/// Process-wide executor used by Transaction, started on first use
+inline TransactionExecutor& getTransactionExecutor()
+{
+    static TransactionExecutor executor;
+    return executor;
+}
+
+#endif //MVCCART_TRANSACTIONEXECUTOR_HPP
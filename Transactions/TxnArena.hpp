@@ -0,0 +1,181 @@
+//
+// Created by Players Inc on 19/10/2026.
+//
+
+#ifndef MVCCART_TXNARENA_HPP
+#define MVCCART_TXNARENA_HPP
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+
+/// Bytes per arena block, read/write set entries are bump allocated inside
+#ifndef TXN_ARENA_BLOCK_SIZE
+#define TXN_ARENA_BLOCK_SIZE 4096
+#endif
+
+/// Free blocks a thread keeps for reuse, the rest goes back to the heap
+#ifndef TXN_ARENA_MAX_FREE_BLOCKS
+#define TXN_ARENA_MAX_FREE_BLOCKS 64
+#endif
+
+
+struct TxnArenaBlock
+{
+    TxnArenaBlock* next;
+    size_t used;
+    alignas(16) unsigned char data[TXN_ARENA_BLOCK_SIZE - 2 * sizeof(void*)];
+};
+
+
+/**
+ * Per-thread pool of arena blocks. Transactions take blocks on demand and
+ * hand the whole chain back on commit/abort, so steady-state transactions
+ * do not touch the heap and memory stays bounded by the number of blocks
+ * live transactions hold plus TXN_ARENA_MAX_FREE_BLOCKS per thread.
+ */
+class TxnArena
+{
+public:
+
+    static TxnArena& local()
+    {
+        static thread_local TxnArena arena;
+        return arena;
+    }
+
+    TxnArena() : mFree(nullptr), mFreeCount(0) {}
+
+    TxnArena(const TxnArena&) = delete;
+    TxnArena& operator=(const TxnArena&) = delete;
+
+    ~TxnArena()
+    {
+        while (mFree)
+        {
+            TxnArenaBlock* next = mFree->next;
+            delete mFree;
+            liveBlocks()--;
+            mFree = next;
+        }
+    }
+
+    TxnArenaBlock* acquire()
+    {
+        TxnArenaBlock* block = mFree;
+        if (block)
+        {
+            mFree = block->next;
+            mFreeCount--;
+        }
+        else
+        {
+            block = new TxnArenaBlock();
+            liveBlocks()++;
+        }
+        block->next = nullptr;
+        block->used = 0;
+        return block;
+    }
+
+    /// Returns a chain of blocks linked through next
+    void release(TxnArenaBlock* chain)
+    {
+        while (chain)
+        {
+            TxnArenaBlock* next = chain->next;
+            if (mFreeCount < TXN_ARENA_MAX_FREE_BLOCKS)
+            {
+                chain->next = mFree;
+                mFree = chain;
+                mFreeCount++;
+            }
+            else
+            {
+                delete chain;
+                liveBlocks()--;
+            }
+            chain = next;
+        }
+    }
+
+    /// Blocks allocated from the heap by all threads and not freed yet
+    static std::atomic<int64_t>& liveBlocks()
+    {
+        static std::atomic<int64_t> blocks(0);
+        return blocks;
+    }
+
+private:
+    TxnArenaBlock* mFree;
+    size_t mFreeCount;
+};
+
+
+/**
+ * Append-only list of trivially copyable entries stored in arena blocks.
+ * The newest block is the head of the chain, so entries are visited
+ * newest first, which is the order rollback needs.
+ */
+template <typename Entry>
+class TxnEntryList
+{
+    static constexpr size_t PerBlock = sizeof(TxnArenaBlock::data) / sizeof(Entry);
+
+public:
+
+    TxnEntryList() : mHead(nullptr), mSize(0) {}
+
+    TxnEntryList(const TxnEntryList&) = delete;
+    TxnEntryList& operator=(const TxnEntryList&) = delete;
+
+    ~TxnEntryList()
+    {
+        clear();
+    }
+
+    void push_back(const Entry& entry)
+    {
+        if (mHead == nullptr || mHead->used == PerBlock)
+        {
+            TxnArenaBlock* block = TxnArena::local().acquire();
+            block->next = mHead;
+            mHead = block;
+        }
+        new (entries(mHead) + mHead->used) Entry(entry);
+        mHead->used++;
+        mSize++;
+    }
+
+    template <typename Visitor>
+    void forEachNewestFirst(Visitor visitor)
+    {
+        for (TxnArenaBlock* block = mHead; block; block = block->next)
+            for (size_t i = block->used; i > 0; i--)
+                visitor(entries(block)[i - 1]);
+    }
+
+    /// Hands all blocks back to the calling thread's arena
+    void clear()
+    {
+        TxnArena::local().release(mHead);
+        mHead = nullptr;
+        mSize = 0;
+    }
+
+    size_t size() const { return mSize; }
+    bool empty() const { return mSize == 0; }
+
+private:
+
+    static Entry* entries(TxnArenaBlock* block)
+    {
+        return reinterpret_cast<Entry*>(block->data);
+    }
+
+    TxnArenaBlock* mHead;
+    size_t mSize;
+};
+
+#endif //MVCCART_TXNARENA_HPP
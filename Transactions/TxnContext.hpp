@@ -0,0 +1,251 @@
+//
+// Created by Players Inc on 19/10/2026.
+//
+
+#ifndef MVCCART_TXNCONTEXT_HPP
+#define MVCCART_TXNCONTEXT_HPP
+
+#include "TransactionClock.hpp"
+#include "ActiveTxnRegistry.hpp"
+#include "TxnArena.hpp"
+#include "RedoLog.hpp"
+
+
+/// Type-erased commit/abort hooks of one mvcc object type
+struct TxnWriteOps
+{
+    /// Replaces txn_id by commit_ts in the version and the version it overwrote
+    void (*commit)(void* object, void* version, size_t txn_id, size_t commit_ts);
+    /// Unlinks or restores a version written by txn_id
+    void (*abort)(void* object, void* version, size_t txn_id);
+};
+
+/// One version installed by a transaction: mvcc object, version, hooks of its type
+struct TxnWrite
+{
+    void* object;
+    void* version;
+    const TxnWriteOps* ops;
+};
+
+/// One version returned to a transaction by a read
+struct TxnRead
+{
+    const void* leaf;
+    const void* version;
+};
+
+
+/**
+ * Explicit transaction: begin(), any number of table operations taking the
+ * context, then commit() or abort(). Runs on the calling thread.
+ * Versions written before commit carry the flagged transaction id and are
+ * only visible to the owner; commit() stamps them with a commit timestamp,
+ * abort() unlinks them again.
+ * Read and write sets are raw pointer entries in arena blocks of the
+ * thread running the transaction and are handed back on commit/abort.
+ * Writes to a table with a redo log are sealed in that log on commit and
+ * dropped from it on abort; durable() completes once the commit is on disk.
+ */
+class TxnContext
+{
+public:
+    enum class State
+    {
+        Idle,
+        Active,
+        Committed,
+        Aborted
+    };
+
+    TxnContext() : mId(0), mBeginTs(0), mCommitTs(0), mSlot(0), mLog(nullptr), mState(State::Idle), mRollbackOnly(false), mReadOnly(false) {}
+
+    TxnContext(const TxnContext&) = delete;
+    TxnContext& operator=(const TxnContext&) = delete;
+
+    ~TxnContext()
+    {
+        if (mState == State::Active)
+            abort();
+    }
+
+    void begin()
+    {
+        if (mState == State::Active)
+            abort();
+        mId = txnClock.nextTxnId();
+        mSlot = activeTxnRegistry.enter(mBeginTs);
+        mCommitTs = 0;
+        mRollbackOnly = false;
+        mReadOnly = false;
+        mLog = nullptr;
+        mDurable = std::shared_future<void>();
+        mWrites.clear();
+        mReads.clear();
+        mState = State::Active;
+    }
+
+    /**
+     * Starts a declared read-only transaction: a registry slot and the published
+     * read timestamp, no id, no read set, never seen by conflict checks.
+     * Writes through the context are rejected.
+     */
+    void beginReadOnly()
+    {
+        if (mState == State::Active)
+            abort();
+        mId = MVCC11_READ_ONLY_TXN_ID;
+        mSlot = activeTxnRegistry.enter(mBeginTs);
+        mCommitTs = mBeginTs;
+        mRollbackOnly = false;
+        mReadOnly = true;
+        mLog = nullptr;
+        mDurable = std::shared_future<void>();
+        mState = State::Active;
+    }
+
+    /**
+     * Stamps all writes with a fresh commit timestamp.
+     * @return false if the transaction hit a conflict and was aborted instead
+     */
+    bool commit()
+    {
+        if (mState != State::Active)
+            return false;
+        if (mReadOnly)
+        {
+            activeTxnRegistry.leave(mSlot);
+            mState = mRollbackOnly ? State::Aborted : State::Committed;
+            return !mRollbackOnly;
+        }
+        if (mRollbackOnly)
+        {
+            abort();
+            return false;
+        }
+        if (!mWrites.empty())
+        {
+            mCommitTs = txnClock.acquireCommitTimestamp();
+            mWrites.forEachNewestFirst([this](TxnWrite& write) {
+                write.ops->commit(write.object, write.version, mId, mCommitTs);
+            });
+            txnClock.publish(mCommitTs);
+            if (mLog != nullptr)
+                mDurable = mLog->seal(mCommitTs);
+        }
+        else
+            mCommitTs = mBeginTs;
+        mWrites.clear();
+        mReads.clear();
+        activeTxnRegistry.leave(mSlot);
+        mState = State::Committed;
+        return true;
+    }
+
+    void abort()
+    {
+        if (mState != State::Active)
+            return;
+        ///newest first, so every unlinked version is the head of its chain
+        mWrites.forEachNewestFirst([this](TxnWrite& write) {
+            write.ops->abort(write.object, write.version, mId);
+        });
+        if (mLog != nullptr)
+            mLog->discard();
+        mWrites.clear();
+        mReads.clear();
+        activeTxnRegistry.leave(mSlot);
+        mState = State::Aborted;
+    }
+
+    void addWrite(void* object, void* version, const TxnWriteOps* ops)
+    {
+        mWrites.push_back(TxnWrite{object, version, ops});
+    }
+
+    /**
+     * Routes the redo records of this transaction to log, they wait in the
+     * buffer of the calling thread until commit/abort.
+     * @return false if the transaction already logs to another log
+     */
+    bool logTo(RedoLog* log)
+    {
+        if (mLog != nullptr && mLog != log)
+            return false;
+        mLog = log;
+        return true;
+    }
+
+    /// Completes once the commit is durable, at once without a redo log or before commit
+    std::shared_future<void> durable() const
+    {
+        if (mDurable.valid())
+            return mDurable;
+        std::promise<void> done;
+        done.set_value();
+        return done.get_future().share();
+    }
+
+    void addRead(const void* leaf, const void* version)
+    {
+        if (!mReadOnly)
+            mReads.push_back(TxnRead{leaf, version});
+    }
+
+    /// Marks a write-write conflict, commit() will abort
+    void setRollbackOnly()
+    {
+        mRollbackOnly = true;
+    }
+
+    bool isRollbackOnly() const { return mRollbackOnly; }
+    bool isActive() const { return mState == State::Active; }
+    bool isReadOnly() const { return mReadOnly; }
+    State state() const { return mState; }
+    size_t id() const { return mId; }
+    uint64_t beginTs() const { return mBeginTs; }
+    uint64_t commitTs() const { return mCommitTs; }
+    size_t writeCount() const { return mWrites.size(); }
+    size_t readCount() const { return mReads.size(); }
+
+    /// Context the calling thread is currently executing an operation for
+    static TxnContext*& current()
+    {
+        static thread_local TxnContext* context = nullptr;
+        return context;
+    }
+
+private:
+    size_t mId;
+    uint64_t mBeginTs;
+    uint64_t mCommitTs;
+    ActiveTxnRegistry::Handle mSlot;
+    RedoLog* mLog;
+    std::shared_future<void> mDurable;
+    State mState;
+    bool mRollbackOnly;
+    bool mReadOnly;
+    TxnEntryList<TxnWrite> mWrites;
+    TxnEntryList<TxnRead> mReads;
+};
+
+
+/// Binds a context to the calling thread for the duration of one table operation
+class TxnScope
+{
+public:
+    explicit TxnScope(TxnContext& txn) : mPrevious(TxnContext::current())
+    {
+        TxnContext::current() = &txn;
+    }
+
+    ~TxnScope()
+    {
+        TxnContext::current() = mPrevious;
+    }
+
+private:
+    TxnContext* mPrevious;
+};
+
+#endif //MVCCART_TXNCONTEXT_HPP
@@ -0,0 +1,400 @@
+//
+// Created by Players Inc on 19/10/2026.
+//
+
+#ifndef MVCCART_VALUESTORE_HPP
+#define MVCCART_VALUESTORE_HPP
+
+#include <boost/thread.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// Bytes of one value segment file, mapped whole; at most 64 MB, the offset has 26 bits
+#ifndef VALUE_STORE_SEGMENT_SIZE
+#define VALUE_STORE_SEGMENT_SIZE (64 << 20)
+#endif
+
+/// A sealed segment with fewer live bytes than this share of its size is compacted
+#ifndef VALUE_STORE_COMPACT_PERCENT
+#define VALUE_STORE_COMPACT_PERCENT 50
+#endif
+
+/// Decoded records the hot record cache keeps, over all shards
+#ifndef VALUE_STORE_CACHE_ENTRIES
+#define VALUE_STORE_CACHE_ENTRIES 65536
+#endif
+
+/// Independently locked parts of the hot record cache, and of the pin counters
+#ifndef VALUE_STORE_SHARDS
+#define VALUE_STORE_SHARDS 16
+#endif
+
+static_assert(VALUE_STORE_SEGMENT_SIZE <= (1 << 26), "segment offsets have 26 bits");
+
+
+/**
+ * Where a record lives in a ValueStore, packed in one word so compaction can
+ * move it while readers resolve it: 16 bits segment, 26 bits offset, 22 bits
+ * length. Segment 0 is never used, a zero handle names no record.
+ */
+struct ValueHandle
+{
+    uint64_t bits;
+
+    static ValueHandle make(uint32_t segment, uint64_t offset, uint32_t length)
+    {
+        ValueHandle handle;
+        handle.bits = ((uint64_t) segment << 48) | (offset << 22) | length;
+        return handle;
+    }
+
+    uint32_t segment() const { return (uint32_t)(bits >> 48); }
+    uint64_t offset() const { return (bits >> 22) & ((1 << 26) - 1); }
+    uint32_t length() const { return (uint32_t)(bits & ((1 << 22) - 1)); }
+
+    /// The handle as it is now, compaction may be replacing it
+    ValueHandle load() const
+    {
+        ValueHandle handle;
+        handle.bits = __atomic_load_n(&bits, __ATOMIC_ACQUIRE);
+        return handle;
+    }
+
+    void store(ValueHandle handle)
+    {
+        __atomic_store_n(&bits, handle.bits, __ATOMIC_RELEASE);
+    }
+};
+
+
+/// What a ValueStore holds, live bytes as of the last mark
+struct ValueStoreStats
+{
+    uint64_t segments = 0;
+    uint64_t appendedBytes = 0;
+    uint64_t liveBytes = 0;
+    uint64_t relocatedBytes = 0;
+    uint64_t retiredSegments = 0;
+};
+
+
+/**
+ * Append-only, memory mapped value segments. Records are appended to the
+ * active segment with one fetch_add, a full segment is sealed and a new one
+ * mapped. The kernel pages mapped segments in and out, so values may exceed
+ * memory while the handles pointing at them stay in the tree.
+ * Liveness comes from the owner: beginMark(), markLive() for every handle
+ * still reachable, then victims() names the sparse segments. Their live
+ * records are copied with relocate() and the segments are dropped by
+ * retire() once every Pin taken before has been released.
+ * Segments are scratch space: the files are removed with the store.
+ */
+class ValueStore
+{
+    struct Segment
+    {
+        uint32_t id;
+        int fd;
+        uint8_t* base;
+        size_t size;
+        std::string path;
+        std::atomic<size_t> tail{0};
+        std::atomic<uint64_t> live{0};
+    };
+
+    struct alignas(64) PinCounter
+    {
+        std::atomic<uint64_t> count{0};
+    };
+
+public:
+
+    /**
+     * Keeps the segments a thread reads from or appends to mapped. A writer
+     * holds it until the handle it appended is linked, a reader until it has
+     * copied the bytes.
+     */
+    class Pin
+    {
+    public:
+        explicit Pin(ValueStore& store) : mCounter(store.mPins[shard()].count)
+        {
+            mCounter.fetch_add(1);
+        }
+
+        ~Pin()
+        {
+            mCounter.fetch_sub(1);
+        }
+
+        Pin(const Pin&) = delete;
+        Pin& operator=(const Pin&) = delete;
+
+    private:
+        std::atomic<uint64_t>& mCounter;
+    };
+
+    explicit ValueStore(const std::string& dir, size_t segmentSize = VALUE_STORE_SEGMENT_SIZE)
+            : mDir(dir), mSegmentSize(std::min<size_t>(segmentSize, 1 << 26)), mSegments(1 << 16),
+              mNextId(1), mAppended(0), mRelocated(0), mRetired(0)
+    {
+        if (::mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+            throw std::runtime_error("cannot create value store directory " + dir);
+        mActive.store(openSegment());
+    }
+
+    ValueStore(const ValueStore&) = delete;
+    ValueStore& operator=(const ValueStore&) = delete;
+
+    ~ValueStore()
+    {
+        for (auto& slot : mSegments)
+            if (Segment* segment = slot.load())
+                closeSegment(segment);
+        ::rmdir(mDir.c_str());
+    }
+
+    /// Copies len bytes into the active segment
+    ValueHandle append(const uint8_t* data, size_t len)
+    {
+        if (len >= (1 << 22) || len > mSegmentSize)
+            throw std::length_error("record does not fit a value segment");
+        while (true)
+        {
+            Segment* segment = mActive.load();
+            size_t offset = segment->tail.fetch_add(len);
+            if (offset + len <= segment->size)
+            {
+                std::memcpy(segment->base + offset, data, len);
+                mAppended.fetch_add(len);
+                return ValueHandle::make(segment->id, offset, (uint32_t) len);
+            }
+            seal(segment);
+        }
+    }
+
+    /// Bytes of a handle, valid while a Pin is held
+    const uint8_t* data(ValueHandle handle) const
+    {
+        return mSegments[handle.segment()].load()->base + handle.offset();
+    }
+
+    /// Resets the live byte counts before the owner marks its reachable handles
+    void beginMark()
+    {
+        for (auto& slot : mSegments)
+            if (Segment* segment = slot.load())
+                segment->live.store(0);
+    }
+
+    void markLive(ValueHandle handle)
+    {
+        if (Segment* segment = mSegments[handle.segment()].load())
+            segment->live.fetch_add(handle.length());
+    }
+
+    /// Sealed segments whose marked live bytes are below VALUE_STORE_COMPACT_PERCENT
+    std::vector<uint32_t> victims()
+    {
+        std::vector<uint32_t> ids;
+        Segment* active = mActive.load();
+        for (auto& slot : mSegments)
+        {
+            Segment* segment = slot.load();
+            if (segment != nullptr && segment != active &&
+                segment->live.load() * 100 < segment->size * VALUE_STORE_COMPACT_PERCENT)
+                ids.push_back(segment->id);
+        }
+        return ids;
+    }
+
+    /// Copies a record of a victim segment to the active one
+    ValueHandle relocate(ValueHandle handle)
+    {
+        ValueHandle moved = append(data(handle), handle.length());
+        mRelocated.fetch_add(handle.length());
+        return moved;
+    }
+
+    /**
+     * Waits until every Pin held when called is released, then unmaps and
+     * removes the segments. No handle may point into them any more.
+     */
+    void retire(const std::vector<uint32_t>& ids)
+    {
+        synchronize();
+        for (uint32_t id : ids)
+        {
+            Segment* segment = mSegments[id].exchange(nullptr);
+            if (segment != nullptr)
+            {
+                closeSegment(segment);
+                mRetired.fetch_add(1);
+            }
+        }
+    }
+
+    /// Returns once every Pin taken before the call has been released
+    void synchronize()
+    {
+        for (auto& pin : mPins)
+            while (pin.count.load() != 0)
+                std::this_thread::yield();
+    }
+
+    ValueStoreStats stats() const
+    {
+        ValueStoreStats stats;
+        for (auto& slot : mSegments)
+            if (Segment* segment = slot.load())
+            {
+                stats.segments++;
+                stats.liveBytes += segment->live.load();
+            }
+        stats.appendedBytes = mAppended.load();
+        stats.relocatedBytes = mRelocated.load();
+        stats.retiredSegments = mRetired.load();
+        return stats;
+    }
+
+    static size_t shard()
+    {
+        static thread_local size_t shard = std::hash<std::thread::id>()(std::this_thread::get_id()) % VALUE_STORE_SHARDS;
+        return shard;
+    }
+
+private:
+
+    Segment* openSegment()
+    {
+        uint32_t id = mNextId++;
+        if (id >= mSegments.size())
+            throw std::runtime_error("value store out of segment ids");
+        std::unique_ptr<Segment> segment(new Segment());
+        segment->id = id;
+        segment->size = mSegmentSize;
+        segment->path = mDir + "/values-" + std::to_string(id) + ".seg";
+        segment->fd = ::open(segment->path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (segment->fd < 0 || ::ftruncate(segment->fd, segment->size) != 0)
+            throw std::runtime_error("cannot create value segment " + segment->path);
+        void* base = ::mmap(nullptr, segment->size, PROT_READ | PROT_WRITE, MAP_SHARED, segment->fd, 0);
+        if (base == MAP_FAILED)
+            throw std::runtime_error("cannot map value segment " + segment->path);
+        segment->base = (uint8_t*) base;
+        mSegments[id].store(segment.get());
+        return segment.release();
+    }
+
+    void seal(Segment* full)
+    {
+        boost::mutex::scoped_lock guard(mRollLock);
+        if (mActive.load() == full)
+            mActive.store(openSegment());
+    }
+
+    static void closeSegment(Segment* segment)
+    {
+        ::munmap(segment->base, segment->size);
+        ::close(segment->fd);
+        ::unlink(segment->path.c_str());
+        delete segment;
+    }
+
+    std::string mDir;
+    size_t mSegmentSize;
+    ///indexed by segment id, nullptr once retired
+    std::vector<std::atomic<Segment*>> mSegments;
+    std::atomic<Segment*> mActive;
+    boost::mutex mRollLock;
+    uint32_t mNextId;
+    PinCounter mPins[VALUE_STORE_SHARDS];
+    std::atomic<uint64_t> mAppended;
+    std::atomic<uint64_t> mRelocated;
+    std::atomic<uint64_t> mRetired;
+};
+
+
+/**
+ * Hot record cache in front of a ValueStore: decoded records by handle, LRU
+ * per shard. A handle always names the same bytes, so entries never go
+ * stale; the handles compaction retires just age out.
+ */
+template <typename RecordType>
+class ValueCache
+{
+    typedef std::shared_ptr<const RecordType> Entry;
+
+    struct Shard
+    {
+        boost::mutex lock;
+        std::list<std::pair<uint64_t, Entry>> lru;
+        std::unordered_map<uint64_t, typename std::list<std::pair<uint64_t, Entry>>::iterator> index;
+    };
+
+public:
+
+    explicit ValueCache(size_t capacity = VALUE_STORE_CACHE_ENTRIES)
+            : mShardCapacity(std::max<size_t>(1, capacity / VALUE_STORE_SHARDS)), mHits(0), mMisses(0) {}
+
+    /// @return nullptr if the record of handle is not cached
+    Entry find(ValueHandle handle)
+    {
+        Shard& shard = shardOf(handle);
+        boost::mutex::scoped_lock guard(shard.lock);
+        auto it = shard.index.find(handle.bits);
+        if (it == shard.index.end())
+        {
+            mMisses.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        mHits.fetch_add(1, std::memory_order_relaxed);
+        return it->second->second;
+    }
+
+    void insert(ValueHandle handle, const Entry& record)
+    {
+        Shard& shard = shardOf(handle);
+        boost::mutex::scoped_lock guard(shard.lock);
+        if (shard.index.count(handle.bits))
+            return;
+        shard.lru.emplace_front(handle.bits, record);
+        shard.index[handle.bits] = shard.lru.begin();
+        if (shard.lru.size() > mShardCapacity)
+        {
+            shard.index.erase(shard.lru.back().first);
+            shard.lru.pop_back();
+        }
+    }
+
+    uint64_t hits() const { return mHits.load(); }
+    uint64_t misses() const { return mMisses.load(); }
+
+private:
+
+    Shard& shardOf(ValueHandle handle)
+    {
+        return mShards[((handle.bits * 0x9E3779B97F4A7C15ull) >> 32) % VALUE_STORE_SHARDS];
+    }
+
+    size_t mShardCapacity;
+    Shard mShards[VALUE_STORE_SHARDS];
+    std::atomic<uint64_t> mHits;
+    std::atomic<uint64_t> mMisses;
+};
+
+#endif //MVCCART_VALUESTORE_HPP
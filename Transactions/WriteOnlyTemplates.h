@@ -27,12 +27,17 @@
 #include <boost/random/uniform_int_distribution.hpp>
 #include <boost/random/variate_generator.hpp>
 #include "fmt-master/fmt/format.h"
+#include "Transactions/ZipfGenerator.hpp"
 
 using namespace std;
 typedef pfabric::Tuple<string,unsigned long, int,string, double> RecordType;
 typedef char KeyType[20];
 typedef ArtCPP<RecordType,KeyType> ARTTupleContainer;
 char KeysToStore[235890][20];
+///time-ordered ids, filled by the sequential write workloads
+char SequentialKeys[200001][20];
+///URL-like keys sharing hosts and paths, filled by the URL write workloads
+char UrlKeys[200001][64];
 std::vector<RecordType> vectorValues;
 using snapshot_type = mvcc11::snapshot<RecordType>;
 typedef smart_ptr::shared_ptr<snapshot_type const> const_snapshot_ptr;
@@ -146,5 +151,52 @@ auto WriteOnlyRandom = [](ARTTupleContainer &ARTWithTuples, size_t id,std::pair<
 };
 
 
+auto WriteOnlySequential = [](ARTTupleContainer &ARTWithTuples, size_t id,std::pair<int,int> range){
+    int totalCachedMissed=0;
+    for (int index = range.first; index <= range.second; index++)
+    {
+        auto result= ARTWithTuples.insertOrUpdateByKey(SequentialKeys[index],vectorValues[index],id);
+
+        if(result == NULL)
+        {
+            totalCachedMissed++;
+        }
+    }
+
+    cout<<"Total writes succeed ="<<totalCachedMissed<<" by transaction#"<<id<<"  from Total# Writes "<<range.second-range.first<<endl;
+};
+
+auto WriteOnlyUrls = [](ARTTupleContainer &ARTWithTuples, size_t id,std::pair<int,int> range){
+    int totalCachedMissed=0;
+    for (int index = range.first; index <= range.second; index++)
+    {
+        auto result= ARTWithTuples.insertOrUpdateByKey(UrlKeys[index],vectorValues[index],id);
+
+        if(result == NULL)
+        {
+            totalCachedMissed++;
+        }
+    }
+
+    cout<<"Total writes succeed ="<<totalCachedMissed<<" by transaction#"<<id<<"  from Total# Writes "<<range.second-range.first<<endl;
+};
+
+auto WriteOnlyZipf = [](ARTTupleContainer &ARTWithTuples, size_t id,std::pair<int,int> range){
+    std::mt19937_64 rng(current_time_nanoseconds() + id);
+    int totalCachedMissed=0;
+    for (int index = range.first; index <= range.second; index++)
+    {
+        int key = (int) zipfKeys()(rng);
+        auto result= ARTWithTuples.insertOrUpdateByKey(KeysToStore[key],vectorValues[key],id);
+
+        if(result == NULL)
+        {
+            totalCachedMissed++;
+        }
+    }
+
+    cout<<"Total writes succeed ="<<totalCachedMissed<<" by transaction#"<<id<<"  from Total# Writes "<<range.second-range.first<<endl;
+};
+
 
 #endif //MVCCART_TRANSACTIONTEMPLATES_H
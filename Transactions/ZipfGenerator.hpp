@@ -0,0 +1,59 @@
+//
+// Created by Players Inc on 19/10/2026.
+//
+
+#ifndef MVCCART_ZIPFGENERATOR_HPP
+#define MVCCART_ZIPFGENERATOR_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdint.h>
+
+/**
+ * Zipfian ranks in [0, n) with skew theta, drawn as YCSB does (Gray et al.,
+ * Quickly Generating Billion-Record Synthetic Databases); rank 0 is the
+ * most frequent.
+ */
+class ZipfGenerator
+{
+public:
+    ZipfGenerator(uint64_t n, double theta) : n(n), theta(theta)
+    {
+        zetan = zeta(n);
+        alpha = 1.0 / (1.0 - theta);
+        eta = (1.0 - std::pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta(2) / zetan);
+    }
+
+    template <typename Rng>
+    uint64_t operator()(Rng& rng) const
+    {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng), uz = u * zetan;
+        if (uz < 1.0)
+            return 0;
+        if (uz < 1.0 + std::pow(0.5, theta))
+            return 1;
+        return std::min<uint64_t>(n - 1, (uint64_t) (n * std::pow(eta * u - eta + 1.0, alpha)));
+    }
+
+private:
+    double zeta(uint64_t upTo) const
+    {
+        double sum = 0;
+        for (uint64_t i = 1; i <= upTo; i++)
+            sum += 1.0 / std::pow((double) i, theta);
+        return sum;
+    }
+
+    uint64_t n;
+    double theta, zetan, alpha, eta;
+};
+
+///ranks of the words the workloads load; the words are sorted, the hot ones share the upper nodes of the tree
+const ZipfGenerator& zipfKeys()
+{
+    static const ZipfGenerator keys(200000, 0.99);
+    return keys;
+}
+
+#endif //MVCCART_ZIPFGENERATOR_HPP
@@ -26,59 +26,58 @@
 #include <boost/signals2.hpp>
 #include "mvcc/snapshot.hpp"
 #include "GlobalEpoch.hpp"
+#include "TransactionExecutor.hpp"
+#include "TransactionClock.hpp"
+#include "TxnContext.hpp"
+#include "ActiveTxnRegistry.hpp"
 
 
 ///Transaction Globals
 boost::mutex cntmutex;
-std::vector<size_t> active_transactionIds;
 std::map<size_t,std::string> TransactionsStatus;
-boost::atomic<int> nextTid;
-boost::thread_group TransactionGroup;
 
 
+///Ids of the size_t id API double as commit timestamps: their writes are visible at once,
+///once the explicit commits drawn before them are published; handing one out never waits
 size_t get_new_transaction_ID()
 {
-    ///cntmutex.lock(); //emulates strict order
-    size_t Tid;
-    nextTid.fetch_add(1, boost::memory_order_relaxed);
-    Tid = nextTid.load(boost::memory_order_relaxed);
-    ///cntmutex.unlock();
-    //boost::this_thread::sleep(boost::posix_time::milliseconds(10));
-    return Tid;
+    return txnClock.autoCommitTimestamp();
 }
 
-size_t reset_transaction_ID()
+void reset_transaction_ID()
 {
-    int temp = (-1)*nextTid;
-    nextTid.fetch_add(temp, boost::memory_order_relaxed);
+    txnClock.reset();
+    activeTxnRegistry.reset();
 }
 
 
 template <typename T, typename C>
 void ThreadFunc1(T func,C& container , size_t id)
 {
-    /// Set Transaction to active
-    active_transactionIds.push_back(id);
     func(container,id);
 }
 
 template <typename T, typename C>
 void ThreadFunc2(T func,C& container , size_t id,std::pair<int,int> range)
 {
-    /// Set Transaction to active
-    active_transactionIds.push_back(id);
     func(container,id,range);
 }
 
 template <typename T, typename C>
 void ThreadFunc3(T func,C& container , size_t id,int numVersions,int keyIndex,int delayms)
 {
-    /// Set Transaction to active
-    active_transactionIds.push_back(id);
     func(container,id,numVersions,keyIndex,delayms);
 }
 
 
+/// Body of a read-only Transaction: no id, reads see the snapshot of txn
+template <typename T, typename C>
+void ReadOnlyThreadFunc(T func,C& container , size_t id,std::pair<int,int> range,TxnContext* txn)
+{
+    TxnScope scope(*txn);
+    func(container,id,range);
+}
+
 template <typename T, typename C>
 void ThreadFunc4(T func,C& container , size_t id,std::pair<int,int> range,std::vector<void*>& ReadSet,std::vector<void*>& WriteSet)
 {
@@ -86,7 +85,6 @@ void ThreadFunc4(T func,C& container , size_t id,std::pair<int,int> range,std::v
     // Set Transaction to active
     //vectorPair vPair = std::pair<std::vector<void*>,std::vector<void*>>(ReadSet,WriteSet);
     //activeTxns.insert(std::pair<size_t,vectorPair>(id,vPair));
-    active_transactionIds.push_back(id);
     func(container,id,range);
 }
 
@@ -94,29 +92,59 @@ void commitTransaction(size_t id)
 {
     TransactionsStatus[id]= "Committed";
     //activeTxns.erase(id);
-    //active_transactionIds.erase(std::remove(active_transactionIds.begin(), active_transactionIds.end(), id), active_transactionIds.end());
 }
 
+void abortTransaction(size_t id)
+{
+    TransactionsStatus[id]= "Aborted";
+}
+
+/// Declared access mode of a Transaction
+enum class TxnMode
+{
+    ReadWrite,
+    ReadOnly
+};
+
 template <typename TransactionFunc, typename ARTContainer>
 class Transaction
 {
 
 public:
     size_t  Tid;
-    boost::thread* TransactionThread;
+    TxnMode mode = TxnMode::ReadWrite;
+    std::unique_ptr<TxnContext> snapshot;
+    std::future<TxnStatus> TransactionFuture;
     std::string status;
-    Epoch myEpoch;
+    ///begin timestamp in the active transaction registry, pins GC until collected
+    uint64_t beginTs = 0;
+    ActiveTxnRegistry::Handle slot = 0;
     std::vector<void*> ReadSet;
     std::vector<void*> WriteSet;
     Transaction(TransactionFunc func, ARTContainer& ART);
     Transaction(TransactionFunc func, ARTContainer& ART,int numVersions,int keyIndex,int delayms);
     Transaction(TransactionFunc func, ARTContainer& ART,std::pair<int,int> range);
+    Transaction(TransactionFunc func, ARTContainer& ART,std::pair<int,int> range,TxnMode txnMode);
 
     void CollectTransaction()
     {
-        TransactionThread->join();
-        commitTransaction(Tid);
-        myEpoch.counter--;
+        if (mode == TxnMode::ReadOnly)
+        {
+            bool bodyCommitted = getTransactionExecutor().wait(TransactionFuture) == TxnStatus::Committed;
+            status = snapshot->commit() && bodyCommitted ? "Committed" : "Aborted";
+            return;
+        }
+        if (getTransactionExecutor().wait(TransactionFuture) == TxnStatus::Committed)
+        {
+            status = "Committed";
+            commitTransaction(Tid);
+        }
+        else
+        {
+            status = "Aborted";
+            abortTransaction(Tid);
+        }
+        activeTxnRegistry.leave(slot);
     }
 };
 
@@ -124,36 +152,58 @@ template <typename TransactionFunc, typename ARTContainer>
 Transaction<TransactionFunc,ARTContainer>::Transaction(TransactionFunc func, ARTContainer& ART )
 {
 
+    slot = activeTxnRegistry.enter(beginTs);
     Tid=get_new_transaction_ID();
     TransactionsStatus[Tid]= "Active";
-    myEpoch = myEpochGlobal.getActiveEpoch();
-    myEpoch.addTxnToEpoch(Tid);
-    TransactionThread = new boost::thread(&ThreadFunc1<TransactionFunc,ARTContainer>,func,boost::ref(ART),Tid);
-    TransactionGroup.add_thread(TransactionThread);
+    TransactionFuture = getTransactionExecutor().submit(
+            boost::bind(&ThreadFunc1<TransactionFunc,ARTContainer>,func,boost::ref(ART),Tid));
 }
 
 template <typename TransactionFunc, typename ARTContainer>
 Transaction<TransactionFunc,ARTContainer>::Transaction(TransactionFunc func, ARTContainer& ART,std::pair<int,int> range)
 {
+    slot = activeTxnRegistry.enter(beginTs);
     Tid=get_new_transaction_ID();
     TransactionsStatus[Tid]= "Active";
-    myEpoch = myEpochGlobal.getActiveEpoch();
-    myEpoch.addTxnToEpoch(Tid);
-    TransactionThread = new boost::thread(&ThreadFunc4<TransactionFunc,ARTContainer>,func,
-                                          boost::ref(ART),Tid,range,boost::ref(ReadSet),boost::ref(WriteSet));
-    TransactionGroup.add_thread(TransactionThread);
+    TransactionFuture = getTransactionExecutor().submit(
+            boost::bind(&ThreadFunc4<TransactionFunc,ARTContainer>,func,
+                        boost::ref(ART),Tid,range,boost::ref(ReadSet),boost::ref(WriteSet)));
+
+}
 
+/**
+ * Read-only transactions skip the id and the status table:
+ * Tid is the snapshot timestamp their context registered with.
+ */
+template <typename TransactionFunc, typename ARTContainer>
+Transaction<TransactionFunc,ARTContainer>::Transaction(TransactionFunc func, ARTContainer& ART,std::pair<int,int> range,TxnMode txnMode)
+        : mode(txnMode)
+{
+    if (mode == TxnMode::ReadWrite)
+    {
+        slot = activeTxnRegistry.enter(beginTs);
+        Tid=get_new_transaction_ID();
+        TransactionsStatus[Tid]= "Active";
+        TransactionFuture = getTransactionExecutor().submit(
+                boost::bind(&ThreadFunc4<TransactionFunc,ARTContainer>,func,
+                            boost::ref(ART),Tid,range,boost::ref(ReadSet),boost::ref(WriteSet)));
+        return;
+    }
+    snapshot.reset(new TxnContext());
+    snapshot->beginReadOnly();
+    Tid = snapshot->beginTs();
+    TransactionFuture = getTransactionExecutor().submit(
+            boost::bind(&ReadOnlyThreadFunc<TransactionFunc,ARTContainer>,func,boost::ref(ART),Tid,range,snapshot.get()));
 }
 
 template <typename TransactionFunc, typename ARTContainer>
 Transaction<TransactionFunc,ARTContainer>::Transaction(TransactionFunc func, ARTContainer& ART,int numVersions,int keyIndex,int delayms)
 {
+    slot = activeTxnRegistry.enter(beginTs);
     Tid=get_new_transaction_ID();
     TransactionsStatus[Tid]= "Active";
-    myEpoch = myEpochGlobal.getActiveEpoch();
-    myEpoch.addTxnToEpoch(Tid);
-    TransactionThread = new boost::thread(&ThreadFunc3<TransactionFunc,ARTContainer>,func,boost::ref(ART),Tid,numVersions,keyIndex,delayms);
-    TransactionGroup.add_thread(TransactionThread);
+    TransactionFuture = getTransactionExecutor().submit(
+            boost::bind(&ThreadFunc3<TransactionFunc,ARTContainer>,func,boost::ref(ART),Tid,numVersions,keyIndex,delayms));
 }
 
 #endif //MVCCART_TRANSACTIONMANAGER_H
\ No newline at end of file
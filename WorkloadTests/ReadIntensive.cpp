@@ -118,6 +118,70 @@ BOOST_AUTO_TEST_SUITE(MVCC_TESTS)
         cout << std::chrono::duration_cast<std::chrono::microseconds>(end_timeWriter - start_timeWriter).count() << ":"<<endl;
     }
 
+    BOOST_AUTO_TEST_CASE(InterleavedLookupsMatchSequential)
+    {
+        cout << "InterleavedLookupsMatchSequential" << endl;
+        const size_t count = 200000;
+        std::vector<char*> keys(count);
+        std::vector<const_snapshot_ptr> batched(count);
+        random::mt19937 rng(current_time_nanoseconds());
+        random::uniform_int_distribution<> randomKeys(0, 200000);
+        for (size_t i = 0; i < count; i++)
+        {
+            keys[i] = KeysToStore[randomKeys(rng)];
+        }
+
+        size_t id = get_new_transaction_ID();
+        auto start_sequential = std::chrono::high_resolution_clock::now();
+        std::vector<const_snapshot_ptr> sequential(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            sequential[i] = ARTable1->findValueByKey(keys[i], id);
+        }
+        auto end_sequential = std::chrono::high_resolution_clock::now();
+
+        auto start_batched = std::chrono::high_resolution_clock::now();
+        ARTable1->findValuesByKeys(keys.data(), count, batched.data(), id);
+        auto end_batched = std::chrono::high_resolution_clock::now();
+
+        for (size_t i = 0; i < count; i++)
+        {
+            BOOST_REQUIRE(batched[i] == sequential[i]);
+        }
+        commitTransaction(id);
+
+        cout<<"Sequential lookups time->";
+        cout << std::chrono::duration_cast<std::chrono::microseconds>(end_sequential - start_sequential).count() << ":"<<endl;
+        cout<<"Interleaved lookups time->";
+        cout << std::chrono::duration_cast<std::chrono::microseconds>(end_batched - start_batched).count() << ":"<<endl;
+    }
+
+    BOOST_AUTO_TEST_CASE(ReadIntensiveBatched100Ops4Transactions)
+    {
+        cout << "ReadIntensiveBatched100Ops4Transactions" << endl;
+        auto start_time2 = std::chrono::high_resolution_clock::now();
+
+        Transaction<TransactionLambda, ARTTupleContainer> *t1 = new Transaction<TransactionLambda, ARTTupleContainer>(
+                ReadIntensiveSmallBatched, *ARTable1,std::make_pair(0, 50000));
+        Transaction<TransactionLambda, ARTTupleContainer> *t2 = new Transaction<TransactionLambda, ARTTupleContainer>(
+                ReadIntensiveSmallBatched, *ARTable1,std::make_pair(50000, 100000));
+        Transaction<TransactionLambda, ARTTupleContainer> *t3 = new Transaction<TransactionLambda, ARTTupleContainer>(
+                ReadIntensiveSmallBatched, *ARTable1,std::make_pair(100000, 150000));
+        Transaction<TransactionLambda, ARTTupleContainer> *t4 = new Transaction<TransactionLambda, ARTTupleContainer>(
+                ReadIntensiveSmallBatched, *ARTable1,std::make_pair(150000, 200000));
+
+        t1->CollectTransaction();
+        t2->CollectTransaction();
+        t3->CollectTransaction();
+        t4->CollectTransaction();
+
+        auto end_time2 = std::chrono::high_resolution_clock::now();
+
+        cout<<"Total time by ReadIntensiveBatched100Ops4Transactions::"<<endl;
+        cout << std::chrono::duration_cast<std::chrono::seconds>(end_time2 - start_time2).count() << ":";
+        cout << std::chrono::duration_cast<std::chrono::microseconds>(end_time2 - start_time2).count() << ":"<<endl;
+    }
+
     BOOST_AUTO_TEST_CASE(ReadIntensive100Ops1Transactions)
     {
         cout << "ReadIntensive100Ops1Transactions" << endl;
@@ -763,5 +827,50 @@ BOOST_AUTO_TEST_SUITE(MVCC_TESTS)
         cout << std::chrono::duration_cast<std::chrono::microseconds>(end_time2 - start_time2).count() << ":" << endl;
     }
 
+    /*
+     * Zipfian (0.99) lookups by 8 transactions while 8 others insert new
+     * keys next to the hot ones, with and without adaptive latching; reports
+     * the lookup latency percentiles.
+     */
+    BOOST_AUTO_TEST_CASE(ReadIntensiveZipfTailLatency)
+    {
+        cout << "ReadIntensiveZipfTailLatency" << endl;
+        zipfKeys();
+        for (bool latching : {false, true})
+        {
+            ARTable1->setAdaptiveLatching(latching);
+            ContentionStats before = ARTable1->contentionStats();
+            lookupLatencies.clear();
+            auto start_time2 = std::chrono::high_resolution_clock::now();
+
+            std::vector<Transaction<TransactionLambda, ARTTupleContainer>*> transactions;
+            for (int i = 0; i < 8; i++)
+            {
+                ///each round writes other siblings
+                int from = (latching ? 8 + i : i) * 5000;
+                transactions.push_back(new Transaction<TransactionLambda, ARTTupleContainer>(
+                        WriteZipfSiblings, *ARTable1, std::make_pair(from, from + 5000)));
+                transactions.push_back(new Transaction<TransactionLambda, ARTTupleContainer>(
+                        ReadZipfTimed, *ARTable1, std::make_pair(0, 25000)));
+            }
+            for (auto t : transactions)
+                t->CollectTransaction();
+
+            auto end_time2 = std::chrono::high_resolution_clock::now();
+
+            std::sort(lookupLatencies.begin(), lookupLatencies.end());
+            auto percentile = [](double p) { return lookupLatencies[(size_t) (p * (lookupLatencies.size() - 1))]; };
+            ContentionStats stats = ARTable1->contentionStats();
+            cout<<"Total time by ReadIntensiveZipf16Transactions"<<(latching ? "Latching" : "")<<"::"<<endl;
+            cout << std::chrono::duration_cast<std::chrono::seconds>(end_time2 - start_time2).count() << ":";
+            cout << std::chrono::duration_cast<std::chrono::microseconds>(end_time2 - start_time2).count() << ":"<<endl;
+            cout<<"lookup ns p50::"<<percentile(0.5)<<" p99::"<<percentile(0.99)<<" p99.9::"<<percentile(0.999)
+                <<" max::"<<lookupLatencies.back()<<endl;
+            cout<<"read restarts::"<<stats.readRestarts - before.readRestarts<<" latch waits::"
+                <<stats.latchWaits - before.latchWaits<<" write conflicts::"<<stats.conflicts - before.conflicts<<endl;
+        }
+        ARTable1->setAdaptiveLatching(false);
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -117,7 +117,7 @@ BOOST_AUTO_TEST_SUITE(MVCC_TESTS)
         auto start_time2 = std::chrono::high_resolution_clock::now();
 
         Transaction<TransactionLambda, ARTTupleContainer> *t1 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(0, 200000));
+                ReadOnlySmall, *ARTable1,std::make_pair(0, 200000),TxnMode::ReadOnly);
 
         t1->CollectTransaction();
 
@@ -136,9 +136,9 @@ BOOST_AUTO_TEST_SUITE(MVCC_TESTS)
         auto start_time2 = std::chrono::high_resolution_clock::now();
 
         Transaction<TransactionLambda, ARTTupleContainer> *t1 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(0, 100000));
+                ReadOnlySmall, *ARTable1,std::make_pair(0, 100000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t2 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(100000, 200000));
+                ReadOnlySmall, *ARTable1,std::make_pair(100000, 200000),TxnMode::ReadOnly);
 
         t1->CollectTransaction();
         t2->CollectTransaction();
@@ -157,13 +157,13 @@ BOOST_AUTO_TEST_SUITE(MVCC_TESTS)
         auto start_time2 = std::chrono::high_resolution_clock::now();
 
         Transaction<TransactionLambda, ARTTupleContainer> *t1 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(0, 50000));
+                ReadOnlySmall, *ARTable1,std::make_pair(0, 50000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t2 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(50000, 100000));
+                ReadOnlySmall, *ARTable1,std::make_pair(50000, 100000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t3 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(100000, 150000));
+                ReadOnlySmall, *ARTable1,std::make_pair(100000, 150000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t4 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(150000, 200000));
+                ReadOnlySmall, *ARTable1,std::make_pair(150000, 200000),TxnMode::ReadOnly);
 
         t1->CollectTransaction();
         t2->CollectTransaction();
@@ -185,21 +185,21 @@ BOOST_AUTO_TEST_SUITE(MVCC_TESTS)
         auto start_time2 = std::chrono::high_resolution_clock::now();
 
         Transaction<TransactionLambda, ARTTupleContainer> *t1 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(0, 25000));
+                ReadOnlySmall, *ARTable1,std::make_pair(0, 25000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t2 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(25000, 50000));
+                ReadOnlySmall, *ARTable1,std::make_pair(25000, 50000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t3 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(50000, 75000));
+                ReadOnlySmall, *ARTable1,std::make_pair(50000, 75000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t4 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(75000, 100000));
+                ReadOnlySmall, *ARTable1,std::make_pair(75000, 100000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t5 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(100000, 125000));
+                ReadOnlySmall, *ARTable1,std::make_pair(100000, 125000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t6 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(125000, 150000));
+                ReadOnlySmall, *ARTable1,std::make_pair(125000, 150000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t7 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(150000, 175000));
+                ReadOnlySmall, *ARTable1,std::make_pair(150000, 175000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t8 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(175000, 200000));
+                ReadOnlySmall, *ARTable1,std::make_pair(175000, 200000),TxnMode::ReadOnly);
 
 
 
@@ -227,38 +227,38 @@ BOOST_AUTO_TEST_SUITE(MVCC_TESTS)
         auto start_time2 = std::chrono::high_resolution_clock::now();
 
         Transaction<TransactionLambda, ARTTupleContainer> *t1 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(0, 12500));
+                ReadOnlySmall, *ARTable1,std::make_pair(0, 12500),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t2 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(12500, 25000));
+                ReadOnlySmall, *ARTable1,std::make_pair(12500, 25000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t3 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(25000, 37500));
+                ReadOnlySmall, *ARTable1,std::make_pair(25000, 37500),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t4 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(37500, 50000));
+                ReadOnlySmall, *ARTable1,std::make_pair(37500, 50000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t5 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(50000, 62500));
+                ReadOnlySmall, *ARTable1,std::make_pair(50000, 62500),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t6 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(62500, 75000));
+                ReadOnlySmall, *ARTable1,std::make_pair(62500, 75000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t7 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(75000, 87500));
+                ReadOnlySmall, *ARTable1,std::make_pair(75000, 87500),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t8 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(87500, 100000));
+                ReadOnlySmall, *ARTable1,std::make_pair(87500, 100000),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t9 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(100000, 112500));
+                ReadOnlySmall, *ARTable1,std::make_pair(100000, 112500),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t10 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(112500, 125000));
+                ReadOnlySmall, *ARTable1,std::make_pair(112500, 125000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t11 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(125000, 137500));
+                ReadOnlySmall, *ARTable1,std::make_pair(125000, 137500),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t12 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(137500, 150000));
+                ReadOnlySmall, *ARTable1,std::make_pair(137500, 150000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t13 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(150000, 162500));
+                ReadOnlySmall, *ARTable1,std::make_pair(150000, 162500),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t14 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(162500, 175000));
+                ReadOnlySmall, *ARTable1,std::make_pair(162500, 175000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t15 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(175000, 187500));
+                ReadOnlySmall, *ARTable1,std::make_pair(175000, 187500),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t16 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(187500, 200000));
+                ReadOnlySmall, *ARTable1,std::make_pair(187500, 200000),TxnMode::ReadOnly);
 
         t1->CollectTransaction();
         t2->CollectTransaction();
@@ -292,100 +292,100 @@ BOOST_AUTO_TEST_SUITE(MVCC_TESTS)
 
 
         Transaction<TransactionLambda, ARTTupleContainer> *t1 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(0, 6250));
+                ReadOnlySmall, *ARTable1,std::make_pair(0, 6250),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t2 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(6250, 12500));
+                ReadOnlySmall, *ARTable1,std::make_pair(6250, 12500),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t3 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(12500, 18750));
+                ReadOnlySmall, *ARTable1,std::make_pair(12500, 18750),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t4 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(18750, 25000));
+                ReadOnlySmall, *ARTable1,std::make_pair(18750, 25000),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t5 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(25000, 31250));
+                ReadOnlySmall, *ARTable1,std::make_pair(25000, 31250),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t6 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(31250, 37500));
+                ReadOnlySmall, *ARTable1,std::make_pair(31250, 37500),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t7 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(37500, 43750));
+                ReadOnlySmall, *ARTable1,std::make_pair(37500, 43750),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t8 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(43750, 50000));
+                ReadOnlySmall, *ARTable1,std::make_pair(43750, 50000),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t9 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(50000, 56250));
+                ReadOnlySmall, *ARTable1,std::make_pair(50000, 56250),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t10 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(56250, 62500));
+                ReadOnlySmall, *ARTable1,std::make_pair(56250, 62500),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t11 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(62500, 68750));
+                ReadOnlySmall, *ARTable1,std::make_pair(62500, 68750),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t12 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(68750, 75000));
+                ReadOnlySmall, *ARTable1,std::make_pair(68750, 75000),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t13 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(75000, 81250));
+                ReadOnlySmall, *ARTable1,std::make_pair(75000, 81250),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t14 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(81250, 87500));
+                ReadOnlySmall, *ARTable1,std::make_pair(81250, 87500),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t15 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(87500, 93750));
+                ReadOnlySmall, *ARTable1,std::make_pair(87500, 93750),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t16 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(93750, 100000));
+                ReadOnlySmall, *ARTable1,std::make_pair(93750, 100000),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t17 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(100000, 106250));
+                ReadOnlySmall, *ARTable1,std::make_pair(100000, 106250),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t18 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(106250, 112500));
+                ReadOnlySmall, *ARTable1,std::make_pair(106250, 112500),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t19 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(112500, 118750));
+                ReadOnlySmall, *ARTable1,std::make_pair(112500, 118750),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t20 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(118750, 125000));
+                ReadOnlySmall, *ARTable1,std::make_pair(118750, 125000),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t21 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(125000, 131250));
+                ReadOnlySmall, *ARTable1,std::make_pair(125000, 131250),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t22 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(131250, 137500));
+                ReadOnlySmall, *ARTable1,std::make_pair(131250, 137500),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t23 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(137500, 143750));
+                ReadOnlySmall, *ARTable1,std::make_pair(137500, 143750),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t24 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(143750, 150000));
+                ReadOnlySmall, *ARTable1,std::make_pair(143750, 150000),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t25 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(150000, 156250));
+                ReadOnlySmall, *ARTable1,std::make_pair(150000, 156250),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t26 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(156250, 162500));
+                ReadOnlySmall, *ARTable1,std::make_pair(156250, 162500),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t27 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(162500, 168750));
+                ReadOnlySmall, *ARTable1,std::make_pair(162500, 168750),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t28 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(168750, 175000));
+                ReadOnlySmall, *ARTable1,std::make_pair(168750, 175000),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t29 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(175000, 181250));
+                ReadOnlySmall, *ARTable1,std::make_pair(175000, 181250),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t30 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(181250, 187500));
+                ReadOnlySmall, *ARTable1,std::make_pair(181250, 187500),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t31 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(187500, 193750));
+                ReadOnlySmall, *ARTable1,std::make_pair(187500, 193750),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t32 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlySmall, *ARTable1,std::make_pair(193750, 200000));
+                ReadOnlySmall, *ARTable1,std::make_pair(193750, 200000),TxnMode::ReadOnly);
 
         t1->CollectTransaction();
         t2->CollectTransaction();
@@ -437,7 +437,7 @@ BOOST_AUTO_TEST_SUITE(MVCC_TESTS)
         auto start_time2 = std::chrono::high_resolution_clock::now();
 
         Transaction<TransactionLambda, ARTTupleContainer> *t1 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(0, 200000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(0, 200000),TxnMode::ReadOnly);
         t1->CollectTransaction();
 
         auto end_time2 = std::chrono::high_resolution_clock::now();
@@ -455,9 +455,9 @@ BOOST_AUTO_TEST_SUITE(MVCC_TESTS)
         auto start_time2 = std::chrono::high_resolution_clock::now();
 
         Transaction<TransactionLambda, ARTTupleContainer> *t1 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(0, 100000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(0, 100000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t2 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(100000, 200000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(100000, 200000),TxnMode::ReadOnly);
 
         t1->CollectTransaction();
         t2->CollectTransaction();
@@ -476,13 +476,13 @@ BOOST_AUTO_TEST_SUITE(MVCC_TESTS)
         auto start_time2 = std::chrono::high_resolution_clock::now();
 
         Transaction<TransactionLambda, ARTTupleContainer> *t1 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(0, 50000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(0, 50000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t2 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(50000, 100000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(50000, 100000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t3 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(100000, 150000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(100000, 150000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t4 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(150000, 200000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(150000, 200000),TxnMode::ReadOnly);
 
         t1->CollectTransaction();
         t2->CollectTransaction();
@@ -504,21 +504,21 @@ BOOST_AUTO_TEST_SUITE(MVCC_TESTS)
         auto start_time2 = std::chrono::high_resolution_clock::now();
 
         Transaction<TransactionLambda, ARTTupleContainer> *t1 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(0, 25000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(0, 25000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t2 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(25000, 50000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(25000, 50000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t3 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(50000, 75000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(50000, 75000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t4 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(75000, 100000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(75000, 100000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t5 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(100000, 125000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(100000, 125000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t6 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(125000, 150000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(125000, 150000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t7 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(150000, 175000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(150000, 175000),TxnMode::ReadOnly);
         Transaction<TransactionLambda, ARTTupleContainer> *t8 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(175000, 200000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(175000, 200000),TxnMode::ReadOnly);
 
 
 
@@ -548,67 +548,67 @@ BOOST_AUTO_TEST_SUITE(MVCC_TESTS)
         int y =12500;
 
         Transaction<TransactionLambda, ARTTupleContainer> *t1 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(x, y));
+                ReadOnlyMedium, *ARTable1,std::make_pair(x, y),TxnMode::ReadOnly);
         x=y;
         y=x*2;
         Transaction<TransactionLambda, ARTTupleContainer> *t2 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(x, y));
+                ReadOnlyMedium, *ARTable1,std::make_pair(x, y),TxnMode::ReadOnly);
         x=y;
         y=x*2;
         Transaction<TransactionLambda, ARTTupleContainer> *t3 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(x, y));
+                ReadOnlyMedium, *ARTable1,std::make_pair(x, y),TxnMode::ReadOnly);
         x=y;
         y=x*2;
         Transaction<TransactionLambda, ARTTupleContainer> *t4 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(x, y));
+                ReadOnlyMedium, *ARTable1,std::make_pair(x, y),TxnMode::ReadOnly);
         x=y;
         y=x*2;
         Transaction<TransactionLambda, ARTTupleContainer> *t5 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(x, y));
+                ReadOnlyMedium, *ARTable1,std::make_pair(x, y),TxnMode::ReadOnly);
         x=y;
         y=x*2;
         Transaction<TransactionLambda, ARTTupleContainer> *t6 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(x, y));
+                ReadOnlyMedium, *ARTable1,std::make_pair(x, y),TxnMode::ReadOnly);
         x=y;
         y=x*2;
         Transaction<TransactionLambda, ARTTupleContainer> *t7 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(x, y));
+                ReadOnlyMedium, *ARTable1,std::make_pair(x, y),TxnMode::ReadOnly);
         x=y;
         y=x*2;
         Transaction<TransactionLambda, ARTTupleContainer> *t8 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(x, y));
+                ReadOnlyMedium, *ARTable1,std::make_pair(x, y),TxnMode::ReadOnly);
         x=y;
         y=x*2;
         Transaction<TransactionLambda, ARTTupleContainer> *t9 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(x, y));
+                ReadOnlyMedium, *ARTable1,std::make_pair(x, y),TxnMode::ReadOnly);
         x=y;
         y=x*2;
         Transaction<TransactionLambda, ARTTupleContainer> *t10 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(x, y));
+                ReadOnlyMedium, *ARTable1,std::make_pair(x, y),TxnMode::ReadOnly);
         x=y;
         y=x*2;
         Transaction<TransactionLambda, ARTTupleContainer> *t11 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(x, y));
+                ReadOnlyMedium, *ARTable1,std::make_pair(x, y),TxnMode::ReadOnly);
         x=y;
         y=x*2;
         Transaction<TransactionLambda, ARTTupleContainer> *t12 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(x, y));
+                ReadOnlyMedium, *ARTable1,std::make_pair(x, y),TxnMode::ReadOnly);
         x=y;
         y=x*2;
         Transaction<TransactionLambda, ARTTupleContainer> *t13 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(x, y));
+                ReadOnlyMedium, *ARTable1,std::make_pair(x, y),TxnMode::ReadOnly);
         x=y;
         y=x*2;
         Transaction<TransactionLambda, ARTTupleContainer> *t14 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(x, y));
+                ReadOnlyMedium, *ARTable1,std::make_pair(x, y),TxnMode::ReadOnly);
         x=y;
         y=x*2;
         Transaction<TransactionLambda, ARTTupleContainer> *t15 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(x, y));
+                ReadOnlyMedium, *ARTable1,std::make_pair(x, y),TxnMode::ReadOnly);
         x=y;
         y=x*2;
         Transaction<TransactionLambda, ARTTupleContainer> *t16 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(x, y));
+                ReadOnlyMedium, *ARTable1,std::make_pair(x, y),TxnMode::ReadOnly);
 
         t1->CollectTransaction();
         t2->CollectTransaction();
@@ -643,100 +643,100 @@ BOOST_AUTO_TEST_SUITE(MVCC_TESTS)
         int y =6250;
 
         Transaction<TransactionLambda, ARTTupleContainer> *t1 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(0, 6250));
+                ReadOnlyMedium, *ARTable1,std::make_pair(0, 6250),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t2 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(6250, 12500));
+                ReadOnlyMedium, *ARTable1,std::make_pair(6250, 12500),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t3 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(12500, 18750));
+                ReadOnlyMedium, *ARTable1,std::make_pair(12500, 18750),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t4 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(18750, 25000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(18750, 25000),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t5 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(25000, 31250));
+                ReadOnlyMedium, *ARTable1,std::make_pair(25000, 31250),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t6 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(31250, 37500));
+                ReadOnlyMedium, *ARTable1,std::make_pair(31250, 37500),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t7 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(37500, 43750));
+                ReadOnlyMedium, *ARTable1,std::make_pair(37500, 43750),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t8 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(43750, 50000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(43750, 50000),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t9 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(50000, 56250));
+                ReadOnlyMedium, *ARTable1,std::make_pair(50000, 56250),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t10 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(56250, 62500));
+                ReadOnlyMedium, *ARTable1,std::make_pair(56250, 62500),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t11 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(62500, 68750));
+                ReadOnlyMedium, *ARTable1,std::make_pair(62500, 68750),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t12 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(68750, 75000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(68750, 75000),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t13 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(75000, 81250));
+                ReadOnlyMedium, *ARTable1,std::make_pair(75000, 81250),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t14 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(81250, 87500));
+                ReadOnlyMedium, *ARTable1,std::make_pair(81250, 87500),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t15 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(87500, 93750));
+                ReadOnlyMedium, *ARTable1,std::make_pair(87500, 93750),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t16 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(93750, 100000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(93750, 100000),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t17 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(100000, 106250));
+                ReadOnlyMedium, *ARTable1,std::make_pair(100000, 106250),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t18 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(106250, 112500));
+                ReadOnlyMedium, *ARTable1,std::make_pair(106250, 112500),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t19 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(112500, 118750));
+                ReadOnlyMedium, *ARTable1,std::make_pair(112500, 118750),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t20 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(118750, 125000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(118750, 125000),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t21 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(125000, 131250));
+                ReadOnlyMedium, *ARTable1,std::make_pair(125000, 131250),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t22 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(131250, 137500));
+                ReadOnlyMedium, *ARTable1,std::make_pair(131250, 137500),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t23 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(137500, 143750));
+                ReadOnlyMedium, *ARTable1,std::make_pair(137500, 143750),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t24 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(143750, 150000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(143750, 150000),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t25 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(150000, 156250));
+                ReadOnlyMedium, *ARTable1,std::make_pair(150000, 156250),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t26 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(156250, 162500));
+                ReadOnlyMedium, *ARTable1,std::make_pair(156250, 162500),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t27 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(162500, 168750));
+                ReadOnlyMedium, *ARTable1,std::make_pair(162500, 168750),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t28 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(168750, 175000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(168750, 175000),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t29 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(175000, 181250));
+                ReadOnlyMedium, *ARTable1,std::make_pair(175000, 181250),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t30 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(181250, 187500));
+                ReadOnlyMedium, *ARTable1,std::make_pair(181250, 187500),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t31 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(187500, 193750));
+                ReadOnlyMedium, *ARTable1,std::make_pair(187500, 193750),TxnMode::ReadOnly);
 
         Transaction<TransactionLambda, ARTTupleContainer> *t32 = new Transaction<TransactionLambda, ARTTupleContainer>(
-                ReadOnlyMedium, *ARTable1,std::make_pair(193750, 200000));
+                ReadOnlyMedium, *ARTable1,std::make_pair(193750, 200000),TxnMode::ReadOnly);
 
         t1->CollectTransaction();
         t2->CollectTransaction();
@@ -783,4 +783,97 @@ BOOST_AUTO_TEST_SUITE(MVCC_TESTS)
     }
 
 
+    /*
+     * Zipfian (0.99) lookups by 16 read-only transactions, without and with
+     * the per-thread read cache.
+     */
+    BOOST_AUTO_TEST_CASE(ReadOnlyZipf16TransactionsReadCache)
+    {
+        cout << "ReadOnlyZipf16TransactionsReadCache" << endl;
+        zipfKeys();
+        for (bool caching : {false, true})
+        {
+            ARTable1->setReadCaching(caching);
+            zipfReadCacheHits.store(0);
+            auto start_time2 = std::chrono::high_resolution_clock::now();
+
+            std::vector<Transaction<TransactionLambda, ARTTupleContainer>*> transactions;
+            for (int i = 0; i < 16; i++)
+                transactions.push_back(new Transaction<TransactionLambda, ARTTupleContainer>(
+                        ReadOnlyZipf, *ARTable1, std::make_pair(0, 50000), TxnMode::ReadOnly));
+            for (auto t : transactions)
+                t->CollectTransaction();
+
+            auto end_time2 = std::chrono::high_resolution_clock::now();
+
+            cout<<"Total time by ReadOnlyZipf16Transactions"<<(caching ? "ReadCache" : "")<<"::"<<endl;
+            cout << std::chrono::duration_cast<std::chrono::seconds>(end_time2 - start_time2).count() << ":";
+            cout << std::chrono::duration_cast<std::chrono::microseconds>(end_time2 - start_time2).count() << ":"<<endl;
+            cout<<"read cache hits::"<<zipfReadCacheHits.load()<<" of "<<16 * 50000<<endl;
+        }
+        ARTable1->setReadCaching(false);
+    }
+
+    /*
+     * Uniform lookups by 16 read-only transactions through the tree, then
+     * through a hash index next to it; prints what the index costs per key.
+     */
+    BOOST_AUTO_TEST_CASE(ReadOnly50000Ops16TransactionsHashIndex)
+    {
+        cout << "ReadOnly50000Ops16TransactionsHashIndex" << endl;
+        for (bool indexed : {false, true})
+        {
+            if (indexed)
+                ARTable1->enableHashIndex();
+            auto start_time2 = std::chrono::high_resolution_clock::now();
+
+            std::vector<Transaction<TransactionLambda, ARTTupleContainer>*> transactions;
+            for (int i = 0; i < 16; i++)
+                transactions.push_back(new Transaction<TransactionLambda, ARTTupleContainer>(
+                        ReadOnlyUniform, *ARTable1, std::make_pair(0, 200000), TxnMode::ReadOnly));
+            for (auto t : transactions)
+                t->CollectTransaction();
+
+            auto end_time2 = std::chrono::high_resolution_clock::now();
+
+            cout<<"Total time by ReadOnly50000Ops16Transactions"<<(indexed ? "HashIndex" : "")<<"::"<<endl;
+            cout << std::chrono::duration_cast<std::chrono::seconds>(end_time2 - start_time2).count() << ":";
+            cout << std::chrono::duration_cast<std::chrono::microseconds>(end_time2 - start_time2).count() << ":"<<endl;
+        }
+        HashIndexStats stats = ARTable1->hashIndexStats();
+        cout<<"hash index::"<<stats.entries<<" keys in "<<stats.capacity<<" slots, "<<stats.bytes<<" bytes, "
+            <<stats.bytes / std::max<uint64_t>(1, stats.entries)<<" bytes per key"<<endl;
+        ARTable1->disableHashIndex();
+    }
+
+    /*
+     * Uniform lookups by 16 read-only transactions, half of them for absent
+     * keys, without and with the leaf fingerprints turning those away.
+     */
+    BOOST_AUTO_TEST_CASE(ReadOnly50000Ops16TransactionsHalfMisses)
+    {
+        cout << "ReadOnly50000Ops16TransactionsHalfMisses" << endl;
+        for (bool fingerprints : {false, true})
+        {
+            ARTable1->setLeafFingerprints(fingerprints);
+            uint64_t rejects = ARTable1->fingerprintRejects();
+            auto start_time2 = std::chrono::high_resolution_clock::now();
+
+            std::vector<Transaction<TransactionLambda, ARTTupleContainer>*> transactions;
+            for (int i = 0; i < 16; i++)
+                transactions.push_back(new Transaction<TransactionLambda, ARTTupleContainer>(
+                        ReadOnlyHalfMisses, *ARTable1, std::make_pair(0, 200000), TxnMode::ReadOnly));
+            for (auto t : transactions)
+                t->CollectTransaction();
+
+            auto end_time2 = std::chrono::high_resolution_clock::now();
+
+            cout<<"Total time by ReadOnly50000Ops16TransactionsHalfMisses"<<(fingerprints ? "Fingerprints" : "")<<"::"<<endl;
+            cout << std::chrono::duration_cast<std::chrono::seconds>(end_time2 - start_time2).count() << ":";
+            cout << std::chrono::duration_cast<std::chrono::microseconds>(end_time2 - start_time2).count() << ":"<<endl;
+            cout<<"rejected by a fingerprint::"<<ARTable1->fingerprintRejects() - rejects<<" of "<<16 * 25000<<" absent keys"<<endl;
+        }
+        ARTable1->setLeafFingerprints(false);
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
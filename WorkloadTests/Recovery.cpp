@@ -0,0 +1,104 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE MVCC_TEST
+
+#include <iostream>
+#include <boost/test/unit_test.hpp>
+#include <boost/lexical_cast.hpp>
+#include "mvcc/mvcc.hpp"
+#include "Transactions/UpdateIntensiveTemplates.hpp"
+#include "generated/settings.h"
+
+
+using namespace std;
+
+
+
+///home/muum8236/code/MVCCART/test_data
+const char * rootpath_words = "/Users/fuadshah/Desktop/MVCCART/test_data/words.txt";
+
+BOOST_AUTO_TEST_SUITE(MVCC_TESTS)
+
+
+    BOOST_AUTO_TEST_CASE(test_loading_Buckets_from_TextFIle)
+    {
+        cout << "loading_Buckets_from_TextFIle" << endl;
+        int keyLen;
+        char buf[20];
+
+        /// Reading all Values to store against keys
+        FILE *fkeys = fopen(rootpath_words, "r");
+        int index = 0;
+        while (fgets(buf, sizeof buf, fkeys))
+        {
+            keyLen = strlen(buf);
+            buf[keyLen] = '\0';
+            RecordType tuple = RecordType(buf,
+                                          (unsigned long) index,
+                                          index + 100,
+                                          fmt::format("String/{}", buf),
+                                          index / 100.0);
+
+            strcpy(KeysToStore[index],buf);
+            vectorValues.push_back(tuple);
+            index++;
+            if (index > 200000)
+            {
+                break;
+            }
+        }
+    }
+
+
+    /*
+     * Recovery time against dataset size and recovery threads. Half of the
+     * keys are in the checkpoint, the other half and 100 updates per
+     * transaction on the first half are only in the redo log.
+    */
+    BOOST_AUTO_TEST_CASE(RecoveryFromCheckpointAndLog)
+    {
+        cout << "RecoveryFromCheckpointAndLog" << endl;
+        for (int numKeys : {50000, 100000, 200000})
+        {
+            const std::string dir = "Recovery_" + std::to_string(numKeys);
+            const std::string logPath = dir + "/redo.log";
+            Checkpoint::createDirectory(dir);
+            ::unlink(logPath.c_str());
+
+            auto ARTable = new ARTTupleContainer();
+            RedoLog* log = new RedoLog(logPath);
+            ARTable->setRedoLog(log);
+            size_t loader = get_new_transaction_ID();
+            for (int index = 0; index < numKeys / 2; index++)
+                ARTable->insertOrUpdateByKey(KeysToStore[index], vectorValues[index], loader);
+            CheckpointInfo info = ARTable->checkpoint(dir);
+
+            for (int index = numKeys / 2; index < numKeys; index++)
+                ARTable->insertOrUpdateByKey(KeysToStore[index], vectorValues[index], get_new_transaction_ID());
+            for (int first = 0; first < numKeys / 2; first += numKeys / 8)
+            {
+                Transaction<TransactionLambda, ARTTupleContainer> *t1 = new Transaction<TransactionLambda, ARTTupleContainer>(
+                        UpdateSmall, *ARTable,std::make_pair(first, first + numKeys / 8));
+                t1->CollectTransaction();
+            }
+            ARTable->setRedoLog(nullptr);
+            delete log;
+
+            for (size_t threads : {1, 2, 4, 8})
+            {
+                auto recovered = new ARTTupleContainer();
+                RecoveryStats stats = recovered->recover(dir, logPath, threads);
+                cout<<"Recovery of "<<numKeys<<" keys with "<<threads<<" threads::"<<stats.totalUs<<":"
+                    <<" checkpoint::"<<stats.checkpointRecords<<" records:"<<stats.loadUs<<":"
+                    <<" log::"<<stats.replayedRecords<<" records:"<<stats.replayUs<<":"
+                    <<" keys::"<<recovered->art_size()<<endl;
+            }
+
+            for (auto& file : info.files)
+                ::unlink((dir + "/" + file).c_str());
+            ::unlink(Checkpoint::manifestPath(dir).c_str());
+            ::unlink(logPath.c_str());
+            ::rmdir(dir.c_str());
+        }
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
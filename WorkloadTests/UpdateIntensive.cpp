@@ -752,4 +752,43 @@ BOOST_AUTO_TEST_SUITE(MVCC_TESTS)
 
     }
 
+    /*
+     * UpdateIntensive10000Ops4Transactions once in memory and once with
+     * every committed write in the redo log, flushed before the clock stops.
+    */
+    BOOST_AUTO_TEST_CASE(UpdateIntensive10000Ops4TransactionsDurable)
+    {
+        cout << "UpdateIntensive10000Ops4TransactionsDurable" << endl;
+        auto run4Transactions = [] ()
+        {
+            auto start_time2 = std::chrono::high_resolution_clock::now();
+            std::vector<Transaction<TransactionLambda, ARTTupleContainer>*> transactions;
+            for (int i = 0; i < 4; i++)
+                transactions.push_back(new Transaction<TransactionLambda, ARTTupleContainer>(
+                        UpdateMedium, *ARTable1,std::make_pair(i * 50000, (i + 1) * 50000)));
+            for (auto t : transactions)
+                t->CollectTransaction();
+            if (ARTable1->getRedoLog() != nullptr)
+                ARTable1->getRedoLog()->flush();
+            auto end_time2 = std::chrono::high_resolution_clock::now();
+            return std::chrono::duration_cast<std::chrono::microseconds>(end_time2 - start_time2).count();
+        };
+
+        auto inMemoryUs = run4Transactions();
+        const char* logPath = "UpdateIntensive_redo.log";
+        ::unlink(logPath);
+        RedoLog* log = new RedoLog(logPath);
+        ARTable1->setRedoLog(log);
+        auto durableUs = run4Transactions();
+        ARTable1->setRedoLog(nullptr);
+        RedoLog::Stats stats = log->stats();
+        delete log;
+        ::unlink(logPath);
+
+        cout<<"Total time by UpdateIntensive10000Ops4Transactions in memory::"<<inMemoryUs<<":"<<endl;
+        cout<<"Total time by UpdateIntensive10000Ops4Transactions durable::"<<durableUs<<":"<<endl;
+        cout<<"durable/in-memory::"<<(double) durableUs / inMemoryUs<<" commits::"<<stats.commits
+            <<" groups::"<<stats.groups<<" bytes::"<<stats.bytes<<endl;
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
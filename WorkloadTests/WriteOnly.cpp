@@ -451,5 +451,192 @@ BOOST_AUTO_TEST_SUITE(MVCC_TESTS)
 
     }
 
+    /*
+     * Random inserts by 4 transactions, straight into the tree and through
+     * the write buffer; the buffered run includes merging what is left.
+    */
+    BOOST_AUTO_TEST_CASE(WriteOnlyRandom4TransactionsWriteBuffer)
+    {
+        cout << "WriteOnlyRandom4TransactionsWriteBuffer" << endl;
+        for (bool buffered : {false, true})
+        {
+            auto ARTable = new ARTTupleContainer();
+            if (buffered)
+                ARTable->enableWriteBuffer();
+            auto start_time2 = std::chrono::high_resolution_clock::now();
+
+            Transaction<TransactionLambda, ARTTupleContainer> *t1 = new Transaction<TransactionLambda, ARTTupleContainer>(
+                    WriteOnlyRandom, *ARTable,std::make_pair(0, 50000));
+            Transaction<TransactionLambda, ARTTupleContainer> *t2 = new Transaction<TransactionLambda, ARTTupleContainer>(
+                    WriteOnlyRandom, *ARTable,std::make_pair(50000, 100000));
+            Transaction<TransactionLambda, ARTTupleContainer> *t3 = new Transaction<TransactionLambda, ARTTupleContainer>(
+                    WriteOnlyRandom, *ARTable,std::make_pair(100000, 150000));
+            Transaction<TransactionLambda, ARTTupleContainer> *t4 = new Transaction<TransactionLambda, ARTTupleContainer>(
+                    WriteOnlyRandom, *ARTable,std::make_pair(150000, 200000));
+
+            t1->CollectTransaction();
+            t2->CollectTransaction();
+            t3->CollectTransaction();
+            t4->CollectTransaction();
+            auto ingested = std::chrono::high_resolution_clock::now();
+            ARTable->flushWriteBuffer();
+            auto end_time2 = std::chrono::high_resolution_clock::now();
+
+            cout<<"Total time by WriteOnlyRandom4Transactions"<<(buffered ? "WriteBuffer" : "")<<"::"<<endl;
+            cout << std::chrono::duration_cast<std::chrono::microseconds>(ingested - start_time2).count() << ":";
+            cout << std::chrono::duration_cast<std::chrono::microseconds>(end_time2 - start_time2).count() << ":"<<endl;
+            if (buffered)
+            {
+                WriteBufferStats stats = ARTable->writeBufferStats();
+                cout<<"batches::"<<stats.batches<<" on writers::"<<stats.writerBatches<<" keys::"<<ARTable->art_size()<<endl;
+                ARTable->disableWriteBuffer();
+            }
+        }
+    }
+
+
+    /*
+     * Time-ordered ids, sorted and nearly sorted (shuffled within windows
+     * of 16), inserted with and without the per-thread finger.
+     */
+    BOOST_AUTO_TEST_CASE(WriteOnlySequentialFinger)
+    {
+        cout << "WriteOnlySequentialFinger" << endl;
+        const int numKeys = 200000;
+        std::mt19937 rng(43);
+        for (bool nearlySorted : {false, true})
+        {
+            std::vector<int> order(numKeys + 1);
+            for (int i = 0; i <= numKeys; i++)
+                order[i] = i;
+            if (nearlySorted)
+                for (int i = 0; i + 16 <= numKeys; i += 16)
+                    std::shuffle(order.begin() + i, order.begin() + i + 16, rng);
+            for (int i = 0; i <= numKeys; i++)
+                sprintf(SequentialKeys[i], "%015llu", 1500000000000ull + order[i] * 7ull);
+
+            for (bool finger : {false, true})
+            {
+                auto ARTable = new ARTTupleContainer();
+                ARTable->setFingerCaching(finger);
+                auto start_time2 = std::chrono::high_resolution_clock::now();
+
+                Transaction<TransactionLambda, ARTTupleContainer> *t1 = new Transaction<TransactionLambda, ARTTupleContainer>(
+                        WriteOnlySequential, *ARTable,std::make_pair(0, numKeys));
+                t1->CollectTransaction();
+
+                auto end_time2 = std::chrono::high_resolution_clock::now();
+
+                cout<<"Total time by WriteOnlySequential"<<(nearlySorted ? "NearlySorted" : "Sorted")
+                    <<(finger ? "Finger" : "")<<"::"<<endl;
+                cout << std::chrono::duration_cast<std::chrono::seconds>(end_time2 - start_time2).count() << ":";
+                cout << std::chrono::duration_cast<std::chrono::microseconds>(end_time2 - start_time2).count() << ":"<<endl;
+                cout<<"keys::"<<ARTable->art_size()<<endl;
+            }
+        }
+    }
+
+
+    /*
+     * Uniform random inserts by 32 transactions into a plain root and into
+     * roots partitioned by one and by two key bytes.
+     */
+    BOOST_AUTO_TEST_CASE(WriteOnlyRandom32TransactionsPartitionedRoot)
+    {
+        cout << "WriteOnlyRandom32TransactionsPartitionedRoot" << endl;
+        for (int bytes : {0, 1, 2})
+        {
+            auto ARTable = new ARTTupleContainer();
+            if (bytes > 0)
+                ARTable->partitionRoot(bytes);
+            auto start_time2 = std::chrono::high_resolution_clock::now();
+
+            std::vector<Transaction<TransactionLambda, ARTTupleContainer>*> transactions;
+            for (int i = 0; i < 32; i++)
+                transactions.push_back(new Transaction<TransactionLambda, ARTTupleContainer>(
+                        WriteOnlyRandom, *ARTable, std::make_pair(i * 6250, (i + 1) * 6250)));
+            for (auto t : transactions)
+                t->CollectTransaction();
+
+            auto end_time2 = std::chrono::high_resolution_clock::now();
+
+            cout<<"Total time by WriteOnlyRandom32Transactions"<<(bytes == 0 ? "" : bytes == 1 ? "PartitionedRoot256" : "PartitionedRoot65536")<<"::"<<endl;
+            cout << std::chrono::duration_cast<std::chrono::seconds>(end_time2 - start_time2).count() << ":";
+            cout << std::chrono::duration_cast<std::chrono::microseconds>(end_time2 - start_time2).count() << ":"<<endl;
+            cout<<"keys::"<<ARTable->art_size()<<endl;
+        }
+    }
+
+    /*
+     * Zipfian (0.99) writes by 32 transactions, hot keys and the nodes above
+     * them are written over and over, with and without flat combining.
+     */
+    BOOST_AUTO_TEST_CASE(WriteOnlyZipf32TransactionsCombining)
+    {
+        cout << "WriteOnlyZipf32TransactionsCombining" << endl;
+        zipfKeys();
+        for (bool combining : {false, true})
+        {
+            auto ARTable = new ARTTupleContainer();
+            ARTable->setCombining(combining);
+            auto start_time2 = std::chrono::high_resolution_clock::now();
+
+            std::vector<Transaction<TransactionLambda, ARTTupleContainer>*> transactions;
+            for (int i = 0; i < 32; i++)
+                transactions.push_back(new Transaction<TransactionLambda, ARTTupleContainer>(
+                        WriteOnlyZipf, *ARTable, std::make_pair(i * 2000, (i + 1) * 2000)));
+            for (auto t : transactions)
+                t->CollectTransaction();
+
+            auto end_time2 = std::chrono::high_resolution_clock::now();
+
+            ContentionStats stats = ARTable->contentionStats();
+            cout<<"Total time by WriteOnlyZipf32Transactions"<<(combining ? "Combining" : "")<<"::"<<endl;
+            cout << std::chrono::duration_cast<std::chrono::seconds>(end_time2 - start_time2).count() << ":";
+            cout << std::chrono::duration_cast<std::chrono::microseconds>(end_time2 - start_time2).count() << ":"<<endl;
+            cout<<"keys::"<<ARTable->art_size()<<" conflicts::"<<stats.conflicts<<" restarts::"<<stats.restarts
+                <<" published::"<<stats.published<<" combined::"<<stats.combined<<endl;
+        }
+    }
+
+    /*
+     * URL-like keys of 30 to 60 bytes, a few hosts and sections in front of
+     * unique item paths, inserted by 8 transactions into leaves holding the
+     * whole key and into leaves holding only the suffix below their depth.
+     */
+    BOOST_AUTO_TEST_CASE(WriteOnlyUrls8TransactionsLeafSuffixes)
+    {
+        cout << "WriteOnlyUrls8TransactionsLeafSuffixes" << endl;
+        const int numKeys = 200000;
+        const char* hosts[] = {"www.example.com", "shop.example.com", "blog.example.org", "docs.example.net"};
+        const char* sections[] = {"products", "articles", "reference", "downloads", "support", "news"};
+        std::mt19937 rng(47);
+        for (int i = 0; i <= numKeys; i++)
+            sprintf(UrlKeys[i], "https://%s/%s/%03u/item-%07d", hosts[rng() % 4], sections[rng() % 6],
+                    (unsigned) (rng() % 200), i);
+
+        for (bool suffixes : {false, true})
+        {
+            auto ARTable = new ARTTupleContainer();
+            ARTable->setLeafSuffixes(suffixes);
+            auto start_time2 = std::chrono::high_resolution_clock::now();
+
+            std::vector<Transaction<TransactionLambda, ARTTupleContainer>*> transactions;
+            for (int i = 0; i < 8; i++)
+                transactions.push_back(new Transaction<TransactionLambda, ARTTupleContainer>(
+                        WriteOnlyUrls, *ARTable, std::make_pair(i * numKeys / 8, (i + 1) * numKeys / 8 - 1)));
+            for (auto t : transactions)
+                t->CollectTransaction();
+
+            auto end_time2 = std::chrono::high_resolution_clock::now();
+
+            uint64_t keys = ARTable->art_size(), bytes = ARTable->estimatedFootprint();
+            cout<<"Total time by WriteOnlyUrls8Transactions"<<(suffixes ? "LeafSuffixes" : "")<<"::"<<endl;
+            cout << std::chrono::duration_cast<std::chrono::seconds>(end_time2 - start_time2).count() << ":";
+            cout << std::chrono::duration_cast<std::chrono::microseconds>(end_time2 - start_time2).count() << ":"<<endl;
+            cout<<"keys::"<<keys<<" bytes::"<<bytes<<" bytes per key::"<<bytes / std::max<uint64_t>(keys, 1)<<endl;
+        }
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
 
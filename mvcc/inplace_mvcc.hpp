@@ -0,0 +1,607 @@
+#ifndef MVCC11_INPLACE_MVCC_HPP
+#define MVCC11_INPLACE_MVCC_HPP
+
+#include <atomic>
+#include <type_traits>
+#include "mvcc/mvcc.hpp"
+
+/// Number of before-images kept per record for snapshot readers and rollback
+#ifndef MVCC11_INPLACE_UNDO_DEPTH
+#define MVCC11_INPLACE_UNDO_DEPTH 8
+#endif // MVCC11_INPLACE_UNDO_DEPTH
+
+/// Snapshots each thread keeps per record type to hand out copies without allocating
+#ifndef MVCC11_INPLACE_SNAPSHOT_POOL
+#define MVCC11_INPLACE_SNAPSHOT_POOL 4
+#endif // MVCC11_INPLACE_SNAPSHOT_POOL
+
+namespace mvcc11 {
+
+    /**
+     * Trait deciding at compile time if records of ValueType are updated
+     * in place. Trivially copyable records (counters, balances) qualify,
+     * everything else keeps one heap snapshot per version.
+     * Define MVCC11_DISABLE_INPLACE_UPDATES to always use mvcc<ValueType>.
+     */
+    template <class ValueType>
+    struct is_inplace_updatable
+    {
+#ifdef MVCC11_DISABLE_INPLACE_UPDATES
+        static constexpr bool value = false;
+#else
+        static constexpr bool value = std::is_trivially_copyable<ValueType>::value;
+#endif
+    };
+
+
+    /**
+     * MVCC object for trivially copyable records.
+     * The head snapshot is allocated once and its payload is overwritten
+     * in place under a seqlock; the before-image of every update goes to a
+     * fixed ring of undo records so rollback never needs a heap allocation.
+     * A transaction writing a record again keeps the before-image of its
+     * first write. An image the ring overwrites while a snapshot above the
+     * low watermark or an open transaction may still need it moves to an
+     * overflow list, which readers search under the latch and prune() trims.
+     * The head stays with the writers: current(), visible() and the writes
+     * hand out copies taken under the seqlock, which later writes leave
+     * alone. The copies come from a small per-thread pool and are reused
+     * once their holders dropped them, so steady updates do not allocate.
+     */
+    template <class ValueType>
+    class inplace_mvcc
+    {
+        static_assert(std::is_trivially_copyable<ValueType>::value,
+                      "inplace_mvcc requires a trivially copyable record type");
+
+    public:
+        using value_type = ValueType;
+        using snapshot_type = snapshot<value_type>;
+        using mutable_snapshot_ptr = smart_ptr::shared_ptr<snapshot_type>;
+        using const_snapshot_ptr = smart_ptr::shared_ptr<snapshot_type const>;
+
+        inplace_mvcc(size_t txn_id, value_type const &value);
+
+        ~inplace_mvcc();
+
+        inplace_mvcc(inplace_mvcc const &) = delete;
+        inplace_mvcc& operator=(inplace_mvcc const &) = delete;
+
+        const_snapshot_ptr current() MVCC11_NOEXCEPT(true);
+        const_snapshot_ptr operator*() MVCC11_NOEXCEPT(true);
+        const_snapshot_ptr operator->() MVCC11_NOEXCEPT(true);
+
+        const_snapshot_ptr overwriteMV(size_t txn_id,value_type const &value);
+        const_snapshot_ptr deleteMV(size_t txn_id);
+
+        template <class Updater>
+        const_snapshot_ptr update(size_t txn_id,Updater updater);
+
+        template <class Updater>
+        const_snapshot_ptr try_update(size_t txn_id,Updater updater);
+
+        /// Consistent copy of the head version, returns its begin version
+        size_t read(value_type &out) const MVCC11_NOEXCEPT(true);
+
+        /// Copy of the version visible to txn_id, false if there is none
+        bool read_as_of(size_t txn_id, value_type &out) const MVCC11_NOEXCEPT(true);
+
+        /// Undo all in-place writes of txn_id still at the head of the record
+        bool rollback(size_t txn_id) MVCC11_NOEXCEPT(true);
+
+        /// Version in the snapshot of (read_ts,txn_id), copied out of the undo ring or overflow if needed
+        const_snapshot_ptr visible(size_t read_ts, size_t txn_id) MVCC11_NOEXCEPT(true);
+
+        /// Begin version of the before-image pushed by the latest write
+        size_t previous_version(const_snapshot_ptr const &v) MVCC11_NOEXCEPT(true);
+
+        /// Commit/abort hooks registered with TxnContext for every write
+        static const TxnWriteOps* write_ops() MVCC11_NOEXCEPT(true);
+
+        /// Frees overflow images that ended at or below watermark, the ring stays
+        size_t prune(size_t watermark, size_t *kept = nullptr) MVCC11_NOEXCEPT(true);
+
+    private:
+
+        void commit_version(size_t txn_id, size_t commit_ts) MVCC11_NOEXCEPT(true);
+
+        struct undo_record
+        {
+            size_t version;
+            size_t end_version;
+            value_type value;
+        };
+
+        struct overflow_record
+        {
+            undo_record undo;
+            overflow_record *older;
+        };
+
+        uint64_t latch() const MVCC11_NOEXCEPT(true);
+        void unlatch(uint64_t seq) const MVCC11_NOEXCEPT(true);
+
+        template <class Producer>
+        const_snapshot_ptr try_write_impl(size_t txn_id, Producer &producer);
+
+        /// Copy of the head from the pool, the caller holds the latch
+        const_snapshot_ptr copy_head() const;
+
+        /// Snapshot holding a copy of undo, reused from the pool of this thread if one is free
+        static const_snapshot_ptr pooled_copy(undo_record const &undo);
+
+        /**
+         * Finds the version matching visible among the head, the ring and,
+         * with overflow set, the overflow list.
+         * @return false if none matches, out is left alone
+         */
+        template <class Visible>
+        bool search(Visible const &visible, bool overflow, undo_record &out) const MVCC11_NOEXCEPT(true);
+
+        /// search() under the seqlock, then under the latch if older images overflowed
+        template <class Visible>
+        bool find_version(Visible const &visible, undo_record &out) const MVCC11_NOEXCEPT(true);
+
+        /// True if a snapshot or an open transaction may still read undo, the caller holds the latch
+        static bool still_needed(undo_record const &undo) MVCC11_NOEXCEPT(true);
+
+        /// Unlinks overflow images that ended at or below watermark, the caller holds the latch
+        size_t drop_overflow(size_t watermark, size_t *kept) MVCC11_NOEXCEPT(true);
+
+        mutable std::atomic<uint64_t> seq_;
+        mutable_snapshot_ptr head_;
+        undo_record undo_[MVCC11_INPLACE_UNDO_DEPTH];
+        uint32_t undo_top_;
+        uint32_t undo_size_;
+        ///newest first, only set while a needed image left the ring
+        std::atomic<overflow_record*> overflow_;
+    };
+
+
+    /// Selects the mvcc implementation for a record type at compile time
+    template <class ValueType>
+    struct select_mvcc
+    {
+        using type = typename std::conditional<is_inplace_updatable<ValueType>::value,
+                                               inplace_mvcc<ValueType>,
+                                               mvcc<ValueType>>::type;
+    };
+
+
+    template <class ValueType>
+    inplace_mvcc<ValueType>::inplace_mvcc(size_t txn_id,value_type const &value)
+            : seq_{0}
+            , head_{smart_ptr::make_shared<snapshot_type>(txn_id,INF, value)}
+            , undo_top_{0}
+            , undo_size_{0}
+            , overflow_{nullptr}
+    {head_->_older_snapshot=nullptr;}
+
+    template <class ValueType>
+    inplace_mvcc<ValueType>::~inplace_mvcc()
+    {
+        drop_overflow(INF, nullptr);
+    }
+
+    template <class ValueType>
+    auto inplace_mvcc<ValueType>::current() MVCC11_NOEXCEPT(true) -> const_snapshot_ptr
+    {
+        undo_record head;
+        while (true)
+        {
+            uint64_t before = seq_.load(std::memory_order_acquire);
+            if (before & 1)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            head.version = head_->version;
+            head.end_version = head_->end_version;
+            head.value = head_->value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) == before)
+                return pooled_copy(head);
+        }
+    }
+
+    template <class ValueType>
+    auto inplace_mvcc<ValueType>::copy_head() const -> const_snapshot_ptr
+    {
+        return pooled_copy(undo_record{head_->version, head_->end_version, head_->value});
+    }
+
+    template <class ValueType>
+    auto inplace_mvcc<ValueType>::pooled_copy(undo_record const &undo) -> const_snapshot_ptr
+    {
+        static thread_local mutable_snapshot_ptr pool[MVCC11_INPLACE_SNAPSHOT_POOL];
+        mutable_snapshot_ptr copy = nullptr;
+        for (mutable_snapshot_ptr &pooled : pool)
+        {
+            if (pooled == nullptr)
+                pooled = smart_ptr::make_shared<snapshot_type>(undo.version, undo.value);
+            ///nobody but the pool holds it, no other thread can reach it again
+            if (pooled.use_count() == 1)
+            {
+                std::atomic_thread_fence(std::memory_order_acquire);
+                copy = pooled;
+                break;
+            }
+        }
+        if (copy == nullptr)
+            copy = smart_ptr::make_shared<snapshot_type>(undo.version, undo.value);
+        copy->version = undo.version;
+        copy->end_version = undo.end_version;
+        copy->value = undo.value;
+        return copy;
+    }
+
+    template <class ValueType>
+    auto inplace_mvcc<ValueType>::operator*() MVCC11_NOEXCEPT(true) -> const_snapshot_ptr
+    {
+        return this->current();
+    }
+    template <class ValueType>
+    auto inplace_mvcc<ValueType>::operator->() MVCC11_NOEXCEPT(true) -> const_snapshot_ptr
+    {
+        return this->current();
+    }
+
+    template <class ValueType>
+    uint64_t inplace_mvcc<ValueType>::latch() const MVCC11_NOEXCEPT(true)
+    {
+        ///odd sequence means a writer owns the record
+        while (true)
+        {
+            uint64_t seq = seq_.load(std::memory_order_acquire);
+            if ((seq & 1) == 0 &&
+                seq_.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire))
+                return seq + 1;
+            std::this_thread::yield();
+        }
+    }
+
+    template <class ValueType>
+    void inplace_mvcc<ValueType>::unlatch(uint64_t seq) const MVCC11_NOEXCEPT(true)
+    {
+        seq_.store(seq + 1, std::memory_order_release);
+    }
+
+    template <class ValueType>
+    size_t inplace_mvcc<ValueType>::read(value_type &out) const MVCC11_NOEXCEPT(true)
+    {
+        while (true)
+        {
+            uint64_t before = seq_.load(std::memory_order_acquire);
+            if (before & 1)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            out = head_->value;
+            size_t version = head_->version;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) == before)
+                return version;
+        }
+    }
+
+    template <class ValueType>
+    bool inplace_mvcc<ValueType>::read_as_of(size_t txn_id, value_type &out) const MVCC11_NOEXCEPT(true)
+    {
+        undo_record found;
+        auto visible = [txn_id](undo_record const &r) {
+            return r.version <= txn_id && r.end_version > txn_id;
+        };
+        if (!find_version(visible, found))
+            return false;
+        out = found.value;
+        return true;
+    }
+
+    template <class ValueType>
+    template <class Visible>
+    bool inplace_mvcc<ValueType>::search(Visible const &visible, bool overflow, undo_record &out) const MVCC11_NOEXCEPT(true)
+    {
+        undo_record head{head_->version, head_->end_version, head_->value};
+        if (visible(head))
+        {
+            out = head;
+            return true;
+        }
+        ///walk the before-images from newest to oldest
+        for (uint32_t i = 0; i < undo_size_; i++)
+        {
+            uint32_t slot = (undo_top_ + MVCC11_INPLACE_UNDO_DEPTH - 1 - i) % MVCC11_INPLACE_UNDO_DEPTH;
+            if (visible(undo_[slot]))
+            {
+                out = undo_[slot];
+                return true;
+            }
+        }
+        if (overflow)
+            for (overflow_record *o = overflow_.load(std::memory_order_relaxed); o != nullptr; o = o->older)
+                if (visible(o->undo))
+                {
+                    out = o->undo;
+                    return true;
+                }
+        return false;
+    }
+
+    template <class ValueType>
+    template <class Visible>
+    bool inplace_mvcc<ValueType>::find_version(Visible const &visible, undo_record &out) const MVCC11_NOEXCEPT(true)
+    {
+        while (true)
+        {
+            uint64_t before = seq_.load(std::memory_order_acquire);
+            if (before & 1)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            undo_record found;
+            bool hit = search(visible, false, found);
+            bool overflowed = overflow_.load(std::memory_order_relaxed) != nullptr;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) != before)
+                continue;
+            if (hit)
+                out = found;
+            if (hit || !overflowed)
+                return hit;
+            break;
+        }
+        ///the list is unlinked and freed under the latch only
+        uint64_t seq = latch();
+        bool hit = search(visible, true, out);
+        unlatch(seq);
+        return hit;
+    }
+
+    template <class ValueType>
+    bool inplace_mvcc<ValueType>::still_needed(undo_record const &undo) MVCC11_NOEXCEPT(true)
+    {
+        if (is_txn_id(undo.end_version))
+            return true;
+        if (undo.version == MVCC11_ABORTED_VERSION || undo.end_version <= activeTxnRegistry.lowWatermark())
+            return false;
+        ///the cached watermark may lag, look again before keeping an image on the heap
+        return undo.end_version > activeTxnRegistry.refreshLowWatermark();
+    }
+
+    template <class ValueType>
+    size_t inplace_mvcc<ValueType>::drop_overflow(size_t watermark, size_t *kept) MVCC11_NOEXCEPT(true)
+    {
+        size_t dropped = 0, left = 0;
+        overflow_record *keep = nullptr, **tail = &keep;
+        overflow_record *o = overflow_.load(std::memory_order_relaxed);
+        while (o != nullptr)
+        {
+            overflow_record *older = o->older;
+            if (!is_txn_id(o->undo.end_version) && o->undo.end_version <= watermark)
+            {
+                delete o;
+                dropped++;
+            }
+            else
+            {
+                *tail = o;
+                tail = &o->older;
+                left++;
+            }
+            o = older;
+        }
+        *tail = nullptr;
+        overflow_.store(keep, std::memory_order_relaxed);
+        if (kept != nullptr)
+            *kept = left;
+        return dropped;
+    }
+
+    template <class ValueType>
+    template <class Producer>
+    auto inplace_mvcc<ValueType>::try_write_impl(size_t txn_id, Producer &producer) -> const_snapshot_ptr
+    {
+        uint64_t seq = latch();
+
+        ///if record was created and its active currently and not by the current transaction
+        if (write_conflict(*head_, txn_id))
+        {
+            unlatch(seq);
+            return nullptr;
+        }
+
+        ///push the before-image, a transaction writing again keeps the one of its first write
+        if (head_->version != txn_id)
+        {
+            undo_record &undo = undo_[undo_top_];
+            ///the oldest image leaves the ring, onto the overflow list if a reader may need it
+            if (undo_size_ == MVCC11_INPLACE_UNDO_DEPTH && still_needed(undo))
+            {
+                drop_overflow(activeTxnRegistry.lowWatermark(), nullptr);
+                overflow_.store(new overflow_record{undo, overflow_.load(std::memory_order_relaxed)},
+                                std::memory_order_relaxed);
+            }
+            undo.version = head_->version;
+            undo.end_version = txn_id;
+            undo.value = head_->value;
+            undo_top_ = (undo_top_ + 1) % MVCC11_INPLACE_UNDO_DEPTH;
+            if (undo_size_ < MVCC11_INPLACE_UNDO_DEPTH)
+                undo_size_++;
+        }
+
+        producer(head_->value);
+        head_->version = txn_id;
+        head_->end_version = INF;
+
+        const_snapshot_ptr written = copy_head();
+        unlatch(seq);
+        return written;
+    }
+
+    template <class ValueType>
+    auto inplace_mvcc<ValueType>::overwriteMV(size_t txn_id,value_type const &value) -> const_snapshot_ptr
+    {
+        auto producer = [&value](value_type &head) { head = value; };
+        return this->try_write_impl(txn_id, producer);
+    }
+
+    template <class ValueType>
+    auto inplace_mvcc<ValueType>::deleteMV(size_t txn_id) -> const_snapshot_ptr
+    {
+        while (true)
+        {
+            uint64_t seq = latch();
+            if (write_conflict(*head_, txn_id))
+            {
+                unlatch(seq);
+                ///explicit transactions abort instead of waiting
+                if (is_txn_id(txn_id))
+                    return nullptr;
+                continue;
+            }
+            ///deleted head keeps its payload, only its end version is set
+            head_->end_version = txn_id;
+            const_snapshot_ptr deleted = copy_head();
+            unlatch(seq);
+            return deleted;
+        }
+    }
+
+    template <class ValueType>
+    template <class Updater>
+    auto inplace_mvcc<ValueType>::update(size_t txn_id,Updater updater) -> const_snapshot_ptr
+    {
+        if (is_txn_id(txn_id))
+            return this->try_update(txn_id,updater);
+        while(true)
+        {
+            auto updated = this->try_update(txn_id,updater);
+            if(updated != nullptr)
+                return updated;
+            std::this_thread::sleep_for(std::chrono::milliseconds(MVCC11_CONTENSION_BACKOFF_SLEEP_MS));
+        }
+    }
+
+    template <class ValueType>
+    template <class Updater>
+    auto inplace_mvcc<ValueType>::try_update(size_t txn_id,Updater updater) -> const_snapshot_ptr
+    {
+        auto producer = [&updater](value_type &head) { head = updater(head); };
+        return this->try_write_impl(txn_id, producer);
+    }
+
+    template <class ValueType>
+    bool inplace_mvcc<ValueType>::rollback(size_t txn_id) MVCC11_NOEXCEPT(true)
+    {
+        uint64_t seq = latch();
+        bool restored = false;
+        ///pop before-images until the head no longer belongs to txn_id
+        while (head_->version == txn_id && undo_size_ > 0)
+        {
+            undo_top_ = (undo_top_ + MVCC11_INPLACE_UNDO_DEPTH - 1) % MVCC11_INPLACE_UNDO_DEPTH;
+            undo_size_--;
+            head_->value = undo_[undo_top_].value;
+            head_->version = undo_[undo_top_].version;
+            head_->end_version = INF;
+            restored = true;
+        }
+        if (head_->end_version == txn_id)
+        {
+            head_->end_version = INF;
+            restored = true;
+        }
+        ///an insert has no before-image left to restore
+        if (head_->version == txn_id)
+        {
+            head_->version = MVCC11_ABORTED_VERSION;
+            restored = true;
+        }
+        unlatch(seq);
+        return restored;
+    }
+
+    template <class ValueType>
+    auto inplace_mvcc<ValueType>::visible(size_t read_ts, size_t txn_id) MVCC11_NOEXCEPT(true) -> const_snapshot_ptr
+    {
+        undo_record found;
+        auto visible = [read_ts, txn_id](undo_record const &r) {
+            snapshot_type image(r.version, r.value);
+            image.end_version = r.end_version;
+            return is_visible(image, read_ts, txn_id);
+        };
+        if (!find_version(visible, found))
+            return nullptr;
+        return pooled_copy(found);
+    }
+
+    template <class ValueType>
+    size_t inplace_mvcc<ValueType>::previous_version(const_snapshot_ptr const &) MVCC11_NOEXCEPT(true)
+    {
+        uint64_t seq = latch();
+        size_t version = undo_size_ > 0
+                         ? undo_[(undo_top_ + MVCC11_INPLACE_UNDO_DEPTH - 1) % MVCC11_INPLACE_UNDO_DEPTH].version
+                         : 0;
+        unlatch(seq);
+        return version;
+    }
+
+    template <class ValueType>
+    void inplace_mvcc<ValueType>::commit_version(size_t txn_id, size_t commit_ts) MVCC11_NOEXCEPT(true)
+    {
+        uint64_t seq = latch();
+        if (head_->version == txn_id)
+            head_->version = commit_ts;
+        if (head_->end_version == txn_id)
+            head_->end_version = commit_ts;
+        for (uint32_t i = 0; i < undo_size_; i++)
+        {
+            undo_record &undo = undo_[(undo_top_ + MVCC11_INPLACE_UNDO_DEPTH - 1 - i) % MVCC11_INPLACE_UNDO_DEPTH];
+            if (undo.version == txn_id)
+                undo.version = commit_ts;
+            if (undo.end_version == txn_id)
+                undo.end_version = commit_ts;
+        }
+        for (overflow_record *o = overflow_.load(std::memory_order_relaxed); o != nullptr; o = o->older)
+            if (o->undo.end_version == txn_id)
+                o->undo.end_version = commit_ts;
+        unlatch(seq);
+    }
+
+    template <class ValueType>
+    size_t inplace_mvcc<ValueType>::prune(size_t watermark, size_t *kept) MVCC11_NOEXCEPT(true)
+    {
+        ///the undo ring lives inside the object, only the head and overflowed images are on the heap
+        if (overflow_.load(std::memory_order_relaxed) == nullptr)
+        {
+            if (kept != nullptr)
+                *kept = 1;
+            return 0;
+        }
+        uint64_t seq = latch();
+        size_t left = 0;
+        size_t dropped = drop_overflow(watermark, &left);
+        unlatch(seq);
+        if (kept != nullptr)
+            *kept = 1 + left;
+        return dropped;
+    }
+
+    template <class ValueType>
+    const TxnWriteOps* inplace_mvcc<ValueType>::write_ops() MVCC11_NOEXCEPT(true)
+    {
+        static const TxnWriteOps ops = {
+                [](void* object, void*, size_t txn_id, size_t commit_ts) {
+                    static_cast<inplace_mvcc*>(object)->commit_version(txn_id, commit_ts);
+                },
+                [](void* object, void*, size_t txn_id) {
+                    static_cast<inplace_mvcc*>(object)->rollback(txn_id);
+                }
+        };
+        return &ops;
+    }
+
+} // namespace mvcc11
+
+#endif // MVCC11_INPLACE_MVCC_HPP
@@ -5,6 +5,11 @@
 #define MVCC11_CONTENSION_BACKOFF_SLEEP_MS 50
 #endif // MVCC11_CONTENSION_BACKOFF_SLEEP_MS
 
+/// Versions a chain may keep before a writer refreshes the low watermark to prune it
+#ifndef MVCC11_MAX_VERSION_DEPTH
+#define MVCC11_MAX_VERSION_DEPTH 100
+#endif // MVCC11_MAX_VERSION_DEPTH
+
 // Optionally uses std::shared_ptr instead of boost::shared_ptr
 #ifdef MVCC11_USES_STD_SHARED_PTR
 
@@ -54,7 +59,6 @@ namespace mvcc11 {
 #include <chrono>
 #include <thread>
 #include "Transactions/transactionManager.h"
-#define INF 99999
 
 #ifdef MVCC11_DISABLE_NOEXCEPT
 #define MVCC11_NOEXCEPT(COND)
@@ -65,6 +69,21 @@ namespace mvcc11 {
 namespace mvcc11 {
 
 
+    /// True if txn_id may not install a version on top of expected
+    template <class ValueType>
+    bool write_conflict(snapshot<ValueType> const &expected, size_t txn_id)
+    {
+        ///first writer wins against any uncommitted writer or deleter
+        if (is_txn_id(expected.version) && expected.version != txn_id)
+            return true;
+        if (is_txn_id(expected.end_version) && expected.end_version != txn_id)
+            return true;
+        if (expected.end_version != INF && expected.version != txn_id &&
+            !is_txn_id(expected.version) && expected.version != MVCC11_ABORTED_VERSION)
+            return TransactionsStatus[expected.version] == "Active";
+        return false;
+    }
+
     template <class ValueType>
     class mvcc
     {
@@ -111,8 +130,38 @@ namespace mvcc11 {
         template <class Updater, class Rep, class Period>
         const_snapshot_ptr try_update_for(size_t txn_id,Updater updater, std::chrono::duration<Rep, Period> const &timeout_duration);
 
+        /// Newest version in the snapshot of a reader (read_ts,txn_id), nullptr if none
+        const_snapshot_ptr visible(size_t read_ts, size_t txn_id) MVCC11_NOEXCEPT(true);
+
+        /// Begin version of the version v replaced, 0 if v was an insert
+        size_t previous_version(const_snapshot_ptr const &v) MVCC11_NOEXCEPT(true);
+
+        /// Commit/abort hooks registered with TxnContext for every write
+        static const TxnWriteOps* write_ops() MVCC11_NOEXCEPT(true);
+
+        /**
+         * Unlinks the versions below the newest one committed at or before
+         * watermark: no snapshot at or above the watermark can reach them.
+         * Unlinked versions are freed once the last reader drops them.
+         * @arg kept receives the number of versions left in the chain
+         * @return number of versions unlinked
+         */
+        size_t prune(size_t watermark, size_t *kept = nullptr) MVCC11_NOEXCEPT(true);
+
+        /// Calls fn(snapshot_type&) on every version linked into the chain, newest first
+        template <class Fn>
+        void for_each_version(Fn fn);
+
     private:
 
+        /// Cooperative pruning after a successful write, enforces MVCC11_MAX_VERSION_DEPTH
+        void prune_after_write() MVCC11_NOEXCEPT(true);
+
+        static size_t unlink_tail(snapshot_type *v) MVCC11_NOEXCEPT(true);
+
+        void commit_version(snapshot_type *v, size_t txn_id, size_t commit_ts) MVCC11_NOEXCEPT(true);
+        void abort_version(snapshot_type *v, size_t txn_id) MVCC11_NOEXCEPT(true);
+
         template <class U>
         const_snapshot_ptr overwrite_impl(U &&value);
 
@@ -254,32 +303,24 @@ namespace mvcc11 {
 
             ///2- Fetch/Read  expected Version speculatively
             auto expected = smart_ptr::atomic_load(&mutable_current_);
-            auto const const_expected_version = expected->version;
-            auto const const_expected_end_version = expected->end_version;
-            auto const &const_expected_value = expected->value;
             //desired->end_version = INF;
 
             ///3- if record was created and its active currently and not by the current transaction
-            if ( const_expected_end_version != INF && const_expected_version != txn_id)
+            if (write_conflict(*expected, txn_id))
             {
-
-                if (TransactionsStatus[const_expected_version] == "Active" )
-                {
-                    //std::cout << "Aborted on value " << expected->value<< std::endl;
-                    //continue;
-                    return nullptr;
-
-                }
+                //std::cout << "Aborted on value " << expected->value<< std::endl;
+                //continue;
+                return nullptr;
             }
 
-
-            expected->end_version = txn_id;
+            ///link before publishing so snapshot readers can always walk past desired
+            desired->_older_snapshot = expected;
             auto const overwritten = smart_ptr::atomic_compare_exchange_strong(&mutable_current_, &expected, desired);
             if (overwritten)
             {
                 // std::cout << "overwritten =" << txn_id << desired->value<<std::endl;
-                ///set status commited
-                smart_ptr::atomic_store(&desired->_older_snapshot,expected);
+                expected->end_version = txn_id;
+                prune_after_write();
                 return desired;
             }
         }
@@ -304,20 +345,15 @@ namespace mvcc11 {
 
             ///2- Fetch/Read  expected Version speculatively
             auto expected = smart_ptr::atomic_load(&mutable_current_);
-            auto const const_expected_version = expected->version;
-            auto const const_expected_end_version = expected->end_version;
-            auto const &const_expected_value = expected->value;
 
 
             ///3- if record was created and its active currently and not by the current transaction
-            if ( const_expected_end_version != INF && const_expected_version != txn_id)
+            if (write_conflict(*expected, txn_id))
             {
-                if (TransactionsStatus[const_expected_version] == "Active" )
-                {
-
-                    std::cout << "Aborted" << std::endl;
-                    continue;
-                }
+                ///explicit transactions abort instead of waiting
+                if (is_txn_id(txn_id))
+                    return nullptr;
+                continue;
             }
 
             ///4- return expected old deleted with end version set to txn-id
@@ -333,6 +369,9 @@ namespace mvcc11 {
     template <class Updater>
     auto mvcc<ValueType>::update(size_t txn_id,Updater updater) -> const_snapshot_ptr
     {
+        ///explicit transactions abort instead of waiting
+        if (is_txn_id(txn_id))
+            return this->try_update_impl(txn_id,updater);
         while(true)
         {
             auto updated = this->try_update_impl(txn_id,updater);
@@ -380,9 +419,6 @@ namespace mvcc11 {
 
         ///1- Fetch/Read  expected Version speculatively: Set Active
         auto expected = smart_ptr::atomic_load(&mutable_current_);
-        auto const const_expected_version = expected->version;
-        auto const const_expected_end_version = expected->end_version;
-        auto const &const_expected_value = expected->value;
 
         ///2- Create New-Snapshot initially
         auto desired = smart_ptr::make_shared<snapshot_type>( txn_id, updater(expected->value));
@@ -390,23 +426,18 @@ namespace mvcc11 {
 
 
         ///3- if record was created and its active currently and not by the current transaction
-        if ( const_expected_end_version != INF && const_expected_version != txn_id)
+        if (write_conflict(*expected, txn_id))
         {
-            if (TransactionsStatus[const_expected_version] == "Active" )
-            {
-                std::cout << "Aborted on value " << expected->value<<" by transaction##"<< txn_id<<std::endl;
-                //continue;
-                return nullptr;
-            }
+            return nullptr;
         }
 
-        expected->end_version = txn_id;
+        desired->_older_snapshot = expected;
         auto const updated = smart_ptr::atomic_compare_exchange_strong(&mutable_current_, &expected, desired);
         if (updated)
         {
             // std::cout << "overwritten =" << txn_id << desired->value<<std::endl;
-            ///set status commited
-            smart_ptr::atomic_store(&desired->_older_snapshot,expected);
+            expected->end_version = txn_id;
+            prune_after_write();
             return desired;
         }
 
@@ -436,6 +467,136 @@ namespace mvcc11 {
         }
     }
 
+    template <class ValueType>
+    auto mvcc<ValueType>::visible(size_t read_ts, size_t txn_id) MVCC11_NOEXCEPT(true) -> const_snapshot_ptr
+    {
+        auto v = smart_ptr::atomic_load(&mutable_current_);
+        while (v != nullptr && !is_visible(*v, read_ts, txn_id))
+            v = smart_ptr::atomic_load(&v->_older_snapshot);
+        ///a committed version below the watermark is the cut point, readers prune too
+        if (v != nullptr && !is_txn_id(v->version) && v->version <= activeTxnRegistry.lowWatermark())
+            unlink_tail(v.get());
+        return v;
+    }
+
+    template <class ValueType>
+    template <class Fn>
+    void mvcc<ValueType>::for_each_version(Fn fn)
+    {
+        auto v = smart_ptr::atomic_load(&mutable_current_);
+        while (v != nullptr)
+        {
+            fn(*v);
+            v = smart_ptr::atomic_load(&v->_older_snapshot);
+        }
+    }
+
+    template <class ValueType>
+    size_t mvcc<ValueType>::prune(size_t watermark, size_t *kept) MVCC11_NOEXCEPT(true)
+    {
+        size_t depth = 0;
+        auto v = smart_ptr::atomic_load(&mutable_current_);
+        while (v != nullptr)
+        {
+            depth++;
+            if (!is_txn_id(v->version) && v->version != MVCC11_ABORTED_VERSION && v->version <= watermark)
+                break;
+            v = smart_ptr::atomic_load(&v->_older_snapshot);
+        }
+        if (kept != nullptr)
+            *kept = depth;
+        return v != nullptr ? unlink_tail(v.get()) : 0;
+    }
+
+    template <class ValueType>
+    void mvcc<ValueType>::prune_after_write() MVCC11_NOEXCEPT(true)
+    {
+        size_t kept = 0;
+        prune(activeTxnRegistry.lowWatermark(), &kept);
+        ///the cached watermark is stale or a long reader pins the chain, look again
+        if (kept > MVCC11_MAX_VERSION_DEPTH)
+            prune(activeTxnRegistry.refreshLowWatermark());
+    }
+
+    template <class ValueType>
+    size_t mvcc<ValueType>::unlink_tail(snapshot_type *v) MVCC11_NOEXCEPT(true)
+    {
+        auto tail = smart_ptr::atomic_load(&v->_older_snapshot);
+        ///the CAS hands the tail to exactly one pruner
+        if (tail == nullptr || !smart_ptr::atomic_compare_exchange_strong(&v->_older_snapshot, &tail, mutable_snapshot_ptr()))
+            return 0;
+        ///detach one by one, releasing a long tail must not recurse through the destructors
+        size_t unlinked = 0;
+        while (tail != nullptr)
+        {
+            auto older = smart_ptr::atomic_load(&tail->_older_snapshot);
+            smart_ptr::atomic_store(&tail->_older_snapshot, mutable_snapshot_ptr());
+            tail = older;
+            unlinked++;
+        }
+        return unlinked;
+    }
+
+    template <class ValueType>
+    size_t mvcc<ValueType>::previous_version(const_snapshot_ptr const &v) MVCC11_NOEXCEPT(true)
+    {
+        auto older = smart_ptr::atomic_load(&v->_older_snapshot);
+        return older != nullptr ? older->version : 0;
+    }
+
+    template <class ValueType>
+    void mvcc<ValueType>::commit_version(snapshot_type *v, size_t txn_id, size_t commit_ts) MVCC11_NOEXCEPT(true)
+    {
+        auto older = smart_ptr::atomic_load(&v->_older_snapshot);
+        if (older != nullptr && older->end_version == txn_id)
+            older->end_version = commit_ts;
+        if (v->end_version == txn_id)
+            v->end_version = commit_ts;
+        if (v->version == txn_id)
+            v->version = commit_ts;
+    }
+
+    template <class ValueType>
+    void mvcc<ValueType>::abort_version(snapshot_type *v, size_t txn_id) MVCC11_NOEXCEPT(true)
+    {
+        if (v->version != txn_id)
+        {
+            ///pending delete of an existing version
+            if (v->end_version == txn_id)
+                v->end_version = INF;
+            return;
+        }
+
+        auto older = smart_ptr::atomic_load(&v->_older_snapshot);
+        auto expected = smart_ptr::atomic_load(&mutable_current_);
+        if (older != nullptr && expected.get() == v &&
+            smart_ptr::atomic_compare_exchange_strong(&mutable_current_, &expected, older))
+        {
+            if (older->end_version == txn_id)
+                older->end_version = INF;
+            return;
+        }
+        if (older != nullptr && older->end_version == txn_id)
+            older->end_version = INF;
+        ///rolled back insert stays in place until GC removes its leaf
+        v->end_version = INF;
+        v->version = MVCC11_ABORTED_VERSION;
+    }
+
+    template <class ValueType>
+    const TxnWriteOps* mvcc<ValueType>::write_ops() MVCC11_NOEXCEPT(true)
+    {
+        static const TxnWriteOps ops = {
+                [](void* object, void* version, size_t txn_id, size_t commit_ts) {
+                    static_cast<mvcc*>(object)->commit_version(static_cast<snapshot_type*>(version), txn_id, commit_ts);
+                },
+                [](void* object, void* version, size_t txn_id) {
+                    static_cast<mvcc*>(object)->abort_version(static_cast<snapshot_type*>(version), txn_id);
+                }
+        };
+        return &ops;
+    }
+
 } // namespace mvcc11
 
 #endif // MVCC11_MVCC_HPP
\ No newline at end of file
@@ -32,7 +32,18 @@ using std::atomic_compare_exchange_strong
 #include <utility>
 #include <chrono>
 #include <thread>
-#define INF 99999
+#include <stdint.h>
+
+/// End version of a version nobody deleted or overwrote yet; larger than any timestamp or id
+#define MVCC11_INF_VERSION (~size_t(0))
+#define INF MVCC11_INF_VERSION
+
+/// Top bit marks a version field holding the id of a still running transaction
+#define MVCC11_TXN_ID_FLAG (size_t(1) << 63)
+/// Begin version of a rolled back insert, never visible and never a conflict
+#define MVCC11_ABORTED_VERSION MVCC11_TXN_ID_FLAG
+/// Id shared by all read-only transactions, no version ever carries it
+#define MVCC11_READ_ONLY_TXN_ID (MVCC11_TXN_ID_FLAG - 1)
 
 #ifdef MVCC11_DISABLE_NOEXCEPT
 #define MVCC11_NOEXCEPT(COND)
@@ -82,6 +93,34 @@ namespace mvcc11 {
 
 
 
+    /// True if a version field still names an uncommitted transaction
+    inline bool is_txn_id(size_t version) MVCC11_NOEXCEPT(true)
+    {
+        return (version & MVCC11_TXN_ID_FLAG) != 0 && version != INF && version != MVCC11_ABORTED_VERSION;
+    }
+
+    /**
+     * Snapshot isolation visibility of one version.
+     * @arg read_ts begin timestamp of the reader
+     * @arg txn_id id of the reader, its own uncommitted writes are visible
+     * @return true if the version belongs to the reader's snapshot
+     */
+    template <class ValueType>
+    bool is_visible(snapshot<ValueType> const &v, size_t read_ts, size_t txn_id) MVCC11_NOEXCEPT(true)
+    {
+        size_t const begin = v.version;
+        size_t const end = v.end_version;
+        if (begin != txn_id)
+        {
+            if (is_txn_id(begin) || begin == MVCC11_ABORTED_VERSION || begin > read_ts)
+                return false;
+        }
+        if (end == txn_id)
+            return false;
+        ///a pending delete of another transaction does not hide the version yet
+        return end == INF || is_txn_id(end) || end > read_ts;
+    }
+
     template <class ValueType>
     void snapshot<ValueType>::setOlderSnapshotNull()
     {